@@ -1,22 +1,29 @@
 #include "AGVCoreNetwork.h"
 #include "AGVCoreNetwork_Resources.h"
 #include <Arduino.h>
+#include <stdarg.h>
+#include <strings.h>
 
 using namespace AGVCoreNetworkLib;
 
-AGVCoreNetwork agvNetwork; // Global instance
+#if AGVNET_DEFAULT_INSTANCE
+AGVCoreNetwork agvNetwork;
+#endif
 
-// WebSocket event wrapper
-void webSocketEventHandler(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
-  agvNetwork.webSocketEvent(num, type, payload, length);
-}
+static_assert(WEBSOCKETS_SERVER_CLIENT_MAX < ControlLease::NONE, "Lease word holds 4-bit client numbers");
+static_assert(WEBSOCKETS_SERVER_CLIENT_MAX <= StreamCompressor::MAX_CLIENTS, "Compressor windows per client");
+static_assert(FlightRecorder::PAYLOAD_SIZE >= CommandFilter::MAX_COMMAND, "Recorded commands must replay whole");
+
+static bool isVerb(const char* cmd, const char* verb);
 
 void AGVCoreNetwork::begin(const char* deviceName, const char* adminUser, const char* adminPass) {
+  bootTimeline.start(Clock::ms());
   Serial.println("\n[AGVNET] Initializing AGV Core Network System...");
   
   // Initialize mutex for thread safety
   mutex = xSemaphoreCreateMutex();
-  if (!mutex) {
+  streamLock = xSemaphoreCreateMutex();
+  if (!mutex || !streamLock) {
     Serial.println("[ERROR] Failed to create network mutex!");
     return;
   }
@@ -26,11 +33,15 @@ void AGVCoreNetwork::begin(const char* deviceName, const char* adminUser, const
   this->admin_username = adminUser;
   this->admin_password = adminPass;
   
-  // Initialize preferences
-  preferences.begin("agvnet", false);
-  stored_ssid = preferences.getString("ssid", "");
-  stored_password = preferences.getString("password", "");
-  preferences.end();
+  // Event ids start from a random base each boot
+  history.reset(esp_random());
+  
+  // Load stored credentials
+  Storage::loadCredentials(storageNamespace, stored_ssid, stored_password);
+  if (fastBoot != FAST_BOOT_OFF) {
+    Storage::loadBootCache(storageNamespace, bootCache);
+  }
+  bootTimeline.mark(BootTimeline::PHASE_STORAGE, Clock::ms());
   
   // Setup WiFi based on stored credentials
   setupWiFi();
@@ -42,16 +53,25 @@ void AGVCoreNetwork::begin(const char* deviceName, const char* adminUser, const
       net->core0Task(NULL);
     },
     "AGVNetCore0",
-    10240,  // Reduced stack size
+    taskConfig.stackSize,
     this,
-    configMAX_PRIORITIES - 2,  // Slightly lower priority than motion
+    taskConfig.priority,
     &core0TaskHandle,
-    0       // Core 0
+    taskConfig.core
   ) != pdPASS) {
     Serial.println("[ERROR] Failed to create Core 0 task!");
   }
   
-  Serial.println("[AGVNET] ✅ Network System started on Core 0");
+  Serial.printf("[AGVNET] ✅ Network System started on Core %d (prio %u, stack %u)\n",
+               (int)taskConfig.core, (unsigned)taskConfig.priority, (unsigned)taskConfig.stackSize);
+}
+
+void AGVCoreNetwork::setTaskConfig(const TaskConfig& config) {
+  if (core0TaskHandle) {
+    Serial.println("[AGVNET] Task config ignored: network task already running");
+    return;
+  }
+  taskConfig = config;
 }
 
 void AGVCoreNetwork::setupWiFi() {
@@ -78,26 +98,30 @@ void AGVCoreNetwork::startAPMode() {
   delay(100);
   
   // Create DNS server for captive portal
-  dnsServer = new DNSServer();
-  dnsServer->start(53, "*", WiFi.softAPIP());
+  dnsServer = new CaptiveDns();
+  if (!dnsServer->start(53, (uint32_t)WiFi.softAPIP())) {
+    Serial.println("[ERROR] Captive DNS failed to start");
+  }
   
   isAPMode = true;
+  updateStatusField(statusSnapshot.apMode, true);
+  updateStatusField(statusSnapshot.ip, (uint32_t)WiFi.softAPIP());
   
   // Setup web server
-  server = new WebServer(80);
+  server = new WebServer(httpPort);
   
   // Setup routes for AP mode
-  server->on("/", HTTP_GET, [this](){ this->handleRoot(); });
-  server->on("/setup", HTTP_GET, [this](){ this->handleWiFiSetup(); });
-  server->on("/scan", HTTP_GET, [this](){ this->handleScan(); });
-  server->on("/savewifi", HTTP_POST, [this](){ this->handleSaveWiFi(); });
+  server->on("/", HTTP_GET, [this](){ if (admitRequest()) this->handleRoot(); });
+  server->on("/setup", HTTP_GET, [this](){ if (admitRequest()) this->handleWiFiSetup(); });
+  server->on("/scan", HTTP_GET, [this](){ if (admitRequest()) this->handleScan(); });
+  onBodyRoute("/savewifi", [this](){ this->handleSaveWiFi(); });
   
   // Captive portal redirects
-  server->on("/generate_204", HTTP_GET, [this](){ this->handleRoot(); });
-  server->on("/fwlink", HTTP_GET, [this](){ this->handleRoot(); });
-  server->on("/hotspot-detect.html", HTTP_GET, [this](){ this->handleRoot(); });
+  server->on("/generate_204", HTTP_GET, [this](){ if (admitRequest()) this->handleRoot(); });
+  server->on("/fwlink", HTTP_GET, [this](){ if (admitRequest()) this->handleRoot(); });
+  server->on("/hotspot-detect.html", HTTP_GET, [this](){ if (admitRequest()) this->handleRoot(); });
   
-  server->onNotFound([this](){ this->handleNotFound(); });
+  server->onNotFound([this](){ if (admitRequest()) this->handleNotFound(); });
   
   server->begin();
   Serial.println("[AGVNET] ✅ AP Mode Web Server Started");
@@ -107,212 +131,1532 @@ void AGVCoreNetwork::startStationMode() {
   Serial.println("\n[AGVNET] 🌐 Starting Station Mode");
   
   WiFi.mode(WIFI_STA);
-  WiFi.begin(stored_ssid.c_str(), stored_password.c_str());
+  beginAssociation(true);
+  bootTimeline.mark(BootTimeline::PHASE_RADIO, Clock::ms());
+  
+  Serial.printf("[AGVNET] Connecting to: %s%s\n", stored_ssid.c_str(),
+                bootCacheUsed ? " (cached access point)" : "");
+  
+  // Servers bind to all interfaces, so they can listen before the link is up
+  if (fastBoot != FAST_BOOT_OFF) {
+    startStationServers();
+  }
+  
+  // Completed by connectTask on the network task, so begin() returns at once
+  scheduler.start(&connectTask);
+}
+
+void AGVCoreNetwork::beginAssociation(bool useCache) {
+  bootCacheUsed = useCache && fastBoot != FAST_BOOT_OFF && bootCache.valid();
+  
+  bool reuseAddress = bootCacheUsed && fastBoot == FAST_BOOT_REUSE_ADDRESS && bootCache.ip != 0;
+  if (reuseAddress) {
+    WiFi.config(IPAddress(bootCache.ip), IPAddress(bootCache.gateway),
+                IPAddress(bootCache.subnet), IPAddress(bootCache.dns));
+  } else if (staticAddress) {
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());  // Back to DHCP
+  }
+  staticAddress = reuseAddress;
+  
+  if (bootCacheUsed) {
+    WiFi.begin(stored_ssid.c_str(), stored_password.c_str(), bootCache.channel, bootCache.bssid);
+  } else {
+    WiFi.begin(stored_ssid.c_str(), stored_password.c_str());
+  }
+}
+
+bool AGVCoreNetwork::ConnectTask::run(AsyncScheduler& scheduler) {
+  AGV_ASYNC_BEGIN();
+  
+  // An access point that moved channel or was replaced falls back to a scan
+  if (net->bootCacheUsed) {
+    deadline = Clock::ms() + CACHED_CONNECT_MS;
+    AGV_AWAIT_UNTIL(WiFi.status() == WL_CONNECTED || (int32_t)(Clock::ms() - deadline) >= 0);
+    
+    if (WiFi.status() != WL_CONNECTED) {
+      Serial.println("[AGVNET] Cached access point not answering, scanning...");
+      WiFi.disconnect();
+      net->beginAssociation(false);
+    }
+  }
+  
+  // Checked every loop rather than on a fixed tick, so services start as
+  // soon as the address is assigned
+  deadline = Clock::ms() + CONNECT_TIMEOUT_MS;
+  AGV_AWAIT_UNTIL(WiFi.status() == WL_CONNECTED || (int32_t)(Clock::ms() - deadline) >= 0);
+  
+  if (WiFi.status() == WL_CONNECTED) {
+    net->startStationServices();
+  } else {
+    Serial.println("\n[AGVNET] ❌ WiFi connection failed");
+    net->countFailedBoot();
+    Serial.println("[AGVNET] Falling back to AP mode...");
+    net->cleanupResources();  // Servers started early by fast boot
+    net->startAPMode();
+  }
+  
+  AGV_ASYNC_END();
+}
+
+void AGVCoreNetwork::startStationServices() {
+  bootTimeline.mark(BootTimeline::PHASE_CONNECTED, Clock::ms());
+  Serial.println("\n[AGVNET] ✅ WiFi Connected!");
+  Serial.printf("[AGVNET] IP Address: %s\n", WiFi.localIP().toString().c_str());
+  
+  isAPMode = false;
+  updateStatusField(statusSnapshot.apMode, false);
+  updateStatusField(statusSnapshot.ip, (uint32_t)WiFi.localIP());
+  
+  startStationServers();
+  bootTimeline.mark(BootTimeline::PHASE_READY, Clock::ms());
+  
+  // Start mDNS
+  if (MDNS.begin(mdnsName)) {
+    MDNS.addService("http", "tcp", httpPort);
+    advertiseService();
+    Serial.printf("[AGVNET] ✅ mDNS started: http://%s.local\n", mdnsName);
+  }
+  bootTimeline.mark(BootTimeline::PHASE_MDNS, Clock::ms());
+  
+  startTransports();
+  
+  if (fastBoot != FAST_BOOT_OFF) {
+    saveBootCache();
+  }
+  
+  // Reaching the network confirms a freshly updated image
+  if (OtaUpdater::pendingVerify()) {
+    OtaUpdater::confirmImage();
+    Storage::saveFailedBoots(storageNamespace, 0);
+  }
+}
+
+// An access point that is down or out of range also fails the connect, so
+// an unconfirmed image is only rolled back after several boots in a row
+void AGVCoreNetwork::countFailedBoot() {
+  if (!OtaUpdater::pendingVerify()) return;
+  
+  uint8_t failed = Storage::loadFailedBoots(storageNamespace) + 1;
+  if (failed < ROLLBACK_AFTER_FAILED_BOOTS) {
+    Storage::saveFailedBoots(storageNamespace, failed);
+    Serial.printf("[AGVNET] Unconfirmed firmware failed to connect (%u of %u boots)\n",
+                  (unsigned)failed, (unsigned)ROLLBACK_AFTER_FAILED_BOOTS);
+    return;
+  }
+  Storage::saveFailedBoots(storageNamespace, 0);
+  OtaUpdater::rollback();
+}
+
+// Web server, WebSocket and poll server; runs at most once per station start
+void AGVCoreNetwork::startStationServers() {
+  if (server) return;
+  
+  // Setup web server and WebSocket (published only once started, since
+  // Core 1 may already be calling sendStatus())
+  server = new WebServer(httpPort);
+  WebSocketsServer* ws = new WebSocketsServer(wsPort);
+  ws->begin();
+  ws->onEvent([this](uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+    this->webSocketEvent(num, type, payload, length);
+  });
+  webSocket = ws;
+  
+  setupRoutes();
+  server->begin();
+    
+  // Persistent-connection server for SCADA/dashboard polling
+  if (pollServerPort > 0) {
+    pollServer = new KeepAliveServer(pollServerPort);
+    pollServer->on("/status", "application/json", [this](const char*& body) {
+      size_t len = 0;
+      body = getStatusJson(len);
+      return len;
+    });
+    pollServer->onAdmit([this](uint32_t ip) { return this->admitClient(ip); });
+    pollServer->begin();
+  }
+  
+  Serial.println("[AGVNET] ✅ Station Mode Web Server Started");
+  Serial.printf("[AGVNET] ✅ WebSocket Server Started (Port %u)\n", wsPort);
+  if (pollServer) {
+    Serial.printf("[AGVNET] ✅ Keep-Alive Poll Server Started (Port %u)\n", pollServerPort);
+  }
+  
+  bootTimeline.mark(BootTimeline::PHASE_SERVERS, Clock::ms());
+}
+
+// Written only when the association changed, to spare the flash
+void AGVCoreNetwork::saveBootCache() {
+  BootCache cache;
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid) memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = (uint8_t)WiFi.channel();
+  cache.ip = (uint32_t)WiFi.localIP();
+  cache.gateway = (uint32_t)WiFi.gatewayIP();
+  cache.subnet = (uint32_t)WiFi.subnetMask();
+  cache.dns = (uint32_t)WiFi.dnsIP();
+  
+  if (cache == bootCache) return;
+  bootCache = cache;
+  Storage::saveBootCache(storageNamespace, bootCache);
+}
+
+void AGVCoreNetwork::setupRoutes() {
+  if (!server || isAPMode) return;
+  
+  // Protected routes (require authentication)
+  server->on("/", HTTP_GET, [this](){ 
+    if (admitRequest() && validateToken()) this->handleDashboard(); 
+  });
+  
+  onBodyRoute("/login", [this](){ this->handleLogin(); });
+  onBodyRoute("/command", [this](){ 
+    if (validateToken()) this->handleCommand(); 
+  });
+  
+  // Public routes
+  server->on("/status", HTTP_GET, [this](){ 
+    if (!admitRequest()) return;
+    size_t len = 0;
+    const char* json = getStatusJson(len);
+    this->server->send_P(200, "application/json", json, len);
+  });
+  
+  server->on("/debug/tasks", HTTP_GET, [this](){ 
+    if (admitRequest() && validateToken()) this->handleDebugTasks(); 
+  });
+  
+  server->on("/debug/recorder", HTTP_GET, [this](){ 
+    if (admitRequest() && validateToken()) this->handleDebugRecorder(); 
+  });
+  
+  server->on("/debug/boot", HTTP_GET, [this](){ 
+    if (admitRequest() && validateToken()) this->handleDebugBoot(); 
+  });
+  
+  server->on("/debug/link", HTTP_GET, [this](){ 
+    if (admitRequest() && validateToken()) this->handleDebugLink(); 
+  });
+  
+  // Firmware upload (multipart); the image is streamed to flash as it arrives
+  server->on("/ota", HTTP_POST, [this](){ this->handleOtaFinish(); },
+                                [this](){ this->handleOtaUpload(); });
+  
+  // Bearer tokens are only visible to handlers for collected headers
+  const char* headerKeys[] = {"Authorization"};
+  server->collectHeaders(headerKeys, 1);
+  
+  server->onNotFound([this](){ if (admitRequest()) this->handleNotFound(); });
+}
+
+// Rate limit shared by every route; refused requests get a fixed 429
+bool AGVCoreNetwork::admitRequest() {
+  if (admitClient((uint32_t)server->client().remoteIP())) return true;
+  sendTooManyRequests();
+  return false;
+}
+
+void AGVCoreNetwork::sendTooManyRequests() {
+  server->sendHeader("Retry-After", "1");
+  server->send(429, "text/plain", "Too Many Requests");
+}
+
+// Web and poll server requests; the caller answers refusals
+bool AGVCoreNetwork::admitClient(uint32_t ip) {
+  RequestGuard::Verdict verdict = guard.admit(ip, Clock::ms());
+  if (verdict == RequestGuard::LIMITED_FIRST) logRateLimited(ip);
+  return verdict == RequestGuard::ADMIT;
+}
+
+// WebSocket counterpart; STOP/ABORT and replayed records are never refused
+bool AGVCoreNetwork::admitMessage(uint8_t num, const char* text) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  if (replayingRecord) return true;
+  if (text && (isVerb(text, "STOP") || isVerb(text, "ABORT"))) return true;
+  
+  RequestGuard::Verdict verdict = guard.admit(clientIps[num], Clock::ms());
+  if (verdict == RequestGuard::ADMIT) return true;
+  
+  if (verdict == RequestGuard::LIMITED_FIRST) {
+    logRateLimited(clientIps[num]);
+    webSocket->sendTXT(num, "NACK: RATE limited");
+  }
+  return false;
+}
+
+// Motion commands need the lease, unless a recorded session is replaying
+bool AGVCoreNetwork::mayCommand(uint8_t num) {
+  return replayingRecord || controlLease.holds(num, Clock::ms());
+}
+
+void AGVCoreNetwork::logRateLimited(uint32_t ip) {
+  Serial.printf("[GUARD] Rate limiting %u.%u.%u.%u\n", (unsigned)(ip & 0xFF), (unsigned)((ip >> 8) & 0xFF),
+                (unsigned)((ip >> 16) & 0xFF), (unsigned)(ip >> 24));
+}
+
+// POST routes with a body: the raw handler copies it into a bounded buffer as
+// it is read, so an oversized body is never materialized as server->arg("plain")
+void AGVCoreNetwork::onBodyRoute(const char* uri, std::function<void()> handler) {
+  server->on(uri, HTTP_POST, [this, handler](){
+    if (admitRequest()) {
+      if (bodyState == BODY_OVERSIZE) {
+        server->send(413, "text/plain", "Payload Too Large");
+      } else {
+        handler();
+      }
+    }
+    bodyState = BODY_NONE;
+  }, [this](){ this->captureBody(); });
+}
+
+void AGVCoreNetwork::captureBody() {
+  HTTPRaw& raw = server->raw();
+  
+  switch (raw.status) {
+    case RAW_START:
+      bodyLength = 0;
+      bodyState = BODY_CAPTURING;
+      break;
+    case RAW_WRITE:
+      if (bodyState != BODY_CAPTURING) break;
+      if (bodyLength + raw.currentSize > MAX_BODY) {
+        bodyState = BODY_OVERSIZE;   // The rest is drained by the server
+        break;
+      }
+      memcpy(requestBody + bodyLength, raw.buf, raw.currentSize);
+      bodyLength += raw.currentSize;
+      break;
+    case RAW_END:
+      if (bodyState == BODY_CAPTURING) bodyState = BODY_CAPTURED;
+      requestBody[bodyLength] = '\0';
+      break;
+    case RAW_ABORTED:
+      bodyState = BODY_NONE;
+      break;
+  }
+}
+
+// Body of the current request. Form-encoded bodies do not go through the raw
+// handler; the server has already parsed those, so only the length is checked.
+bool AGVCoreNetwork::readBody(String& body) {
+  if (bodyState == BODY_CAPTURED) {
+    body = requestBody;
+    return true;
+  }
+  
+  body = server->arg("plain");
+  if (body.length() <= MAX_BODY) return true;
+  
+  body = String();
+  server->send(413, "text/plain", "Payload Too Large");
+  return false;
+}
+
+void AGVCoreNetwork::core0Task(void *parameter) {
+  Serial.println("[CORE0] AGV Network task started on Core 0");
+  
+  profiler.start(Clock::us());
+  
+  while(1) {
+    uint32_t loopStart = Clock::us();
+    uint32_t t = loopStart;
+    
+    if (isAPMode && dnsServer) {
+      dnsServer->poll();
+      t = profileSection(SUBSYS_DNS, t);
+    }
+    
+    if (server) {
+      server->handleClient();
+    }
+    
+    if (pollServer) {
+      pollServer->poll();
+    }
+    t = profileSection(SUBSYS_HTTP, t);
+    
+    if (webSocket) {
+      webSocket->loop();
+      t = profileSection(SUBSYS_WS, t);
+    }
+    
+    processSerialInput();
+    t = profileSection(SUBSYS_SERIAL, t);
+    
+    for (uint8_t i = 0; i < transportCount; i++) {
+      transports[i]->loop();
+    }
+    t = profileSection(SUBSYS_TRANSPORT, t);
+    
+    // Link edges become events for waiting tasks
+    bool linkUp = WiFi.status() == WL_CONNECTED;
+    if (linkUp != wifiLinkUp) {
+      wifiLinkUp = linkUp;
+      scheduler.signal(linkUp ? AsyncScheduler::EVENT_WIFI_CONNECTED
+                              : AsyncScheduler::EVENT_WIFI_DISCONNECTED);
+    }
+    scheduler.poll();
+    t = profileSection(SUBSYS_ASYNC, t);
+    
+    serviceLink();
+    
+    if (mdnsStarted) {
+      updateAdvertisement(false);
+      serviceDiscovery();
+    }
+    
+    if (replayer.active()) {
+      processReplay();
+    }
+    
+    if (timedCommands.pending()) {
+      timedCommands.advance(Clock::timeUs(),
+        [this](uint8_t num, const char* cmd, uint32_t epoch, int64_t lateUs) {
+          releaseTimedCommand(num, cmd, epoch, lateUs);
+        });
+    }
+    
+    if (Clock::ms() - lastStatusRefresh >= 1000) {
+      refreshStatusSnapshot();
+    }
+    
+    if (Clock::ms() - lastStatusPush >= 100) {
+      updateStatusField(statusSnapshot.leaseHolder, getLeaseHolder());
+      pushStatusDeltas();
+      serviceTimeSync();
+    }
+    
+    profileLoopEnd(loopStart, t);
+    
+    delay(1);
+  }
+}
+
+// Applies the link profile for the current motion state and measures it with
+// a WebSocket ping to one client at a time (browsers answer pings natively)
+void AGVCoreNetwork::serviceLink() {
+  if (isAPMode || !wifiLinkUp) return;
+  
+  uint32_t now = Clock::ms();
+  LinkProfile profile = linkPolicy.evaluate(now);
+  if (profile != linkPolicy.current() && Link::applyProfile(profile)) {
+    linkPolicy.applied(profile, now);
+    linkProbePending = false;   // A reply now would mix the two profiles
+    Serial.printf("[LINK] Profile: %s\n", LinkPolicy::name(profile));
+  }
+  
+  if (!webSocket) return;
+  if (linkProbePending) {
+    if (Clock::us() - linkProbeSentUs < LINK_PROBE_TIMEOUT_MS * 1000) return;
+    linkProbePending = false;   // Lost; not counted as a sample
+  }
+  if ((int32_t)(now - linkProbeDue) < 0) return;
+  linkProbeDue = now + LINK_PROBE_MS;
+  
+  for (uint8_t i = 1; i <= WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    uint8_t num = (linkProbeClient + i) % WEBSOCKETS_SERVER_CLIENT_MAX;
+    if (!webSocket->clientIsConnected(num)) continue;
+    
+    linkProbeClient = num;
+    linkProbeSentUs = Clock::us();
+    linkProbePending = webSocket->sendPing(num);
+    break;
+  }
+}
+
+// Fleet service: _agv._tcp on the WebSocket port with the TXT records listed
+// in AGVCoreNetwork_Discovery.h
+void AGVCoreNetwork::advertiseService() {
+  char value[12];
+  MDNS.addService("agv", "tcp", wsPort);
+  
+  snprintf(value, sizeof(value), "%u", (unsigned)AGV_PROTOCOL_VERSION);
+  MDNS.addServiceTxt("agv", "tcp", "proto", value);
+  snprintf(value, sizeof(value), "%u", (unsigned)wsPort);
+  MDNS.addServiceTxt("agv", "tcp", "ws", value);
+  snprintf(value, sizeof(value), "%u", (unsigned)httpPort);
+  MDNS.addServiceTxt("agv", "tcp", "http", value);
+  MDNS.addServiceTxt("agv", "tcp", "fw", esp_ota_get_app_description()->version);
+  MDNS.addServiceTxt("agv", "tcp", "caps", "path,time,lz,resume,lease,ota");
+  
+  mdnsStarted = true;
+  updateAdvertisement(true);
+}
+
+// Every TXT change is multicast to the fleet, so only changed values are
+// written and the load figures are held back
+void AGVCoreNetwork::updateAdvertisement(bool force) {
+  uint32_t now = Clock::ms();
+  if (!force && now - advertAt < ADVERT_STATE_MS) return;
+  
+  FleetDiscovery::State state = emergency.isActive() ? FleetDiscovery::STATE_ESTOP
+                              : linkPolicy.isMoving() ? FleetDiscovery::STATE_MOVING
+                              : FleetDiscovery::STATE_IDLE;
+  if (force || state != advertState) {
+    advertState = state;
+    advertAt = now;
+    MDNS.addServiceTxt("agv", "tcp", "state", FleetDiscovery::stateName(state));
+  }
+  
+  if (!force && now - advertLoadAt < ADVERT_LOAD_MS) return;
+  advertLoadAt = now;
+  
+  TaskProfile profile;
+  uint8_t clients = webSocket ? webSocket->connectedClients() : 0;
+  uint8_t cpu = getTaskProfile(profile) ? (uint8_t)((profile.cpuPercent + 5) / 10 * 10) : 0;
+  char value[8];
+  if (force || clients != advertClients) {
+    advertClients = clients;
+    snprintf(value, sizeof(value), "%u", (unsigned)clients);
+    MDNS.addServiceTxt("agv", "tcp", "clients", value);
+  }
+  if (force || cpu != advertCpu) {
+    advertCpu = cpu;
+    snprintf(value, sizeof(value), "%u", (unsigned)cpu);
+    MDNS.addServiceTxt("agv", "tcp", "cpu", value);
+  }
+}
+
+bool AGVCoreNetwork::discoverVehicles(uint32_t timeoutMs) {
+  if (isDiscovering() || timeoutMs == 0) return false;
+  if (!discovery.begin()) return false;
+  discoveryRequest = timeoutMs;
+  return true;
+}
+
+size_t AGVCoreNetwork::getVehicles(FleetDiscovery::Vehicle* vehicles, size_t max) {
+  size_t count = 0;
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    count = discovery.copy(vehicles, max, Clock::ms());
+    xSemaphoreGive(mutex);
+  }
+  return count;
+}
+
+bool AGVCoreNetwork::findVehicle(const char* name, FleetDiscovery::Vehicle& vehicle) {
+  bool found = false;
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    found = discovery.find(name, vehicle, Clock::ms());
+    xSemaphoreGive(mutex);
+  }
+  return found;
+}
+
+// One asynchronous PTR query at a time; its answers are merged in a batch
+// when it completes, so the network loop never blocks on mDNS
+void AGVCoreNetwork::serviceDiscovery() {
+  if (!discoveryQuery) {
+    if (!discoveryRequest) return;
+    discoveryQuery = mdns_query_async_new(nullptr, "_agv", "_tcp", MDNS_TYPE_PTR,
+                                          discoveryRequest, DISCOVERY_MAX_RESULTS, nullptr);
+    discoveryRequest = 0;
+    if (!discoveryQuery) Serial.println("[MDNS] ❌ Discovery query failed to start");
+    return;
+  }
+  
+  mdns_result_t* results = nullptr;
+  if (!mdns_query_async_get_results(discoveryQuery, 0, &results)) return;
+  
+  uint32_t now = Clock::ms();
+  size_t found = 0;
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    for (mdns_result_t* r = results; r; r = r->next) {
+      if (!r->instance_name || strcasecmp(r->instance_name, mdnsName) == 0) continue;
+      
+      uint32_t ip = 0;
+      for (mdns_ip_addr_t* a = r->addr; a && !ip; a = a->next) {
+        if (a->addr.type == ESP_IPADDR_TYPE_V4) ip = a->addr.u_addr.ip4.addr;
+      }
+      
+      FleetDiscovery::TxtItem txt[DISCOVERY_MAX_TXT];
+      size_t txtCount = r->txt_count < DISCOVERY_MAX_TXT ? r->txt_count : DISCOVERY_MAX_TXT;
+      for (size_t i = 0; i < txtCount; i++) {
+        txt[i].key = r->txt[i].key;
+        txt[i].value = r->txt[i].value;
+      }
+      
+      if (discovery.ingest(r->instance_name, ip, r->port, txt, txtCount, now)) {
+        found++;
+      }
+    }
+    xSemaphoreGive(mutex);
+  }
+  
+  mdns_query_results_free(results);
+  mdns_query_async_delete(discoveryQuery);
+  discoveryQuery = nullptr;
+  Serial.printf("[MDNS] Discovery: %u vehicles answered, %u cached\n",
+                (unsigned)found, (unsigned)discovery.size(now));
+}
+
+// Task profiler
+uint32_t AGVCoreNetwork::profileSection(Subsystem subsystem, uint32_t start) {
+  if (!profilingEnabled) return start;
+  return profiler.section(subsystem, start, Clock::us());
+}
+
+void AGVCoreNetwork::profileLoopEnd(uint32_t loopStart, uint32_t loopEnd) {
+  if (!profilingEnabled) return;
+  
+  // Publish each completed window
+  TaskProfile completed;
+  if (!profiler.loopEnd(loopStart, loopEnd, completed)) return;
+  completed.stackHighWater = uxTaskGetStackHighWaterMark(NULL);
+  
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(5)) == pdPASS) {
+    profileSnapshot = completed;
+    xSemaphoreGive(mutex);
+  }
+}
+
+void AGVCoreNetwork::setProfilingEnabled(bool enabled, uint32_t windowMs) {
+  if (windowMs == 0) windowMs = 1000;
+  
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    profiler.setWindow(windowMs * 1000);
+    profilingEnabled = enabled;
+    xSemaphoreGive(mutex);
+  }
+}
+
+bool AGVCoreNetwork::getTaskProfile(TaskProfile& profile) {
+  if (!mutex || !profilingEnabled) return false;
+  
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    profile = profileSnapshot;
+    xSemaphoreGive(mutex);
+    return profile.windowUs > 0;
+  }
+  return false;
+}
+
+void AGVCoreNetwork::processSerialInput() {
+  // Bounded per loop so a long line cannot starve the other subsystems
+  for (size_t n = 0; n < SERIAL_CHUNK && Serial.available() > 0; n++) {
+    char c = Serial.read();
+    
+    if (c == '\n' || c == '\r') {
+      finishSerialLine();
+    } else if (serialAssembler.active()) {
+      serialAssembler.append(&c, 1);
+    } else if (serialLength < sizeof(serialBuffer) - 1) {
+      serialBuffer[serialLength++] = c;
+    } else if (commandViewCallback) {
+      // Past the inline buffer: continue in a pooled one
+      serialAssembler.start(payloadPool);
+      serialAssembler.append(serialBuffer, serialLength);
+      serialAssembler.append(&c, 1);
+    } else {
+      serialOverflow = true;
+    }
+  }
+  
+  size_t pending = serialAssembler.active() ? serialAssembler.length() : serialLength;
+  updateStatusField(statusSnapshot.serialPending, (uint8_t)(pending < 255 ? pending : 255));
+}
+
+void AGVCoreNetwork::finishSerialLine() {
+  const char* line = serialBuffer;
+  size_t length = serialLength;
+  serialBuffer[serialLength] = '\0';
+  
+  if (serialAssembler.active()) {
+    switch (serialAssembler.finish(line, length)) {
+      case PayloadAssembler::ASSEMBLE_OK:
+        break;
+      case PayloadAssembler::ASSEMBLE_OVERFLOW:
+        serialOverflow = true;
+        break;
+      case PayloadAssembler::ASSEMBLE_NO_BUFFER:
+        Serial.println("[SERIAL] Command rejected (no buffer)");
+        length = 0;
+        break;
+    }
+  }
+  
+  if (serialOverflow) {
+    Serial.println("[SERIAL] Command rejected (too long)");
+  } else {
+    handleSerialLine(line, length);
+  }
+  
+  serialOverflow = false;
+  serialLength = 0;
+  serialAssembler.release();
+}
+
+void AGVCoreNetwork::handleSerialLine(const char* line, size_t length) {
+  // Blank lines (e.g. the second half of CR LF) are ignored
+  size_t start = 0;
+  while (start < length && isspace((unsigned char)line[start])) start++;
+  if (start == length) return;
+  
+  int shown = (int)(length < CommandFilter::MAX_COMMAND ? length : CommandFilter::MAX_COMMAND);
+  const char* more = length > CommandFilter::MAX_COMMAND ? "..." : "";
+  recorder.record(FlightRecorder::REC_SERIAL_COMMAND, 0, line, length);
+  Serial.printf("\n[SERIAL] Command received: '%.*s%s'\n", shown, line, more);
+  
+  // Process command immediately
+  processSerialCommand(line, length);
+  
+  // Echo back to serial
+  Serial.printf("[SERIAL] Executed: %.*s%s\n", shown, line, more);
+  
+  // Broadcast to web clients (if not in AP mode)
+  if (!isAPMode && !emergency.isActive()) {
+    char broadcastMsg[80];
+    snprintf(broadcastMsg, sizeof(broadcastMsg), "SERIAL: %.*s", (int)(length - start), line + start);
+    sendStatus(broadcastMsg);
+  }
+}
+
+void AGVCoreNetwork::processSerialCommand(const char* cmd, size_t length) {
+  // Emergency commands bypass everything
+  if (handleEmergencyCommand(cmd, EmergencyState::SOURCE_SERIAL)) {
+    return;
+  }
+  
+  // Only process valid commands if not in emergency state
+  if (emergency.isActive()) {
+    Serial.println("[SERIAL] Command blocked: System emergency active");
+    return;
+  }
+  
+  if (!filterCommand(cmd, length, "SERIAL", nullptr)) return;
+  
+  // Send to command callback if registered
+  updateStatusText(statusSnapshot.lastCommand, sizeof(statusSnapshot.lastCommand), cmd);
+  linkPolicy.activity(Clock::ms());
+  
+  deliverCommand(cmd, length);
+}
+
+bool AGVCoreNetwork::processWebCommand(const char* cmd, size_t length, EmergencyState::Source source,
+                                       const char** rejection) {
+  // Emergency commands bypass everything
+  if (handleEmergencyCommand(cmd, source)) {
+    return true;
+  }
+  
+  // Only process if not in emergency state
+  if (emergency.isActive()) {
+    Serial.println("[WEB] Command blocked: System emergency active");
+    if (rejection) *rejection = "emergency active";
+    return false;
+  }
+  
+  if (!filterCommand(cmd, length, "WEB", rejection)) return false;
+  
+  // Send to command callback if registered
+  updateStatusText(statusSnapshot.lastCommand, sizeof(statusSnapshot.lastCommand), cmd);
+  linkPolicy.activity(Clock::ms());
+  
+  deliverCommand(cmd, length);
+  return true;
+}
+
+// The view callback gets every command; the C-string one only ever sees
+// commands within CommandFilter::MAX_COMMAND (the filter limit without a
+// view callback)
+void AGVCoreNetwork::deliverCommand(const char* cmd, size_t length) {
+  if (commandViewCallback) {
+    commandViewCallback(cmd, length);
+  } else if (commandCallback) {
+    commandCallback(cmd);
+  }
+}
+
+// Validation stage shared by every command source; runs after the stop verbs
+// so those can never be filtered out
+bool AGVCoreNetwork::filterCommand(const char* cmd, size_t length, const char* tag, const char** rejection) {
+  CommandFilter::Verdict verdict = filter.check(cmd, length, Clock::ms(), linkPolicy.isMoving());
+  if (verdict == CommandFilter::CMD_OK) return true;
+  
+  Serial.printf("[%s] Command rejected (%s): '%.*s'\n", tag, CommandFilter::reason(verdict),
+                (int)CommandFilter::MAX_COMMAND, cmd);
+  if (rejection) *rejection = CommandFilter::reason(verdict);
+  return false;
+}
+
+// Case-insensitive verb match ignoring surrounding whitespace
+static bool isVerb(const char* cmd, const char* verb) {
+  while (*cmd == ' ' || *cmd == '\t') cmd++;
+  
+  size_t verbLength = strlen(verb);
+  if (strncasecmp(cmd, verb, verbLength) != 0) return false;
+  
+  for (cmd += verbLength; *cmd; cmd++) {
+    if (*cmd != ' ' && *cmd != '\t' && *cmd != '\r' && *cmd != '\n') return false;
+  }
+  return true;
+}
+
+// STOP/ABORT/CLEAR_EMERGENCY from any operator interface
+bool AGVCoreNetwork::handleEmergencyCommand(const char* cmd, EmergencyState::Source source) {
+  bool stop = isVerb(cmd, "STOP");
+  if (stop || isVerb(cmd, "ABORT")) {
+    static const char* const sourceNames[] = {"", "serial", "websocket", "http", "application", "transport"};
+    bool remote = source == EmergencyState::SOURCE_TRANSPORT;
+    char message[48];
+    snprintf(message, sizeof(message), "%s %s via %s", remote ? "Remote" : "Operator",
+             stop ? "STOP" : "ABORT", sourceNames[source]);
+    
+    EmergencyState::Reason reason = remote ? EmergencyState::REASON_TRANSPORT
+                                  : stop ? EmergencyState::REASON_OPERATOR_STOP : EmergencyState::REASON_ABORT;
+    enterEmergency(reason, source, message);
+    
+    // Stop verbs always reach the application as well
+    deliverCommand(cmd, strlen(cmd));
+    return true;
+  }
+  
+  if (isVerb(cmd, "CLEAR_EMERGENCY")) {
+    exitEmergency();
+    return true;
+  }
+  
+  return false;
+}
+
+void AGVCoreNetwork::webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+  switch(type) {
+    case WStype_DISCONNECTED:
+      Serial.printf("[WS] Client #%u disconnected\n", num);
+      recorder.record(FlightRecorder::REC_CLIENT_DISCONNECT, num, nullptr, 0);
+      if (num < WEBSOCKETS_SERVER_CLIENT_MAX) {
+        clientTopics[num] = 0;
+        pathDecoders[num].reset();
+        clientClocks[num].reset();
+        setCompression(num, false);
+        cursorClients &= ~(1u << num);
+        fragments[num] = FRAGMENT_NONE;
+        fragmentAssemblers[num].release();
+      }
+      controlLease.drop(num);
+      break;
+      
+    case WStype_CONNECTED:
+      {
+        IPAddress ip = webSocket->remoteIP(num);
+        Serial.printf("[WS] Client #%u connected from %d.%d.%d.%d\n", 
+                     num, ip[0], ip[1], ip[2], ip[3]);
+        uint8_t ipBytes[4] = {ip[0], ip[1], ip[2], ip[3]};
+        recorder.record(FlightRecorder::REC_CLIENT_CONNECT, num, ipBytes, sizeof(ipBytes));
+        if (num < WEBSOCKETS_SERVER_CLIENT_MAX) {
+          clientIps[num] = (uint32_t)ip;
+          if (guard.admit(clientIps[num], Clock::ms()) != RequestGuard::ADMIT) {
+            webSocket->disconnect(num);
+            break;
+          }
+          clientTopics[num] = 0;
+          pathDecoders[num].reset();
+          clientClocks[num].reset();
+          setCompression(num, false);
+          cursorClients &= ~(1u << num);
+        }
+        webSocket->sendTXT(num, "AGV Connected - Ready for commands");
+      }
+      break;
+      
+    case WStype_TEXT:
+      if (!admitMessage(num, (const char*)payload)) break;
+      handleTextMessage(num, (const char*)payload, length);
+      break;
+      
+    case WStype_FRAGMENT_TEXT_START:
+    case WStype_FRAGMENT_BIN_START:
+    case WStype_FRAGMENT:
+    case WStype_FRAGMENT_FIN:
+      handleFragment(num, type, payload, length);
+      break;
+      
+    case WStype_BIN:
+      if (!admitMessage(num, nullptr)) break;
+      handlePathFrame(num, payload, length);
+      break;
+      
+    case WStype_PONG:
+      if (linkProbePending && num == linkProbeClient) {
+        linkPolicy.recordLatency(Clock::us() - linkProbeSentUs);
+        linkProbePending = false;
+      }
+      break;
+      
+    default:
+      break;
+  }
+}
+
+// Text messages, whole or reassembled; text is NUL-terminated at length
+void AGVCoreNetwork::handleTextMessage(uint8_t num, const char* text, size_t length) {
+  // Control messages are answered to the sender only
+  if (handleControlMessage(num, text, length)) {
+    recorder.record(FlightRecorder::REC_WS_CONTROL, num, text, length);
+    return;
+  }
+  recorder.record(FlightRecorder::REC_WS_COMMAND, num, text, length);
+  
+  // Refused rather than truncated
+  if (length > filter.getMaxLength()) {
+    sendCommandNack(num, "too long");
+    return;
+  }
+  
+  // Only the lease holder commands motion; stops are open to everyone
+  if (!mayCommand(num) && !isVerb(text, "STOP") && !isVerb(text, "ABORT")) {
+    sendFramed(num, "NACK: ", "LEASE required", 14);
+    return;
+  }
+  
+  // AT:<client time us>:<command> waits in the timer wheel
+  if (strncmp(text, "AT:", 3) == 0) {
+    scheduleTimedCommand(num, text + 3, length - 3);
+    return;
+  }
+  
+  // Long payloads are logged and acknowledged by size rather than echoed
+  char summary[40];
+  const char* shown = text;
+  size_t shownLength = length;
+  if (length > CommandFilter::MAX_COMMAND) {
+    shownLength = snprintf(summary, sizeof(summary), "payload of %u bytes", (unsigned)length);
+    shown = summary;
+  }
+  
+  Serial.printf("\n[WS] Command received from client #%u: '%.*s'\n", num, (int)shownLength, shown);
+  
+  // Process command
+  const char* rejection = nullptr;
+  if (!processWebCommand(text, length, EmergencyState::SOURCE_WEBSOCKET, &rejection)) {
+    sendCommandNack(num, rejection);
+    return;
+  }
+  
+  // Send confirmation back to client
+  sendFramed(num, "ACK: ", shown, shownLength);
+  
+  // Broadcast to all clients
+  sendFramed(ALL_CLIENTS, "WS: ", shown, shownLength, STREAM_LOG);
+}
+
+// Fragmented messages: text is reassembled into a pooled buffer; binary goes
+// straight to the path decoder, which already works on a stream
+void AGVCoreNetwork::handleFragment(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  PayloadAssembler& assembler = fragmentAssemblers[num];
+  
+  if (type == WStype_FRAGMENT_TEXT_START || type == WStype_FRAGMENT_BIN_START) {
+    assembler.release();
+    bool binary = type == WStype_FRAGMENT_BIN_START;
+    if (!admitMessage(num, nullptr)) {
+      fragments[num] = FRAGMENT_DROPPED;
+    } else if (binary) {
+      fragments[num] = FRAGMENT_BINARY;
+    } else {
+      fragments[num] = FRAGMENT_TEXT;
+      assembler.start(payloadPool);
+    }
+  }
+  
+  switch (fragments[num]) {
+    case FRAGMENT_BINARY:
+      handlePathFrame(num, payload, length);
+      break;
+    case FRAGMENT_TEXT:
+      assembler.append(payload, length);
+      break;
+    default:
+      break;
+  }
+  
+  if (type != WStype_FRAGMENT_FIN) return;
+  FragmentState state = fragments[num];
+  fragments[num] = FRAGMENT_NONE;
+  if (state != FRAGMENT_TEXT) return;
+  
+  const char* text;
+  size_t textLength;
+  switch (assembler.finish(text, textLength)) {
+    case PayloadAssembler::ASSEMBLE_OK:
+      handleTextMessage(num, text, textLength);
+      break;
+    case PayloadAssembler::ASSEMBLE_OVERFLOW:
+      sendCommandNack(num, "too long");
+      break;
+    case PayloadAssembler::ASSEMBLE_NO_BUFFER:
+      sendCommandNack(num, "no buffer");
+      break;
+  }
+  assembler.release();
+}
+
+// A path may span several binary frames and several paths may share one
+// frame; each client has its own decoder
+void AGVCoreNetwork::handlePathFrame(uint8_t num, const uint8_t* data, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  
+  PathDecoder& decoder = pathDecoders[num];
+  recorder.recordStream(FlightRecorder::REC_PATH_FRAME, num, data, length);
+  
+  // Motion data is refused while the emergency latch is set
+  if (emergency.isActive()) {
+    decoder.reset();
+    sendFramed(num, "NACK: ", "PATH emergency active", 21);
+    return;
+  }
+  
+  if (!mayCommand(num)) {
+    decoder.reset();
+    sendFramed(num, "NACK: ", "LEASE required", 14);
+    return;
+  }
+  linkPolicy.activity(Clock::ms());
+  
+  while (length > 0) {
+    if (!decoder.decoding()) {
+      decoder.reset();
+      decoder.setHandler([this](const PathDecoder::Waypoint& waypoint) {
+        if (waypointCallback) waypointCallback(waypoint);
+      });
+    }
+    
+    size_t used = decoder.feed(data, length);
+    data += used;
+    length -= used;
+    
+    if (decoder.getState() == PathDecoder::STATE_ERROR) {
+      Serial.printf("[WS] Invalid path stream from client #%u\n", num);
+      decoder.reset();
+      sendFramed(num, "NACK: ", "PATH invalid", 12);
+      return;
+    }
+    
+    if (decoder.getState() == PathDecoder::STATE_DONE) {
+      char ack[32];
+      int ackLength = snprintf(ack, sizeof(ack), "PATH %u waypoints", (unsigned)decoder.waypointCount());
+      sendFramed(num, "ACK: ", ack, ackLength);
+      decoder.reset();
+    }
+  }
+}
+
+// Plant transports
+bool AGVCoreNetwork::addTransport(Transport* transport) {
+  if (!transport || transportCount >= MAX_TRANSPORTS || core0TaskHandle) {
+    Serial.println("[AGVNET] Transport not added: limit reached or network already started");
+    return false;
+  }
+  
+  transports[transportCount++] = transport;
+  return true;
+}
+
+void AGVCoreNetwork::startTransports() {
+  for (uint8_t i = 0; i < transportCount; i++) {
+    Transport* transport = transports[i];
+    
+    // Inbound commands take the same path (and emergency handling) as web commands
+    transport->onCommand([this](const char* command, size_t length) {
+      recorder.record(FlightRecorder::REC_TRANSPORT_COMMAND, 0, command, length);
+      Serial.printf("[TRANSPORT] Command received: '%s'\n", command);
+      processWebCommand(command, length, EmergencyState::SOURCE_TRANSPORT);
+    });
+    
+    if (transport->begin(mdnsName)) {
+      Serial.printf("[AGVNET] ✅ Transport '%s' started\n", transport->name());
+    } else {
+      Serial.printf("[ERROR] Transport '%s' failed to start\n", transport->name());
+    }
+  }
+}
+
+void AGVCoreNetwork::publishTransports(Transport::Channel channel, const char* payload, size_t length) {
+  for (uint8_t i = 0; i < transportCount; i++) {
+    transports[i]->publish(channel, payload, length);
+  }
+}
+
+// Flight recorder replay
+bool AGVCoreNetwork::startReplay(const uint8_t* dump, size_t length, uint16_t speedPercent) {
+  if (!replayer.start(dump, length, speedPercent)) {
+    Serial.println("[REPLAY] Invalid recorder dump");
+    return false;
+  }
+  
+  Serial.printf("[REPLAY] Replaying recorded session at %u%% speed\n", speedPercent);
+  return true;
+}
+
+// Feeds due inbound records back through the same entry points they were
+// recorded at; outbound records (status, emergency, connections) are skipped.
+// The rate limit and the lease were applied when the records were made, so
+// replayed records bypass both (a fast replay would otherwise be refused).
+void AGVCoreNetwork::processReplay() {
+  FlightRecorder::Record rec;
+  char cmd[FlightRecorder::PAYLOAD_SIZE + 1];
+  
+  replayingRecord = true;
+  for (uint8_t i = 0; i < 16 && replayer.nextDue(Clock::timeUs(), rec); i++) {
+    memcpy(cmd, rec.payload, rec.length);
+    cmd[rec.length] = '\0';
+    
+    // A truncated command would run as a different one
+    if (rec.flags & FlightRecorder::FLAG_TRUNCATED) continue;
+    
+    switch (rec.type) {
+      case FlightRecorder::REC_WS_COMMAND:
+      case FlightRecorder::REC_WS_CONTROL:
+        if (webSocket) webSocketEvent(rec.source, WStype_TEXT, (uint8_t*)cmd, rec.length);
+        break;
+        
+      case FlightRecorder::REC_SERIAL_COMMAND:
+        processSerialCommand(cmd, rec.length);
+        break;
+        
+      case FlightRecorder::REC_HTTP_COMMAND:
+        processWebCommand(cmd, rec.length, EmergencyState::SOURCE_HTTP);
+        break;
+        
+      case FlightRecorder::REC_TRANSPORT_COMMAND:
+        processWebCommand(cmd, rec.length, EmergencyState::SOURCE_TRANSPORT);
+        break;
+        
+      case FlightRecorder::REC_PATH_FRAME:
+        if (webSocket) handlePathFrame(rec.source, (const uint8_t*)rec.payload, rec.length);
+        break;
+        
+      default:
+        break;
+    }
+  }
+  replayingRecord = false;
+  
+  if (!replayer.active()) {
+    Serial.println("[REPLAY] Replay finished");
+  }
+}
+
+// Sends prefix + message to one client or all of them. The payload is laid out
+// once after WEBSOCKETS_MAX_HEADER_SIZE bytes of headroom so the WebSocket
+// library writes the frame header in place instead of copying the payload
+// for every client.
+bool AGVCoreNetwork::sendFramed(int16_t num, const char* prefix, const char* message, size_t length, Stream stream) {
+  if (!webSocket || !message) return false;
+  
+  size_t prefixLength = prefix ? strlen(prefix) : 0;
+  size_t total = prefixLength + length;
+  
+  uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + FRAME_PAYLOAD_MAX + 1];
+  uint8_t* heapFrame = nullptr;
+  uint8_t* payload = frame + WEBSOCKETS_MAX_HEADER_SIZE;
+  
+  if (total > FRAME_PAYLOAD_MAX) {
+    heapFrame = (uint8_t*)malloc(WEBSOCKETS_MAX_HEADER_SIZE + total + 1);
+    if (!heapFrame) return false;
+    payload = heapFrame + WEBSOCKETS_MAX_HEADER_SIZE;
+  }
+  
+  if (prefixLength) memcpy(payload, prefix, prefixLength);
+  memcpy(payload + prefixLength, message, length);
+  payload[total] = '\0';
+  
+  bool sent;
+  if (num == ALL_CLIENTS && stream != STREAM_NONE) {
+    sent = broadcastLog(payload, total, stream);
+  } else {
+    sent = (num == ALL_CLIENTS)
+      ? webSocket->broadcastTXT(payload, total, true)
+      : webSocket->sendTXT((uint8_t)num, payload, total, true);
+  }
+  
+  free(heapFrame);
+  return sent;
+}
+
+// Log-stream broadcast. Under streamLock the event is added to the history
+// and sent in id order: clients with a resume cursor get it as "#<id> text",
+// opted-in clients compressed against their own window (never emergencies).
+// If the lock is not available the event goes out as plain text only.
+bool AGVCoreNetwork::broadcastLog(uint8_t* payload, size_t length, Stream stream) {
+  bool locked = xSemaphoreTake(streamLock, pdMS_TO_TICKS(100)) == pdPASS;
+  uint32_t id = locked ? history.append(payload, length) : 0;
+  
+  // Tagged copy for cursor clients, built once (on the heap for long events;
+  // without one they get the plain text and may see it again on resume)
+  uint8_t tagFrame[WEBSOCKETS_MAX_HEADER_SIZE + 12 + FRAME_PAYLOAD_MAX + 1];
+  uint8_t* tagHeap = nullptr;
+  uint8_t* tagged = nullptr;
+  size_t taggedLength = 0;
+  if (id && cursorClients) {
+    if (length > FRAME_PAYLOAD_MAX) {
+      tagHeap = (uint8_t*)malloc(WEBSOCKETS_MAX_HEADER_SIZE + 12 + length + 1);
+    }
+    if (length <= FRAME_PAYLOAD_MAX || tagHeap) {
+      tagged = (tagHeap ? tagHeap : tagFrame) + WEBSOCKETS_MAX_HEADER_SIZE;
+    }
+  }
+  if (tagged) {
+    taggedLength = snprintf((char*)tagged, 13, "#%lu ", (unsigned long)id);
+    memcpy(tagged + taggedLength, payload, length);
+    taggedLength += length;
+    tagged[taggedLength] = '\0';
+  }
+  
+  uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + StreamCompressor::MAX_OUTPUT];
+  uint8_t* packed = frame + WEBSOCKETS_MAX_HEADER_SIZE;
+  bool compress = locked && stream == STREAM_LOG && compressor.any();
+  bool sent = true;
+  
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (!webSocket->clientIsConnected(i)) continue;
+    
+    uint8_t* text = payload;
+    size_t textLength = length;
+    if (tagged && (cursorClients & (1u << i))) {
+      text = tagged;
+      textLength = taggedLength;
+    }
+    
+    size_t packedLength = compress ? compressor.compress(i, text, textLength, packed) : 0;
+    sent &= packedLength
+      ? webSocket->sendBIN(i, packed, packedLength, true)
+      : webSocket->sendTXT(i, text, textLength, true);
+  }
+  
+  if (locked) xSemaphoreGive(streamLock);
+  free(tagHeap);
+  return sent;
+}
+
+// COMPRESS:ON resets the client's window to the dictionary; the reply goes out
+// under the lock so no compressed frame can overtake it
+void AGVCoreNetwork::setCompression(uint8_t num, bool enabled) {
+  if (!streamLock || xSemaphoreTake(streamLock, pdMS_TO_TICKS(100)) != pdPASS) return;
+  
+  if (!enabled) {
+    compressor.disable(num);
+  } else if (compressor.enable(num)) {
+    webSocket->sendTXT(num, "COMPRESS:ON");
+  } else {
+    webSocket->sendTXT(num, "COMPRESS:UNAVAILABLE");
+  }
+  
+  xSemaphoreGive(streamLock);
+}
+
+// RESUME:<last id seen> (0 for a new page). Missed events come back in one
+// frame, "HISTORY:<count>:<last id>" followed by "\n#<id> <text>" lines; a
+// cursor the ring no longer covers gets "HISTORY:SNAPSHOT:<last id>" and the
+// current status instead. Either way the client is on cursors afterwards.
+void AGVCoreNetwork::handleResume(uint8_t num, const char* msg, size_t length) {
+  char* end;
+  uint32_t afterId = strtoul(msg, &end, 10);
+  if (end != msg + length) {
+    webSocket->sendTXT(num, "HISTORY:INVALID");
+    return;
+  }
+  if (xSemaphoreTake(streamLock, pdMS_TO_TICKS(100)) != pdPASS) return;
+  
+  // Room for the frame header and "HISTORY:..." in front, then per event
+  // "\n#<id> " (at most 13 characters) and the text
+  size_t capacity = WEBSOCKETS_MAX_HEADER_SIZE + 32 + history.pendingBytes(afterId) +
+                    (size_t)history.size() * 13 + 1;
+  uint8_t* batch = (uint8_t*)malloc(capacity);
+  char* text = batch ? (char*)batch + WEBSOCKETS_MAX_HEADER_SIZE : nullptr;
+  size_t len = 32;   // Header is written last, in front of the lines
+  uint32_t count = 0;
+  
+  EventHistory::Resume result = EventHistory::RESUME_GAP;
+  if (batch) {
+    result = history.resume(afterId, [&](uint32_t id, const char* event, size_t eventLength) {
+      len += snprintf(text + len, 14, "\n#%lu ", (unsigned long)id);
+      for (size_t i = 0; i < eventLength; i++) {
+        text[len++] = event[i] == '\n' ? ' ' : event[i];
+      }
+      count++;
+    });
+  }
+  
+  char header[32];
+  if (!batch) {
+    snprintf(header, sizeof(header), "HISTORY:UNAVAILABLE");
+    webSocket->sendTXT(num, header);
+  } else if (result == EventHistory::RESUME_GAP) {
+    snprintf(header, sizeof(header), "HISTORY:SNAPSHOT:%lu", (unsigned long)history.lastId());
+    webSocket->sendTXT(num, header);
+    size_t jsonLength = 0;
+    const char* json = getStatusJson(jsonLength);
+    webSocket->sendTXT(num, json, jsonLength);
+  } else {
+    int headerLength = snprintf(header, sizeof(header), "HISTORY:%lu:%lu",
+                                (unsigned long)count, (unsigned long)history.lastId());
+    size_t first = 32 - headerLength;
+    memcpy(text + first, header, headerLength);
+    webSocket->sendTXT(num, (uint8_t*)text + first, len - first, true);
+  }
+  
+  if (batch) cursorClients |= 1u << num;
+  xSemaphoreGive(streamLock);
+  free(batch);
+}
+
+// Control message namespace:
+//   STATUS_REQUEST            - full status snapshot
+//   SUBSCRIBE[:status]        - full snapshot now, then pushed deltas
+//   UNSUBSCRIBE[:status]      - stop pushed deltas
+//   PING                      - PONG
+//   COMPRESS:ON|OFF           - compressed log stream (AGVCoreNetwork_Compress.h)
+//   RESUME:<id>               - missed log-stream events, then "#<id> " tags
+bool AGVCoreNetwork::handleControlMessage(uint8_t num, const char* msg, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  
+  size_t len = 0;
+  const char* json;
+  
+  if (length == 14 && memcmp(msg, "STATUS_REQUEST", 14) == 0) {
+    json = getStatusJson(len);
+    webSocket->sendTXT(num, json, len);
+    return true;
+  }
+  
+  if (length == 4 && memcmp(msg, "PING", 4) == 0) {
+    webSocket->sendTXT(num, "PONG", 4);
+    return true;
+  }
+  
+  if ((length == 9 && memcmp(msg, "SUBSCRIBE", 9) == 0) ||
+      (length == 16 && memcmp(msg, "SUBSCRIBE:status", 16) == 0)) {
+    clientTopics[num] |= TOPIC_STATUS;
+    json = getStatusJson(len);
+    webSocket->sendTXT(num, json, len);
+    return true;
+  }
+  
+  if ((length == 11 && memcmp(msg, "UNSUBSCRIBE", 11) == 0) ||
+      (length == 18 && memcmp(msg, "UNSUBSCRIBE:status", 18) == 0)) {
+    clientTopics[num] &= ~TOPIC_STATUS;
+    return true;
+  }
+  
+  if (length == 11 && memcmp(msg, "COMPRESS:ON", 11) == 0) {
+    setCompression(num, true);
+    return true;
+  }
+  
+  if (length == 12 && memcmp(msg, "COMPRESS:OFF", 12) == 0) {
+    setCompression(num, false);
+    webSocket->sendTXT(num, "COMPRESS:OFF");
+    return true;
+  }
+  
+  if (length > 7 && memcmp(msg, "RESUME:", 7) == 0) {
+    handleResume(num, msg + 7, length - 7);
+    return true;
+  }
+  
+  if (length > 6 && memcmp(msg, "LEASE:", 6) == 0) {
+    handleLeaseMessage(num, msg + 6, length - 6);
+    return true;
+  }
+  
+  if (length > 5 && memcmp(msg, "TIME:", 5) == 0) {
+    handleTimeMessage(num, msg + 5, length - 5);
+    return true;
+  }
+  
+  return false;
+}
+
+// LEASE:ACQUIRE, LEASE:RENEW (heartbeat), LEASE:RELEASE and LEASE:DECLINE
+// (holder refuses a handover). Holder changes reach subscribers through the
+// "lease" status field.
+void AGVCoreNetwork::handleLeaseMessage(uint8_t num, const char* msg, size_t length) {
+  uint32_t now = Clock::ms();
+  char reply[48];
   
-  Serial.printf("[AGVNET] Connecting to: %s\n", stored_ssid.c_str());
+  if (length == 7 && memcmp(msg, "ACQUIRE", 7) == 0) {
+    switch (controlLease.acquire(num, now)) {
+      case ControlLease::LEASE_GRANTED:
+        snprintf(reply, sizeof(reply), "LEASE:GRANTED:%u:%u", num, (unsigned)controlLease.getDuration());
+        break;
+      case ControlLease::LEASE_REQUESTED: {
+        uint8_t holder = controlLease.holder(now);
+        snprintf(reply, sizeof(reply), "LEASE:HANDOVER_REQUEST:%u", num);
+        if (holder != ControlLease::NONE) webSocket->sendTXT(holder, reply);
+        snprintf(reply, sizeof(reply), "LEASE:WAIT:%u", holder);
+        break;
+      }
+      default:
+        snprintf(reply, sizeof(reply), "LEASE:DISABLED");
+        break;
+    }
+    webSocket->sendTXT(num, reply);
+    return;
+  }
   
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 30) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
+  if (length == 5 && memcmp(msg, "RENEW", 5) == 0) {
+    // Heartbeats are only answered when the lease was lost
+    if (controlLease.enabled() && !controlLease.renew(num, now)) {
+      webSocket->sendTXT(num, "LEASE:LOST");
+    }
+    return;
   }
   
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\n[AGVNET] ✅ WiFi Connected!");
-    Serial.printf("[AGVNET] IP Address: %s\n", WiFi.localIP().toString().c_str());
-    
-    // Start mDNS
-    if (MDNS.begin(mdnsName)) {
-      MDNS.addService("http", "tcp", 80);
-      Serial.printf("[AGVNET] ✅ mDNS started: http://%s.local\n", mdnsName);
+  if (length == 7 && memcmp(msg, "RELEASE", 7) == 0) {
+    uint8_t next = controlLease.release(num, now);
+    webSocket->sendTXT(num, "LEASE:RELEASED");
+    if (next != ControlLease::NONE && next != num) {
+      snprintf(reply, sizeof(reply), "LEASE:GRANTED:%u:%u", next, (unsigned)controlLease.getDuration());
+      webSocket->sendTXT(next, reply);
     }
-    
-    isAPMode = false;
-    
-    // Setup web server and WebSocket
-    server = new WebServer(80);
-    webSocket = new WebSocketsServer(81);
-    webSocket->begin();
-    webSocket->onEvent(webSocketEventHandler);
-    
-    setupRoutes();
-    server->begin();
-    
-    Serial.println("[AGVNET] ✅ Station Mode Web Server Started");
-    Serial.println("[AGVNET] ✅ WebSocket Server Started (Port 81)");
-    
-  } else {
-    Serial.println("\n[AGVNET] ❌ WiFi connection failed");
-    Serial.println("[AGVNET] Falling back to AP mode...");
-    startAPMode();
+    return;
+  }
+  
+  if (length == 7 && memcmp(msg, "DECLINE", 7) == 0) {
+    uint8_t refused = controlLease.decline(num, now);
+    if (refused != ControlLease::NONE) webSocket->sendTXT(refused, "LEASE:DECLINED");
+    return;
   }
+  
+  webSocket->sendTXT(num, "LEASE:UNKNOWN");
 }
 
-void AGVCoreNetwork::setupRoutes() {
-  if (!server || isAPMode) return;
+// Clock sync is driven from this side so the AGV holds the estimate of every
+// client clock:
+//   client: TIME:SYNC                 opt in (TIME:STOP to leave)
+//   AGV:    TIME:REQ:<agv us>         repeated, fast at first
+//   client: TIME:RESP:<agv us>:<client us>
+//   client: TIME:STATUS  ->  TIME:STATE:<offset us>:<rtt us>:<drift ppb>:<samples>
+void AGVCoreNetwork::handleTimeMessage(uint8_t num, const char* msg, size_t length) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*s", (int)length, msg);
   
-  // Protected routes (require authentication)
-  server->on("/", HTTP_GET, [this](){ 
-    if (validateToken()) this->handleDashboard(); 
-  });
+  if (strcmp(text, "SYNC") == 0) {
+    clientTopics[num] |= TOPIC_TIME;
+    clientClocks[num].reset();
+    timeSyncDue[num] = Clock::ms();
+    return;
+  }
   
-  server->on("/login", HTTP_POST, [this](){ this->handleLogin(); });
-  server->on("/command", HTTP_POST, [this](){ 
-    if (validateToken()) this->handleCommand(); 
-  });
+  if (strcmp(text, "STOP") == 0) {
+    clientTopics[num] &= ~TOPIC_TIME;
+    return;
+  }
   
-  // Public routes
-  server->on("/status", HTTP_GET, [this](){ 
-    this->server->send(200, "application/json", 
-      "{\"emergency\":" + String(systemEmergency) + 
-      ",\"connected\":" + String(WiFi.status() == WL_CONNECTED) + "}");
-  });
+  if (strncmp(text, "RESP:", 5) == 0) {
+    int64_t now = Clock::timeUs();
+    char* end;
+    int64_t sent = strtoll(text + 5, &end, 10);
+    if (*end != ':') return;
+    int64_t remote = strtoll(end + 1, &end, 10);
+    if (*end != '\0' || sent > now || now - sent > 1000000) return;  // Stale or bogus
+    clientClocks[num].addSample(sent, remote, now);
+    return;
+  }
   
-  server->onNotFound([this](){ this->handleNotFound(); });
+  if (strcmp(text, "STATUS") == 0) {
+    const ClockSync& clock = clientClocks[num];
+    snprintf(text, sizeof(text), "TIME:STATE:%lld:%u:%d:%u",
+             (long long)clock.offsetUs(Clock::timeUs()), (unsigned)clock.rttUs(),
+             (int)clock.driftPpb(), clock.samples());
+    webSocket->sendTXT(num, text);
+    return;
+  }
 }
 
-void AGVCoreNetwork::core0Task(void *parameter) {
-  Serial.println("[CORE0] AGV Network task started on Core 0");
+void AGVCoreNetwork::serviceTimeSync() {
+  if (!webSocket) return;
   
-  while(1) {
-    if (isAPMode && dnsServer) {
-      dnsServer->processNextRequest();
-    }
+  uint32_t now = Clock::ms();
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (!(clientTopics[i] & TOPIC_TIME) || (int32_t)(now - timeSyncDue[i]) < 0) continue;
     
-    if (server) {
-      server->handleClient();
-    }
-    
-    if (webSocket) {
-      webSocket->loop();
-    }
-    
-    processSerialInput();
+    bool fast = clientClocks[i].samples() < ClockSync::WINDOW;
+    timeSyncDue[i] = now + (fast ? TIME_SYNC_FAST_MS : TIME_SYNC_INTERVAL_MS);
     
-    delay(1);
+    char req[40];
+    int len = snprintf(req, sizeof(req), "TIME:REQ:%lld", (long long)Clock::timeUs());
+    webSocket->sendTXT(i, req, len);
   }
 }
 
-void AGVCoreNetwork::processSerialInput() {
-  static char serialBuffer[64];
-  static int bufferIndex = 0;
+void AGVCoreNetwork::scheduleTimedCommand(uint8_t num, const char* cmd, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
   
-  while (Serial.available() > 0 && bufferIndex < 63) {
-    char c = Serial.read();
-    
-    if (c == '\n' || c == '\r') {
-      if (bufferIndex > 0) {
-        serialBuffer[bufferIndex] = '\0';
-        String cmd = String(serialBuffer);
-        cmd.trim();
-        
-        if (cmd.length() > 0) {
-          Serial.printf("\n[SERIAL] Command received: '%s'\n", cmd.c_str());
-          
-          // Process command immediately
-          processSerialCommand(serialBuffer);
-          
-          // Echo back to serial
-          Serial.printf("[SERIAL] Executed: %s\n", serialBuffer);
-          
-          // Broadcast to web clients (if not in AP mode)
-          if (!isAPMode && !systemEmergency) {
-            String broadcastMsg = "SERIAL: " + cmd;
-            sendStatus(broadcastMsg.c_str());
-          }
-        }
-        
-        bufferIndex = 0;
-      }
-    } else {
-      serialBuffer[bufferIndex++] = c;
-    }
-    
-    delay(1); // Prevent watchdog trigger
+  char* end;
+  int64_t remoteUs = strtoll(cmd, &end, 10);
+  if (end == cmd || *end != ':' || !end[1]) {
+    sendFramed(num, "NACK: ", "AT malformed", 12);
+    return;
   }
-}
-
-void AGVCoreNetwork::processSerialCommand(const char* cmd) {
-  // Emergency commands bypass everything
-  String command = String(cmd);
-  command.trim();
+  const char* command = end + 1;
+  size_t commandLength = length - (command - cmd);
   
-  if (command.equalsIgnoreCase("STOP") || command.equalsIgnoreCase("ABORT")) {
-    if (emergencyStateCallback) {
-      emergencyStateCallback(true); // Trigger system-wide emergency
-    }
+  // Timer wheel slots hold short commands only
+  if (commandLength > CommandFilter::MAX_COMMAND) {
+    sendFramed(num, "NACK: ", "AT too long", 11);
     return;
   }
   
-  if (command.equalsIgnoreCase("CLEAR_EMERGENCY")) {
-    if (emergencyStateCallback) {
-      emergencyStateCallback(false); // Clear system-wide emergency
-    }
+  CommandFilter::Verdict verdict = filter.checkSyntax(command, commandLength);
+  if (verdict != CommandFilter::CMD_OK) {
+    sendCommandNack(num, CommandFilter::reason(verdict));
     return;
   }
   
-  // Only process valid commands if not in emergency state
-  if (systemEmergency) {
-    Serial.println("[SERIAL] Command blocked: System emergency active");
+  const ClockSync& clock = clientClocks[num];
+  if (!clock.synced()) {
+    sendFramed(num, "NACK: ", "AT clock not synchronized", 25);
     return;
   }
   
-  // Send to command callback if registered
-  if (commandCallback) {
-    commandCallback(cmd);
+  int64_t now = Clock::timeUs();
+  int64_t dueUs = clock.toLocal(remoteUs);
+  int64_t leadUs = dueUs - now;
+  if (leadUs > TIMED_HORIZON_US) {
+    sendFramed(num, "NACK: ", "AT too far ahead", 16);
+    return;
+  }
+  
+  // Commands scheduled before an emergency never run after it
+  uint32_t epoch = emergency.snapshot().epoch;
+  if (!timedCommands.schedule(dueUs, num, command, epoch)) {
+    sendFramed(num, "NACK: ", "AT queue full", 13);
+    return;
   }
+  
+  char ack[96];
+  int len = snprintf(ack, sizeof(ack), "AT %s in %lld us (rtt %u us)",
+                     command, (long long)leadUs, (unsigned)clock.rttUs());
+  sendFramed(num, "ACK: ", ack, len);
 }
 
-void AGVCoreNetwork::processWebCommand(const char* cmd) {
-  // Only process if not in emergency state
-  if (systemEmergency) {
-    Serial.println("[WEB] Command blocked: System emergency active");
+// "NACK: CMD <reason>" to the sender of a refused command
+void AGVCoreNetwork::sendCommandNack(uint8_t num, const char* reason) {
+  char text[40];
+  int len = snprintf(text, sizeof(text), "CMD %s", reason ? reason : "rejected");
+  sendFramed(num, "NACK: ", text, len);
+}
+
+void AGVCoreNetwork::releaseTimedCommand(uint8_t num, const char* cmd, uint32_t epoch, int64_t lateUs) {
+  if (epoch != emergency.snapshot().epoch || !controlLease.holds(num, Clock::ms())) {
+    Serial.printf("[WS] Timed command dropped: '%s'\n", cmd);
+    sendFramed(num, "NACK: ", "AT cancelled", 12);
     return;
   }
   
-  // Send to command callback if registered
-  if (commandCallback) {
-    commandCallback(cmd);
+  Serial.printf("[WS] Timed command from client #%u: '%s' (%lld us late)\n", num, cmd, (long long)lateUs);
+  const char* rejection = nullptr;
+  if (!processWebCommand(cmd, strlen(cmd), EmergencyState::SOURCE_WEBSOCKET, &rejection)) {
+    sendCommandNack(num, rejection);
+    return;
   }
+  sendFramed(ALL_CLIENTS, "WS: ", cmd, strlen(cmd), STREAM_LOG);
 }
 
-void AGVCoreNetwork::webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
-  switch(type) {
-    case WStype_DISCONNECTED:
-      Serial.printf("[WS] Client #%u disconnected\n", num);
-      break;
-      
-    case WStype_CONNECTED:
-      {
-        IPAddress ip = webSocket->remoteIP(num);
-        Serial.printf("[WS] Client #%u connected from %d.%d.%d.%d\n", 
-                     num, ip[0], ip[1], ip[2], ip[3]);
-        webSocket->sendTXT(num, "AGV Connected - Ready for commands");
-      }
-      break;
-      
-    case WStype_TEXT:
-      {
-        // Copy command safely without holding mutex
-        char cmdCopy[65];
-        snprintf(cmdCopy, sizeof(cmdCopy), "%.*s", (int)length, (char*)payload);
-        
-        Serial.printf("\n[WS] Command received from client #%u: '%s'\n", num, cmdCopy);
-        
-        // Process command
-        processWebCommand(cmdCopy);
-        
-        // Send confirmation back to client
-        String response = "ACK: " + String(cmdCopy);
-        webSocket->sendTXT(num, response.c_str());
-        
-        // Broadcast to all clients
-        String broadcastMsg = "WS: " + String(cmdCopy);
-        webSocket->broadcastTXT(broadcastMsg.c_str());
-      }
-      break;
-  }
+int8_t AGVCoreNetwork::getLeaseHolder() const {
+  uint8_t holder = controlLease.holder(Clock::ms());
+  return holder == ControlLease::NONE ? -1 : (int8_t)holder;
 }
 
 // Callback registration
@@ -324,6 +1668,15 @@ void AGVCoreNetwork::setCommandCallback(CommandCallback callback) {
   }
 }
 
+void AGVCoreNetwork::setCommandViewCallback(CommandViewCallback callback) {
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    commandViewCallback = callback;
+    filter.setMaxLength(callback ? AGVNET_PAYLOAD_MAX : CommandFilter::MAX_COMMAND);
+    xSemaphoreGive(mutex);
+    Serial.println("[AGVNET] Command view callback registered");
+  }
+}
+
 void AGVCoreNetwork::setEmergencyStateCallback(EmergencyStateCallback callback) {
   if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
     emergencyStateCallback = callback;
@@ -332,6 +1685,14 @@ void AGVCoreNetwork::setEmergencyStateCallback(EmergencyStateCallback callback)
   }
 }
 
+void AGVCoreNetwork::setWaypointCallback(WaypointCallback callback) {
+  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
+    waypointCallback = callback;
+    xSemaphoreGive(mutex);
+    Serial.println("[AGVNET] Waypoint callback registered");
+  }
+}
+
 void AGVCoreNetwork::setStatusCallback(StatusCallback callback) {
   if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
     statusCallback = callback;
@@ -345,12 +1706,13 @@ void AGVCoreNetwork::sendStatus(const char* status) {
   if (!status || strlen(status) == 0 || isAPMode) return;
   
   if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
-    if (webSocket) {
-      webSocket->broadcastTXT(status);
-    }
+    sendFramed(ALL_CLIENTS, nullptr, status, strlen(status), STREAM_LOG);
     xSemaphoreGive(mutex);
   }
   
+  recorder.record(FlightRecorder::REC_STATUS, 0, status, strlen(status));
+  publishTransports(Transport::CHANNEL_STATUS, status, strlen(status));
+  
   // Also send to serial for logging
   Serial.printf("[STATUS] %s\n", status);
   
@@ -363,18 +1725,34 @@ void AGVCoreNetwork::sendStatus(const char* status) {
 void AGVCoreNetwork::broadcastEmergency(const char* message) {
   if (!message || strlen(message) == 0) return;
   
-  systemEmergency = true;
+  enterEmergency(EmergencyState::REASON_APPLICATION, EmergencyState::SOURCE_APPLICATION, message);
+}
+
+void AGVCoreNetwork::clearEmergencyState() {
+  exitEmergency();
+}
+
+// Every emergency trigger goes through here; each one is announced and
+// re-asserted to the application, since repeating a stop is always safe
+void AGVCoreNetwork::enterEmergency(EmergencyState::Reason reason, EmergencyState::Source source, const char* message) {
+  // The first reason's text stays latched until the emergency is cleared
+  if (emergency.trigger(reason, source)) {
+    updateStatusText(statusSnapshot.emergencyReason, sizeof(statusSnapshot.emergencyReason), message);
+  }
+  updateStatusField(statusSnapshot.emergency, emergency.isActive());
   
+  recorder.record(FlightRecorder::REC_EMERGENCY_SET, source, message, strlen(message));
   Serial.printf("!!! NETWORK EMERGENCY: %s\n", message);
   
   if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
-    if (webSocket) {
-      String emergencyMsg = "SYSTEM_EMERGENCY: " + String(message);
-      webSocket->broadcastTXT(emergencyMsg.c_str());
-    }
+    sendFramed(ALL_CLIENTS, "SYSTEM_EMERGENCY: ", message, strlen(message), STREAM_EMERGENCY);
     xSemaphoreGive(mutex);
   }
   
+  char transportMsg[80];
+  int len = snprintf(transportMsg, sizeof(transportMsg), "SYSTEM_EMERGENCY: %s", message);
+  publishTransports(Transport::CHANNEL_EMERGENCY, transportMsg, min(len, (int)sizeof(transportMsg) - 1));
+  
   // Also send to serial
   Serial.println("!!! SYSTEM EMERGENCY STATE ACTIVE !!!");
   
@@ -384,21 +1762,27 @@ void AGVCoreNetwork::broadcastEmergency(const char* message) {
   }
 }
 
-void AGVCoreNetwork::clearEmergencyState() {
-  if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
-    systemEmergency = false;
-    xSemaphoreGive(mutex);
+// Returns true if the emergency was active and is now cleared
+bool AGVCoreNetwork::exitEmergency() {
+  if (!emergency.clear()) {
+    return false;
   }
   
+  updateStatusField(statusSnapshot.emergency, emergency.isActive());
+  updateStatusText(statusSnapshot.emergencyReason, sizeof(statusSnapshot.emergencyReason), "");
+  
+  recorder.record(FlightRecorder::REC_EMERGENCY_CLEAR, 0, nullptr, 0);
   Serial.println("[AGVNET] System emergency state cleared");
   
-  // Notify web clients
+  // Notify web clients and plant transports
   sendStatus("SYSTEM_NORMAL: Emergency cleared");
+  publishTransports(Transport::CHANNEL_EMERGENCY, "SYSTEM_NORMAL", 13);
   
   // Clear system-wide emergency if callback exists
   if (emergencyStateCallback) {
     emergencyStateCallback(false);
   }
+  return true;
 }
 
 // Web route handlers
@@ -416,7 +1800,16 @@ void AGVCoreNetwork::handleLogin() {
     return;
   }
   
-  String body = server->arg("plain");
+  uint32_t ip = (uint32_t)server->client().remoteIP();
+  uint32_t lockedMs = guard.loginLockedFor(ip, Clock::ms());
+  if (lockedMs > 0) {
+    server->sendHeader("Retry-After", String((lockedMs + 999) / 1000));
+    server->send(429, "application/json", "{\"success\":false,\"error\":\"Locked\"}");
+    return;
+  }
+  
+  String body;
+  if (!readBody(body)) return;
   
   // Parse JSON manually to avoid String fragmentation
   int userStart = body.indexOf("\"username\":\"") + 12;
@@ -430,11 +1823,13 @@ void AGVCoreNetwork::handleLogin() {
   Serial.printf("\n[AUTH] Login attempt: '%s'\n", username.c_str());
   
   if (username == admin_username && password == admin_password) {
+    guard.loginSucceeded(ip);
     sessionToken = getSessionToken();
     String response = "{\"success\":true,\"token\":\"" + sessionToken + "\"}";
     server->send(200, "application/json", response);
     Serial.println("[AUTH] ✅ Login successful");
   } else {
+    guard.loginFailed(ip, Clock::ms());
     server->send(200, "application/json", "{\"success\":false}");
     Serial.println("[AUTH] ❌ Login failed");
   }
@@ -445,7 +1840,7 @@ void AGVCoreNetwork::handleDashboard() {
   
   // Include emergency status in dashboard
   String page = String(mainPage);
-  if (systemEmergency) {
+  if (emergency.isActive()) {
     page.replace("AGV: Waiting for connection...", "AGV: !!! EMERGENCY STATE ACTIVE !!!");
   }
   server->send(200, "text/html", page.c_str());
@@ -455,10 +1850,20 @@ void AGVCoreNetwork::handleWiFiSetup() {
   server->send_P(200, "text/html", wifiSetupPage);
 }
 
+// Scans run in the background: 202 while scanning, the client polls again
 void AGVCoreNetwork::handleScan() {
   if (isAPMode) {
-    Serial.println("[WIFI] Scanning networks...");
-    int n = WiFi.scanNetworks();
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING || n == WIFI_SCAN_FAILED) {
+      if (n == WIFI_SCAN_FAILED) {
+        Serial.println("[WIFI] Scanning networks...");
+        WiFi.scanNetworks(true);
+      }
+      server->sendHeader("Retry-After", "1");
+      server->send(202, "application/json", "{\"scanning\":true}");
+      return;
+    }
+    
     String json = "[";
     
     for (int i = 0; i < n; i++) {
@@ -471,6 +1876,7 @@ void AGVCoreNetwork::handleScan() {
     }
     
     json += "]";
+    WiFi.scanDelete();  // Next request starts a fresh scan
     server->send(200, "application/json", json);
     Serial.printf("[WIFI] Found %d networks\n", n);
   } else {
@@ -484,7 +1890,8 @@ void AGVCoreNetwork::handleSaveWiFi() {
     return;
   }
   
-  String body = server->arg("plain");
+  String body;
+  if (!readBody(body)) return;
   
   int ssidStart = body.indexOf("\"ssid\":\"") + 8;
   int ssidEnd = body.indexOf("\"", ssidStart);
@@ -496,55 +1903,394 @@ void AGVCoreNetwork::handleSaveWiFi() {
   
   Serial.printf("\n[WIFI] Saving credentials: '%s'\n", ssid.c_str());
   
-  // Save to preferences
-  preferences.begin("agvnet", false);
-  preferences.putString("ssid", ssid);
-  preferences.putString("password", password);
-  preferences.end();
+  // Save to NVS
+  Storage::saveCredentials(storageNamespace, ssid, password);
+  Storage::saveBootCache(storageNamespace, BootCache());  // Cached access point belongs to the old network
   
   server->send(200, "application/json", "{\"success\":true}");
   
   Serial.println("[WIFI] ✅ Credentials saved. Restarting...");
-  delay(1000);
-  restartSystem();
+  
+  // Restart once the response has gone out, without stalling the loop
+  scheduler.start(&restartTask);
+}
+
+bool AGVCoreNetwork::RestartTask::run(AsyncScheduler& scheduler) {
+  AGV_ASYNC_BEGIN();
+  AGV_AWAIT_DELAY(1000);
+  net->restartSystem();
+  AGV_ASYNC_END();
 }
 
 void AGVCoreNetwork::handleCommand() {
-  if (server->method() != HTTP_POST || systemEmergency) {
-    server->send(403, "text/plain", systemEmergency ? "Emergency state active" : "Forbidden");
+  if (server->method() != HTTP_POST) {
+    server->send(403, "text/plain", "Forbidden");
     return;
   }
   
-  String body = server->arg("plain");
+  String body;
+  if (!readBody(body)) return;
   
   int cmdStart = body.indexOf("\"command\":\"") + 11;
   int cmdEnd = body.indexOf("\"", cmdStart);
   String command = (cmdStart > 11 && cmdEnd > cmdStart) ? body.substring(cmdStart, cmdEnd) : "";
   
   if (command.length() > 0) {
+    recorder.record(FlightRecorder::REC_HTTP_COMMAND, 0, command.c_str(), command.length());
+    
+    // HTTP clients cannot hold the motion lease; while it is on only stops pass
+    if (controlLease.enabled() && !isVerb(command.c_str(), "STOP") && !isVerb(command.c_str(), "ABORT")) {
+      server->send(409, "application/json", "{\"success\":false,\"error\":\"LEASE required\"}");
+      return;
+    }
+    
     Serial.printf("[WEB] Executing command: '%s'\n", command.c_str());
-    processWebCommand(command.c_str());
-    server->send(200, "application/json", "{\"success\":true}");
+    const char* rejection = nullptr;
+    if (processWebCommand(command.c_str(), command.length(), EmergencyState::SOURCE_HTTP, &rejection)) {
+      server->send(200, "application/json", "{\"success\":true}");
+    } else if (emergency.isActive()) {
+      server->send(403, "text/plain", "Emergency state active");
+    } else {
+      char json[64];
+      snprintf(json, sizeof(json), "{\"success\":false,\"error\":\"%s\"}", rejection ? rejection : "rejected");
+      server->send(400, "application/json", json);
+    }
   } else {
     server->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid command\"}");
   }
 }
 
+// Fixed reply: echoing the URI and arguments let scanners make us allocate
 void AGVCoreNetwork::handleNotFound() {
-  String message = "File Not Found\n\n";
-  message += "URI: ";
-  message += server->uri();
-  message += "\nMethod: ";
-  message += (server->method() == HTTP_GET) ? "GET" : "POST";
-  message += "\nArguments: ";
-  message += server->args();
-  message += "\n";
+  server->send(404, "text/plain", "Not Found");
+}
+
+void AGVCoreNetwork::handleDebugTasks() {
+  TaskProfile p;
+  if (!getTaskProfile(p)) {
+    server->send(503, "application/json", "{\"error\":\"No profile sample yet\"}");
+    return;
+  }
+  
+  char json[448];
+  snprintf(json, sizeof(json),
+    "{\"task\":\"AGVNetCore0\",\"core\":%d,\"priority\":%u,\"stackSize\":%u,"
+    "\"stackHighWater\":%u,\"cpuPercent\":%u,\"windowUs\":%u,\"loops\":%u,"
+    "\"maxLoopUs\":%u,\"subsystemUs\":{\"http\":%u,\"ws\":%u,\"dns\":%u,\"serial\":%u,\"transport\":%u,\"async\":%u},"
+    "\"pollConnections\":%u,\"pollRequests\":%u,\"freeHeap\":%u}",
+    (int)taskConfig.core, (unsigned)taskConfig.priority, (unsigned)taskConfig.stackSize,
+    (unsigned)p.stackHighWater, (unsigned)p.cpuPercent, (unsigned)p.windowUs, (unsigned)p.loops,
+    (unsigned)p.maxLoopUs, (unsigned)p.subsystemUs[SUBSYS_HTTP], (unsigned)p.subsystemUs[SUBSYS_WS],
+    (unsigned)p.subsystemUs[SUBSYS_DNS], (unsigned)p.subsystemUs[SUBSYS_SERIAL],
+    (unsigned)p.subsystemUs[SUBSYS_TRANSPORT], (unsigned)p.subsystemUs[SUBSYS_ASYNC],
+    pollServer ? (unsigned)pollServer->activeConnections() : 0u,
+    pollServer ? (unsigned)pollServer->getStats().requests : 0u,
+    (unsigned)ESP.getFreeHeap());
+  
+  server->send(200, "application/json", json);
+}
+
+void AGVCoreNetwork::handleDebugBoot() {
+  static const char* const MODES[] = {"off", "on", "reuse_address"};
+  
+  char json[224];
+  size_t len = snprintf(json, sizeof(json), "{\"fastBoot\":\"%s\",\"cachedAccessPoint\":%s,\"staticAddress\":%s,\"phases\":",
+                        MODES[fastBoot], bootCacheUsed ? "true" : "false", staticAddress ? "true" : "false");
+  len += bootTimeline.toJson(json + len, sizeof(json) - len);
+  snprintf(json + len, sizeof(json) - len, "}");
+  server->send(200, "application/json", json);
+}
+
+void AGVCoreNetwork::handleDebugLink() {
+  char json[640];
+  uint32_t now = Clock::ms();
+  size_t len = snprintf(json, sizeof(json), "{\"profile\":\"%s\",\"auto\":%s,\"moving\":%s,\"profiles\":{",
+                        LinkPolicy::name(linkPolicy.current()), linkPolicy.isAuto() ? "true" : "false",
+                        linkPolicy.isMoving() ? "true" : "false");
+  
+  for (uint8_t i = 0; i < LINK_PROFILE_COUNT && len < sizeof(json); i++) {
+    LinkPolicy::Stats st;
+    linkPolicy.getStats((LinkProfile)i, st, now);
+    len += snprintf(json + len, sizeof(json) - len,
+      "%s\"%s\":{\"samples\":%u,\"minUs\":%u,\"medianUs\":%u,\"p95Us\":%u,\"maxUs\":%u,"
+      "\"switches\":%u,\"residentMs\":%u}",
+      i ? "," : "", LinkPolicy::name((LinkProfile)i), (unsigned)st.samples, (unsigned)st.minUs,
+      (unsigned)st.medianUs, (unsigned)st.p95Us, (unsigned)st.maxUs, (unsigned)st.switches,
+      (unsigned)st.residentMs);
+  }
+  if (len < sizeof(json)) snprintf(json + len, sizeof(json) - len, "}}");
+  
+  server->send(200, "application/json", json);
+}
+
+// Firmware upload: POST /ota?sha256=<hex>[&format=delta] with the image as a
+// multipart file. Chunks go straight to the inactive partition; the image is
+// only made bootable when its SHA-256 matches.
+void AGVCoreNetwork::handleOtaUpload() {
+  HTTPUpload& upload = server->upload();
+  
+  switch (upload.status) {
+    case UPLOAD_FILE_START: {
+      // The response can only be sent once the upload is over; a refused
+      // upload never reaches flash
+      otaRefused = !admitClient((uint32_t)server->client().remoteIP());
+      if (otaRefused) return;
+      otaAuthorized = isAuthorized();
+      if (!otaAuthorized) return;
+      
+      uint8_t hash[OtaUpdater::HASH_SIZE];
+      if (!OtaUpdater::parseHash(server->arg("sha256").c_str(), hash)) {
+        Serial.println("[OTA] Rejected: missing or invalid sha256");
+        return;
+      }
+      
+      OtaUpdater::Format format = server->arg("format") == "delta" ? OtaUpdater::FORMAT_DELTA
+                                                                  : OtaUpdater::FORMAT_FULL;
+      otaStartMs = Clock::ms();
+      if (ota.begin(&otaWriter, format, hash)) {
+        Serial.printf("[OTA] Receiving %s image '%s'\n",
+                     format == OtaUpdater::FORMAT_DELTA ? "delta" : "full", upload.filename.c_str());
+      }
+      break;
+    }
+    
+    case UPLOAD_FILE_WRITE:
+      if (ota.active()) ota.write(upload.buf, upload.currentSize);
+      break;
+      
+    case UPLOAD_FILE_END:
+      if (ota.active()) ota.end();
+      break;
+      
+    case UPLOAD_FILE_ABORTED:
+      ota.abort();
+      Serial.println("[OTA] Upload aborted");
+      break;
+  }
+}
+
+void AGVCoreNetwork::handleOtaFinish() {
+  if (otaRefused) {
+    otaRefused = false;
+    sendTooManyRequests();
+    return;
+  }
   
-  for (uint8_t i = 0; i < server->args(); i++) {
-    message += " " + server->argName(i) + ": " + server->arg(i) + "\n";
+  // Uploads were admitted when they started; anything else is admitted here
+  if (!otaAuthorized) {
+    if (admitRequest()) validateToken();  // Sends 401
+    return;
+  }
+  otaAuthorized = false;
+  
+  OtaUpdater::Error error = ota.getError();
+  char json[160];
+  
+  if (error != OtaUpdater::OTA_OK) {
+    snprintf(json, sizeof(json), "{\"success\":false,\"error\":\"%s\"}", OtaUpdater::errorName(error));
+    Serial.printf("[OTA] ❌ Update failed: %s\n", OtaUpdater::errorName(error));
+    server->send(error == OtaUpdater::OTA_WRITE_FAILED || error == OtaUpdater::OTA_COMMIT_FAILED ? 500 : 400,
+                 "application/json", json);
+    return;
+  }
+  
+  uint32_t elapsed = Clock::ms() - otaStartMs;
+  snprintf(json, sizeof(json), "{\"success\":true,\"received\":%u,\"written\":%u,\"ms\":%u}",
+           (unsigned)ota.bytesReceived(), (unsigned)ota.bytesWritten(), (unsigned)elapsed);
+  server->send(200, "application/json", json);
+  
+  Serial.printf("[OTA] ✅ %u bytes written (%u received) in %u ms. Restarting...\n",
+               (unsigned)ota.bytesWritten(), (unsigned)ota.bytesReceived(), (unsigned)elapsed);
+  scheduler.start(&restartTask);
+}
+
+// Streams the flight recorder as a binary dump: DumpHeader + records, oldest first
+void AGVCoreNetwork::handleDebugRecorder() {
+  FlightRecorder::DumpHeader header;
+  memcpy(header.magic, "AGVR", 4);
+  header.version = FlightRecorder::DUMP_VERSION;
+  header.recordSize = sizeof(FlightRecorder::Record);
+  header.firstSeq = recorder.oldestSeq();
+  
+  // Records written during the dump are not included
+  header.count = recorder.nextSeq() - header.firstSeq;
+  
+  server->setContentLength(sizeof(header) + (size_t)header.count * sizeof(FlightRecorder::Record));
+  server->send(200, "application/octet-stream", "");
+  server->sendContent((const char*)&header, sizeof(header));
+  
+  FlightRecorder::Record chunk[8];
+  uint32_t seq = header.firstSeq;
+  uint32_t sent = 0;
+  while (sent < header.count) {
+    uint32_t want = min((uint32_t)8, header.count - sent);
+    size_t n = recorder.copyRecords(seq, chunk, want);
+    
+    // If the ring wraps mid-dump newer records fill the remaining slots;
+    // zero-fill only if nothing is left so the length stays correct
+    if (n == 0) {
+      memset(chunk, 0, sizeof(chunk));
+      n = want;
+    }
+    server->sendContent((const char*)chunk, n * sizeof(FlightRecorder::Record));
+    sent += n;
+  }
+}
+
+// Status snapshot
+// Copies a string into a JSON string body, escaping quotes and control characters
+static void jsonEscape(char* out, size_t size, const char* in) {
+  size_t o = 0;
+  for (; *in && o + 2 < size; in++) {
+    char c = *in;
+    if (c == '"' || c == '\\') {
+      out[o++] = '\\';
+      out[o++] = c;
+    } else if ((uint8_t)c >= 0x20) {
+      out[o++] = c;
+    }
+  }
+  out[o] = '\0';
+}
+
+void AGVCoreNetwork::updateStatusText(char* field, size_t size, const char* value) {
+  if (!value) value = "";
+  
+  portENTER_CRITICAL(&statusLock);
+  if (strncmp(field, value, size - 1) != 0) {
+    strncpy(field, value, size - 1);
+    field[size - 1] = '\0';
+    statusVersion++;
+  }
+  portEXIT_CRITICAL(&statusLock);
+}
+
+void AGVCoreNetwork::refreshStatusSnapshot() {
+  lastStatusRefresh = Clock::ms();
+  
+  bool connected = WiFi.status() == WL_CONNECTED;
+  updateStatusField(statusSnapshot.connected, connected);
+  updateStatusField(statusSnapshot.rssi, (int8_t)(connected ? WiFi.RSSI() : 0));
+  updateStatusField(statusSnapshot.uptimeSec, (uint32_t)(lastStatusRefresh / 1000));
+  updateStatusField(statusSnapshot.wsClients, (uint8_t)(webSocket ? webSocket->connectedClients() : 0));
+  updateStatusField(statusSnapshot.pollClients, (uint8_t)(pollServer ? pollServer->activeConnections() : 0));
+}
+
+void AGVCoreNetwork::getStatusSnapshot(StatusSnapshot& snapshot) {
+  portENTER_CRITICAL(&statusLock);
+  snapshot = statusSnapshot;
+  portEXIT_CRITICAL(&statusLock);
+}
+
+// Appends formatted text to a bounded buffer, keeping it NUL-terminated
+static void appendf(char* out, size_t size, size_t& len, const char* fmt, ...) {
+  if (len >= size) return;
+  
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(out + len, size - len, fmt, args);
+  va_end(args);
+  
+  if (n > 0) len = ((size_t)n < size - len) ? len + n : size - 1;
+}
+
+// Sends the fields that changed since the last push to status subscribers
+void AGVCoreNetwork::pushStatusDeltas() {
+  lastStatusPush = Clock::ms();
+  if (!webSocket) return;
+  
+  bool anySubscriber = false;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clientTopics[i] & TOPIC_STATUS) anySubscriber = true;
+  }
+  if (!anySubscriber) return;
+  
+  StatusSnapshot snap;
+  portENTER_CRITICAL(&statusLock);
+  uint32_t version = statusVersion;
+  if (version != statusPushVersion) snap = statusSnapshot;
+  portEXIT_CRITICAL(&statusLock);
+  
+  if (version == statusPushVersion) return;
+  statusPushVersion = version;
+  
+  // Uptime is left to the client; RSSI only moves with a 3 dB deadband
+  const StatusSnapshot& prev = pushedSnapshot;
+  if (abs(snap.rssi - prev.rssi) < 3) snap.rssi = prev.rssi;
+  
+  char delta[384];
+  char text[sizeof(snap.lastCommand) * 2];
+  size_t len = 0;
+  appendf(delta, sizeof(delta), len, "{\"delta\":{");
+  size_t start = len;
+  
+  if (snap.emergency != prev.emergency) appendf(delta, sizeof(delta), len, "\"emergency\":%d,", snap.emergency ? 1 : 0);
+  if (snap.connected != prev.connected) appendf(delta, sizeof(delta), len, "\"connected\":%d,", snap.connected ? 1 : 0);
+  if (snap.apMode != prev.apMode) appendf(delta, sizeof(delta), len, "\"mode\":\"%s\",", snap.apMode ? "ap" : "station");
+  if (snap.rssi != prev.rssi) appendf(delta, sizeof(delta), len, "\"rssi\":%d,", snap.rssi);
+  if (snap.ip != prev.ip) {
+    appendf(delta, sizeof(delta), len, "\"ip\":\"%u.%u.%u.%u\",",
+            (unsigned)(snap.ip & 0xFF), (unsigned)((snap.ip >> 8) & 0xFF),
+            (unsigned)((snap.ip >> 16) & 0xFF), (unsigned)(snap.ip >> 24));
+  }
+  if (snap.wsClients != prev.wsClients) appendf(delta, sizeof(delta), len, "\"clients\":%u,", snap.wsClients);
+  if (snap.pollClients != prev.pollClients) appendf(delta, sizeof(delta), len, "\"pollClients\":%u,", snap.pollClients);
+  if (snap.serialPending != prev.serialPending) appendf(delta, sizeof(delta), len, "\"serialPending\":%u,", snap.serialPending);
+  if (snap.leaseHolder != prev.leaseHolder) appendf(delta, sizeof(delta), len, "\"lease\":%d,", snap.leaseHolder);
+  if (strcmp(snap.lastCommand, prev.lastCommand) != 0) {
+    jsonEscape(text, sizeof(text), snap.lastCommand);
+    appendf(delta, sizeof(delta), len, "\"lastCommand\":\"%s\",", text);
+  }
+  if (strcmp(snap.emergencyReason, prev.emergencyReason) != 0) {
+    jsonEscape(text, sizeof(text), snap.emergencyReason);
+    appendf(delta, sizeof(delta), len, "\"reason\":\"%s\",", text);
+  }
+  
+  pushedSnapshot = snap;
+  if (len == start) return;  // Only suppressed fields changed
+  
+  if (delta[len - 1] == ',') len--;  // Drop the trailing comma
+  appendf(delta, sizeof(delta), len, "}}");
+  
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clientTopics[i] & TOPIC_STATUS) {
+      webSocket->sendTXT(i, delta, len);
+    }
+  }
+}
+
+const char* AGVCoreNetwork::getStatusJson(size_t& length) {
+  StatusSnapshot snap;
+  uint32_t version;
+  
+  portENTER_CRITICAL(&statusLock);
+  version = statusVersion;
+  if (version != statusJsonVersion) snap = statusSnapshot;
+  portEXIT_CRITICAL(&statusLock);
+  
+  // Rebuild only when a field changed since the last serialization
+  if (version != statusJsonVersion) {
+    char command[sizeof(snap.lastCommand) * 2];
+    char reason[sizeof(snap.emergencyReason) * 2];
+    jsonEscape(command, sizeof(command), snap.lastCommand);
+    jsonEscape(reason, sizeof(reason), snap.emergencyReason);
+    
+    int len = snprintf(statusJson, sizeof(statusJson),
+      "{\"emergency\":%d,\"connected\":%d,\"mode\":\"%s\",\"rssi\":%d,"
+      "\"ip\":\"%u.%u.%u.%u\",\"uptime\":%u,\"clients\":%u,\"pollClients\":%u,"
+      "\"serialPending\":%u,\"lease\":%d,\"lastCommand\":\"%s\",\"reason\":\"%s\"}",
+      snap.emergency ? 1 : 0, snap.connected ? 1 : 0, snap.apMode ? "ap" : "station", snap.rssi,
+      (unsigned)(snap.ip & 0xFF), (unsigned)((snap.ip >> 8) & 0xFF),
+      (unsigned)((snap.ip >> 16) & 0xFF), (unsigned)(snap.ip >> 24),
+      (unsigned)snap.uptimeSec, snap.wsClients, snap.pollClients, snap.serialPending,
+      snap.leaseHolder, command, reason);
+    
+    statusJsonLength = (len > 0 && (size_t)len < sizeof(statusJson)) ? (size_t)len : 0;
+    statusJsonVersion = version;
   }
   
-  server->send(404, "text/plain", message);
+  length = statusJsonLength;
+  return statusJson;
 }
 
 // Utility methods
@@ -556,11 +2302,15 @@ String AGVCoreNetwork::getSessionToken() {
   return token;
 }
 
-bool AGVCoreNetwork::validateToken() {
+bool AGVCoreNetwork::isAuthorized() {
   if (isAPMode) return true; // No auth in AP mode
   
   String auth = server->header("Authorization");
-  if (auth.startsWith("Bearer ") && auth.substring(7) == sessionToken) {
+  return sessionToken.length() > 0 && auth.startsWith("Bearer ") && auth.substring(7) == sessionToken;
+}
+
+bool AGVCoreNetwork::validateToken() {
+  if (isAuthorized()) {
     return true;
   }
   
@@ -569,6 +2319,10 @@ bool AGVCoreNetwork::validateToken() {
 }
 
 void AGVCoreNetwork::cleanupResources() {
+  for (uint8_t i = 0; i < transportCount; i++) {
+    transports[i]->stop();
+  }
+  
   if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdPASS) {
     if (webSocket) {
       delete webSocket;
@@ -580,6 +2334,11 @@ void AGVCoreNetwork::cleanupResources() {
       server = nullptr;
     }
     
+    if (pollServer) {
+      delete pollServer;
+      pollServer = nullptr;
+    }
+    
     if (dnsServer) {
       dnsServer->stop();
       delete dnsServer;
@@ -6,20 +6,85 @@
 #include <WebServer.h>
 #include <WebSocketsServer.h>
 #include <ESPmDNS.h>
-#include <Preferences.h>
-#include <DNSServer.h>
+#include <mdns.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include "AGVCoreNetwork_Platform.h"
+#include "AGVCoreNetwork_Profiler.h"
+#include "AGVCoreNetwork_Http.h"
+#include "AGVCoreNetwork_Recorder.h"
+#include "AGVCoreNetwork_Emergency.h"
+#include "AGVCoreNetwork_Transport.h"
+#include "AGVCoreNetwork_Mqtt.h"
+#include "AGVCoreNetwork_Async.h"
+#include "AGVCoreNetwork_Path.h"
+#include "AGVCoreNetwork_Dns.h"
+#include "AGVCoreNetwork_Lease.h"
+#include "AGVCoreNetwork_Ota.h"
+#include "AGVCoreNetwork_Time.h"
+#include "AGVCoreNetwork_Compress.h"
+#include "AGVCoreNetwork_History.h"
+#include "AGVCoreNetwork_Guard.h"
+#include "AGVCoreNetwork_Discovery.h"
+#include "AGVCoreNetwork_Filter.h"
+#include "AGVCoreNetwork_Payload.h"
 
 namespace AGVCoreNetworkLib {
 
 class AGVCoreNetwork {
 public:
+  // Platform policies (see AGVCoreNetwork_Platform.h)
+  typedef AGVNET_CLOCK Clock;
+  typedef AGVNET_STORAGE Storage;
+  typedef AGVNET_LINK Link;
+  
   // Callback function types
   typedef void (*CommandCallback)(const char* command);
+  typedef void (*CommandViewCallback)(const char* command, size_t length);
   typedef void (*EmergencyStateCallback)(bool);
   typedef void (*StatusCallback)(const char* status);
+  typedef void (*WaypointCallback)(const PathDecoder::Waypoint& waypoint);
+  
+  // Placement of the Core 0 network task (applied by begin())
+  struct TaskConfig {
+    BaseType_t core = 0;
+    UBaseType_t priority = configMAX_PRIORITIES - 2;  // Slightly lower priority than motion
+    uint32_t stackSize = 10240;
+  };
+  
+  // Live status snapshot, updated in place as state changes
+  struct StatusSnapshot {
+    bool apMode = false;
+    bool emergency = false;
+    bool connected = false;
+    int8_t rssi = 0;
+    uint32_t ip = 0;
+    uint32_t uptimeSec = 0;
+    uint8_t wsClients = 0;
+    uint8_t pollClients = 0;
+    uint8_t serialPending = 0;              // Bytes waiting in the serial line buffer
+    int8_t leaseHolder = -1;                // WebSocket client holding the motion lease
+    char lastCommand[48] = "";
+    char emergencyReason[48] = "";
+  };
+  
+  // WebSocket subscription topics (library control messages)
+  enum Topic : uint8_t {
+    TOPIC_STATUS = 0x01,                    // Status snapshot deltas
+    TOPIC_TIME = 0x02                       // Clock sync exchanges (TIME:SYNC)
+  };
+  
+  // Station start-up. FAST_BOOT_ON associates with the cached access point and
+  // channel (no scan) and starts the servers while the link comes up.
+  // FAST_BOOT_REUSE_ADDRESS also applies the cached address statically instead
+  // of waiting for DHCP; only use it when the DHCP server reserves that
+  // address for the vehicle.
+  enum FastBoot : uint8_t {
+    FAST_BOOT_OFF = 0,
+    FAST_BOOT_ON,
+    FAST_BOOT_REUSE_ADDRESS
+  };
   
   // Initialize the network system
   void begin(const char* deviceName = "agvcontrol", 
@@ -28,19 +93,129 @@ public:
   
   // Set callbacks for system integration
   void setCommandCallback(CommandCallback callback);
+  
+  // Commands as a length-delimited view, valid for the duration of the call
+  // (also NUL-terminated). Replaces the command callback when set and raises
+  // the command limit from 64 bytes to AGVNET_PAYLOAD_MAX: fragmented
+  // WebSocket messages and long serial lines are reassembled in pooled
+  // buffers, and longer ones are refused with "NACK: CMD too long".
+  void setCommandViewCallback(CommandViewCallback callback);
+  const PayloadPool::Stats& getPayloadStats() const { return payloadPool.getStats(); }
   void setEmergencyStateCallback(EmergencyStateCallback callback);
   void setStatusCallback(StatusCallback callback);
   
+  // Waypoints of binary path streams (see AGVCoreNetwork_Path.h), delivered
+  // on the network task as each frame is decoded
+  void setWaypointCallback(WaypointCallback callback);
+  
+  // Task placement - must be set before begin()
+  void setTaskConfig(const TaskConfig& config);
+  const TaskConfig& getTaskConfig() const { return taskConfig; }
+  
+  // Task profiler (enabled by default, 1 s sample window)
+  void setProfilingEnabled(bool enabled, uint32_t windowMs = 1000);
+  bool getTaskProfile(TaskProfile& profile);
+  
+  // Keep-alive polling server port (default 8080, 0 disables) - set before begin()
+  void setPollServerPort(uint16_t port) { pollServerPort = port; }
+  
+  // Web server and WebSocket ports (default 80/81) - set before begin().
+  // The dashboard expects the WebSocket one port above the web server.
+  void setServerPorts(uint16_t http, uint16_t ws) { httpPort = http; wsPort = ws; }
+  
+  // NVS namespace holding the WiFi credentials (default "agvnet") - set before
+  // begin(); each instance in one process needs its own
+  void setStorageNamespace(const char* ns) { storageNamespace = ns; }
+  
+  // Per-address rate limit over HTTP requests and WebSocket messages
+  // (default 20/s, burst 40; 0 disables). STOP/ABORT are never limited.
+  void setRateLimit(uint16_t perSecond, uint16_t burst) { guard.setRateLimit(perSecond, burst); }
+  const RequestGuard::Stats& getRequestGuardStats() const { return guard.getStats(); }
+  
   // Send status update to web clients
   void sendStatus(const char* status);
   
+  // Copy of the current status snapshot
+  void getStatusSnapshot(StatusSnapshot& snapshot);
+  
+  // Plant messaging backends (e.g. MqttTransport) - register before begin();
+  // they are started once the station connection is up
+  static const uint8_t MAX_TRANSPORTS = 4;
+  bool addTransport(Transport* transport);
+  
+  // Cooperative tasks resumed from the network task (see AGVCoreNetwork_Async.h).
+  // Command callbacks run on that task, so they can start a task that waits for
+  // motion completion instead of blocking; the application signals the event.
+  bool startAsync(AsyncTask* task) { return scheduler.start(task); }
+  void signalEvent(uint32_t bits) { scheduler.signal(bits); }
+  
+  // Flight recorder and replay of a recorded dump (dump must stay valid while replaying)
+  FlightRecorder& getFlightRecorder() { return recorder; }
+  bool startReplay(const uint8_t* dump, size_t length, uint16_t speedPercent = 100);
+  void stopReplay() { replayer.stop(); }
+  bool isReplaying() const { return replayer.active(); }
+  
+  // Motion lease for WebSocket clients, renewed by heartbeat. Off by default;
+  // once a duration is set only the holder may send commands (others get
+  // "NACK: LEASE required") and STOP/ABORT are still accepted from anyone.
+  // HTTP clients cannot hold it, so POST /command answers 409 to anything
+  // but STOP/ABORT while the lease is on.
+  void setControlLeaseDuration(uint32_t ms) { controlLease.setDuration(ms); }
+  int8_t getLeaseHolder() const;
+  
   // Emergency broadcast and state management
   void broadcastEmergency(const char* message);
   void clearEmergencyState();
+  bool isEmergencyActive() const { return emergency.isActive(); }
+  EmergencyState::Snapshot getEmergencyState() const { return emergency.snapshot(); }
   
   // WebSocket event handler
   void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
   
+  // Fast-boot mode (default off) - set before begin()
+  void setFastBoot(FastBoot mode) { fastBoot = mode; }
+  
+  // Time from begin() to each start-up phase (also GET /debug/boot)
+  const BootTimeline& getBootTimeline() const { return bootTimeline; }
+  
+  // WiFi power-save profile. By default the link runs low-latency while the
+  // vehicle moves or commands arrive and balanced after 10 s of quiet;
+  // battery-limited vehicles can pick LINK_POWER_SAVE for idle. A fixed
+  // profile turns the switching off. Applied on the network task.
+  void setLinkProfile(LinkProfile profile) { linkPolicy.setFixed(profile); }
+  void setLinkProfiles(LinkProfile moving, LinkProfile idle, uint32_t idleAfterMs = 10000) {
+    linkPolicy.setAuto(moving, idle, idleAfterMs);
+  }
+  LinkProfile getLinkProfile() const { return linkPolicy.current(); }
+  
+  // Motion state from the motion controller (either core)
+  void setMotionState(bool moving) { linkPolicy.setMoving(moving); }
+  
+  // Round-trip latency and residency per profile (network task; also
+  // GET /debug/link). Round trips are WebSocket pings, one client per second.
+  void getLinkStats(LinkProfile profile, LinkPolicy::Stats& stats) const {
+    linkPolicy.getStats(profile, stats, Clock::ms());
+  }
+  
+  // Fleet discovery over _agv._tcp (see AGVCoreNetwork_Discovery.h). The
+  // query runs on the network task for timeoutMs and merges answers into a
+  // cache; entries expire ttlMs (default 120 s) after they were last seen.
+  // discoverVehicles() is false while a query is running or without memory.
+  bool discoverVehicles(uint32_t timeoutMs = 1500);
+  bool isDiscovering() const { return discoveryRequest != 0 || discoveryQuery != nullptr; }
+  void setDiscoveryTtl(uint32_t ms) { discovery.setTtl(ms); }
+  size_t getVehicles(FleetDiscovery::Vehicle* vehicles, size_t max);
+  bool findVehicle(const char* name, FleetDiscovery::Vehicle& vehicle);
+  
+  // Command validation on the network task before the command callback (see
+  // AGVCoreNetwork_Filter.h); rejected commands are NACKed to the sender.
+  // "Moving" is the state given to setMotionState(). Set before begin().
+  bool addCommandRule(const char* verb, const char* args = "", uint16_t minIntervalMs = 0, uint8_t flags = 0) {
+    return filter.addRule(verb, args, minIntervalMs, flags);
+  }
+  void setAllowUnknownCommands(bool allow) { filter.setAllowUnknownVerbs(allow); }
+  const CommandFilter& getCommandFilter() const { return filter; }
+  
   // Check connectivity status
   bool isConnected() const { return WiFi.status() == WL_CONNECTED && !isAPMode; }
   bool isInAPMode() const { return isAPMode; }
@@ -49,8 +224,22 @@ private:
   // Network resources
   WebServer* server = nullptr;
   WebSocketsServer* webSocket = nullptr;
-  DNSServer* dnsServer = nullptr;
-  Preferences preferences;
+  CaptiveDns* dnsServer = nullptr;
+  KeepAliveServer* pollServer = nullptr;
+  uint16_t pollServerPort = 8080;
+  uint16_t httpPort = 80;
+  uint16_t wsPort = 81;
+  const char* storageNamespace = "agvnet";
+  
+  // Start-up
+  static const uint32_t CACHED_CONNECT_MS = 3000;     // Before falling back to a scan
+  static const uint32_t CONNECT_TIMEOUT_MS = 15000;
+  static const uint8_t ROLLBACK_AFTER_FAILED_BOOTS = 3;  // Unconfirmed image that cannot connect
+  FastBoot fastBoot = FAST_BOOT_OFF;
+  BootCache bootCache;
+  bool bootCacheUsed = false;
+  bool staticAddress = false;
+  BootTimeline bootTimeline;
   
   // Configuration
   String stored_ssid;
@@ -61,7 +250,8 @@ private:
   
   // System state
   bool isAPMode = false;
-  bool systemEmergency = false;
+  EmergencyState emergency;
+  ControlLease controlLease;
   const char* mdnsName = nullptr;
   
   // Default AP credentials
@@ -70,20 +260,157 @@ private:
   
   // Callbacks
   CommandCallback commandCallback = nullptr;
+  CommandViewCallback commandViewCallback = nullptr;
   EmergencyStateCallback emergencyStateCallback = nullptr;
   StatusCallback statusCallback = nullptr;
+  WaypointCallback waypointCallback = nullptr;
   
   // Synchronization
   SemaphoreHandle_t mutex = nullptr;
   TaskHandle_t core0TaskHandle = nullptr;
+  TaskConfig taskConfig;
+  
+  // Status snapshot and its cached JSON form (JSON is only touched on Core 0)
+  portMUX_TYPE statusLock = portMUX_INITIALIZER_UNLOCKED;
+  StatusSnapshot statusSnapshot;
+  uint32_t statusVersion = 1;
+  uint32_t statusJsonVersion = 0;
+  uint32_t lastStatusRefresh = 0;
+  uint32_t lastStatusPush = 0;
+  uint32_t statusPushVersion = 0;
+  StatusSnapshot pushedSnapshot;
+  uint8_t clientTopics[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+  PathDecoder pathDecoders[WEBSOCKETS_SERVER_CLIENT_MAX];
+  
+  // Per-client clock estimates and commands waiting for their execute-at time
+  static const uint32_t TIME_SYNC_FAST_MS = 250;      // Until the window is full
+  static const uint32_t TIME_SYNC_INTERVAL_MS = 5000;
+  static const int64_t TIMED_HORIZON_US = 60000000;   // Furthest AT: accepted
+  ClockSync clientClocks[WEBSOCKETS_SERVER_CLIENT_MAX];
+  uint32_t timeSyncDue[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+  TimerWheel timedCommands;
+  size_t statusJsonLength = 0;
+  char statusJson[384];
+  
+  // Registered transports
+  Transport* transports[MAX_TRANSPORTS] = {};
+  uint8_t transportCount = 0;
+  
+  // Link power profile and the ping probe that measures it
+  static const uint32_t LINK_PROBE_MS = 1000;
+  static const uint32_t LINK_PROBE_TIMEOUT_MS = 2000;
+  LinkPolicy linkPolicy;
+  uint32_t linkProbeDue = 0;
+  uint32_t linkProbeSentUs = 0;
+  uint8_t linkProbeClient = 0;
+  bool linkProbePending = false;
+  
+  // DNS-SD advertisement and fleet discovery. State changes reach the TXT
+  // record within a second; client count and load at most every 10 s.
+  static const uint32_t ADVERT_STATE_MS = 1000;
+  static const uint32_t ADVERT_LOAD_MS = 10000;
+  static const size_t DISCOVERY_MAX_RESULTS = AGVNET_DISCOVERY_MAX;
+  static const size_t DISCOVERY_MAX_TXT = 12;
+  bool mdnsStarted = false;
+  FleetDiscovery::State advertState = FleetDiscovery::STATE_UNKNOWN;
+  uint8_t advertClients = 0;
+  uint8_t advertCpu = 0;
+  uint32_t advertAt = 0;
+  uint32_t advertLoadAt = 0;
+  FleetDiscovery discovery;
+  mdns_search_once_t* discoveryQuery = nullptr;
+  volatile uint32_t discoveryRequest = 0;   // Timeout of a requested query
+  
+  // Cooperative tasks
+  AsyncScheduler scheduler;
+  bool wifiLinkUp = false;
+  
+  class ConnectTask : public AsyncTask {
+  public:
+    explicit ConnectTask(AGVCoreNetwork* net) : net(net) {}
+    bool run(AsyncScheduler& scheduler) override;
+  private:
+    AGVCoreNetwork* net;
+    uint32_t deadline = 0;
+  };
+  
+  class RestartTask : public AsyncTask {
+  public:
+    explicit RestartTask(AGVCoreNetwork* net) : net(net) {}
+    bool run(AsyncScheduler& scheduler) override;
+  private:
+    AGVCoreNetwork* net;
+  };
+  
+  ConnectTask connectTask{this};
+  RestartTask restartTask{this};
+  
+  // Firmware update in progress (network task only)
+  OtaUpdater ota;
+  EspFlashWriter otaWriter;
+  bool otaAuthorized = false;
+  bool otaRefused = false;                  // Rate limited when the upload started
+  uint32_t otaStartMs = 0;
+  
+  // Flight recorder
+  FlightRecorder recorder;
+  FlightReplayer replayer;
+  bool replayingRecord = false;             // Skips admission and the lease check
+  
+  // Profiler state (accumulated on Core 0, published once per window)
+  bool profilingEnabled = true;
+  TaskProfiler profiler;
+  TaskProfile profileSnapshot;
+  
+  // Serial line being assembled
+  static const size_t SERIAL_CHUNK = 256;   // Bytes read per loop
+  char serialBuffer[CommandFilter::MAX_COMMAND + 1];
+  uint8_t serialLength = 0;
+  bool serialOverflow = false;              // Rest of an overlong line is dropped
+  CommandFilter filter;
+  
+  // Reassembly of long commands (view callback only for serial lines)
+  enum FragmentState : uint8_t { FRAGMENT_NONE, FRAGMENT_TEXT, FRAGMENT_BINARY, FRAGMENT_DROPPED };
+  PayloadPool payloadPool;
+  PayloadAssembler serialAssembler;
+  PayloadAssembler fragmentAssemblers[WEBSOCKETS_SERVER_CLIENT_MAX];
+  FragmentState fragments[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
   
   // Internal methods
   void setupWiFi();
   void startAPMode();
   void startStationMode();
+  void beginAssociation(bool useCache);
+  void startStationServers();
+  void saveBootCache();
+  void countFailedBoot();
+  void startStationServices();
   void setupRoutes();
   void processSerialInput();
+  void processReplay();
+  void startTransports();
+  void publishTransports(Transport::Channel channel, const char* payload, size_t length);
   void core0Task(void *parameter);
+  uint32_t profileSection(Subsystem subsystem, uint32_t start);
+  void profileLoopEnd(uint32_t loopStart, uint32_t loopEnd);
+  
+  // Admission control and bounded request bodies
+  static const size_t MAX_BODY = 512;
+  enum BodyState : uint8_t { BODY_NONE, BODY_CAPTURING, BODY_CAPTURED, BODY_OVERSIZE };
+  RequestGuard guard;
+  uint32_t clientIps[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+  char requestBody[MAX_BODY + 1];
+  size_t bodyLength = 0;
+  BodyState bodyState = BODY_NONE;
+  bool admitRequest();
+  bool admitClient(uint32_t ip);
+  bool admitMessage(uint8_t num, const char* text);
+  bool mayCommand(uint8_t num);
+  void sendTooManyRequests();
+  void logRateLimited(uint32_t ip);
+  void onBodyRoute(const char* uri, std::function<void()> handler);
+  void captureBody();
+  bool readBody(String& body);
   
   // Web handlers
   void handleRoot();
@@ -94,21 +421,94 @@ private:
   void handleSaveWiFi();
   void handleCommand();
   void handleNotFound();
+  void handleDebugTasks();
+  void handleDebugRecorder();
+  void handleDebugBoot();
+  void handleDebugLink();
+  void serviceLink();
+  void advertiseService();
+  void updateAdvertisement(bool force);
+  void serviceDiscovery();
+  void handleOtaUpload();
+  void handleOtaFinish();
+  
+  // Status snapshot maintenance
+  template <typename T> void updateStatusField(T& field, T value) {
+    portENTER_CRITICAL(&statusLock);
+    if (field != value) {
+      field = value;
+      statusVersion++;
+    }
+    portEXIT_CRITICAL(&statusLock);
+  }
+  void updateStatusText(char* field, size_t size, const char* value);
+  void refreshStatusSnapshot();
+  const char* getStatusJson(size_t& length);
+  void pushStatusDeltas();
+  
+  // WebSocket framing: payload is built once behind reserved header space
+  static const size_t FRAME_PAYLOAD_MAX = 256;   // Larger frames use the heap
+  static const int16_t ALL_CLIENTS = -1;
+  
+  // Broadcasts that are part of the log stream are kept in the event history;
+  // STREAM_LOG frames may also be compressed, emergencies always go as text
+  enum Stream : uint8_t { STREAM_NONE, STREAM_LOG, STREAM_EMERGENCY };
+  bool sendFramed(int16_t num, const char* prefix, const char* message, size_t length,
+                  Stream stream = STREAM_NONE);
+  
+  // Log stream: history for reconnect catch-up (RESUME:<id>) and compression
+  // for clients that sent COMPRESS:ON, both serialized by streamLock
+  SemaphoreHandle_t streamLock = nullptr;
+  EventHistory history;
+  StreamCompressor compressor;
+  volatile uint32_t cursorClients = 0;     // Bit per client receiving "#<id> " tags
+  bool broadcastLog(uint8_t* payload, size_t length, Stream stream);
+  void setCompression(uint8_t num, bool enabled);
+  void handleResume(uint8_t num, const char* msg, size_t length);
+  
+  // Library control messages (never forwarded to the application)
+  bool handleControlMessage(uint8_t num, const char* msg, size_t length);
+  void handleLeaseMessage(uint8_t num, const char* msg, size_t length);
+  void handleTimeMessage(uint8_t num, const char* msg, size_t length);
+  void serviceTimeSync();
+  void scheduleTimedCommand(uint8_t num, const char* cmd, size_t length);
+  void releaseTimedCommand(uint8_t num, const char* cmd, uint32_t epoch, int64_t lateUs);
+  
+  // WebSocket commands, whole or reassembled from fragments
+  void handleTextMessage(uint8_t num, const char* text, size_t length);
+  void handleFragment(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
+  
+  // Binary path stream from a WebSocket client
+  void handlePathFrame(uint8_t num, const uint8_t* data, size_t length);
   
   // Utility methods
   String getSessionToken();
+  bool isAuthorized();
   bool validateToken();
   void cleanupResources();
   void restartSystem();
   
   // Command processing
-  void processWebCommand(const char* cmd);
-  void processSerialCommand(const char* cmd);
+  bool processWebCommand(const char* cmd, size_t length, EmergencyState::Source source,
+                         const char** rejection = nullptr);
+  bool filterCommand(const char* cmd, size_t length, const char* tag, const char** rejection);
+  void deliverCommand(const char* cmd, size_t length);
+  void sendCommandNack(uint8_t num, const char* reason);
+  void processSerialCommand(const char* cmd, size_t length);
+  void finishSerialLine();
+  void handleSerialLine(const char* line, size_t length);
+  
+  // Emergency transitions shared by every interface
+  bool handleEmergencyCommand(const char* cmd, EmergencyState::Source source);
+  void enterEmergency(EmergencyState::Reason reason, EmergencyState::Source source, const char* message);
+  bool exitEmergency();
 };
 
 } // namespace AGVCoreNetworkLib
 
-// Global instance
+#if AGVNET_DEFAULT_INSTANCE
+// Default instance for single-vehicle sketches
 extern AGVCoreNetworkLib::AGVCoreNetwork agvNetwork;
+#endif
 
 #endif
@@ -0,0 +1,48 @@
+#include "AGVCoreNetwork_Async.h"
+
+using namespace AGVCoreNetworkLib;
+
+bool AsyncScheduler::start(AsyncTask* task) {
+  if (!task) return false;
+
+  bool started = false;
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < MAX_TASKS; i++) {
+    if (tasks[i] == task) break;  // Already running
+    if (!tasks[i]) {
+      task->asyncLine = 0;
+      tasks[i] = task;
+      started = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+
+  return started;
+}
+
+bool AsyncScheduler::isRunning(const AsyncTask* task) {
+  bool running = false;
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < MAX_TASKS; i++) {
+    if (tasks[i] == task) running = true;
+  }
+  portEXIT_CRITICAL(&lock);
+  return running;
+}
+
+void AsyncScheduler::poll() {
+  for (uint8_t i = 0; i < MAX_TASKS; i++) {
+    portENTER_CRITICAL(&lock);
+    AsyncTask* task = tasks[i];
+    portEXIT_CRITICAL(&lock);
+
+    if (!task || !task->run(*this)) continue;
+
+    portENTER_CRITICAL(&lock);
+    tasks[i] = nullptr;
+    portEXIT_CRITICAL(&lock);
+
+    task->finished();
+  }
+}
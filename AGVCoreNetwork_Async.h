@@ -0,0 +1,89 @@
+#ifndef AGVCORENETWORK_ASYNC_H
+#define AGVCORENETWORK_ASYNC_H
+
+#include <Arduino.h>
+#include <atomic>
+
+namespace AGVCoreNetworkLib {
+
+class AsyncScheduler;
+
+// Stackless cooperative task for handlers that need to wait (timers, WiFi,
+// motion completion) without blocking the network loop. run() is resumed
+// from the network task until it returns true:
+//
+//   class MoveAndReport : public AsyncTask {
+//     bool run(AsyncScheduler& scheduler) override {
+//       AGV_ASYNC_BEGIN();
+//       AGV_AWAIT_EVENT(scheduler, AsyncScheduler::EVENT_MOTION_COMPLETE);
+//       agvNetwork.sendStatus("Move complete");
+//       AGV_AWAIT_DELAY(500);
+//       AGV_ASYNC_END();
+//     }
+//   };
+//
+// Locals do not survive a wait; keep state in members. Use at most one
+// AGV_AWAIT_* per source line.
+class AsyncTask {
+public:
+  virtual ~AsyncTask() {}
+  virtual bool run(AsyncScheduler& scheduler) = 0;
+
+  // Called on the network task after run() returned true
+  virtual void finished() {}
+
+protected:
+  uint16_t asyncLine = 0;
+  uint32_t asyncWakeAt = 0;
+
+  friend class AsyncScheduler;
+};
+
+#define AGV_ASYNC_BEGIN() switch (asyncLine) { case 0:
+
+#define AGV_AWAIT_UNTIL(condition) \
+  do { asyncLine = __LINE__; __attribute__((fallthrough)); \
+       case __LINE__: if (!(condition)) return false; } while (0)
+
+#define AGV_AWAIT_DELAY(ms) \
+  do { asyncWakeAt = millis() + (ms); \
+       AGV_AWAIT_UNTIL((int32_t)(millis() - asyncWakeAt) >= 0); } while (0)
+
+#define AGV_AWAIT_EVENT(scheduler, bits) AGV_AWAIT_UNTIL((scheduler).consume(bits))
+
+#define AGV_ASYNC_END() } asyncLine = 0; return true
+
+// Runs AsyncTasks from the network loop and carries event bits between cores
+class AsyncScheduler {
+public:
+  static const uint8_t MAX_TASKS = 8;
+
+  enum Event : uint32_t {
+    EVENT_MOTION_COMPLETE = 0x0001,    // Signalled by the application
+    EVENT_WIFI_CONNECTED = 0x0002,
+    EVENT_WIFI_DISCONNECTED = 0x0004,
+    EVENT_USER = 0x0100                // First bit free for application use
+  };
+
+  // Queue a task (either core); false if all slots are busy
+  bool start(AsyncTask* task);
+  bool isRunning(const AsyncTask* task);
+
+  // Set event bits (either core); waiting tasks consume them
+  void signal(uint32_t bits) { events.fetch_or(bits, std::memory_order_release); }
+
+  // Clears and returns true if any of the bits were set
+  bool consume(uint32_t bits) { return events.fetch_and(~bits, std::memory_order_acq_rel) & bits; }
+
+  // Resume every task once; call from the network loop
+  void poll();
+
+private:
+  AsyncTask* tasks[MAX_TASKS] = {};
+  std::atomic<uint32_t> events{0};
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
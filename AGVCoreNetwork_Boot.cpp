@@ -0,0 +1,35 @@
+#include "AGVCoreNetwork_Boot.h"
+
+using namespace AGVCoreNetworkLib;
+
+static const char* const PHASE_NAMES[BootTimeline::PHASE_COUNT] = {
+  "storage", "radio", "servers", "connected", "mdns", "ready"
+};
+
+void BootTimeline::start(uint32_t nowMs) {
+  startMs = nowMs;
+  reachedMask = 0;
+}
+
+void BootTimeline::mark(Phase phase, uint32_t nowMs) {
+  if (phase >= PHASE_COUNT || reached(phase)) return;
+  phaseMs[phase] = nowMs - startMs;
+  reachedMask |= 1 << phase;
+}
+
+const char* BootTimeline::name(Phase phase) {
+  return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "unknown";
+}
+
+size_t BootTimeline::toJson(char* out, size_t size) const {
+  size_t len = snprintf(out, size, "{");
+  bool first = true;
+  for (uint8_t i = 0; i < PHASE_COUNT && len < size; i++) {
+    if (!reached((Phase)i)) continue;
+    len += snprintf(out + len, size - len, "%s\"%s\":%u", first ? "" : ",",
+                    PHASE_NAMES[i], (unsigned)phaseMs[i]);
+    first = false;
+  }
+  if (len < size) len += snprintf(out + len, size - len, "}");
+  return len < size ? len : size - 1;
+}
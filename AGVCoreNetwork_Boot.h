@@ -0,0 +1,58 @@
+#ifndef AGVCORENETWORK_BOOT_H
+#define AGVCORENETWORK_BOOT_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// Association data saved after a successful station connection, so the next
+// boot can skip the channel scan (and optionally DHCP). Kept in NVS by the
+// storage policy; channel 0 means nothing cached.
+struct BootCache {
+  uint8_t bssid[6] = {};
+  uint8_t channel = 0;
+  uint32_t ip = 0;
+  uint32_t gateway = 0;
+  uint32_t subnet = 0;
+  uint32_t dns = 0;
+
+  bool valid() const { return channel != 0; }
+  bool operator==(const BootCache& other) const {
+    return memcmp(bssid, other.bssid, sizeof(bssid)) == 0 && channel == other.channel &&
+           ip == other.ip && gateway == other.gateway && subnet == other.subnet && dns == other.dns;
+  }
+};
+
+// Milliseconds from begin() to each boot phase. Each phase is stamped once;
+// phases may complete in any order when fast boot overlaps them.
+class BootTimeline {
+public:
+  enum Phase : uint8_t {
+    PHASE_STORAGE = 0,    // Credentials and boot cache read
+    PHASE_RADIO,          // Association started
+    PHASE_SERVERS,        // Web and WebSocket servers listening
+    PHASE_CONNECTED,      // Link up with an address
+    PHASE_MDNS,           // Hostname advertised
+    PHASE_READY,          // Servers listening and link up: commands accepted
+    PHASE_COUNT
+  };
+
+  void start(uint32_t nowMs);
+  void mark(Phase phase, uint32_t nowMs);
+
+  bool reached(Phase phase) const { return (reachedMask >> phase) & 1; }
+  uint32_t elapsed(Phase phase) const { return phaseMs[phase]; }
+  static const char* name(Phase phase);
+
+  // {"storage":12,...} with only the phases reached so far
+  size_t toJson(char* out, size_t size) const;
+
+private:
+  uint32_t startMs = 0;
+  uint32_t phaseMs[PHASE_COUNT] = {};
+  uint8_t reachedMask = 0;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,158 @@
+#include "AGVCoreNetwork_Compress.h"
+
+using namespace AGVCoreNetworkLib;
+
+const char StreamCompressor::DICTIONARY[] =
+  "{\"delta\":{\"emergency\":1,\"connected\":0,\"mode\":\"station\",\"rssi\":-"
+  "\"clients\":\"pollClients\":\"serialPending\":\"lease\":-1,\"lastCommand\":\""
+  "\"reason\":\"\"}}SYSTEM_EMERGENCY: Emergency cleared AGV Ready - Idle "
+  "turnaround turn_left 90 turn_right 90 move forward STOP ABORT START PAUSE "
+  "RESUME PATH:MOVE:NACK: ACK: SERIAL: Executing: WS: ";
+
+static inline uint16_t hash3(const uint8_t* p) {
+  uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  return (uint16_t)((v * 2654435761u) >> 22);   // 10 bits for HASH_SIZE 1024
+}
+
+StreamCompressor::~StreamCompressor() {
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) free(windows[i]);
+}
+
+bool StreamCompressor::enable(uint8_t client) {
+  if (client >= MAX_CLIENTS) return false;
+
+  if (!windows[client]) {
+    windows[client] = (Window*)malloc(sizeof(Window));
+    if (!windows[client]) return false;
+    activeClients++;
+  }
+
+  Window* w = windows[client];
+  w->length = sizeof(DICTIONARY) - 1;
+  memcpy(w->data, DICTIONARY, w->length);
+  for (size_t i = 0; i < HASH_SIZE; i++) w->head[i] = NIL;
+  for (size_t i = 0; i + MIN_MATCH <= w->length; i++) insert(w, i);
+  return true;
+}
+
+void StreamCompressor::disable(uint8_t client) {
+  if (!enabled(client)) return;
+
+  free(windows[client]);
+  windows[client] = nullptr;
+  activeClients--;
+}
+
+void StreamCompressor::insert(Window* w, uint16_t position) {
+  uint16_t h = hash3(w->data + position);
+  w->prev[position] = w->head[h];
+  w->head[h] = position;
+}
+
+// Moves the window to the start of the buffer, dropping chain entries that
+// fall off the front
+void StreamCompressor::slide(Window* w) {
+  uint16_t shift = w->length - WINDOW;
+  memmove(w->data, w->data + shift, WINDOW);
+  for (size_t i = 0; i < HASH_SIZE; i++) {
+    w->head[i] = w->head[i] != NIL && w->head[i] >= shift ? w->head[i] - shift : NIL;
+  }
+  for (size_t i = 0; i < WINDOW; i++) {
+    uint16_t p = w->prev[i + shift];
+    w->prev[i] = p != NIL && p >= shift ? p - shift : NIL;
+  }
+  w->length = WINDOW;
+}
+
+size_t StreamCompressor::compress(uint8_t client, const uint8_t* message, size_t length, uint8_t* out) {
+  // The shortest frame is the magic and one match
+  if (!enabled(client) || length <= 1 + MIN_MATCH || length > MAX_MESSAGE) return 0;
+
+  // Message after the history so matches can reach into either
+  Window* w = windows[client];
+  if (w->length + length > BUFFER) slide(w);
+  uint8_t* buf = w->data;
+  size_t start = w->length;
+  size_t end = start + length;
+  size_t base = start > WINDOW ? start - WINDOW : 0;
+  memcpy(buf + start, message, length);
+
+  // Positions are chained once their three bytes are known; the ones added
+  // here come off again if the message goes out as text
+  size_t first = start >= MIN_MATCH - 1 ? start - (MIN_MATCH - 1) : 0;
+  size_t indexed = first;
+
+  // Alternating short literals and matches expand the data, so the output
+  // is bounded by the message length rather than by a worst-case formula
+  const size_t budget = length - 1;
+  bool overflow = false;
+  size_t o = 0;
+  out[o++] = MAGIC;
+  size_t literals = start;
+  size_t pos = start;
+
+  auto flushLiterals = [&](size_t upto) {
+    while (literals < upto) {
+      size_t n = upto - literals < MAX_LITERAL ? upto - literals : MAX_LITERAL;
+      if (o + 1 + n > budget) {
+        overflow = true;
+        return;
+      }
+      out[o++] = (uint8_t)(n - 1);
+      memcpy(out + o, buf + literals, n);
+      o += n;
+      literals += n;
+    }
+  };
+
+  while (pos < end && !overflow) {
+    for (; indexed < pos && indexed + MIN_MATCH <= end; indexed++) insert(w, indexed);
+
+    size_t bestLength = 0;
+    size_t bestDistance = 0;
+
+    if (pos + MIN_MATCH <= end) {
+      size_t limit = end - pos < MAX_MATCH ? end - pos : MAX_MATCH;
+      uint16_t candidate = w->head[hash3(buf + pos)];
+      for (uint8_t depth = 0; candidate != NIL && candidate >= base && depth < CHAIN_DEPTH; depth++) {
+        size_t n = 0;
+        while (n < limit && buf[candidate + n] == buf[pos + n]) n++;
+        if (n > bestLength) {
+          bestLength = n;
+          bestDistance = pos - candidate;
+          if (n == limit) break;
+        }
+        candidate = w->prev[candidate];
+      }
+    }
+
+    if (bestLength >= MIN_MATCH) {
+      flushLiterals(pos);
+      if (overflow || o + 3 > budget) {
+        overflow = true;
+        break;
+      }
+      out[o++] = (uint8_t)(0x80 | (bestLength - MIN_MATCH));
+      out[o++] = (uint8_t)(bestDistance & 0xFF);
+      out[o++] = (uint8_t)(bestDistance >> 8);
+      pos += bestLength;
+      literals = pos;
+    } else {
+      pos++;
+    }
+  }
+  if (!overflow) flushLiterals(end);
+
+  if (overflow) {
+    // Unwind the chains in reverse so the window is as it was
+    while (indexed > first) {
+      indexed--;
+      w->head[hash3(buf + indexed)] = w->prev[indexed];
+    }
+    return 0;
+  }
+
+  for (; indexed + MIN_MATCH <= end; indexed++) insert(w, indexed);
+  w->length = end;
+  return o;
+}
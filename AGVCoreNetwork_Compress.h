@@ -0,0 +1,75 @@
+#ifndef AGVCORENETWORK_COMPRESS_H
+#define AGVCORENETWORK_COMPRESS_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// LZ77 compression of the WebSocket log stream for clients that opt in.
+// Each client has its own history window (the last WINDOW bytes it was sent,
+// primed with DICTIONARY), so repeated prefixes and whole repeated lines
+// shrink to a few bytes. The window keeps its match finder hash chains up to
+// date as messages are appended, so a message costs its own length to index
+// rather than the window's; the buffer slides back only every few messages.
+//
+// Frame (binary WebSocket message):
+//   MAGIC, then tokens until the end of the frame
+//   0x00-0x7F  literal run of (token + 1) bytes, which follow
+//   0x80-0xFF  match of ((token & 0x7F) + 3) bytes, followed by the
+//              distance back into history + output (u16 little endian)
+// After each frame both sides append the decoded message to the window.
+class StreamCompressor {
+public:
+  static const uint8_t MAGIC = 0xC7;
+  static const uint8_t MAX_CLIENTS = 16;
+  static const size_t WINDOW = 1024;
+  static const size_t MAX_MESSAGE = 256;          // Longer messages go out as text
+  static const size_t MAX_OUTPUT = MAX_MESSAGE - 1;  // Frames are always shorter than the text
+
+  // Shared with the dashboard decoder; changing it breaks older pages
+  static const char DICTIONARY[];
+
+  ~StreamCompressor();
+
+  // Allocates the client's window (about 6.5 KB) and primes it
+  bool enable(uint8_t client);
+  void disable(uint8_t client);
+  bool enabled(uint8_t client) const { return client < MAX_CLIENTS && windows[client]; }
+  bool any() const { return activeClients > 0; }
+
+  // Compresses one message into out (MAX_OUTPUT bytes) and appends it to the
+  // client's window. Returns 0 if the frame would not be shorter than the
+  // message, the message is too long or the client is not enabled; the window
+  // is then left unchanged and the message goes out as text.
+  size_t compress(uint8_t client, const uint8_t* message, size_t length, uint8_t* out);
+
+private:
+  static const size_t HASH_SIZE = 1024;
+  static const uint8_t MIN_MATCH = 3;
+  static const uint8_t MAX_MATCH = 130;
+  static const uint8_t MAX_LITERAL = 128;
+  static const uint8_t CHAIN_DEPTH = 8;
+  static const uint16_t NIL = 0xFFFF;
+
+  // History plus room for a couple of messages before the buffer slides
+  static const size_t BUFFER = WINDOW + 2 * MAX_MESSAGE;
+
+  // Positions up to length - MIN_MATCH are on the chains; the window proper
+  // is the last WINDOW bytes of data[0, length)
+  struct Window {
+    uint16_t length;
+    uint16_t head[HASH_SIZE];
+    uint16_t prev[BUFFER];
+    uint8_t data[BUFFER];
+  };
+
+  Window* windows[MAX_CLIENTS] = {};
+  uint8_t activeClients = 0;
+
+  static void insert(Window* w, uint16_t position);
+  static void slide(Window* w);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
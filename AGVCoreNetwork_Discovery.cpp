@@ -0,0 +1,133 @@
+#include "AGVCoreNetwork_Discovery.h"
+#include <new>
+#include <strings.h>
+
+using namespace AGVCoreNetworkLib;
+
+const char* const FleetDiscovery::CAPABILITY_NAMES[] = {
+  "path", "time", "lz", "resume", "lease", "ota", nullptr
+};
+
+static uint32_t nameHash(const char* name) {
+  uint32_t h = 2166136261u;   // FNV-1a, case-folded like DNS names
+  for (; *name; name++) {
+    h ^= (uint8_t)tolower((unsigned char)*name);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void copyText(char* dest, size_t size, const char* src) {
+  snprintf(dest, size, "%s", src ? src : "");
+}
+
+const char* FleetDiscovery::stateName(State state) {
+  switch (state) {
+    case STATE_IDLE:   return "idle";
+    case STATE_MOVING: return "moving";
+    case STATE_ESTOP:  return "estop";
+    default:           return "unknown";
+  }
+}
+
+FleetDiscovery::State FleetDiscovery::parseState(const char* text) {
+  if (!text) return STATE_UNKNOWN;
+  if (strcmp(text, "idle") == 0) return STATE_IDLE;
+  if (strcmp(text, "moving") == 0) return STATE_MOVING;
+  if (strcmp(text, "estop") == 0) return STATE_ESTOP;
+  return STATE_UNKNOWN;
+}
+
+uint8_t FleetDiscovery::parseCapabilities(const char* text) {
+  uint8_t caps = 0;
+  while (text && *text) {
+    const char* end = strchr(text, ',');
+    size_t len = end ? (size_t)(end - text) : strlen(text);
+    for (uint8_t i = 0; CAPABILITY_NAMES[i]; i++) {
+      if (strlen(CAPABILITY_NAMES[i]) == len && strncmp(CAPABILITY_NAMES[i], text, len) == 0) {
+        caps |= 1 << i;
+      }
+    }
+    text = end ? end + 1 : nullptr;
+  }
+  return caps;
+}
+
+FleetDiscovery::~FleetDiscovery() {
+  delete[] slots;
+}
+
+bool FleetDiscovery::begin() {
+  if (slots) return true;
+  slots = new (std::nothrow) Slot[AGVNET_DISCOVERY_MAX];
+  return slots != nullptr;
+}
+
+int FleetDiscovery::indexOf(const char* name, uint32_t hash) const {
+  for (int i = 0; i < AGVNET_DISCOVERY_MAX; i++) {
+    if (slots[i].hash == hash && slots[i].vehicle.name[0] && strcasecmp(slots[i].vehicle.name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool FleetDiscovery::ingest(const char* name, uint32_t ip, uint16_t port,
+                            const TxtItem* txt, size_t txtCount, uint32_t nowMs) {
+  if (!slots || !name || !*name) return false;
+
+  uint32_t hash = nameHash(name);
+  int index = indexOf(name, hash);
+  for (int i = 0; index < 0 && i < AGVNET_DISCOVERY_MAX; i++) {
+    if (!live(slots[i], nowMs)) index = i;   // Free or expired
+  }
+  if (index < 0) return false;
+
+  Slot& slot = slots[index];
+  Vehicle& v = slot.vehicle;
+  if (slot.hash != hash || strcasecmp(v.name, name) != 0) {
+    v = Vehicle();
+    slot.hash = hash;
+    copyText(v.name, sizeof(v.name), name);
+  }
+  if (ip) v.ip = ip;   // Answers without an address record keep the last one
+  v.wsPort = port;
+  v.seenAt = nowMs;
+
+  for (size_t i = 0; i < txtCount; i++) {
+    const char* key = txt[i].key;
+    const char* value = txt[i].value ? txt[i].value : "";
+    if (strcmp(key, "proto") == 0) v.protocol = (uint8_t)atoi(value);
+    else if (strcmp(key, "http") == 0) v.httpPort = (uint16_t)atoi(value);
+    else if (strcmp(key, "fw") == 0) copyText(v.firmware, sizeof(v.firmware), value);
+    else if (strcmp(key, "state") == 0) v.state = parseState(value);
+    else if (strcmp(key, "caps") == 0) v.capabilities = parseCapabilities(value);
+    else if (strcmp(key, "clients") == 0) v.clients = (uint8_t)atoi(value);
+    else if (strcmp(key, "cpu") == 0) v.cpuPercent = (uint8_t)atoi(value);
+  }
+  return true;
+}
+
+size_t FleetDiscovery::copy(Vehicle* out, size_t max, uint32_t nowMs) const {
+  size_t n = 0;
+  for (int i = 0; slots && i < AGVNET_DISCOVERY_MAX && n < max; i++) {
+    if (live(slots[i], nowMs)) out[n++] = slots[i].vehicle;
+  }
+  return n;
+}
+
+bool FleetDiscovery::find(const char* name, Vehicle& out, uint32_t nowMs) const {
+  if (!slots || !name) return false;
+  int index = indexOf(name, nameHash(name));
+  if (index < 0 || !live(slots[index], nowMs)) return false;
+  out = slots[index].vehicle;
+  return true;
+}
+
+size_t FleetDiscovery::size(uint32_t nowMs) const {
+  size_t n = 0;
+  for (int i = 0; slots && i < AGVNET_DISCOVERY_MAX; i++) {
+    if (live(slots[i], nowMs)) n++;
+  }
+  return n;
+}
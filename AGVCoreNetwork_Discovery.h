@@ -0,0 +1,95 @@
+#ifndef AGVCORENETWORK_DISCOVERY_H
+#define AGVCORENETWORK_DISCOVERY_H
+
+#include <Arduino.h>
+
+// Vehicles held by the discovery cache (allocated on first use)
+#ifndef AGVNET_DISCOVERY_MAX
+#define AGVNET_DISCOVERY_MAX 128
+#endif
+
+namespace AGVCoreNetworkLib {
+
+// DNS-SD service advertised by every vehicle: _agv._tcp on the WebSocket
+// port, with TXT records
+//   proto=1  ws=81  http=80  fw=<app version>
+//   state=idle|moving|estop  caps=path,time,lz,resume,lease,ota
+//   clients=<WebSocket clients>  cpu=<network task %, in steps of 10>
+// so fleet tools learn all of it from one query.
+static const uint8_t AGV_PROTOCOL_VERSION = 1;
+
+// Cache of vehicles found through _agv._tcp queries. Answers are merged as
+// they arrive and each entry expires ttlMs after it was last seen, so a
+// gateway can list the fleet without querying per lookup.
+//
+// The network task ingests; readers on other cores copy entries out. The
+// caller provides the locking (AGVCoreNetwork uses a spinlock).
+class FleetDiscovery {
+public:
+  enum Capability : uint8_t {
+    CAP_PATH = 0x01,        // Binary path streams
+    CAP_TIME = 0x02,        // TIME:SYNC and AT: commands
+    CAP_COMPRESS = 0x04,    // COMPRESS:ON log stream
+    CAP_RESUME = 0x08,      // RESUME:<id> catch-up
+    CAP_LEASE = 0x10,       // Motion lease
+    CAP_OTA = 0x20          // POST /ota
+  };
+
+  enum State : uint8_t { STATE_UNKNOWN, STATE_IDLE, STATE_MOVING, STATE_ESTOP };
+
+  struct Vehicle {
+    char name[32] = "";     // Service instance (the vehicle's mDNS name)
+    char firmware[24] = "";
+    uint32_t ip = 0;
+    uint16_t wsPort = 0;
+    uint16_t httpPort = 0;
+    uint8_t protocol = 0;
+    uint8_t capabilities = 0;
+    State state = STATE_UNKNOWN;
+    uint8_t clients = 0;
+    uint8_t cpuPercent = 0;
+    uint32_t seenAt = 0;    // Clock::ms() of the last answer
+  };
+
+  struct TxtItem {
+    const char* key;
+    const char* value;
+  };
+
+  static const char* const CAPABILITY_NAMES[];
+  static const char* stateName(State state);
+  static State parseState(const char* text);
+  static uint8_t parseCapabilities(const char* text);
+
+  ~FleetDiscovery();
+
+  bool begin();             // false if the cache cannot be allocated
+  void setTtl(uint32_t ms) { ttlMs = ms; }
+
+  // Merges one answer; false if the cache is full of live entries
+  bool ingest(const char* name, uint32_t ip, uint16_t port,
+              const TxtItem* txt, size_t txtCount, uint32_t nowMs);
+
+  // Copies live entries (up to max); returns how many were copied
+  size_t copy(Vehicle* out, size_t max, uint32_t nowMs) const;
+  bool find(const char* name, Vehicle& out, uint32_t nowMs) const;
+  size_t size(uint32_t nowMs) const;
+
+private:
+  struct Slot {
+    uint32_t hash = 0;
+    Vehicle vehicle;
+  };
+
+  Slot* slots = nullptr;
+  uint32_t ttlMs = 120000;  // mDNS host record TTL
+
+  bool live(const Slot& slot, uint32_t nowMs) const {
+    return slot.vehicle.name[0] && nowMs - slot.vehicle.seenAt < ttlMs;
+  }
+  int indexOf(const char* name, uint32_t hash) const;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,147 @@
+#include "AGVCoreNetwork_Dns.h"
+#include <lwip/sockets.h>
+
+using namespace AGVCoreNetworkLib;
+
+static const uint16_t TYPE_A = 1;
+static const uint16_t TYPE_ANY = 255;
+
+void CaptiveDns::setRateLimit(uint16_t perSecond, uint16_t burst) {
+  ratePerSecond = perSecond;
+  rateBurst = burst > 0 ? burst : 1;
+}
+
+bool CaptiveDns::start(uint16_t port, uint32_t address) {
+  stop();
+
+  // Answer record: pointer to the question name, type A, class IN, TTL, address
+  const uint8_t head[] = { 0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01 };
+  memcpy(answer, head, sizeof(head));
+  answer[6] = ttl >> 24;
+  answer[7] = ttl >> 16;
+  answer[8] = ttl >> 8;
+  answer[9] = ttl;
+  answer[10] = 0x00;
+  answer[11] = 0x04;
+  memcpy(answer + 12, &address, 4);   // Already in network order
+
+  sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0) return false;
+
+  struct sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(port);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  if (bind(sock, (struct sockaddr*)&local, sizeof(local)) < 0) {
+    stop();
+    return false;
+  }
+
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+  return true;
+}
+
+void CaptiveDns::stop() {
+  if (sock >= 0) {
+    close(sock);
+    sock = -1;
+  }
+}
+
+void CaptiveDns::poll() {
+  if (sock < 0) return;
+
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < MAX_PER_POLL; i++) {
+    struct sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    int received = recvfrom(sock, packet, sizeof(packet), 0, (struct sockaddr*)&from, &fromLength);
+    if (received <= 0) return;   // Drained
+
+    stats.queries++;
+    if (!allow(from.sin_addr.s_addr, now)) {
+      stats.limited++;
+      continue;
+    }
+
+    size_t replyLength = buildReply((size_t)received);
+    if (replyLength == 0) {
+      stats.malformed++;
+      continue;
+    }
+
+    sendto(sock, packet, replyLength, 0, (struct sockaddr*)&from, fromLength);
+  }
+}
+
+// Token bucket per client address; the least recently seen entry is reused
+bool CaptiveDns::allow(uint32_t ip, uint32_t now) {
+  if (ratePerSecond == 0) return true;
+
+  Bucket* bucket = nullptr;
+  Bucket* oldest = &buckets[0];
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    if (buckets[i].ip == ip) {
+      bucket = &buckets[i];
+      break;
+    }
+    if ((int32_t)(buckets[i].lastSeen - oldest->lastSeen) < 0) oldest = &buckets[i];
+  }
+
+  if (!bucket) {
+    bucket = oldest;
+    bucket->ip = ip;
+    bucket->tokens = rateBurst;
+    bucket->refilledAt = now;
+  }
+  bucket->lastSeen = now;
+
+  uint32_t refill = (now - bucket->refilledAt) * ratePerSecond / 1000;
+  if (refill > 0) {
+    uint32_t tokens = bucket->tokens + refill;
+    bucket->tokens = tokens > rateBurst ? rateBurst : tokens;
+    bucket->refilledAt = now;
+  }
+
+  if (bucket->tokens == 0) return false;
+  bucket->tokens--;
+  return true;
+}
+
+// Turns the query in 'packet' into its reply in place; 0 if it is not a
+// single-question standard query
+size_t CaptiveDns::buildReply(size_t length) {
+  if (length < 12) return 0;
+  if (packet[2] & 0x80) return 0;                     // Already a response
+  if ((packet[2] >> 3) & 0x0F) return 0;              // Opcode other than QUERY
+  if (packet[4] != 0 || packet[5] != 1) return 0;     // Exactly one question
+
+  size_t pos = 12;
+  while (pos < length && packet[pos] != 0) {
+    if (packet[pos] & 0xC0) return 0;                 // No compression in questions
+    pos += packet[pos] + 1;
+  }
+  pos++;                                              // Root label
+  if (pos + 4 > length) return 0;
+
+  uint16_t qtype = (packet[pos] << 8) | packet[pos + 1];
+  pos += 4;                                           // QTYPE, QCLASS; drop any EDNS record
+
+  bool answerA = (qtype == TYPE_A || qtype == TYPE_ANY) && pos + sizeof(answer) <= sizeof(packet);
+
+  packet[2] = 0x84 | (packet[2] & 0x01);              // QR, AA, keep RD
+  packet[3] = 0x00;                                   // NOERROR
+  packet[6] = 0;
+  packet[7] = answerA ? 1 : 0;
+  memset(packet + 8, 0, 4);                           // NSCOUNT, ARCOUNT
+
+  if (!answerA) {
+    stats.empty++;
+    return pos;
+  }
+
+  memcpy(packet + pos, answer, sizeof(answer));
+  stats.answered++;
+  return pos + sizeof(answer);
+}
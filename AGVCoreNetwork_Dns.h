@@ -0,0 +1,62 @@
+#ifndef AGVCORENETWORK_DNS_H
+#define AGVCORENETWORK_DNS_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// Wildcard DNS responder for the setup access point. Every A (or ANY) query
+// is answered with the portal address; other types get an empty NOERROR
+// reply so clients do not wait for a timeout. Replies are built in the
+// receive buffer from a precomputed answer record, several queries are
+// drained per poll(), and each client is rate limited by a token bucket.
+class CaptiveDns {
+public:
+  struct Stats {
+    uint32_t queries = 0;
+    uint32_t answered = 0;
+    uint32_t empty = 0;          // Non-A queries answered without records
+    uint32_t limited = 0;        // Dropped by the per-client rate limit
+    uint32_t malformed = 0;
+  };
+
+  static const uint8_t MAX_PER_POLL = 16;
+  static const uint8_t MAX_CLIENTS = 8;
+  static const size_t PACKET_SIZE = 512;
+
+  // Per-client limit: sustained queries per second and burst size
+  void setRateLimit(uint16_t perSecond, uint16_t burst);
+  void setTtl(uint32_t seconds) { ttl = seconds; }
+
+  bool start(uint16_t port, uint32_t address);
+  void stop();
+
+  // Answers up to MAX_PER_POLL pending queries without blocking
+  void poll();
+
+  const Stats& getStats() const { return stats; }
+
+private:
+  struct Bucket {
+    uint32_t ip = 0;
+    uint32_t lastSeen = 0;
+    uint32_t refilledAt = 0;
+    uint16_t tokens = 0;
+  };
+
+  int sock = -1;
+  uint32_t ttl = 60;
+  uint16_t ratePerSecond = 20;
+  uint16_t rateBurst = 40;
+  uint8_t answer[16];            // Name pointer, A, IN, TTL, address
+  uint8_t packet[PACKET_SIZE];
+  Bucket buckets[MAX_CLIENTS];
+  Stats stats;
+
+  bool allow(uint32_t ip, uint32_t now);
+  size_t buildReply(size_t length);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
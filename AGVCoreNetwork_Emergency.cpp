@@ -0,0 +1,66 @@
+#include "AGVCoreNetwork_Emergency.h"
+
+using namespace AGVCoreNetworkLib;
+
+bool EmergencyState::trigger(Reason reason, Source source) {
+  uint32_t current = word.load(std::memory_order_acquire);
+
+  while (true) {
+    bool transition = !(current & ACTIVE_BIT);
+    uint32_t next;
+
+    if (transition) {
+      uint32_t epoch = ((current >> EPOCH_SHIFT) + 1) & EPOCH_MASK;
+      next = ACTIVE_BIT |
+             (((uint32_t)source & SOURCE_MASK) << SOURCE_SHIFT) |
+             (((uint32_t)reason & REASON_MASK) << REASON_SHIFT) |
+             (epoch << EPOCH_SHIFT);
+    } else {
+      next = current | (((uint32_t)reason & REASON_MASK) << REASON_SHIFT);
+      if (next == current) return false;  // Reason already latched
+    }
+
+    // The time is published before the state, so a reader that sees the
+    // latch set also sees when it was set
+    if (transition) stampTrigger(millis());
+
+    if (word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return transition;
+    }
+  }
+}
+
+// Only moves the stamp forward, so a racing trigger that read the clock
+// earlier cannot leave an older time behind
+void EmergencyState::stampTrigger(uint32_t nowMs) {
+  uint32_t stamp = triggeredAtMs.load(std::memory_order_relaxed);
+  while ((int32_t)(nowMs - stamp) > 0 &&
+         !triggeredAtMs.compare_exchange_weak(stamp, nowMs, std::memory_order_relaxed)) {
+  }
+}
+
+bool EmergencyState::clear() {
+  uint32_t current = word.load(std::memory_order_acquire);
+
+  while (current & ACTIVE_BIT) {
+    uint32_t epoch = ((current >> EPOCH_SHIFT) + 1) & EPOCH_MASK;
+    uint32_t next = epoch << EPOCH_SHIFT;
+
+    if (word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+EmergencyState::Snapshot EmergencyState::snapshot() const {
+  uint32_t w = word.load(std::memory_order_acquire);
+
+  Snapshot s;
+  s.active = w & ACTIVE_BIT;
+  s.source = (Source)((w >> SOURCE_SHIFT) & SOURCE_MASK);
+  s.reasons = (w >> REASON_SHIFT) & REASON_MASK;
+  s.epoch = (w >> EPOCH_SHIFT) & EPOCH_MASK;
+  s.triggeredAtMs = triggeredAtMs.load(std::memory_order_relaxed);
+  return s;
+}
@@ -0,0 +1,72 @@
+#ifndef AGVCORENETWORK_EMERGENCY_H
+#define AGVCORENETWORK_EMERGENCY_H
+
+#include <Arduino.h>
+#include <atomic>
+
+namespace AGVCoreNetworkLib {
+
+// Lock-free emergency state machine shared by both cores.
+// The whole state lives in one 32-bit atomic word:
+//   bit 0      active
+//   bits 1-3   source of the triggering event
+//   bits 4-11  latched reason mask (every reason seen since the last clear)
+//   bits 12-31 epoch, incremented on every transition (odd = active)
+class EmergencyState {
+public:
+  enum Reason : uint8_t {
+    REASON_NONE = 0x00,
+    REASON_OPERATOR_STOP = 0x01,   // STOP from an operator interface
+    REASON_ABORT = 0x02,           // ABORT from an operator interface
+    REASON_APPLICATION = 0x04,     // broadcastEmergency() from the application
+    REASON_TRANSPORT = 0x08        // Remote emergency via a plant transport
+  };
+
+  enum Source : uint8_t {
+    SOURCE_NONE = 0,
+    SOURCE_SERIAL,
+    SOURCE_WEBSOCKET,
+    SOURCE_HTTP,
+    SOURCE_APPLICATION,
+    SOURCE_TRANSPORT
+  };
+
+  struct Snapshot {
+    bool active;
+    uint8_t reasons;
+    Source source;
+    uint32_t epoch;
+    uint32_t triggeredAtMs;       // millis() of the last NORMAL -> ACTIVE transition (a
+                                  // trigger racing it may move this to its own, later time)
+  };
+
+  // Command-path check: a single atomic load
+  bool isActive() const { return word.load(std::memory_order_acquire) & ACTIVE_BIT; }
+
+  // Returns true if this call moved the system from NORMAL to ACTIVE.
+  // While active, further reasons are latched; the first source is kept.
+  bool trigger(Reason reason, Source source);
+
+  // Returns true if this call moved the system from ACTIVE to NORMAL
+  bool clear();
+
+  Snapshot snapshot() const;
+
+private:
+  static const uint32_t ACTIVE_BIT = 0x1;
+  static const uint32_t SOURCE_SHIFT = 1;
+  static const uint32_t SOURCE_MASK = 0x7;
+  static const uint32_t REASON_SHIFT = 4;
+  static const uint32_t REASON_MASK = 0xFF;
+  static const uint32_t EPOCH_SHIFT = 12;
+  static const uint32_t EPOCH_MASK = 0xFFFFF;
+
+  std::atomic<uint32_t> word{0};
+  std::atomic<uint32_t> triggeredAtMs{0};
+
+  void stampTrigger(uint32_t nowMs);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,229 @@
+#include "AGVCoreNetwork_Filter.h"
+#include <strings.h>
+
+using namespace AGVCoreNetworkLib;
+
+// Control words of the WebSocket protocol, in any case; never forwarded as
+// commands. The second list is reserved only in the colon form (LEASE:...).
+static const char* const RESERVED_VERBS[] = {
+  "STATUS_REQUEST", "PING", "SUBSCRIBE", "UNSUBSCRIBE", nullptr
+};
+static const char* const RESERVED_PREFIXES[] = {
+  "COMPRESS", "RESUME", "LEASE", "TIME", "AT", nullptr
+};
+
+static const char* const REASONS[CommandFilter::CMD_VERDICT_COUNT] = {
+  "ok", "empty", "too long", "bad character", "reserved", "unknown verb",
+  "bad arguments", "rate limited", "not while moving"
+};
+
+static inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool parseInt(const char* text, size_t length, int32_t& value) {
+  size_t i = 0;
+  bool negative = false;
+  if (length > 0 && (text[0] == '-' || text[0] == '+')) {
+    negative = text[0] == '-';
+    i++;
+  }
+  if (i == length || length - i > 9) return false;   // Fits int32 without overflow checks
+
+  int32_t v = 0;
+  for (; i < length; i++) {
+    if (text[i] < '0' || text[i] > '9') return false;
+    v = v * 10 + (text[i] - '0');
+  }
+  value = negative ? -v : v;
+  return true;
+}
+
+const char* CommandFilter::reason(Verdict verdict) {
+  return verdict < CMD_VERDICT_COUNT ? REASONS[verdict] : "invalid";
+}
+
+void CommandFilter::clearRules() {
+  ruleCount = 0;
+  wordPoolUsed = 0;
+}
+
+bool CommandFilter::compileArg(const char* spec, size_t length, Arg& arg) {
+  arg = Arg();
+
+  if (length == 4 && strncmp(spec, "text", 4) == 0) {
+    arg.type = ARG_TEXT;
+    return true;
+  }
+
+  if (length > 4 && strncmp(spec, "int:", 4) == 0) {
+    const char* minText = spec + 4;
+    const char* colon = (const char*)memchr(minText, ':', length - 4);
+    if (!colon) return false;
+    arg.type = ARG_INT;
+    return parseInt(minText, colon - minText, arg.min) &&
+           parseInt(colon + 1, spec + length - colon - 1, arg.max) && arg.min <= arg.max;
+  }
+
+  if (length > 5 && strncmp(spec, "word:", 5) == 0) {
+    arg.type = ARG_WORD;
+    arg.words = wordPoolUsed;
+    size_t need = length - 5 + 1;
+    if (wordPoolUsed + need > WORD_POOL) return false;
+
+    // Choices are stored NUL-separated
+    size_t choiceStart = wordPoolUsed;
+    for (size_t i = 5; i <= length; i++) {
+      char c = i < length ? spec[i] : '|';
+      if (c != '|') {
+        wordPool[wordPoolUsed++] = c;
+        continue;
+      }
+      if (wordPoolUsed == choiceStart) return false;   // Empty choice
+      wordPool[wordPoolUsed++] = '\0';
+      choiceStart = wordPoolUsed;
+      arg.wordCount++;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+bool CommandFilter::addRule(const char* verb, const char* args, uint16_t minIntervalMs, uint8_t flags) {
+  size_t verbLength = verb ? strlen(verb) : 0;
+  if (ruleCount >= MAX_RULES || verbLength == 0 || verbLength > MAX_VERB) return false;
+
+  Rule& rule = rules[ruleCount];
+  memset(&rule, 0, sizeof(rule));
+  memcpy(rule.verb, verb, verbLength + 1);
+  rule.flags = flags;
+  rule.minIntervalMs = minIntervalMs;
+  rule.requiredArgs = 0xFF;
+
+  uint16_t poolMark = wordPoolUsed;
+  const char* p = args ? args : "";
+  while (*p) {
+    while (isSpace(*p)) p++;
+    if (!*p) break;
+    const char* end = p;
+    while (*end && !isSpace(*end)) end++;
+
+    size_t length = end - p;
+    bool optional = p[length - 1] == '?';
+    if (optional) length--;
+    if (rule.argCount >= MAX_ARGS || !compileArg(p, length, rule.args[rule.argCount])) {
+      wordPoolUsed = poolMark;
+      return false;
+    }
+    if (optional && rule.requiredArgs == 0xFF) rule.requiredArgs = rule.argCount;
+    rule.argCount++;
+    p = end;
+  }
+  if (rule.requiredArgs == 0xFF) rule.requiredArgs = rule.argCount;
+
+  ruleCount++;
+  return true;
+}
+
+bool CommandFilter::matchArg(const Arg& arg, const Token& token) const {
+  switch (arg.type) {
+    case ARG_INT: {
+      int32_t value;
+      return parseInt(token.text, token.length, value) && value >= arg.min && value <= arg.max;
+    }
+    case ARG_WORD: {
+      const char* word = wordPool + arg.words;
+      for (uint8_t i = 0; i < arg.wordCount; i++) {
+        size_t length = strlen(word);
+        if (length == token.length && strncasecmp(word, token.text, length) == 0) return true;
+        word += length + 1;
+      }
+      return false;
+    }
+    default:
+      return true;
+  }
+}
+
+CommandFilter::Verdict CommandFilter::parse(const char* cmd, size_t length, const Rule*& rule) const {
+  rule = nullptr;
+  if (!cmd) return CMD_EMPTY;
+  if (length > maxLength) return CMD_TOO_LONG;
+
+  // One pass: vet characters and split tokens. A ':' right after the verb
+  // selects the colon form, where ':' also separates the arguments
+  Token tokens[MAX_ARGS + 1];
+  uint8_t tokenCount = 0;
+  bool extra = false;
+  bool inToken = false;
+  bool colonForm = false;
+  for (size_t i = 0; i < length; i++) {
+    char c = cmd[i];
+    if (c == ':' && !colonForm && inToken && tokenCount == 1) colonForm = true;
+    if (isSpace(c) || (c == ':' && colonForm)) {
+      inToken = false;
+      continue;
+    }
+    if ((uint8_t)c < 0x20 || (uint8_t)c > 0x7E) return CMD_BAD_CHARACTER;
+
+    if (inToken) {
+      if (!extra) tokens[tokenCount - 1].length++;
+    } else if (tokenCount <= MAX_ARGS) {
+      tokens[tokenCount++] = {cmd + i, 1};
+    } else {
+      extra = true;
+    }
+    inToken = true;
+  }
+  if (tokenCount == 0) return CMD_EMPTY;
+
+  const Token& verb = tokens[0];
+  for (uint8_t r = 0; RESERVED_VERBS[r]; r++) {
+    if (strlen(RESERVED_VERBS[r]) == verb.length && strncasecmp(RESERVED_VERBS[r], verb.text, verb.length) == 0) {
+      return CMD_RESERVED;
+    }
+  }
+  for (uint8_t r = 0; colonForm && RESERVED_PREFIXES[r]; r++) {
+    if (strlen(RESERVED_PREFIXES[r]) == verb.length &&
+        strncasecmp(RESERVED_PREFIXES[r], verb.text, verb.length) == 0) {
+      return CMD_RESERVED;
+    }
+  }
+
+  for (uint8_t r = 0; r < ruleCount && !rule; r++) {
+    const Rule& candidate = rules[r];
+    if (strlen(candidate.verb) == verb.length && strncasecmp(candidate.verb, verb.text, verb.length) == 0) {
+      rule = &candidate;
+    }
+  }
+  if (!rule) return allowUnknown ? CMD_OK : CMD_UNKNOWN_VERB;
+
+  uint8_t argCount = tokenCount - 1;
+  if (extra || argCount < rule->requiredArgs || argCount > rule->argCount) return CMD_BAD_ARGUMENTS;
+  for (uint8_t a = 0; a < argCount; a++) {
+    if (!matchArg(rule->args[a], tokens[a + 1])) return CMD_BAD_ARGUMENTS;
+  }
+  return CMD_OK;
+}
+
+CommandFilter::Verdict CommandFilter::checkSyntax(const char* cmd, size_t length) const {
+  const Rule* rule;
+  return parse(cmd, length, rule);
+}
+
+CommandFilter::Verdict CommandFilter::check(const char* cmd, size_t length, uint32_t nowMs, bool moving) {
+  const Rule* found;
+  Verdict verdict = parse(cmd, length, found);
+  if (verdict != CMD_OK || !found) return record(verdict);
+
+  Rule& rule = rules[found - rules];
+  if ((rule.flags & RULE_NOT_WHILE_MOVING) && moving) return record(CMD_NOT_WHILE_MOVING);
+  if (rule.minIntervalMs && rule.accepted && nowMs - rule.lastAccepted < rule.minIntervalMs) {
+    return record(CMD_RATE_LIMITED);
+  }
+
+  rule.accepted = true;
+  rule.lastAccepted = nowMs;
+  return record(CMD_OK);
+}
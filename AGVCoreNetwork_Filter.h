@@ -0,0 +1,116 @@
+#ifndef AGVCORENETWORK_FILTER_H
+#define AGVCORENETWORK_FILTER_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// Validation stage between the transports and the command callback, run on
+// the network task. Every command gets the structural checks (non-empty,
+// within the length limit, printable ASCII, not a library control word);
+// verbs with a rule are also checked for arguments, rate and motion state.
+// Rules are compiled when added, so checking never allocates or parses
+// patterns. Configure before begin().
+//
+// Commands are split on whitespace. A ':' directly after the verb selects
+// the colon form, where ':' separates arguments as well, so a "path" rule
+// also matches "PATH:1,1,3,2:ONCE" and "MOVE:" is the verb "MOVE" alone.
+// Verbs match case-insensitively, including the reserved control words.
+//
+// Argument patterns, space separated, one per argument:
+//   int:<min>:<max>     decimal integer in range
+//   word:<a>|<b>|...    one of the words (case-insensitive)
+//   text                any single token
+// A trailing '?' makes that argument and all after it optional. E.g.
+//   addRule("turn_left", "int:1:360", 200);
+//   addRule("move", "word:forward|backward int:1:5000?");
+//   addRule("calibrate", "", 0, CommandFilter::RULE_NOT_WHILE_MOVING);
+class CommandFilter {
+public:
+  static const size_t MAX_COMMAND = 64;      // Default length limit
+  static const uint8_t MAX_RULES = 24;
+  static const uint8_t MAX_ARGS = 4;
+  static const uint8_t MAX_VERB = 20;
+  static const size_t WORD_POOL = 256;      // Bytes for all word: choices
+
+  enum Verdict : uint8_t {
+    CMD_OK = 0,
+    CMD_EMPTY,
+    CMD_TOO_LONG,
+    CMD_BAD_CHARACTER,
+    CMD_RESERVED,             // Control message sent as a command
+    CMD_UNKNOWN_VERB,         // Only with setAllowUnknownVerbs(false)
+    CMD_BAD_ARGUMENTS,
+    CMD_RATE_LIMITED,         // Sooner than the verb's minimum interval
+    CMD_NOT_WHILE_MOVING,
+    CMD_VERDICT_COUNT
+  };
+
+  enum RuleFlags : uint8_t {
+    RULE_NOT_WHILE_MOVING = 0x01
+  };
+
+  // False if the table or word pool is full or the pattern does not parse
+  bool addRule(const char* verb, const char* args = "", uint16_t minIntervalMs = 0, uint8_t flags = 0);
+  void clearRules();
+
+  // Verbs without a rule pass after the structural checks (default true)
+  void setAllowUnknownVerbs(bool allow) { allowUnknown = allow; }
+
+  // Longest command accepted (default MAX_COMMAND)
+  void setMaxLength(size_t length) { maxLength = length; }
+  size_t getMaxLength() const { return maxLength; }
+
+  // Full check; an accepted command starts its verb's rate interval
+  Verdict check(const char* cmd, size_t length, uint32_t nowMs, bool moving);
+
+  // Structural and argument checks only (for commands queued to run later)
+  Verdict checkSyntax(const char* cmd, size_t length) const;
+
+  static const char* reason(Verdict verdict);
+  uint32_t count(Verdict verdict) const { return verdict < CMD_VERDICT_COUNT ? counts[verdict] : 0; }
+
+private:
+  enum ArgType : uint8_t { ARG_INT, ARG_WORD, ARG_TEXT };
+
+  struct Arg {
+    ArgType type;
+    int32_t min;
+    int32_t max;
+    uint16_t words;           // Word pool offset of the choices
+    uint8_t wordCount;
+  };
+
+  struct Rule {
+    char verb[MAX_VERB + 1];
+    uint8_t argCount;
+    uint8_t requiredArgs;
+    uint8_t flags;
+    uint16_t minIntervalMs;
+    bool accepted;            // lastAccepted is valid
+    uint32_t lastAccepted;
+    Arg args[MAX_ARGS];
+  };
+
+  struct Token {
+    const char* text;
+    uint16_t length;
+  };
+
+  Rule rules[MAX_RULES];
+  uint8_t ruleCount = 0;
+  char wordPool[WORD_POOL];
+  uint16_t wordPoolUsed = 0;
+  bool allowUnknown = true;
+  size_t maxLength = MAX_COMMAND;
+  uint32_t counts[CMD_VERDICT_COUNT] = {};
+
+  Verdict parse(const char* cmd, size_t length, const Rule*& rule) const;
+  bool matchArg(const Arg& arg, const Token& token) const;
+  bool compileArg(const char* spec, size_t length, Arg& arg);
+  Verdict record(Verdict verdict) { counts[verdict]++; return verdict; }
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,88 @@
+#include "AGVCoreNetwork_Guard.h"
+
+using namespace AGVCoreNetworkLib;
+
+void RequestGuard::setRateLimit(uint16_t perSecond, uint16_t burst) {
+  ratePerSecond = perSecond;
+  rateBurst = burst > 0 ? burst : 1;
+}
+
+RequestGuard::Client& RequestGuard::lookup(uint32_t ip, uint32_t nowMs) {
+  Client* victim = nullptr;
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    Client& c = clients[i];
+    if (c.ip == ip) {
+      c.lastSeen = nowMs;
+      return c;
+    }
+
+    // Evict the stalest address, keeping lockouts while there is a choice
+    if (!victim ||
+        (lockedOut(*victim, nowMs) && !lockedOut(c, nowMs)) ||
+        (lockedOut(*victim, nowMs) == lockedOut(c, nowMs) &&
+         (int32_t)(c.lastSeen - victim->lastSeen) < 0)) {
+      victim = &c;
+    }
+  }
+
+  *victim = Client();
+  victim->ip = ip;
+  victim->lastSeen = nowMs;
+  victim->refilledAt = nowMs;
+  victim->tokens = rateBurst;
+  return *victim;
+}
+
+RequestGuard::Verdict RequestGuard::admit(uint32_t ip, uint32_t nowMs) {
+  if (ratePerSecond == 0) {
+    stats.admitted++;
+    return ADMIT;
+  }
+
+  Client& c = lookup(ip, nowMs);
+
+  uint32_t refill = (uint32_t)((uint64_t)(nowMs - c.refilledAt) * ratePerSecond / 1000);
+  if (refill > 0) {
+    c.tokens = (uint32_t)c.tokens + refill >= rateBurst ? rateBurst : c.tokens + refill;
+    c.refilledAt += refill * 1000 / ratePerSecond;
+  }
+
+  if (c.tokens == 0) {
+    stats.limited++;
+    bool first = !c.limited;
+    c.limited = true;
+    return first ? LIMITED_FIRST : LIMITED;
+  }
+
+  c.tokens--;
+  c.limited = false;
+  stats.admitted++;
+  return ADMIT;
+}
+
+uint32_t RequestGuard::loginLockedFor(uint32_t ip, uint32_t nowMs) {
+  Client& c = lookup(ip, nowMs);
+  return lockedOut(c, nowMs) ? c.lockedUntil - nowMs : 0;
+}
+
+void RequestGuard::loginFailed(uint32_t ip, uint32_t nowMs) {
+  Client& c = lookup(ip, nowMs);
+  stats.loginFailures++;
+  if (c.loginFailures < 255) c.loginFailures++;
+  if (c.loginFailures <= FREE_LOGIN_FAILURES) return;
+
+  uint8_t doublings = c.loginFailures - FREE_LOGIN_FAILURES - 1;
+  uint32_t lockout = doublings >= 9 ? LOCKOUT_MAX_MS : LOCKOUT_BASE_MS << doublings;
+  if (lockout > LOCKOUT_MAX_MS) lockout = LOCKOUT_MAX_MS;
+  c.lockedUntil = nowMs + lockout;
+  stats.lockouts++;
+}
+
+void RequestGuard::loginSucceeded(uint32_t ip) {
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    if (clients[i].ip == ip) {
+      clients[i].loginFailures = 0;
+      clients[i].lockedUntil = 0;
+    }
+  }
+}
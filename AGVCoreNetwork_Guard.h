@@ -0,0 +1,69 @@
+#ifndef AGVCORENETWORK_GUARD_H
+#define AGVCORENETWORK_GUARD_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// Admission control per remote IPv4 address, shared by the web server and
+// the WebSocket server: a token bucket for requests/messages and an
+// exponential lockout after repeated failed logins. The table is small and
+// fixed; the least recently seen address is evicted, preferring addresses
+// that are not locked out. Used from the network task only.
+class RequestGuard {
+public:
+  enum Verdict : uint8_t {
+    ADMIT,
+    LIMITED,              // Over the rate; already reported for this burst
+    LIMITED_FIRST         // First refusal since the address was last admitted
+  };
+
+  struct Stats {
+    uint32_t admitted = 0;
+    uint32_t limited = 0;
+    uint32_t loginFailures = 0;
+    uint32_t lockouts = 0;
+  };
+
+  static const uint8_t MAX_CLIENTS = 16;
+  static const uint8_t FREE_LOGIN_FAILURES = 3;   // Before the first lockout
+  static const uint32_t LOCKOUT_BASE_MS = 1000;   // Doubles per further failure
+  static const uint32_t LOCKOUT_MAX_MS = 300000;
+
+  // Sustained requests per second and burst; 0 disables rate limiting
+  void setRateLimit(uint16_t perSecond, uint16_t burst);
+
+  Verdict admit(uint32_t ip, uint32_t nowMs);
+
+  // Remaining lockout in ms (0 = login allowed)
+  uint32_t loginLockedFor(uint32_t ip, uint32_t nowMs);
+  void loginFailed(uint32_t ip, uint32_t nowMs);
+  void loginSucceeded(uint32_t ip);
+
+  const Stats& getStats() const { return stats; }
+
+private:
+  struct Client {
+    uint32_t ip = 0;
+    uint32_t lastSeen = 0;
+    uint32_t refilledAt = 0;
+    uint32_t lockedUntil = 0;
+    uint16_t tokens = 0;
+    uint8_t loginFailures = 0;
+    bool limited = false;
+  };
+
+  uint16_t ratePerSecond = 20;
+  uint16_t rateBurst = 40;
+  Client clients[MAX_CLIENTS];
+  Stats stats;
+
+  Client& lookup(uint32_t ip, uint32_t nowMs);
+  static bool lockedOut(const Client& c, uint32_t nowMs) {
+    return c.loginFailures > FREE_LOGIN_FAILURES && (int32_t)(c.lockedUntil - nowMs) > 0;
+  }
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,80 @@
+#include "AGVCoreNetwork_History.h"
+
+using namespace AGVCoreNetworkLib;
+
+static_assert(AGVNET_HISTORY_BYTES >= EventHistory::MAX_EVENT, "History arena must hold one event");
+static_assert((AGVNET_HISTORY_EVENTS & (AGVNET_HISTORY_EVENTS - 1)) == 0,
+              "History events must be a power of two so slots stay consecutive when ids wrap");
+
+void EventHistory::reset(uint32_t firstId) {
+  if (firstId == 0) firstId = 1;   // 0 is the "new client" cursor
+  head = 0;
+  next = firstId;
+  oldest = firstId;
+}
+
+uint32_t EventHistory::append(const void* data, size_t length) {
+  // 0 is the "new client" cursor: when the ids wrap, it becomes an empty
+  // event that resume() never reports
+  if (next == 0) store(nullptr, 0);
+  return store(data, length);
+}
+
+uint32_t EventHistory::store(const void* data, size_t length) {
+  if (length > MAX_EVENT) length = MAX_EVENT;
+
+  // Keep the text contiguous
+  uint32_t offset = head % AGVNET_HISTORY_BYTES;
+  if (offset + length > AGVNET_HISTORY_BYTES) head += AGVNET_HISTORY_BYTES - offset;
+  uint32_t start = head;
+  head += length;
+
+  // Drop events whose index slot or text is about to be reused
+  uint32_t id = next++;
+  while (oldest != next) {
+    const Entry& e = index[oldest % AGVNET_HISTORY_EVENTS];
+    bool slotReused = next - oldest > AGVNET_HISTORY_EVENTS;
+    bool textOverwritten = oldest != id && head - e.start > AGVNET_HISTORY_BYTES;
+    if (!slotReused && !textOverwritten) break;
+    oldest++;
+  }
+
+  Entry& e = index[id % AGVNET_HISTORY_EVENTS];
+  e.start = start;
+  e.length = (uint16_t)length;
+  if (length) memcpy(arena + start % AGVNET_HISTORY_BYTES, data, length);
+  return id;
+}
+
+bool EventHistory::firstAfter(uint32_t afterId, uint32_t& first) const {
+  if (afterId == 0) {
+    first = oldest;
+    return true;
+  }
+
+  // afterId must lie in [oldest - 1, next - 1] (modulo 2^32)
+  if (afterId - (oldest - 1) > next - oldest) return false;
+  first = afterId + 1;
+  return true;
+}
+
+EventHistory::Resume EventHistory::resume(uint32_t afterId, const Visitor& visitor) const {
+  uint32_t id;
+  if (!firstAfter(afterId, id)) return RESUME_GAP;
+
+  for (; id != next; id++) {
+    if (id == 0) continue;
+    const Entry& e = index[id % AGVNET_HISTORY_EVENTS];
+    visitor(id, arena + e.start % AGVNET_HISTORY_BYTES, e.length);
+  }
+  return RESUME_OK;
+}
+
+size_t EventHistory::pendingBytes(uint32_t afterId) const {
+  uint32_t id;
+  if (!firstAfter(afterId, id)) return 0;
+
+  size_t total = 0;
+  for (; id != next; id++) total += index[id % AGVNET_HISTORY_EVENTS].length;
+  return total;
+}
@@ -0,0 +1,71 @@
+#ifndef AGVCORENETWORK_HISTORY_H
+#define AGVCORENETWORK_HISTORY_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Events indexed and bytes of event text kept for reconnect catch-up
+#ifndef AGVNET_HISTORY_EVENTS
+#define AGVNET_HISTORY_EVENTS 64
+#endif
+
+#ifndef AGVNET_HISTORY_BYTES
+#define AGVNET_HISTORY_BYTES 4096
+#endif
+
+namespace AGVCoreNetworkLib {
+
+// Bounded history of the WebSocket log stream (status and emergency
+// broadcasts) with consecutive event ids. An event stays available until
+// either the id index or the text arena wraps over it. Text is stored
+// contiguously, skipping the arena tail when an event would not fit.
+//
+// Not synchronized: AGVCoreNetwork appends and reads under its stream lock,
+// which also orders the broadcasts, so ids match delivery order.
+class EventHistory {
+public:
+  static const size_t MAX_EVENT = 256;          // Longer events are truncated
+
+  typedef std::function<void(uint32_t id, const char* text, size_t length)> Visitor;
+
+  enum Resume : uint8_t {
+    RESUME_OK,            // Missed events (possibly none) were visited
+    RESUME_GAP            // Cursor too old or unknown (e.g. before a reboot)
+  };
+
+  // Ids continue from firstId; a random base per boot makes stale cursors
+  // from a previous boot show up as gaps
+  void reset(uint32_t firstId);
+
+  uint32_t append(const void* data, size_t length);
+
+  uint32_t lastId() const { return next - 1; }
+  uint32_t oldestId() const { return oldest; }
+  uint32_t size() const { return next - oldest; }
+
+  // Visits every event after afterId, oldest first. afterId 0 means a new
+  // client: everything still held is visited.
+  Resume resume(uint32_t afterId, const Visitor& visitor) const;
+
+  // Bytes resume() would visit (text only), for sizing a batch
+  size_t pendingBytes(uint32_t afterId) const;
+
+private:
+  struct Entry {
+    uint32_t start;       // Arena offset (monotonic, wraps with the arena)
+    uint16_t length;
+  };
+
+  Entry index[AGVNET_HISTORY_EVENTS];
+  char arena[AGVNET_HISTORY_BYTES];
+  uint32_t head = 0;      // Total arena bytes consumed
+  uint32_t next = 1;
+  uint32_t oldest = 1;
+
+  uint32_t store(const void* data, size_t length);
+  bool firstAfter(uint32_t afterId, uint32_t& first) const;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
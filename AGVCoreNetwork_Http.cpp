@@ -0,0 +1,260 @@
+#include "AGVCoreNetwork_Http.h"
+#include <strings.h>
+
+using namespace AGVCoreNetworkLib;
+
+static const char POOL_FULL_RESPONSE[] =
+  "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\nRetry-After: 1\r\n\r\n";
+static const char RATE_LIMITED_RESPONSE[] =
+  "HTTP/1.1 429 Too Many Requests\r\nContent-Length: 0\r\nConnection: close\r\nRetry-After: 1\r\n\r\n";
+
+// Returns the length of the header block including the blank line, or 0 if incomplete
+static size_t findHeaderEnd(const char* buf, size_t len) {
+  for (size_t i = 3; i < len; i++) {
+    if (buf[i] == '\n' && buf[i - 1] == '\r' && buf[i - 2] == '\n' && buf[i - 3] == '\r') {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+// Looks up a header value inside the header block (case-insensitive name)
+static const char* findHeader(const char* head, size_t len, const char* name, size_t& valueLen) {
+  size_t nameLen = strlen(name);
+  const char* end = head + len;
+  const char* line = (const char*)memchr(head, '\n', len);
+
+  while (line && ++line < end) {
+    const char* eol = (const char*)memchr(line, '\r', end - line);
+    if (!eol) break;
+
+    if ((size_t)(eol - line) > nameLen && line[nameLen] == ':' && strncasecmp(line, name, nameLen) == 0) {
+      const char* value = line + nameLen + 1;
+      while (value < eol && *value == ' ') value++;
+      valueLen = eol - value;
+      return value;
+    }
+    line = (const char*)memchr(eol, '\n', end - eol);
+  }
+  return nullptr;
+}
+
+KeepAliveServer::KeepAliveServer(uint16_t port, uint32_t idleTimeoutMs, uint16_t maxRequestsPerConnection)
+  : listener(port), idleTimeoutMs(idleTimeoutMs), maxRequestsPerConnection(maxRequestsPerConnection) {
+}
+
+KeepAliveServer::~KeepAliveServer() {
+  stop();
+}
+
+void KeepAliveServer::begin() {
+  listener.begin();
+  listener.setNoDelay(true);
+}
+
+void KeepAliveServer::stop() {
+  for (uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+    if (connections[i].active) closeConnection(connections[i]);
+  }
+  listener.end();
+}
+
+bool KeepAliveServer::on(const char* path, const char* contentType, RouteHandler handler) {
+  if (routeCount >= MAX_ROUTES || !path || !handler) return false;
+
+  routes[routeCount].path = path;
+  routes[routeCount].contentType = contentType;
+  routes[routeCount].handler = handler;
+  routeCount++;
+  return true;
+}
+
+uint8_t KeepAliveServer::activeConnections() const {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+    if (connections[i].active) count++;
+  }
+  return count;
+}
+
+void KeepAliveServer::poll() {
+  acceptClients();
+
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+    if (connections[i].active) serviceConnection(connections[i], now);
+  }
+}
+
+void KeepAliveServer::acceptClients() {
+  while (listener.hasClient()) {
+    WiFiClient client = listener.available();
+    if (!client) break;
+
+    Connection* slot = nullptr;
+    for (uint8_t i = 0; i < MAX_CONNECTIONS; i++) {
+      if (!connections[i].active) {
+        slot = &connections[i];
+        break;
+      }
+    }
+
+    // Pool exhausted: answer with a fixed response instead of queueing
+    if (!slot) {
+      client.write((const uint8_t*)POOL_FULL_RESPONSE, sizeof(POOL_FULL_RESPONSE) - 1);
+      client.stop();
+      stats.rejected++;
+      continue;
+    }
+
+    client.setNoDelay(true);
+    slot->client = client;
+    slot->active = true;
+    slot->lastActivity = millis();
+    slot->served = 0;
+    slot->length = 0;
+    stats.accepted++;
+  }
+}
+
+void KeepAliveServer::serviceConnection(Connection& conn, uint32_t now) {
+  int available = conn.client.available();
+
+  if (available > 0) {
+    size_t space = REQUEST_BUFFER_SIZE - conn.length;
+    size_t toRead = (size_t)available < space ? (size_t)available : space;
+    int n = conn.client.read((uint8_t*)conn.buffer + conn.length, toRead);
+    if (n > 0) {
+      conn.length += n;
+      conn.lastActivity = now;
+    }
+  } else if (!conn.client.connected()) {
+    closeConnection(conn);
+    return;
+  } else if (now - conn.lastActivity > idleTimeoutMs) {
+    stats.timeouts++;
+    closeConnection(conn);
+    return;
+  }
+
+  // Answer every complete request in the buffer (pipelining)
+  for (uint8_t i = 0; i < MAX_PIPELINED_PER_POLL && conn.active; i++) {
+    size_t headerLength = findHeaderEnd(conn.buffer, conn.length);
+
+    if (headerLength == 0) {
+      if (conn.length >= REQUEST_BUFFER_SIZE) {
+        sendResponse(conn, 431, "Request Header Fields Too Large", "text/plain", nullptr, 0, false);
+        stats.errors++;
+        closeConnection(conn);
+      }
+      return;
+    }
+
+    bool keepAlive = handleRequest(conn, headerLength);
+
+    conn.length -= headerLength;
+    memmove(conn.buffer, conn.buffer + headerLength, conn.length);
+
+    if (!keepAlive) {
+      closeConnection(conn);
+      return;
+    }
+  }
+}
+
+bool KeepAliveServer::handleRequest(Connection& conn, size_t headerLength) {
+  const char* req = conn.buffer;
+  const char* lineEnd = (const char*)memchr(req, '\r', headerLength);
+  const char* sp1 = (const char*)memchr(req, ' ', lineEnd - req);
+  const char* sp2 = sp1 ? (const char*)memchr(sp1 + 1, ' ', lineEnd - sp1 - 1) : nullptr;
+
+  if (!sp1 || !sp2) {
+    sendResponse(conn, 400, "Bad Request", "text/plain", nullptr, 0, false);
+    stats.errors++;
+    return false;
+  }
+
+  stats.requests++;
+  conn.served++;
+
+  // Refused requests close the connection, freeing the pool slot
+  if (admitHandler && !admitHandler((uint32_t)conn.client.remoteIP())) {
+    conn.client.write((const uint8_t*)RATE_LIMITED_RESPONSE, sizeof(RATE_LIMITED_RESPONSE) - 1);
+    stats.limited++;
+    return false;
+  }
+
+  // HTTP/1.1 defaults to persistent connections, HTTP/1.0 must opt in
+  size_t valueLen = 0;
+  const char* connection = findHeader(req, headerLength, "Connection", valueLen);
+  bool http11 = (lineEnd - sp2 - 1) == 8 && strncmp(sp2 + 1, "HTTP/1.1", 8) == 0;
+  bool keepAlive = http11;
+  if (connection) {
+    if (valueLen == 5 && strncasecmp(connection, "close", 5) == 0) keepAlive = false;
+    if (valueLen == 10 && strncasecmp(connection, "keep-alive", 10) == 0) keepAlive = true;
+  }
+  if (conn.served >= maxRequestsPerConnection) keepAlive = false;
+
+  // Request bodies are not supported on the polling server
+  const char* contentLength = findHeader(req, headerLength, "Content-Length", valueLen);
+  if (contentLength && atoi(contentLength) > 0) {
+    sendResponse(conn, 413, "Payload Too Large", "text/plain", nullptr, 0, false);
+    stats.errors++;
+    return false;
+  }
+
+  size_t methodLen = sp1 - req;
+  bool isHead = methodLen == 4 && strncmp(req, "HEAD", 4) == 0;
+  bool isGet = methodLen == 3 && strncmp(req, "GET", 3) == 0;
+  if (!isGet && !isHead) {
+    sendResponse(conn, 405, "Method Not Allowed", "text/plain", nullptr, 0, keepAlive);
+    return keepAlive;
+  }
+
+  const char* path = sp1 + 1;
+  size_t pathLen = sp2 - path;
+  const char* query = (const char*)memchr(path, '?', pathLen);
+  if (query) pathLen = query - path;
+
+  for (uint8_t i = 0; i < routeCount; i++) {
+    if (strlen(routes[i].path) == pathLen && strncmp(routes[i].path, path, pathLen) == 0) {
+      const char* body = nullptr;
+      size_t bodyLength = routes[i].handler(body);
+      sendResponse(conn, 200, "OK", routes[i].contentType, isHead ? nullptr : body,
+                   isHead ? 0 : bodyLength, keepAlive);
+      return keepAlive;
+    }
+  }
+
+  sendResponse(conn, 404, "Not Found", "text/plain", nullptr, 0, keepAlive);
+  return keepAlive;
+}
+
+void KeepAliveServer::sendResponse(Connection& conn, int code, const char* reason, const char* contentType,
+                                   const char* body, size_t bodyLength, bool keepAlive) {
+  char out[640];
+  int headerLength = snprintf(out, sizeof(out),
+    "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+    "Access-Control-Allow-Origin: *\r\nCache-Control: no-store\r\nConnection: %s\r\n\r\n",
+    code, reason, contentType ? contentType : "text/plain", (unsigned)bodyLength,
+    keepAlive ? "keep-alive" : "close");
+  if (headerLength <= 0 || (size_t)headerLength >= sizeof(out)) return;
+
+  // Coalesce small responses into a single segment
+  if (body && bodyLength > 0 && headerLength + bodyLength <= sizeof(out)) {
+    memcpy(out + headerLength, body, bodyLength);
+    conn.client.write((const uint8_t*)out, headerLength + bodyLength);
+    return;
+  }
+
+  conn.client.write((const uint8_t*)out, headerLength);
+  if (body && bodyLength > 0) {
+    conn.client.write((const uint8_t*)body, bodyLength);
+  }
+}
+
+void KeepAliveServer::closeConnection(Connection& conn) {
+  conn.client.stop();
+  conn.active = false;
+  conn.length = 0;
+}
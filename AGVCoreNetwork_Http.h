@@ -0,0 +1,83 @@
+#ifndef AGVCORENETWORK_HTTP_H
+#define AGVCORENETWORK_HTTP_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+
+namespace AGVCoreNetworkLib {
+
+// Lightweight HTTP/1.1 server for high-rate polling endpoints (/status).
+// Connections stay open between requests, pipelined requests are answered
+// in order, and every pooled connection is served on each poll() call.
+class KeepAliveServer {
+public:
+  // Route handler: points body at the response and returns its length
+  typedef std::function<size_t(const char*& body)> RouteHandler;
+  // Admission check per request by remote IPv4 address; false answers 429
+  typedef std::function<bool(uint32_t ip)> AdmitHandler;
+
+  static const uint8_t MAX_CONNECTIONS = 4;
+  static const uint8_t MAX_ROUTES = 8;
+  static const size_t REQUEST_BUFFER_SIZE = 512;
+  static const uint8_t MAX_PIPELINED_PER_POLL = 8;
+
+  struct Stats {
+    uint32_t accepted = 0;
+    uint32_t rejected = 0;     // Pool full (503)
+    uint32_t limited = 0;      // Refused by the admission check (429)
+    uint32_t requests = 0;
+    uint32_t timeouts = 0;     // Idle connections closed
+    uint32_t errors = 0;       // Malformed or unsupported requests
+  };
+
+  KeepAliveServer(uint16_t port, uint32_t idleTimeoutMs = 5000, uint16_t maxRequestsPerConnection = 1000);
+  ~KeepAliveServer();
+
+  void begin();
+  void stop();
+  bool on(const char* path, const char* contentType, RouteHandler handler);
+  void onAdmit(AdmitHandler handler) { admitHandler = handler; }
+
+  // Accept, read and answer everything pending; call once per network loop
+  void poll();
+
+  uint8_t activeConnections() const;
+  const Stats& getStats() const { return stats; }
+
+private:
+  struct Route {
+    const char* path = nullptr;
+    const char* contentType = nullptr;
+    RouteHandler handler;
+  };
+
+  struct Connection {
+    WiFiClient client;
+    bool active = false;
+    uint32_t lastActivity = 0;
+    uint16_t served = 0;
+    size_t length = 0;
+    char buffer[REQUEST_BUFFER_SIZE];
+  };
+
+  WiFiServer listener;
+  uint32_t idleTimeoutMs;
+  uint16_t maxRequestsPerConnection;
+  Route routes[MAX_ROUTES];
+  uint8_t routeCount = 0;
+  AdmitHandler admitHandler;
+  Connection connections[MAX_CONNECTIONS];
+  Stats stats;
+
+  void acceptClients();
+  void serviceConnection(Connection& conn, uint32_t now);
+  bool handleRequest(Connection& conn, size_t headerLength);
+  void sendResponse(Connection& conn, int code, const char* reason, const char* contentType,
+                    const char* body, size_t bodyLength, bool keepAlive);
+  void closeConnection(Connection& conn);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,105 @@
+#include "AGVCoreNetwork_Lease.h"
+
+using namespace AGVCoreNetworkLib;
+
+static inline uint8_t holderOf(uint32_t w) { return w & 0x0F; }
+static inline uint8_t requesterOf(uint32_t w) { return (w >> 4) & 0x0F; }
+static inline uint32_t pack(uint8_t holder, uint8_t requester, uint32_t expiry) {
+  return holder | ((uint32_t)requester << 4) | (expiry << 8);
+}
+
+// Held and not yet expired (24-bit wrapping compare in 100 ms ticks)
+bool ControlLease::live(uint32_t w, uint32_t nowMs) {
+  if (holderOf(w) == NONE) return false;
+  uint32_t remaining = ((w >> EXPIRY_SHIFT) - nowMs / 100) & EXPIRY_MASK;
+  return remaining != 0 && remaining < (EXPIRY_MASK >> 1);
+}
+
+uint32_t ControlLease::expiryFrom(uint32_t nowMs) const {
+  uint32_t ticks = (getDuration() + 99) / 100;
+  return (nowMs / 100 + ticks) & EXPIRY_MASK;
+}
+
+bool ControlLease::holds(uint8_t client, uint32_t nowMs) const {
+  if (!enabled()) return true;
+  uint32_t w = word.load(std::memory_order_acquire);
+  return holderOf(w) == client && live(w, nowMs);
+}
+
+uint8_t ControlLease::holder(uint32_t nowMs) const {
+  uint32_t w = word.load(std::memory_order_acquire);
+  return live(w, nowMs) ? holderOf(w) : NONE;
+}
+
+ControlLease::Result ControlLease::acquire(uint8_t client, uint32_t nowMs) {
+  if (!enabled() || client >= NONE) return LEASE_DENIED;
+
+  uint32_t current = word.load(std::memory_order_acquire);
+  while (true) {
+    uint32_t next;
+    Result result;
+
+    if (!live(current, nowMs) || holderOf(current) == client) {
+      uint8_t waiting = requesterOf(current) == client ? NONE : requesterOf(current);
+      next = pack(client, waiting, expiryFrom(nowMs));
+      result = LEASE_GRANTED;
+    } else {
+      // Latest requester wins the handover slot
+      next = (current & ~0xF0u) | ((uint32_t)client << 4);
+      result = LEASE_REQUESTED;
+    }
+
+    if (next == current ||
+        word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return result;
+    }
+  }
+}
+
+bool ControlLease::renew(uint8_t client, uint32_t nowMs) {
+  uint32_t current = word.load(std::memory_order_acquire);
+  while (holderOf(current) == client && live(current, nowMs)) {
+    uint32_t next = pack(client, requesterOf(current), expiryFrom(nowMs));
+    if (word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t ControlLease::release(uint8_t client, uint32_t nowMs) {
+  uint32_t current = word.load(std::memory_order_acquire);
+  while (holderOf(current) == client) {
+    uint8_t next = requesterOf(current);
+    uint32_t w = next == NONE ? pack(NONE, NONE, 0) : pack(next, NONE, expiryFrom(nowMs));
+    if (word.compare_exchange_weak(current, w, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return next;
+    }
+  }
+  return holder(nowMs);
+}
+
+uint8_t ControlLease::decline(uint8_t client, uint32_t nowMs) {
+  uint32_t current = word.load(std::memory_order_acquire);
+  while (holderOf(current) == client && live(current, nowMs) && requesterOf(current) != NONE) {
+    uint32_t next = current | (NONE << 4);
+    if (word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return requesterOf(current);
+    }
+  }
+  return NONE;
+}
+
+void ControlLease::drop(uint8_t client) {
+  uint32_t current = word.load(std::memory_order_acquire);
+  while (true) {
+    uint32_t next = current;
+    if (holderOf(next) == client) next = pack(NONE, requesterOf(next), 0);
+    if (requesterOf(next) == client) next = (next & ~0xF0u) | (NONE << 4);
+
+    if (next == current ||
+        word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return;
+    }
+  }
+}
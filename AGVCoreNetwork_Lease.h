@@ -0,0 +1,65 @@
+#ifndef AGVCORENETWORK_LEASE_H
+#define AGVCORENETWORK_LEASE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+namespace AGVCoreNetworkLib {
+
+// Exclusive, time-limited motion lease for one WebSocket client.
+// The whole state lives in one 32-bit atomic word:
+//   bits 0-3   holder client (15 = none)
+//   bits 4-7   client waiting for a handover (15 = none)
+//   bits 8-31  expiry in units of 100 ms (wrapping)
+// holds() is a single atomic load; updates are compare-and-swap loops.
+class ControlLease {
+public:
+  static const uint8_t NONE = 0x0F;
+
+  enum Result : uint8_t {
+    LEASE_GRANTED,        // Caller now holds (or still holds) the lease
+    LEASE_REQUESTED,      // Held by another client; handover requested
+    LEASE_DENIED          // Disabled or invalid client
+  };
+
+  // Lease length; 0, the default, disables arbitration (every client may command)
+  void setDuration(uint32_t ms) { durationMs.store(ms, std::memory_order_relaxed); }
+  uint32_t getDuration() const { return durationMs.load(std::memory_order_relaxed); }
+  bool enabled() const { return getDuration() > 0; }
+
+  // Command-path check
+  bool holds(uint8_t client, uint32_t nowMs) const;
+
+  Result acquire(uint8_t client, uint32_t nowMs);
+
+  // Heartbeat; false if the caller no longer holds the lease
+  bool renew(uint8_t client, uint32_t nowMs);
+
+  // Gives the lease up, handing it to a waiting client if there is one.
+  // Returns the new holder (NONE if released).
+  uint8_t release(uint8_t client, uint32_t nowMs);
+
+  // Holder keeps the lease and refuses the pending handover. Returns the
+  // refused client (NONE if there was no request).
+  uint8_t decline(uint8_t client, uint32_t nowMs);
+
+  // Client went away: drops its lease and any pending request
+  void drop(uint8_t client);
+
+  uint8_t holder(uint32_t nowMs) const;
+  uint8_t requester() const { return (word.load(std::memory_order_acquire) >> 4) & 0x0F; }
+
+private:
+  static const uint32_t EXPIRY_SHIFT = 8;
+  static const uint32_t EXPIRY_MASK = 0xFFFFFF;
+
+  std::atomic<uint32_t> word{NONE | (NONE << 4)};
+  std::atomic<uint32_t> durationMs{0};
+
+  static bool live(uint32_t w, uint32_t nowMs);
+  uint32_t expiryFrom(uint32_t nowMs) const;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,71 @@
+#include "AGVCoreNetwork_Link.h"
+#include <algorithm>
+
+using namespace AGVCoreNetworkLib;
+
+static const char* const PROFILE_NAMES[LINK_PROFILE_COUNT] = {
+  "low_latency", "balanced", "power_save"
+};
+
+void LinkPolicy::setFixed(LinkProfile profile) {
+  if (profile >= LINK_PROFILE_COUNT) return;
+  automatic = false;
+  fixedProfile = profile;
+}
+
+void LinkPolicy::setAuto(LinkProfile moving, LinkProfile idle, uint32_t idleAfterMs) {
+  if (moving >= LINK_PROFILE_COUNT || idle >= LINK_PROFILE_COUNT) return;
+  automatic = true;
+  movingProfile = moving;
+  idleProfile = idle;
+  idleAfter = idleAfterMs;
+}
+
+LinkProfile LinkPolicy::evaluate(uint32_t nowMs) const {
+  if (!automatic) return fixedProfile;
+  if (motion) return movingProfile;
+  if (activitySeen && nowMs - lastActivity < idleAfter) return movingProfile;
+  return idleProfile;
+}
+
+void LinkPolicy::applied(LinkProfile profile, uint32_t nowMs) {
+  if (profile >= LINK_PROFILE_COUNT || profile == active) return;
+  if (active < LINK_PROFILE_COUNT) records[active].residentMs += nowMs - activeSince;
+  active = profile;
+  activeSince = nowMs;
+  records[profile].switches++;
+}
+
+void LinkPolicy::recordLatency(uint32_t rttUs) {
+  if (active >= LINK_PROFILE_COUNT) return;
+
+  Record& r = records[active];
+  if (r.samples == 0 || rttUs < r.minUs) r.minUs = rttUs;
+  if (rttUs > r.maxUs) r.maxUs = rttUs;
+  r.window[r.samples % LATENCY_WINDOW] = rttUs;
+  r.samples++;
+}
+
+void LinkPolicy::getStats(LinkProfile profile, Stats& stats, uint32_t nowMs) const {
+  stats = Stats();
+  if (profile >= LINK_PROFILE_COUNT) return;
+
+  const Record& r = records[profile];
+  stats.samples = r.samples;
+  stats.minUs = r.minUs;
+  stats.maxUs = r.maxUs;
+  stats.switches = r.switches;
+  stats.residentMs = r.residentMs + (profile == active ? nowMs - activeSince : 0);
+
+  uint8_t n = r.samples < LATENCY_WINDOW ? (uint8_t)r.samples : LATENCY_WINDOW;
+  if (n == 0) return;
+  uint32_t sorted[LATENCY_WINDOW];
+  memcpy(sorted, r.window, n * sizeof(uint32_t));
+  std::sort(sorted, sorted + n);
+  stats.medianUs = sorted[n / 2];
+  stats.p95Us = sorted[(n * 95 - 1) / 100];
+}
+
+const char* LinkPolicy::name(LinkProfile profile) {
+  return profile < LINK_PROFILE_COUNT ? PROFILE_NAMES[profile] : "unknown";
+}
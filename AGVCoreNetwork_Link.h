@@ -0,0 +1,87 @@
+#ifndef AGVCORENETWORK_LINK_H
+#define AGVCORENETWORK_LINK_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// WiFi power-save trade-off of the station link. Modem sleep holds downlink
+// frames at the access point until the next beacon/DTIM, which is where most
+// WebSocket command jitter comes from.
+enum LinkProfile : uint8_t {
+  LINK_LOW_LATENCY = 0,   // Radio always on
+  LINK_BALANCED,          // Modem sleep, waking every DTIM (ESP32 default)
+  LINK_POWER_SAVE,        // Modem sleep at the listen interval
+  LINK_PROFILE_COUNT
+};
+
+// Chooses the link profile from the vehicle's motion state and records
+// round-trip latency per profile. The motion state may be set from either
+// core; everything else runs on the network task.
+//
+// In automatic mode the moving profile applies while the vehicle reports
+// motion or commands/path frames keep arriving, and the idle profile once
+// both have been quiet for the hold-off (so a pause between path segments
+// does not flap the radio).
+class LinkPolicy {
+public:
+  static const uint8_t LATENCY_WINDOW = 32;     // Recent samples kept per profile
+
+  struct Stats {
+    uint32_t samples = 0;           // Round trips measured in this profile
+    uint32_t minUs = 0;
+    uint32_t medianUs = 0;          // Over the recent window
+    uint32_t p95Us = 0;             // Over the recent window
+    uint32_t maxUs = 0;
+    uint32_t switches = 0;          // Times this profile was entered
+    uint32_t residentMs = 0;        // Time spent in this profile
+  };
+
+  void setFixed(LinkProfile profile);
+  void setAuto(LinkProfile moving, LinkProfile idle, uint32_t idleAfterMs);
+  bool isAuto() const { return automatic; }
+
+  void setMoving(bool moving) { motion = moving; }
+  bool isMoving() const { return motion; }
+  void activity(uint32_t nowMs) { lastActivity = nowMs; activitySeen = true; }
+
+  // Profile that should be in effect now
+  LinkProfile evaluate(uint32_t nowMs) const;
+
+  // Bookkeeping once the profile is actually applied to the radio
+  void applied(LinkProfile profile, uint32_t nowMs);
+  LinkProfile current() const { return active; }
+
+  void recordLatency(uint32_t rttUs);
+  void getStats(LinkProfile profile, Stats& stats, uint32_t nowMs) const;
+
+  static const char* name(LinkProfile profile);
+
+private:
+  struct Record {
+    uint32_t samples = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t switches = 0;
+    uint32_t residentMs = 0;
+    uint32_t window[LATENCY_WINDOW] = {};
+  };
+
+  bool automatic = true;
+  LinkProfile fixedProfile = LINK_BALANCED;
+  LinkProfile movingProfile = LINK_LOW_LATENCY;
+  LinkProfile idleProfile = LINK_BALANCED;   // Same as an untouched ESP32
+  uint32_t idleAfter = 10000;
+
+  volatile bool motion = false;
+  bool activitySeen = false;
+  uint32_t lastActivity = 0;
+
+  LinkProfile active = LINK_PROFILE_COUNT;   // Nothing applied yet
+  uint32_t activeSince = 0;
+  Record records[LINK_PROFILE_COUNT];
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,466 @@
+#include "AGVCoreNetwork_Mqtt.h"
+
+using namespace AGVCoreNetworkLib;
+
+// MQTT control packet types (fixed header, upper nibble)
+enum : uint8_t {
+  MQTT_CONNECT = 0x10,
+  MQTT_CONNACK = 0x20,
+  MQTT_PUBLISH = 0x30,
+  MQTT_PUBACK = 0x40,
+  MQTT_SUBSCRIBE = 0x82,
+  MQTT_SUBACK = 0x90,
+  MQTT_PINGREQ = 0xC0,
+  MQTT_PINGRESP = 0xD0,
+  MQTT_DISCONNECT = 0xE0
+};
+
+// Writes a length-prefixed MQTT string, returns the bytes written
+static size_t putString(uint8_t* out, const char* str) {
+  size_t len = strlen(str);
+  out[0] = len >> 8;
+  out[1] = len & 0xFF;
+  memcpy(out + 2, str, len);
+  return len + 2;
+}
+
+MqttTransport::MqttTransport(const char* host, uint16_t port, const char* username, const char* password)
+  : host(host), port(port), username(username), password(password) {
+}
+
+void MqttTransport::setTopicPrefix(const char* prefix) {
+  strncpy(this->prefix, prefix, sizeof(this->prefix) - 1);
+  this->prefix[sizeof(this->prefix) - 1] = '\0';
+}
+
+bool MqttTransport::begin(const char* deviceName) {
+  if (!host || !deviceName) return false;
+
+  strncpy(clientId, deviceName, sizeof(clientId) - 1);
+  snprintf(statusTopic, sizeof(statusTopic), "%s/%s/status", prefix, deviceName);
+  snprintf(emergencyTopic, sizeof(emergencyTopic), "%s/%s/emergency", prefix, deviceName);
+  snprintf(commandTopic, sizeof(commandTopic), "%s/%s/cmd", prefix, deviceName);
+  snprintf(onlineTopic, sizeof(onlineTopic), "%s/%s/online", prefix, deviceName);
+
+  running = true;
+  lastAttempt = millis() - retryMs;  // Connect on the first loop()
+  Serial.printf("[MQTT] Broker %s:%u, topics %s/%s/*\n", host, port, prefix, deviceName);
+  return true;
+}
+
+void MqttTransport::stop() {
+  if (sessionUp) {
+    // Graceful disconnect: the broker discards the last will
+    sendPacket(MQTT_DISCONNECT, 0);
+  }
+  dropSession();
+  running = false;
+}
+
+bool MqttTransport::publish(Channel channel, const char* payload, size_t length) {
+  if (!running || !payload) return false;
+
+  bool queued = false;
+  portENTER_CRITICAL(&lock);
+
+  if (channel == CHANNEL_STATUS) {
+    // Telemetry lines are joined with '\n' and flushed once per interval
+    size_t needed = length + (batchLength ? 1 : 0);
+    if (batchLength + needed <= BATCH_SIZE) {
+      if (batchLength) batch[batchLength++] = '\n';
+      memcpy(batch + batchLength, payload, length);
+      batchLength += length;
+      queued = true;
+    } else {
+      stats.dropped++;
+    }
+  } else {
+    // Reliable channel: take a free slot or replace the oldest entry,
+    // since the newest emergency state is the one that matters
+    Pending* slot = &outbox[0];
+    for (uint8_t i = 0; i < OUTBOX_SLOTS; i++) {
+      if (!outbox[i].used) {
+        slot = &outbox[i];
+        break;
+      }
+      if ((int32_t)(outbox[i].sequence - slot->sequence) < 0) slot = &outbox[i];
+    }
+
+    slot->used = true;
+    slot->inFlight = false;
+    slot->attempts = 0;
+    slot->packetId = allocatePacketId();
+    slot->sequence = nextSequence++;
+    slot->length = length < OUTBOX_PAYLOAD ? length : OUTBOX_PAYLOAD;
+    memcpy(slot->payload, payload, slot->length);
+    queued = true;
+  }
+
+  portEXIT_CRITICAL(&lock);
+  return queued;
+}
+
+// Called with the lock held
+uint16_t MqttTransport::allocatePacketId() {
+  uint16_t id = nextPacketId++;
+  if (nextPacketId == 0) nextPacketId = 1;
+  return id;
+}
+
+void MqttTransport::loop() {
+  if (!running) return;
+
+  uint32_t now = millis();
+
+  if (!client.connected()) {
+    if (sessionUp || awaitingConnack) {
+      Serial.println("[MQTT] Connection lost");
+      dropSession();
+    }
+    if (WiFi.status() != WL_CONNECTED || now - lastAttempt < retryMs) return;
+
+    lastAttempt = now;
+    if (!connectSession()) {
+      retryMs = retryMs * 2 > RETRY_MAX_MS ? RETRY_MAX_MS : retryMs * 2;
+    }
+    return;
+  }
+
+  readPackets();
+
+  if (awaitingConnack) {
+    if (now - lastAttempt > ACK_TIMEOUT_MS) {
+      Serial.println("[MQTT] No CONNACK from broker");
+      dropSession();
+    }
+    return;
+  }
+  if (!sessionUp) return;
+
+  if (now - lastFlush >= batchIntervalMs) {
+    flushBatch();
+  }
+
+  serviceOutbox(now);
+
+  // Keep-alive: ping at half the interval, drop if the broker stays silent
+  uint32_t keepAliveMs = (uint32_t)keepAliveSec * 1000;
+  if (pingOutstanding && now - lastPing > keepAliveMs) {
+    Serial.println("[MQTT] Keep-alive timeout");
+    dropSession();
+  } else if (!pingOutstanding && now - lastTx > keepAliveMs / 2) {
+    if (sendPacket(MQTT_PINGREQ, 0)) {
+      pingOutstanding = true;
+      lastPing = now;
+    }
+  }
+}
+
+bool MqttTransport::connectSession() {
+  if (!client.connect(host, port, CONNECT_TIMEOUT_MS)) {
+    Serial.printf("[MQTT] Broker %s:%u unreachable, retry in %u ms\n", host, port, (unsigned)retryMs);
+    return false;
+  }
+  client.setNoDelay(true);
+
+  // Persistent session with a retained "offline" last will
+  uint8_t flags = 0x04 | 0x08 | 0x20;     // Will flag, will QoS 1, will retain
+  if (username) flags |= 0x80;
+  if (password) flags |= 0x40;
+
+  uint8_t* body = tx + TX_HEADROOM;
+  size_t n = putString(body, "MQTT");
+  body[n++] = 0x04;                       // Protocol level 3.1.1
+  body[n++] = flags;
+  body[n++] = keepAliveSec >> 8;
+  body[n++] = keepAliveSec & 0xFF;
+  n += putString(body + n, clientId);
+  n += putString(body + n, onlineTopic);
+  n += putString(body + n, "0");
+  if (username) n += putString(body + n, username);
+  if (password) n += putString(body + n, password);
+
+  if (!sendPacket(MQTT_CONNECT, n)) return false;
+
+  awaitingConnack = true;
+  rxState = RX_HEADER;
+  return true;
+}
+
+void MqttTransport::dropSession() {
+  client.stop();
+  sessionUp = false;
+  awaitingConnack = false;
+  pingOutstanding = false;
+  rxState = RX_HEADER;
+
+  // Everything in flight is resent once the session is back
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < OUTBOX_SLOTS; i++) {
+    outbox[i].inFlight = false;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+void MqttTransport::flushBatch() {
+  lastFlush = millis();
+
+  char local[BATCH_SIZE];
+  size_t length;
+
+  portENTER_CRITICAL(&lock);
+  length = batchLength;
+  memcpy(local, batch, length);
+  batchLength = 0;
+  portEXIT_CRITICAL(&lock);
+
+  if (length == 0) return;
+
+  if (sendPublish(statusTopic, local, length, 0, false, false, 0)) {
+    stats.batches++;
+  }
+}
+
+// Sent in queue order rather than slot order. The topic is retained, so once
+// one entry goes out every newer one follows it again: the last publish the
+// broker sees is always the newest state.
+void MqttTransport::serviceOutbox(uint32_t now) {
+  uint8_t order[OUTBOX_SLOTS];
+  uint8_t count = 0;
+
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < OUTBOX_SLOTS; i++) {
+    if (!outbox[i].used) continue;
+    uint8_t j = count++;
+    for (; j > 0 && (int32_t)(outbox[order[j - 1]].sequence - outbox[i].sequence) > 0; j--) {
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+  }
+  portEXIT_CRITICAL(&lock);
+
+  bool resend = false;
+  for (uint8_t k = 0; k < count; k++) {
+    char payload[OUTBOX_PAYLOAD];
+    uint16_t length, packetId;
+    bool dup;
+
+    portENTER_CRITICAL(&lock);
+    Pending& slot = outbox[order[k]];
+    bool due = slot.used && (resend || !slot.inFlight || now - slot.sentAt > ACK_TIMEOUT_MS);
+    if (due) {
+      length = slot.length;
+      packetId = slot.packetId;
+      dup = slot.attempts > 0;
+      memcpy(payload, slot.payload, length);
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (!due) continue;
+    if (!sendPublish(emergencyTopic, payload, length, 1, true, dup, packetId)) return;
+    if (dup) stats.retransmits++;
+    resend = true;
+
+    portENTER_CRITICAL(&lock);
+    if (slot.used && slot.packetId == packetId) {
+      slot.inFlight = true;
+      slot.sentAt = now;
+      slot.attempts++;
+    }
+    portEXIT_CRITICAL(&lock);
+  }
+}
+
+bool MqttTransport::sendPublish(const char* topic, const char* payload, size_t length,
+                                uint8_t qos, bool retain, bool dup, uint16_t packetId) {
+  size_t topicLength = strlen(topic);
+  if (2 + topicLength + 2 + length > TX_SIZE - TX_HEADROOM) return false;
+
+  uint8_t* body = tx + TX_HEADROOM;
+  size_t n = putString(body, topic);
+  if (qos > 0) {
+    body[n++] = packetId >> 8;
+    body[n++] = packetId & 0xFF;
+  }
+  memcpy(body + n, payload, length);
+  n += length;
+
+  uint8_t header = MQTT_PUBLISH | (dup ? 0x08 : 0) | (qos << 1) | (retain ? 0x01 : 0);
+  if (!sendPacket(header, n)) return false;
+
+  stats.published++;
+  return true;
+}
+
+bool MqttTransport::sendSubscribe() {
+  uint8_t* body = tx + TX_HEADROOM;
+  uint16_t packetId;
+
+  portENTER_CRITICAL(&lock);
+  packetId = allocatePacketId();
+  portEXIT_CRITICAL(&lock);
+
+  body[0] = packetId >> 8;
+  body[1] = packetId & 0xFF;
+  size_t n = 2 + putString(body + 2, commandTopic);
+  body[n++] = 0;                          // Requested QoS 0 (see header)
+
+  return sendPacket(MQTT_SUBSCRIBE, n);
+}
+
+// The body has already been written at tx + TX_HEADROOM; the fixed header
+// is placed directly in front of it so the packet goes out in one write
+bool MqttTransport::sendPacket(uint8_t header, size_t bodyLength) {
+  uint8_t encoded[4];
+  size_t n = 0;
+  size_t remaining = bodyLength;
+  do {
+    uint8_t b = remaining % 128;
+    remaining /= 128;
+    if (remaining) b |= 0x80;
+    encoded[n++] = b;
+  } while (remaining && n < sizeof(encoded));
+
+  uint8_t* start = tx + TX_HEADROOM - n - 1;
+  start[0] = header;
+  memcpy(start + 1, encoded, n);
+
+  size_t total = 1 + n + bodyLength;
+  if (client.write(start, total) != total) {
+    Serial.println("[MQTT] Write failed");
+    dropSession();
+    return false;
+  }
+
+  lastTx = millis();
+  return true;
+}
+
+void MqttTransport::readPackets() {
+  while (client.available() > 0) {
+    int c = client.read();
+    if (c < 0) break;
+
+    switch (rxState) {
+      case RX_HEADER:
+        rxHeader = c;
+        rxRemaining = 0;
+        rxMultiplier = 1;
+        rxState = RX_LENGTH;
+        break;
+
+      case RX_LENGTH:
+        rxRemaining += (c & 0x7F) * rxMultiplier;
+        rxMultiplier *= 128;
+        if (!(c & 0x80)) {
+          rxLength = 0;
+          if (rxRemaining == 0) {
+            handlePacket(rxHeader, rx, 0);
+            rxState = RX_HEADER;
+          } else {
+            rxState = RX_BODY;
+          }
+        } else if (rxMultiplier > 128UL * 128 * 128) {
+          Serial.println("[MQTT] Malformed packet length");
+          dropSession();
+          return;
+        }
+        break;
+
+      case RX_BODY:
+        // Oversized packets are consumed but not dispatched
+        if (rxLength < RX_SIZE) rx[rxLength] = c;
+        rxLength++;
+        if (rxLength == rxRemaining) {
+          if (rxRemaining <= RX_SIZE) {
+            handlePacket(rxHeader, rx, rxRemaining);
+          }
+          rxState = RX_HEADER;
+        }
+        break;
+    }
+
+    if (!client.connected()) return;
+  }
+}
+
+void MqttTransport::handlePacket(uint8_t header, const uint8_t* body, size_t length) {
+  switch (header & 0xF0) {
+    case MQTT_CONNACK:
+      if (length < 2 || body[1] != 0) {
+        Serial.printf("[MQTT] Connection refused (code %u)\n", length >= 2 ? body[1] : 0xFF);
+        dropSession();
+        return;
+      }
+
+      awaitingConnack = false;
+      sessionUp = true;
+      retryMs = RETRY_MIN_MS;
+      lastFlush = millis();
+      stats.connects++;
+
+      // Session present: the broker still holds our subscription
+      if (body[0] & 0x01) {
+        stats.sessionResumes++;
+        Serial.println("[MQTT] ✅ Session resumed");
+      } else {
+        sendSubscribe();
+        Serial.println("[MQTT] ✅ Connected (new session)");
+      }
+      sendPublish(onlineTopic, "1", 1, 0, true, false, 0);
+      break;
+
+    case MQTT_PUBLISH: {
+      if (length < 2) return;
+
+      uint8_t qos = (header >> 1) & 0x03;
+      size_t topicLength = ((size_t)body[0] << 8) | body[1];
+      size_t pos = 2 + topicLength + (qos ? 2 : 0);
+      if (pos > length) return;
+
+      stats.received++;
+      if (topicLength == strlen(commandTopic) && memcmp(body + 2, commandTopic, topicLength) == 0 && commandHandler) {
+        char command[RX_SIZE + 1];
+        size_t commandLength = length - pos;
+        memcpy(command, body + pos, commandLength);
+        command[commandLength] = '\0';
+        commandHandler(command, commandLength);
+      }
+
+      if (qos == 1) {
+        uint8_t* ack = tx + TX_HEADROOM;
+        ack[0] = body[2 + topicLength];
+        ack[1] = body[3 + topicLength];
+        sendPacket(MQTT_PUBACK, 2);
+      }
+      break;
+    }
+
+    case MQTT_PUBACK: {
+      if (length < 2) return;
+      uint16_t packetId = ((uint16_t)body[0] << 8) | body[1];
+
+      portENTER_CRITICAL(&lock);
+      for (uint8_t i = 0; i < OUTBOX_SLOTS; i++) {
+        if (outbox[i].used && outbox[i].packetId == packetId) {
+          outbox[i].used = false;
+        }
+      }
+      portEXIT_CRITICAL(&lock);
+      break;
+    }
+
+    case MQTT_SUBACK:
+      if (length >= 3 && body[2] == 0x80) {
+        Serial.println("[MQTT] Command subscription rejected");
+      }
+      break;
+
+    case MQTT_PINGRESP:
+      pingOutstanding = false;
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef AGVCORENETWORK_MQTT_H
+#define AGVCORENETWORK_MQTT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "AGVCoreNetwork_Transport.h"
+
+namespace AGVCoreNetworkLib {
+
+// MQTT 3.1.1 client transport.
+//   <prefix>/<device>/status     QoS 0, telemetry batched per interval
+//   <prefix>/<device>/emergency  QoS 1, retained, resent until acknowledged
+//   <prefix>/<device>/cmd        subscribed QoS 0, fed to the command path
+//   <prefix>/<device>/online     retained "1", last will "0"
+// Sessions are persistent (clean session off, client id = device name): the
+// broker keeps the command subscription across reconnects and unacknowledged
+// emergency messages are resent with DUP set, oldest first, so the retained
+// emergency state is always the newest one. Commands are subscribed at
+// QoS 0 on purpose so a vehicle never executes motion commands the broker
+// queued while it was offline.
+class MqttTransport : public Transport {
+public:
+  struct Stats {
+    uint32_t connects = 0;
+    uint32_t sessionResumes = 0;   // CONNACK with session present
+    uint32_t published = 0;
+    uint32_t batches = 0;
+    uint32_t dropped = 0;          // Telemetry that did not fit the batch
+    uint32_t retransmits = 0;
+    uint32_t received = 0;
+  };
+
+  MqttTransport(const char* host, uint16_t port = 1883,
+                const char* username = nullptr, const char* password = nullptr);
+
+  // Configuration - call before begin()
+  void setTopicPrefix(const char* prefix);
+  void setBatchInterval(uint16_t ms) { batchIntervalMs = ms; }
+  void setKeepAlive(uint16_t seconds) { keepAliveSec = seconds; }
+
+  const char* name() const override { return "mqtt"; }
+  bool begin(const char* deviceName) override;
+  void loop() override;
+  void stop() override;
+  bool connected() override { return sessionUp; }
+  bool publish(Channel channel, const char* payload, size_t length) override;
+
+  const Stats& getStats() const { return stats; }
+
+private:
+  static const size_t TOPIC_SIZE = 64;
+  static const size_t BATCH_SIZE = 512;
+  static const size_t RX_SIZE = 384;
+  static const size_t TX_HEADROOM = 5;    // Fixed header is written in front of the body
+  static const size_t TX_SIZE = TX_HEADROOM + BATCH_SIZE + TOPIC_SIZE + 8;
+  static const uint8_t OUTBOX_SLOTS = 4;
+  static const size_t OUTBOX_PAYLOAD = 128;
+  static const uint32_t CONNECT_TIMEOUT_MS = 1000;
+  static const uint32_t RETRY_MIN_MS = 1000;
+  static const uint32_t RETRY_MAX_MS = 30000;
+  static const uint32_t ACK_TIMEOUT_MS = 5000;
+
+  // QoS 1 message waiting for PUBACK
+  struct Pending {
+    bool used = false;
+    bool inFlight = false;
+    uint8_t attempts = 0;
+    uint16_t packetId = 0;
+    uint32_t sequence = 0;       // Queue order, from nextSequence
+    uint32_t sentAt = 0;
+    uint16_t length = 0;
+    char payload[OUTBOX_PAYLOAD];
+  };
+
+  enum RxState : uint8_t { RX_HEADER, RX_LENGTH, RX_BODY };
+
+  WiFiClient client;
+  const char* host;
+  uint16_t port;
+  const char* username;
+  const char* password;
+
+  char prefix[16] = "agv";
+  char clientId[32] = "";
+  char statusTopic[TOPIC_SIZE] = "";
+  char emergencyTopic[TOPIC_SIZE] = "";
+  char commandTopic[TOPIC_SIZE] = "";
+  char onlineTopic[TOPIC_SIZE] = "";
+
+  uint16_t batchIntervalMs = 200;
+  uint16_t keepAliveSec = 30;
+
+  bool running = false;
+  bool sessionUp = false;
+  bool awaitingConnack = false;
+  bool pingOutstanding = false;
+  uint32_t lastAttempt = 0;
+  uint32_t retryMs = RETRY_MIN_MS;
+  uint32_t lastTx = 0;
+  uint32_t lastPing = 0;
+  uint32_t lastFlush = 0;
+  uint16_t nextPacketId = 1;
+  uint32_t nextSequence = 0;
+
+  // Shared with publish() callers on either core
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  char batch[BATCH_SIZE];
+  size_t batchLength = 0;
+  Pending outbox[OUTBOX_SLOTS];
+
+  // Network task only
+  uint8_t tx[TX_SIZE];
+  uint8_t rx[RX_SIZE];
+  RxState rxState = RX_HEADER;
+  uint8_t rxHeader = 0;
+  uint32_t rxRemaining = 0;
+  uint32_t rxMultiplier = 1;
+  uint32_t rxLength = 0;
+
+  Stats stats;
+
+  bool connectSession();
+  void dropSession();
+  void flushBatch();
+  void serviceOutbox(uint32_t now);
+  void readPackets();
+  void handlePacket(uint8_t header, const uint8_t* body, size_t length);
+  bool sendPublish(const char* topic, const char* payload, size_t length,
+                   uint8_t qos, bool retain, bool dup, uint16_t packetId);
+  bool sendSubscribe();
+  bool sendPacket(uint8_t header, size_t bodyLength);
+  uint16_t allocatePacketId();
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
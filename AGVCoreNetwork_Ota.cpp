@@ -0,0 +1,242 @@
+#include "AGVCoreNetwork_Ota.h"
+#include <esp_partition.h>
+
+using namespace AGVCoreNetworkLib;
+
+#if AGVNET_OTA_ROLLBACK
+// Tell the core not to confirm a fresh image at boot; confirmImage() does it
+// once the network is up, and rollback() reverts an image that cannot connect
+extern "C" bool verifyRollbackLater() {
+  return true;
+}
+#endif
+
+// ESP-IDF flash writer
+
+bool EspFlashWriter::begin() {
+  target = esp_ota_get_next_update_partition(nullptr);
+  if (!target) return false;
+  return esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle) == ESP_OK;
+}
+
+bool EspFlashWriter::write(const uint8_t* data, size_t length) {
+  return esp_ota_write(handle, data, length) == ESP_OK;
+}
+
+size_t EspFlashWriter::sourceSize() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  return running ? running->size : 0;
+}
+
+bool EspFlashWriter::readSource(uint32_t offset, uint8_t* out, size_t length) {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  return running && esp_partition_read(running, offset, out, length) == ESP_OK;
+}
+
+bool EspFlashWriter::commit() {
+  if (esp_ota_end(handle) != ESP_OK) return false;   // Also validates the image
+  handle = 0;
+  return esp_ota_set_boot_partition(target) == ESP_OK;
+}
+
+void EspFlashWriter::abort() {
+  if (handle) esp_ota_abort(handle);
+  handle = 0;
+}
+
+// Updater
+
+bool OtaUpdater::begin(FlashWriter* writer, Format format, const uint8_t expectedHash[HASH_SIZE]) {
+  if (active()) abort();
+
+  this->format = format;
+  memcpy(expected, expectedHash, HASH_SIZE);
+  received = 0;
+  written = 0;
+  state = D_HEADER;
+  headerLength = 0;
+  targetSize = 0;
+  varint = 0;
+  varintShift = 0;
+  copyEnd = 0;
+
+  if (!writer->begin()) {
+    error = OTA_BEGIN_FAILED;
+    return false;
+  }
+
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  this->writer = writer;
+  error = OTA_OK;
+  return true;
+}
+
+bool OtaUpdater::fail(Error reason) {
+  if (writer) {
+    writer->abort();
+    mbedtls_sha256_free(&sha);
+    writer = nullptr;
+  }
+  error = reason;
+  return false;
+}
+
+void OtaUpdater::abort() {
+  if (active()) fail(OTA_ABORTED);
+}
+
+bool OtaUpdater::emit(const uint8_t* data, size_t length) {
+  if (format == FORMAT_DELTA && written + length > targetSize) return fail(OTA_BAD_DELTA);
+  if (!writer->write(data, length)) return fail(OTA_WRITE_FAILED);
+
+  mbedtls_sha256_update(&sha, data, length);
+  written += length;
+  return true;
+}
+
+bool OtaUpdater::copy(uint32_t offset, uint32_t length) {
+  if ((uint64_t)offset + length > writer->sourceSize()) return fail(OTA_BAD_DELTA);
+
+  uint8_t chunk[COPY_CHUNK];
+  while (length > 0) {
+    size_t n = length < COPY_CHUNK ? length : COPY_CHUNK;
+    if (!writer->readSource(offset, chunk, n)) return fail(OTA_WRITE_FAILED);
+    if (!emit(chunk, n)) return false;
+    offset += n;
+    length -= n;
+  }
+  return true;
+}
+
+bool OtaUpdater::feedDelta(const uint8_t* data, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    switch (state) {
+      case D_HEADER:
+        header[headerLength++] = data[i++];
+        if (headerLength == DELTA_HEADER_SIZE) {
+          if (memcmp(header, "AGVD", 4) != 0 || header[4] != 1) return fail(OTA_BAD_DELTA);
+          targetSize = header[5] | (header[6] << 8) | (header[7] << 16) | ((uint32_t)header[8] << 24);
+          state = D_OP;
+        }
+        break;
+
+      case D_OP:
+      case D_COPY_OFFSET: {
+        uint8_t b = data[i++];
+        if (varintShift > 28) return fail(OTA_BAD_DELTA);
+        varint |= (uint32_t)(b & 0x7F) << varintShift;
+        varintShift += 7;
+        if (b & 0x80) break;
+
+        uint32_t value = varint;
+        varint = 0;
+        varintShift = 0;
+
+        if (state == D_OP) {
+          opLength = value >> 1;
+          if (opLength == 0) return fail(OTA_BAD_DELTA);
+          state = (value & 1) ? D_INSERT : D_COPY_OFFSET;
+        } else {
+          int32_t delta = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+          uint32_t offset = copyEnd + delta;
+          if (!copy(offset, opLength)) return false;
+          copyEnd = offset + opLength;
+          state = D_OP;
+        }
+        break;
+      }
+
+      case D_INSERT: {
+        size_t n = length - i < opLength ? length - i : opLength;
+        if (!emit(data + i, n)) return false;
+        i += n;
+        opLength -= n;
+        if (opLength == 0) state = D_OP;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+bool OtaUpdater::write(const uint8_t* data, size_t length) {
+  if (!active()) return false;
+
+  received += length;
+  if (format == FORMAT_FULL) return emit(data, length);
+  return feedDelta(data, length);
+}
+
+OtaUpdater::Error OtaUpdater::end() {
+  if (!active()) return error == OTA_OK ? OTA_NOT_STARTED : error;
+
+  if (format == FORMAT_DELTA && (state != D_OP || varintShift != 0 || written != targetSize)) {
+    fail(OTA_BAD_DELTA);
+    return error;
+  }
+
+  uint8_t hash[HASH_SIZE];
+  mbedtls_sha256_finish(&sha, hash);
+  if (memcmp(hash, expected, HASH_SIZE) != 0) {
+    fail(OTA_HASH_MISMATCH);
+    return error;
+  }
+
+  if (!writer->commit()) {
+    fail(OTA_COMMIT_FAILED);
+    return error;
+  }
+
+  mbedtls_sha256_free(&sha);
+  writer = nullptr;
+  error = OTA_OK;
+  return error;
+}
+
+const char* OtaUpdater::errorName(Error error) {
+  static const char* const names[] = {
+    "ok", "not started", "begin failed", "write failed",
+    "bad delta", "hash mismatch", "commit failed", "aborted"
+  };
+  return error <= OTA_ABORTED ? names[error] : "unknown";
+}
+
+bool OtaUpdater::parseHash(const char* hex, uint8_t out[HASH_SIZE]) {
+  if (!hex || strlen(hex) != HASH_SIZE * 2) return false;
+
+  for (size_t i = 0; i < HASH_SIZE * 2; i++) {
+    char c = hex[i];
+    uint8_t v;
+    if (c >= '0' && c <= '9') v = c - '0';
+    else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+    else return false;
+    out[i / 2] = (i & 1) ? (out[i / 2] | v) : (v << 4);
+  }
+  return true;
+}
+
+// Rollback
+
+bool OtaUpdater::pendingVerify() {
+  esp_ota_img_states_t imageState;
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  return running && esp_ota_get_state_partition(running, &imageState) == ESP_OK &&
+         imageState == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+void OtaUpdater::confirmImage() {
+  if (pendingVerify()) {
+    esp_ota_mark_app_valid_cancel_rollback();
+    Serial.println("[OTA] ✅ New firmware confirmed");
+  }
+}
+
+void OtaUpdater::rollback() {
+  if (pendingVerify()) {
+    Serial.println("[OTA] ❌ New firmware failed its first boot, rolling back");
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+  }
+}
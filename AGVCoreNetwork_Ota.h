@@ -0,0 +1,124 @@
+#ifndef AGVCORENETWORK_OTA_H
+#define AGVCORENETWORK_OTA_H
+
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+
+// Confirm new firmware from the library (after the network comes up) instead
+// of at boot. Set to 0 if the sketch defines verifyRollbackLater() itself.
+#ifndef AGVNET_OTA_ROLLBACK
+#define AGVNET_OTA_ROLLBACK 1
+#endif
+
+namespace AGVCoreNetworkLib {
+
+// Destination of a firmware image, with read access to the running image
+// that delta updates copy from
+class FlashWriter {
+public:
+  virtual ~FlashWriter() {}
+  virtual bool begin() = 0;
+  virtual bool write(const uint8_t* data, size_t length) = 0;
+  virtual size_t sourceSize() = 0;
+  virtual bool readSource(uint32_t offset, uint8_t* out, size_t length) = 0;
+  virtual bool commit() = 0;              // Make the written image the boot image
+  virtual void abort() = 0;
+};
+
+// Inactive OTA partition via the ESP-IDF OTA API
+class EspFlashWriter : public FlashWriter {
+public:
+  bool begin() override;
+  bool write(const uint8_t* data, size_t length) override;
+  size_t sourceSize() override;
+  bool readSource(uint32_t offset, uint8_t* out, size_t length) override;
+  bool commit() override;
+  void abort() override;
+
+private:
+  const esp_partition_t* target = nullptr;
+  esp_ota_handle_t handle = 0;
+};
+
+// Streams a full or delta image into a FlashWriter chunk by chunk and only
+// commits it when the SHA-256 of the produced image matches.
+//
+// Delta images:
+//   "AGVD", version (1), target size (u32 little endian)
+//   ops: varint (length << 1 | op)
+//     op 0  COPY length bytes of the running image, followed by a varint
+//           zigzag offset relative to the end of the previous copy
+//     op 1  INSERT length literal bytes, which follow
+class OtaUpdater {
+public:
+  enum Format : uint8_t { FORMAT_FULL, FORMAT_DELTA };
+
+  enum Error : uint8_t {
+    OTA_OK = 0,
+    OTA_NOT_STARTED,
+    OTA_BEGIN_FAILED,
+    OTA_WRITE_FAILED,
+    OTA_BAD_DELTA,
+    OTA_HASH_MISMATCH,
+    OTA_COMMIT_FAILED,
+    OTA_ABORTED
+  };
+
+  static const size_t HASH_SIZE = 32;
+
+  bool begin(FlashWriter* writer, Format format, const uint8_t expectedHash[HASH_SIZE]);
+
+  // Feeds the next chunk of the upload; false once the update has failed
+  bool write(const uint8_t* data, size_t length);
+
+  // Verifies and commits; the writer is aborted on any failure
+  Error end();
+  void abort();
+
+  bool active() const { return writer != nullptr; }
+  Error getError() const { return error; }
+  uint32_t bytesReceived() const { return received; }
+  uint32_t bytesWritten() const { return written; }
+
+  static const char* errorName(Error error);
+  static bool parseHash(const char* hex, uint8_t out[HASH_SIZE]);
+
+  // Boot-time rollback handling for an image that has not been confirmed yet
+  static bool pendingVerify();
+  static void confirmImage();
+  static void rollback();
+
+private:
+  enum DeltaState : uint8_t { D_HEADER, D_OP, D_COPY_OFFSET, D_INSERT };
+
+  static const uint8_t DELTA_HEADER_SIZE = 9;
+  static const size_t COPY_CHUNK = 256;
+
+  FlashWriter* writer = nullptr;
+  Format format = FORMAT_FULL;
+  Error error = OTA_NOT_STARTED;
+  uint8_t expected[HASH_SIZE];
+  mbedtls_sha256_context sha;
+  uint32_t received = 0;
+  uint32_t written = 0;
+
+  // Delta parser
+  DeltaState state = D_HEADER;
+  uint8_t header[DELTA_HEADER_SIZE];
+  uint8_t headerLength = 0;
+  uint32_t targetSize = 0;
+  uint32_t varint = 0;
+  uint8_t varintShift = 0;
+  uint32_t opLength = 0;
+  uint32_t copyEnd = 0;
+
+  bool emit(const uint8_t* data, size_t length);
+  bool copy(uint32_t offset, uint32_t length);
+  bool feedDelta(const uint8_t* data, size_t length);
+  bool fail(Error reason);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
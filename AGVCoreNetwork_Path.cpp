@@ -0,0 +1,227 @@
+#include "AGVCoreNetwork_Path.h"
+
+using namespace AGVCoreNetworkLib;
+
+// Unit steps for direction codes 0-7
+static const int8_t stepX[8] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+static const int8_t stepY[8] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static int8_t directionCode(int32_t dx, int32_t dy) {
+  for (uint8_t code = 0; code < 8; code++) {
+    if (stepX[code] == dx && stepY[code] == dy) return code;
+  }
+  return -1;
+}
+
+// Decoder
+
+void PathDecoder::reset() {
+  state = STATE_IDLE;
+  field = F_MAGIC;
+  pathFlags = 0;
+  varintShift = 0;
+  varint = 0;
+  x = y = 0;
+  index = 0;
+}
+
+void PathDecoder::emit(uint32_t steps, uint8_t flags) {
+  if (pathFlags & PathFormat::FLAG_LOOP) flags |= WAYPOINT_LOOP;
+  if (handler) {
+    Waypoint waypoint = { x, y, steps, index, flags };
+    handler(waypoint);
+  }
+  if (!(flags & WAYPOINT_END)) index++;
+}
+
+// Returns false once the end token has been seen
+bool PathDecoder::token(uint32_t value) {
+  uint8_t code = value & 0x0F;
+  uint32_t run = value >> 4;
+
+  if (code < 8) {
+    if (run == 0) {
+      state = STATE_ERROR;
+      return false;
+    }
+    x += stepX[code] * (int32_t)run;
+    y += stepY[code] * (int32_t)run;
+    emit(run, 0);
+    return true;
+  }
+
+  if (code == PathFormat::CODE_JUMP) {
+    field = F_JUMP_X;
+    return true;
+  }
+
+  if (code == PathFormat::CODE_END && run == 0) {
+    emit(0, WAYPOINT_END);
+    state = STATE_DONE;
+    return false;
+  }
+
+  state = STATE_ERROR;
+  return false;
+}
+
+size_t PathDecoder::feed(const uint8_t* data, size_t length) {
+  if (state == STATE_DONE || state == STATE_ERROR) return 0;
+
+  size_t i = 0;
+  while (i < length) {
+    uint8_t b = data[i++];
+
+    if (field == F_MAGIC) {
+      if (b != PathFormat::MAGIC) {
+        state = STATE_ERROR;
+        return i;
+      }
+      state = STATE_DECODING;
+      field = F_HEADER;
+      continue;
+    }
+
+    if (field == F_HEADER) {
+      if ((b >> 4) != PathFormat::VERSION) {
+        state = STATE_ERROR;
+        return i;
+      }
+      pathFlags = b & 0x0F;
+      field = F_START_X;
+      continue;
+    }
+
+    // Everything after the header is a varint
+    if (varintShift > 28) {
+      state = STATE_ERROR;
+      return i;
+    }
+    varint |= (uint32_t)(b & 0x7F) << varintShift;
+    if (b & 0x80) {
+      varintShift += 7;
+      continue;
+    }
+
+    uint32_t value = varint;
+    varint = 0;
+    varintShift = 0;
+
+    switch (field) {
+      case F_START_X:
+        x = unzigzag(value);
+        field = F_START_Y;
+        break;
+
+      case F_START_Y:
+        y = unzigzag(value);
+        emit(0, WAYPOINT_START);
+        field = F_TOKEN;
+        break;
+
+      case F_TOKEN:
+        if (!token(value)) return i;
+        break;
+
+      case F_JUMP_X:
+        jumpDx = unzigzag(value);
+        field = F_JUMP_Y;
+        break;
+
+      case F_JUMP_Y: {
+        int32_t jumpDy = unzigzag(value);
+        x += jumpDx;
+        y += jumpDy;
+        uint32_t ax = jumpDx < 0 ? -jumpDx : jumpDx;
+        uint32_t ay = jumpDy < 0 ? -jumpDy : jumpDy;
+        emit(ax > ay ? ax : ay, 0);
+        field = F_TOKEN;
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  return i;
+}
+
+// Encoder
+
+void PathEncoder::put(uint8_t byte) {
+  if (length < capacity) {
+    buffer[length++] = byte;
+  } else {
+    overflow = true;
+  }
+}
+
+void PathEncoder::putVarint(uint32_t value) {
+  while (value >= 0x80) {
+    put((uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  put((uint8_t)value);
+}
+
+void PathEncoder::flushRun() {
+  if (runCode < 0) return;
+  putVarint((run << 4) | (uint32_t)runCode);
+  runCode = -1;
+  run = 0;
+}
+
+bool PathEncoder::begin(int32_t x, int32_t y, bool loop) {
+  length = 0;
+  overflow = false;
+  runCode = -1;
+  run = 0;
+  this->x = x;
+  this->y = y;
+
+  put(PathFormat::MAGIC);
+  put((PathFormat::VERSION << 4) | (loop ? PathFormat::FLAG_LOOP : 0));
+  putVarint(zigzag(x));
+  putVarint(zigzag(y));
+  return !overflow;
+}
+
+bool PathEncoder::add(int32_t nx, int32_t ny) {
+  int32_t dx = nx - x;
+  int32_t dy = ny - y;
+  if (dx == 0 && dy == 0) return !overflow;
+
+  // Straight lines along one of the eight directions become runs
+  int32_t ax = dx < 0 ? -dx : dx;
+  int32_t ay = dy < 0 ? -dy : dy;
+  int32_t steps = ax > ay ? ax : ay;
+  int8_t code = -1;
+  if (ax == 0 || ay == 0 || ax == ay) {
+    code = directionCode(dx / steps, dy / steps);
+  }
+
+  if (code >= 0) {
+    if (code != runCode) flushRun();
+    runCode = code;
+    run += steps;
+  } else {
+    flushRun();
+    putVarint(PathFormat::CODE_JUMP);
+    putVarint(zigzag(dx));
+    putVarint(zigzag(dy));
+  }
+
+  x = nx;
+  y = ny;
+  return !overflow;
+}
+
+size_t PathEncoder::finish() {
+  flushRun();
+  putVarint(PathFormat::CODE_END);
+  return overflow ? 0 : length;
+}
@@ -0,0 +1,108 @@
+#ifndef AGVCORENETWORK_PATH_H
+#define AGVCORENETWORK_PATH_H
+
+#include <Arduino.h>
+#include <functional>
+
+namespace AGVCoreNetworkLib {
+
+// Compact binary path encoding, sent as WebSocket binary frames.
+//
+//   0xA7                      magic
+//   version << 4 | flags      version 1, flags bit 0 = loop
+//   varint zigzag x, y        start cell
+//   tokens...                 varint (run << 4 | code)
+//     code 0-7                run unit steps E, NE, N, NW, W, SW, S, SE
+//     code 8                  jump, followed by varint zigzag dx, dy
+//     code 15, run 0          end of path
+//
+// Straight runs collapse into a single token, so the decoder reports one
+// waypoint per corner (or jump) with the number of cells travelled. A path
+// may be split across any number of frames.
+namespace PathFormat {
+  static const uint8_t MAGIC = 0xA7;
+  static const uint8_t VERSION = 1;
+  static const uint8_t FLAG_LOOP = 0x01;
+  static const uint8_t CODE_JUMP = 8;
+  static const uint8_t CODE_END = 15;
+}
+
+class PathDecoder {
+public:
+  enum WaypointFlags : uint8_t {
+    WAYPOINT_START = 0x01,   // Start cell of a new path
+    WAYPOINT_END = 0x02,     // Path complete (repeats the final cell, steps 0)
+    WAYPOINT_LOOP = 0x04     // Path should be repeated
+  };
+
+  struct Waypoint {
+    int32_t x;
+    int32_t y;
+    uint32_t steps;          // Cells from the previous waypoint
+    uint16_t index;
+    uint8_t flags;
+  };
+
+  typedef std::function<void(const Waypoint& waypoint)> Handler;
+
+  enum State : uint8_t { STATE_IDLE, STATE_DECODING, STATE_DONE, STATE_ERROR };
+
+  void setHandler(Handler handler) { this->handler = handler; }
+  void reset();
+
+  // Consumes bytes until the path ends or the data is invalid. Returns the
+  // number of bytes used; the rest of the buffer is not part of this path.
+  size_t feed(const uint8_t* data, size_t length);
+
+  State getState() const { return state; }
+  bool decoding() const { return state == STATE_DECODING; }
+  uint16_t waypointCount() const { return index; }
+
+private:
+  enum Field : uint8_t { F_MAGIC, F_HEADER, F_START_X, F_START_Y, F_TOKEN, F_JUMP_X, F_JUMP_Y };
+
+  Handler handler;
+  State state = STATE_IDLE;
+  Field field = F_MAGIC;
+  uint8_t pathFlags = 0;
+  uint8_t varintShift = 0;
+  uint32_t varint = 0;
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t jumpDx = 0;
+  uint16_t index = 0;
+
+  void emit(uint32_t steps, uint8_t flags);
+  bool token(uint32_t value);
+};
+
+// Builds an encoded path into a caller buffer. Consecutive points on the
+// same unit direction are merged into one run.
+class PathEncoder {
+public:
+  PathEncoder(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+  bool begin(int32_t x, int32_t y, bool loop = false);
+  bool add(int32_t x, int32_t y);
+
+  // Flushes the pending run and the end token; returns the size, 0 on overflow
+  size_t finish();
+
+private:
+  uint8_t* buffer;
+  size_t capacity;
+  size_t length = 0;
+  bool overflow = false;
+  int32_t x = 0;
+  int32_t y = 0;
+  int8_t runCode = -1;
+  uint32_t run = 0;
+
+  void put(uint8_t byte);
+  void putVarint(uint32_t value);
+  void flushRun();
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
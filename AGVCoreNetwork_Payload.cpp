@@ -0,0 +1,78 @@
+#include "AGVCoreNetwork_Payload.h"
+
+using namespace AGVCoreNetworkLib;
+
+PayloadPool::~PayloadPool() {
+  for (uint8_t i = 0; i < AGVNET_PAYLOAD_BUFFERS; i++) free(buffers[i]);
+}
+
+PayloadPool::Buffer* PayloadPool::acquire() {
+  for (uint8_t i = 0; i < AGVNET_PAYLOAD_BUFFERS; i++) {
+    if (busy[i]) continue;
+    if (!buffers[i]) {
+      buffers[i] = (Buffer*)malloc(sizeof(Buffer));
+      if (!buffers[i]) break;
+    }
+    busy[i] = true;
+    buffers[i]->length = 0;
+    stats.acquired++;
+    return buffers[i];
+  }
+  stats.exhausted++;
+  return nullptr;
+}
+
+void PayloadPool::release(Buffer* buffer) {
+  for (uint8_t i = 0; i < AGVNET_PAYLOAD_BUFFERS; i++) {
+    if (buffers[i] == buffer) busy[i] = false;
+  }
+}
+
+uint8_t PayloadPool::inUse() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < AGVNET_PAYLOAD_BUFFERS; i++) n += busy[i];
+  return n;
+}
+
+bool PayloadAssembler::start(PayloadPool& from) {
+  release();
+  pool = &from;
+  buffer = from.acquire();
+  started = true;
+  overflow = false;
+  return buffer != nullptr;
+}
+
+void PayloadAssembler::append(const void* data, size_t length) {
+  if (!started || !buffer || overflow) return;
+
+  if (length > AGVNET_PAYLOAD_MAX - buffer->length) {
+    overflow = true;
+    return;
+  }
+  memcpy(buffer->data + buffer->length, data, length);
+  buffer->length += length;
+}
+
+PayloadAssembler::Result PayloadAssembler::finish(const char*& data, size_t& length) {
+  data = nullptr;
+  length = 0;
+  started = false;
+  if (!buffer) return ASSEMBLE_NO_BUFFER;
+  if (overflow) {
+    pool->countOverflow();
+    return ASSEMBLE_OVERFLOW;
+  }
+
+  buffer->data[buffer->length] = '\0';
+  data = buffer->data;
+  length = buffer->length;
+  return ASSEMBLE_OK;
+}
+
+void PayloadAssembler::release() {
+  if (buffer) pool->release(buffer);
+  buffer = nullptr;
+  started = false;
+  overflow = false;
+}
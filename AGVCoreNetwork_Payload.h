@@ -0,0 +1,83 @@
+#ifndef AGVCORENETWORK_PAYLOAD_H
+#define AGVCORENETWORK_PAYLOAD_H
+
+#include <Arduino.h>
+
+// Longest command payload reassembled from WebSocket fragments or serial
+// lines, and how many can be in flight at once (buffers are allocated on
+// first use and then kept)
+#ifndef AGVNET_PAYLOAD_MAX
+#define AGVNET_PAYLOAD_MAX 4096
+#endif
+
+#ifndef AGVNET_PAYLOAD_BUFFERS
+#define AGVNET_PAYLOAD_BUFFERS 4
+#endif
+
+namespace AGVCoreNetworkLib {
+
+// Fixed pool of payload buffers shared by every command source. Used from
+// the network task only.
+class PayloadPool {
+public:
+  struct Buffer {
+    size_t length;
+    char data[AGVNET_PAYLOAD_MAX + 1];   // NUL-terminated for C-string users
+  };
+
+  struct Stats {
+    uint32_t acquired = 0;
+    uint32_t exhausted = 0;     // acquire() found every buffer busy
+    uint32_t overflows = 0;     // Payloads refused for exceeding the maximum
+  };
+
+  ~PayloadPool();
+
+  Buffer* acquire();            // nullptr when exhausted or out of memory
+  void release(Buffer* buffer);
+  uint8_t inUse() const;
+
+  const Stats& getStats() const { return stats; }
+  void countOverflow() { stats.overflows++; }
+
+private:
+  Buffer* buffers[AGVNET_PAYLOAD_BUFFERS] = {};
+  bool busy[AGVNET_PAYLOAD_BUFFERS] = {};
+  Stats stats;
+};
+
+// Collects one payload from consecutive pieces into a pooled buffer. Once
+// it overflows, further pieces are dropped until finish(), so a sender's
+// oversize message costs no more memory than a maximal one.
+class PayloadAssembler {
+public:
+  enum Result : uint8_t {
+    ASSEMBLE_OK,
+    ASSEMBLE_OVERFLOW,          // Longer than AGVNET_PAYLOAD_MAX
+    ASSEMBLE_NO_BUFFER          // Pool exhausted when the payload started
+  };
+
+  ~PayloadAssembler() { release(); }
+
+  // Starts a payload (dropping any unfinished one); false without a buffer,
+  // in which case the pieces are still accepted and finish() says ASSEMBLE_NO_BUFFER
+  bool start(PayloadPool& pool);
+  bool active() const { return started; }
+  size_t length() const { return buffer ? buffer->length : 0; }
+
+  void append(const void* data, size_t length);
+
+  // The view stays valid until release() or the next start()
+  Result finish(const char*& data, size_t& length);
+  void release();
+
+private:
+  PayloadPool* pool = nullptr;
+  PayloadPool::Buffer* buffer = nullptr;
+  bool started = false;
+  bool overflow = false;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
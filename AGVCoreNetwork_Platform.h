@@ -0,0 +1,107 @@
+#ifndef AGVCORENETWORK_PLATFORM_H
+#define AGVCORENETWORK_PLATFORM_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include "AGVCoreNetwork_Boot.h"
+#include "AGVCoreNetwork_Link.h"
+
+// Compile-time platform policies of AGVCoreNetwork. The core only reaches the
+// clock, persistent storage and radio power settings through these static
+// interfaces, so the embedded build inlines straight to the ESP-IDF calls. A
+// simulation build defines AGVNET_CLOCK, AGVNET_STORAGE and/or AGVNET_LINK to
+// its own classes with the same static members before including
+// AGVCoreNetwork.h.
+#ifndef AGVNET_CLOCK
+#define AGVNET_CLOCK AGVCoreNetworkLib::EspClock
+#endif
+
+#ifndef AGVNET_STORAGE
+#define AGVNET_STORAGE AGVCoreNetworkLib::NvsStorage
+#endif
+
+#ifndef AGVNET_LINK
+#define AGVNET_LINK AGVCoreNetworkLib::EspLink
+#endif
+
+// Define as 0 to drop the global agvNetwork and declare instances yourself
+#ifndef AGVNET_DEFAULT_INSTANCE
+#define AGVNET_DEFAULT_INSTANCE 1
+#endif
+
+namespace AGVCoreNetworkLib {
+
+struct EspClock {
+  static uint32_t ms() { return millis(); }
+  static uint32_t us() { return micros(); }           // Wraps after ~71 minutes
+  static int64_t timeUs() { return esp_timer_get_time(); }
+};
+
+// WiFi credentials, the fast-boot cache and the OTA failed-boot count in NVS, one namespace per instance
+struct NvsStorage {
+  static void loadCredentials(const char* ns, String& ssid, String& password) {
+    Preferences prefs;
+    prefs.begin(ns, true);
+    ssid = prefs.getString("ssid", "");
+    password = prefs.getString("password", "");
+    prefs.end();
+  }
+
+  static void saveCredentials(const char* ns, const String& ssid, const String& password) {
+    Preferences prefs;
+    prefs.begin(ns, false);
+    prefs.putString("ssid", ssid);
+    prefs.putString("password", password);
+    prefs.end();
+  }
+
+  static bool loadBootCache(const char* ns, BootCache& cache) {
+    Preferences prefs;
+    prefs.begin(ns, true);
+    bool found = prefs.getBytes("boot", &cache, sizeof(cache)) == sizeof(cache);
+    prefs.end();
+    if (!found) cache = BootCache();
+    return found;
+  }
+
+  static void saveBootCache(const char* ns, const BootCache& cache) {
+    Preferences prefs;
+    prefs.begin(ns, false);
+    prefs.putBytes("boot", &cache, sizeof(cache));
+    prefs.end();
+  }
+
+  // Boots of an unconfirmed image that could not reach the network
+  static uint8_t loadFailedBoots(const char* ns) {
+    Preferences prefs;
+    prefs.begin(ns, true);
+    uint8_t count = prefs.getUChar("otafail", 0);
+    prefs.end();
+    return count;
+  }
+
+  static void saveFailedBoots(const char* ns, uint8_t count) {
+    Preferences prefs;
+    prefs.begin(ns, false);
+    prefs.putUChar("otafail", count);
+    prefs.end();
+  }
+};
+
+// Station power save through the Arduino WiFi layer
+struct EspLink {
+  static bool applyProfile(LinkProfile profile) {
+    switch (profile) {
+      case LINK_LOW_LATENCY: return WiFi.setSleep(WIFI_PS_NONE);
+      case LINK_BALANCED:    return WiFi.setSleep(WIFI_PS_MIN_MODEM);
+      case LINK_POWER_SAVE:  return WiFi.setSleep(WIFI_PS_MAX_MODEM);
+      default:               return false;
+    }
+  }
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
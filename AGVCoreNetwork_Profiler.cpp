@@ -0,0 +1,27 @@
+#include "AGVCoreNetwork_Profiler.h"
+
+using namespace AGVCoreNetworkLib;
+
+void TaskProfiler::start(uint32_t nowUs) {
+  accum = TaskProfile();
+  windowStart = nowUs;
+}
+
+bool TaskProfiler::loopEnd(uint32_t loopStartUs, uint32_t loopEndUs, TaskProfile& completed) {
+  uint32_t loopUs = loopEndUs - loopStartUs;
+  accum.busyUs += loopUs;
+  accum.loops++;
+  if (loopUs > accum.maxLoopUs) accum.maxLoopUs = loopUs;
+
+  uint32_t elapsed = loopEndUs - windowStart;
+  if (elapsed < windowUs) return false;
+
+  // Close the window and start accumulating the next one
+  accum.windowUs = elapsed;
+  accum.cpuPercent = (uint8_t)((uint64_t)accum.busyUs * 100 / elapsed);
+  completed = accum;
+
+  accum = TaskProfile();
+  windowStart = loopEndUs;
+  return true;
+}
@@ -0,0 +1,61 @@
+#ifndef AGVCORENETWORK_PROFILER_H
+#define AGVCORENETWORK_PROFILER_H
+
+#include <Arduino.h>
+
+namespace AGVCoreNetworkLib {
+
+// Subsystems timed by the task profiler
+enum Subsystem : uint8_t {
+  SUBSYS_HTTP = 0,
+  SUBSYS_WS,
+  SUBSYS_DNS,
+  SUBSYS_SERIAL,
+  SUBSYS_TRANSPORT,
+  SUBSYS_ASYNC,
+  SUBSYS_COUNT
+};
+
+// One completed profiler sample window of a task
+struct TaskProfile {
+  uint32_t windowUs = 0;                  // Length of the sample window
+  uint32_t busyUs = 0;                    // Time spent in subsystems
+  uint32_t subsystemUs[SUBSYS_COUNT] = {};
+  uint32_t maxLoopUs = 0;                 // Longest single loop iteration
+  uint32_t loops = 0;                     // Loop iterations in the window
+  uint32_t stackHighWater = 0;            // Lowest free stack seen (bytes)
+  uint8_t cpuPercent = 0;                 // busyUs relative to windowUs
+};
+
+// Accounts the time a polling task spends per subsystem. The task brackets
+// each subsystem with section() and ends every iteration with loopEnd(),
+// which closes the sample window once it is long enough. Times are passed in
+// (wrapping microseconds), so the profiler has no clock or RTOS dependency;
+// the stack high-water mark is filled in by the caller. Used from the
+// profiled task only.
+class TaskProfiler {
+public:
+  void setWindow(uint32_t windowUs) { this->windowUs = windowUs ? windowUs : 1000000; }
+  uint32_t getWindow() const { return windowUs; }
+
+  void start(uint32_t nowUs);
+
+  // Adds the time since 'startUs' to the subsystem; returns 'nowUs' as the
+  // start of the next section
+  uint32_t section(Subsystem subsystem, uint32_t startUs, uint32_t nowUs) {
+    accum.subsystemUs[subsystem] += nowUs - startUs;
+    return nowUs;
+  }
+
+  // True when this iteration closed a window; 'completed' then holds it
+  bool loopEnd(uint32_t loopStartUs, uint32_t loopEndUs, TaskProfile& completed);
+
+private:
+  uint32_t windowUs = 1000000;
+  uint32_t windowStart = 0;
+  TaskProfile accum;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,118 @@
+#include "AGVCoreNetwork_Recorder.h"
+#include <esp_timer.h>
+
+using namespace AGVCoreNetworkLib;
+
+static_assert(sizeof(FlightRecorder::Record) == 80, "Flight record layout changed");
+static_assert(sizeof(FlightRecorder::DumpHeader) == 16, "Flight dump header layout changed");
+
+void FlightRecorder::record(RecordType type, uint8_t source, const void* data, size_t length) {
+  if (!enabled) return;
+
+  uint64_t now = esp_timer_get_time();
+  size_t copyLength = length < PAYLOAD_SIZE ? length : PAYLOAD_SIZE;
+
+  portENTER_CRITICAL(&lock);
+  Record& r = ring[next % AGVNET_RECORDER_CAPACITY];
+  r.timestampUs = now;
+  r.seq = next++;
+  r.type = type;
+  r.source = source;
+  r.length = (uint8_t)copyLength;
+  r.flags = length > PAYLOAD_SIZE ? FLAG_TRUNCATED : 0;
+  if (copyLength) memcpy(r.payload, data, copyLength);
+  portEXIT_CRITICAL(&lock);
+}
+
+void FlightRecorder::recordStream(RecordType type, uint8_t source, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  do {
+    size_t chunk = length < PAYLOAD_SIZE ? length : PAYLOAD_SIZE;
+    record(type, source, bytes, chunk);
+    bytes += chunk;
+    length -= chunk;
+  } while (length > 0);
+}
+
+void FlightRecorder::clear() {
+  portENTER_CRITICAL(&lock);
+  next = 0;
+  portEXIT_CRITICAL(&lock);
+}
+
+uint32_t FlightRecorder::oldestSeq() {
+  portENTER_CRITICAL(&lock);
+  uint32_t oldest = next > AGVNET_RECORDER_CAPACITY ? next - AGVNET_RECORDER_CAPACITY : 0;
+  portEXIT_CRITICAL(&lock);
+  return oldest;
+}
+
+uint32_t FlightRecorder::nextSeq() {
+  portENTER_CRITICAL(&lock);
+  uint32_t n = next;
+  portEXIT_CRITICAL(&lock);
+  return n;
+}
+
+size_t FlightRecorder::copyRecords(uint32_t& fromSeq, Record* out, size_t max) {
+  size_t copied = 0;
+
+  portENTER_CRITICAL(&lock);
+  uint32_t oldest = next > AGVNET_RECORDER_CAPACITY ? next - AGVNET_RECORDER_CAPACITY : 0;
+  if (fromSeq < oldest) fromSeq = oldest;
+  while (fromSeq < next && copied < max) {
+    out[copied++] = ring[fromSeq % AGVNET_RECORDER_CAPACITY];
+    fromSeq++;
+  }
+  portEXIT_CRITICAL(&lock);
+
+  return copied;
+}
+
+bool FlightReplayer::start(const uint8_t* dump, size_t length, uint16_t speedPercent) {
+  FlightRecorder::DumpHeader header;
+  if (!dump || length < sizeof(header)) return false;
+
+  memcpy(&header, dump, sizeof(header));
+  if (memcmp(header.magic, "AGVR", 4) != 0 ||
+      header.version != FlightRecorder::DUMP_VERSION ||
+      header.recordSize != sizeof(FlightRecorder::Record) ||
+      length < sizeof(header) + (size_t)header.count * sizeof(FlightRecorder::Record)) {
+    return false;
+  }
+
+  stop();
+  count = header.count;
+  index = 0;
+  this->speedPercent = speedPercent;
+  startUs = esp_timer_get_time();
+
+  if (count > 0) {
+    FlightRecorder::Record first;
+    memcpy(&first, dump + sizeof(header), sizeof(first));
+    firstTimestampUs = first.timestampUs;
+  }
+  data.store(dump + sizeof(header), std::memory_order_release);
+  return true;
+}
+
+bool FlightReplayer::nextDue(int64_t nowUs, FlightRecorder::Record& out) {
+  const uint8_t* records = data.load(std::memory_order_acquire);
+  if (!records) return false;
+
+  if (index >= count) {
+    stop();
+    return false;
+  }
+
+  // Records may be unaligned inside the dump buffer
+  memcpy(&out, records + (size_t)index * sizeof(FlightRecorder::Record), sizeof(out));
+
+  if (speedPercent > 0) {
+    uint64_t offsetUs = (out.timestampUs - firstTimestampUs) * 100 / speedPercent;
+    if ((uint64_t)(nowUs - startUs) < offsetUs) return false;
+  }
+
+  index++;
+  return true;
+}
@@ -0,0 +1,106 @@
+#ifndef AGVCORENETWORK_RECORDER_H
+#define AGVCORENETWORK_RECORDER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <atomic>
+
+// Number of records kept in RAM (80 bytes each)
+#ifndef AGVNET_RECORDER_CAPACITY
+#define AGVNET_RECORDER_CAPACITY 128
+#endif
+
+namespace AGVCoreNetworkLib {
+
+// In-memory flight recorder: a fixed ring of compact binary records covering
+// inbound commands, status broadcasts, emergency transitions and connection
+// events. Safe to call from both cores.
+class FlightRecorder {
+public:
+  enum RecordType : uint8_t {
+    REC_WS_COMMAND = 1,
+    REC_WS_CONTROL,
+    REC_SERIAL_COMMAND,
+    REC_HTTP_COMMAND,
+    REC_STATUS,
+    REC_EMERGENCY_SET,
+    REC_EMERGENCY_CLEAR,
+    REC_CLIENT_CONNECT,
+    REC_CLIENT_DISCONNECT,
+    REC_TRANSPORT_COMMAND,
+    REC_PATH_FRAME
+  };
+
+  static const uint8_t FLAG_TRUNCATED = 0x01;
+  static const size_t PAYLOAD_SIZE = 64;    // A whole command (CommandFilter::MAX_COMMAND)
+
+  // On-wire and in-memory record layout (little endian, 80 bytes)
+  struct Record {
+    uint64_t timestampUs;   // esp_timer time since boot
+    uint32_t seq;           // Monotonic record number
+    uint8_t type;           // RecordType
+    uint8_t source;         // WebSocket client number, 0 otherwise
+    uint8_t length;         // Valid payload bytes
+    uint8_t flags;
+    char payload[PAYLOAD_SIZE];
+  };
+
+  // Dump header, followed by 'count' records oldest first
+  struct DumpHeader {
+    char magic[4];          // "AGVR"
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    uint32_t firstSeq;
+  };
+
+  static const uint16_t DUMP_VERSION = 2;
+
+  void record(RecordType type, uint8_t source, const void* data, size_t length);
+
+  // Records a byte stream whose consumer accepts it split anywhere (binary
+  // path frames) as consecutive records, so nothing is truncated
+  void recordStream(RecordType type, uint8_t source, const void* data, size_t length);
+  void setEnabled(bool enabled) { this->enabled = enabled; }
+  void clear();
+
+  // Sequence range currently held: [oldestSeq(), nextSeq())
+  uint32_t oldestSeq();
+  uint32_t nextSeq();
+
+  // Copies up to 'max' records starting at 'fromSeq' (clamped to the oldest
+  // record still held). Returns the number copied and advances fromSeq.
+  size_t copyRecords(uint32_t& fromSeq, Record* out, size_t max);
+
+private:
+  Record ring[AGVNET_RECORDER_CAPACITY];
+  uint32_t next = 0;
+  bool enabled = true;
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Feeds a recorder dump back at its original pacing, scaled by speedPercent
+// (100 = real time, 400 = four times faster, 0 = as fast as possible).
+// start() may run on the other core from nextDue(); the dump is published
+// only once the rest of the state is set.
+class FlightReplayer {
+public:
+  bool start(const uint8_t* dump, size_t length, uint16_t speedPercent = 100);
+  void stop() { data.store(nullptr, std::memory_order_release); }
+  bool active() const { return data.load(std::memory_order_acquire) != nullptr; }
+
+  // Returns the next record whose scheduled time has passed
+  bool nextDue(int64_t nowUs, FlightRecorder::Record& out);
+
+private:
+  std::atomic<const uint8_t*> data{nullptr};
+  uint32_t count = 0;
+  uint32_t index = 0;
+  uint16_t speedPercent = 100;
+  int64_t startUs = 0;
+  uint64_t firstTimestampUs = 0;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -139,7 +139,13 @@ const char wifiSetupPage[] PROGMEM = R"rawliteral(
             message.style.display = 'none';
             
             try {
-                const response = await fetch('/scan', {timeout: 10000});
+                // The scan runs in the background; poll until results are ready
+                let response = await fetch('/scan');
+                for (let i = 0; response.status === 202 && i < 20; i++) {
+                    await new Promise(resolve => setTimeout(resolve, 1000));
+                    response = await fetch('/scan');
+                }
+                if (!response.ok) throw new Error('Scan timed out');
                 const networks = await response.json();
                 
                 ssidSelect.innerHTML = '<option value="">-- Select WiFi Network --</option>';
@@ -271,8 +277,10 @@ const char mainPage[] PROGMEM = R"rawliteral(
         .clear-logs{background:#95a5a6;color:white;border:none;padding:5px 15px;border-radius:5px;cursor:pointer;transition:background 0.3s}
         .clear-logs:hover{background:#7f8c8d}
         
-        .log-container{max-height:300px;overflow-y:auto;background:#2c3e50;color:#ecf0f1;font-family:monospace;padding:15px;border-radius:8px;font-size:0.95em}
-        .log-entry{margin-bottom:5px;padding:5px 0;border-bottom:1px solid #34495e}
+        .log-container{height:300px;overflow-y:auto;position:relative;background:#2c3e50;color:#ecf0f1;font-family:monospace;padding:0 15px;border-radius:8px;font-size:0.95em}
+        .log-spacer{position:relative}
+        .log-rows{position:absolute;left:0;right:0;top:0;will-change:transform}
+        .log-entry{height:28px;line-height:27px;white-space:nowrap;overflow:hidden;text-overflow:ellipsis;border-bottom:1px solid #34495e}
         .log-timestamp{color:#3498db;font-weight:bold;margin-right:10px}
         .log-serial{color:#2ecc71}
         .log-web{color:#3498db}
@@ -305,6 +313,7 @@ const char mainPage[] PROGMEM = R"rawliteral(
                 <span class="status-indicator" id="connectionIndicator"></span>
                 <span id="connectionText">Connecting...</span>
             </div>
+            <div id="agvStatusText" style="font-size:0.9em;opacity:0.85;"></div>
             <div class="emergency-status" id="emergencyStatus" style="display:none;">
                 ⚠️ EMERGENCY STOP ACTIVE
             </div>
@@ -315,6 +324,12 @@ const char mainPage[] PROGMEM = R"rawliteral(
             <div class="card">
                 <div class="card-header">
                     <div class="card-title"><span class="card-icon">🔄</span> Movement Controls</div>
+                    <button class="clear-logs" id="leaseButton" onclick="toggleControl()">Take control</button>
+                </div>
+                <div id="handoverPrompt" style="display:none;margin-top:10px;padding:10px;background:#fff8e1;border-radius:8px;font-size:0.9em;">
+                    <span id="handoverText"></span>
+                    <button class="clear-logs" onclick="answerHandover(true)">Hand over</button>
+                    <button class="clear-logs" onclick="answerHandover(false)">Keep control</button>
                 </div>
                 <div class="btn-group">
                     <button class="btn btn-success" onclick="sendCommand('move forward')">
@@ -362,7 +377,7 @@ const char mainPage[] PROGMEM = R"rawliteral(
                 <button class="clear-logs" onclick="clearLogs()">Clear Logs</button>
             </div>
             <div class="log-container" id="logContainer">
-                <div class="log-entry"><span class="log-timestamp">[00:00:00]</span> <span class="log-web">System initialized - Ready for commands</span></div>
+                <div class="log-spacer" id="logSpacer"><div class="log-rows" id="logRows"></div></div>
             </div>
         </div>
         
@@ -376,7 +391,12 @@ const char mainPage[] PROGMEM = R"rawliteral(
         let ws;
         let isConnected = false;
         let systemEmergency = false;
-        let logEntries = [];
+        let agvStatus = {};
+        let myClient = -1;
+        let leaseTimer = null;
+        let leaseRetry = null;
+        let leaseAttempts = 0;
+        let haveControl = false;
         
         function checkAuth() {
             const token = localStorage.getItem('token');
@@ -390,19 +410,71 @@ const char mainPage[] PROGMEM = R"rawliteral(
             window.location.href = '/';
         }
         
+        // Compressed log stream (see AGVCoreNetwork_Compress.h); the dictionary
+        // must match StreamCompressor::DICTIONARY byte for byte
+        const COMPRESS_DICTIONARY =
+                '{"delta":{"emergency":1,"connected":0,"mode":"station","rssi":-' +
+                '"clients":"pollClients":"serialPending":"lease":-1,"lastCommand":"' +
+                '"reason":""}}SYSTEM_EMERGENCY: Emergency cleared AGV Ready - Idle ' +
+                'turnaround turn_left 90 turn_right 90 move forward STOP ABORT START PAUSE ' +
+                'RESUME PATH:MOVE:NACK: ACK: SERIAL: Executing: WS: ';
+        const COMPRESS_WINDOW = 1024;
+        let compressHistory = null;
+        
+        // Last log-stream event seen; survives reconnects so RESUME only
+        // returns what was missed (0 = everything the vehicle still holds)
+        let lastEventId = 0;
+        
+        function decompressFrame(buffer) {
+            const src = new Uint8Array(buffer);
+            if (!compressHistory || src[0] !== 0xC7) return null;
+            
+            const out = new Uint8Array(compressHistory.length + src.length * 43);
+            out.set(compressHistory);
+            const start = compressHistory.length;
+            let n = start;
+            let i = 1;
+            while (i < src.length) {
+                const token = src[i++];
+                if (token < 0x80) {
+                    out.set(src.subarray(i, i + token + 1), n);
+                    n += token + 1;
+                    i += token + 1;
+                } else {
+                    const length = (token & 0x7F) + 3;
+                    const distance = src[i] | (src[i + 1] << 8);
+                    i += 2;
+                    for (let k = 0; k < length; k++, n++) out[n] = out[n - distance];
+                }
+            }
+            compressHistory = out.slice(Math.max(0, n - COMPRESS_WINDOW), n);
+            return new TextDecoder().decode(out.subarray(start, n));
+        }
+        
         function connectWebSocket() {
+            // The WebSocket listens one port above the page (81 by default)
             const host = window.location.hostname;
-            ws = new WebSocket(`ws://${host}:81`);
+            const wsPort = Number(window.location.port || 80) + 1;
+            ws = new WebSocket(`ws://${host}:${wsPort}`);
+            ws.binaryType = 'arraybuffer';
+            compressHistory = null;
             
             ws.onopen = function() {
                 isConnected = true;
                 updateConnectionStatus(true);
                 addLog('✅ Connected to AGV', 'system');
-                requestSystemStatus();
+                ws.send('COMPRESS:ON');
+                ws.send('RESUME:' + lastEventId);
+                subscribeStatus();
             };
             
             ws.onclose = function() {
                 isConnected = false;
+                stopLeaseHeartbeat();
+                cancelLeaseRequest();
+                haveControl = false;
+                showHandoverPrompt(null);
+                updateLeaseButton();
                 updateConnectionStatus(false);
                 addLog('🔌 Disconnected from AGV', 'system');
                 setTimeout(connectWebSocket, 3000);
@@ -414,11 +486,50 @@ const char mainPage[] PROGMEM = R"rawliteral(
             };
             
             ws.onmessage = function(event) {
-                const message = event.data.trim();
-                processMessage(message);
+                let message = event.data;
+                if (typeof message !== 'string') {
+                    message = decompressFrame(message);
+                    if (message === null) return;
+                } else if (message === 'COMPRESS:ON') {
+                    compressHistory = new TextEncoder().encode(COMPRESS_DICTIONARY);
+                    return;
+                }
+                if (message.startsWith('HISTORY:')) {
+                    handleHistory(message);
+                    return;
+                }
+                processMessage(stripEventId(message).trim());
             };
         }
         
+        // "#<id> text" - remember the id, return the text
+        function stripEventId(message) {
+            const match = /^#(\d+) /.exec(message);
+            if (!match) return message;
+            lastEventId = Number(match[1]);
+            return message.substring(match[0].length);
+        }
+        
+        // Catch-up after (re)connecting: "HISTORY:<count>:<last>" followed by
+        // one "#<id> text" line per missed event, or "HISTORY:SNAPSHOT:<last>"
+        // when too much was missed (the status snapshot follows)
+        function handleHistory(message) {
+            const lines = message.split('\n');
+            const header = lines[0].split(':');
+            if (header[1] === 'SNAPSHOT') {
+                lastEventId = Number(header[2]);
+                addLog('⚠️ Missed events while disconnected - showing current state', 'system');
+                return;
+            }
+            if (lines.length > 1) {
+                addLog(`📜 ${lines.length - 1} event(s) while disconnected:`, 'system');
+            }
+            for (let i = 1; i < lines.length; i++) {
+                processMessage(stripEventId(lines[i]));
+            }
+            if (header.length > 2) lastEventId = Number(header[2]);
+        }
+        
         function updateConnectionStatus(connected) {
             const indicator = document.getElementById('connectionIndicator');
             const text = document.getElementById('connectionText');
@@ -426,8 +537,6 @@ const char mainPage[] PROGMEM = R"rawliteral(
             if (connected) {
                 indicator.className = 'status-indicator connected';
                 text.textContent = 'Connected to AGV';
-                // Request status update on reconnection
-                setTimeout(requestSystemStatus, 1000);
             } else {
                 indicator.className = 'status-indicator';
                 text.textContent = 'Disconnected - Reconnecting...';
@@ -435,6 +544,21 @@ const char mainPage[] PROGMEM = R"rawliteral(
         }
         
         function processMessage(message) {
+            // Status snapshots and pushed deltas update the status bar, not the log
+            if (message.charAt(0) === '{') {
+                try {
+                    applyStatus(JSON.parse(message));
+                    return;
+                } catch (e) {
+                    // Not a status document - log it below
+                }
+            }
+            if (message === 'PONG') return;
+            if (message.startsWith('LEASE:')) {
+                handleLeaseMessage(message.substring(6));
+                return;
+            }
+            
             addLog(message, 'web');
             
             // Check for emergency status
@@ -452,6 +576,28 @@ const char mainPage[] PROGMEM = R"rawliteral(
             }
         }
         
+        function applyStatus(status) {
+            const fields = status.delta || status;
+            Object.assign(agvStatus, fields);
+            
+            if ('emergency' in fields) {
+                systemEmergency = !!agvStatus.emergency;
+                updateEmergencyStatus(systemEmergency);
+            }
+            
+            const parts = [];
+            if (agvStatus.mode) parts.push(agvStatus.mode.toUpperCase());
+            if (agvStatus.ip) parts.push(agvStatus.ip);
+            if (agvStatus.rssi) parts.push(`${agvStatus.rssi} dBm`);
+            if (agvStatus.clients !== undefined) parts.push(`${agvStatus.clients} client(s)`);
+            if (agvStatus.lease !== undefined) {
+                parts.push(agvStatus.lease < 0 ? 'Control: free' :
+                           agvStatus.lease === myClient ? 'Control: this dashboard' : `Control: client #${agvStatus.lease}`);
+            }
+            if (agvStatus.lastCommand) parts.push(`Last: ${agvStatus.lastCommand}`);
+            document.getElementById('agvStatusText').textContent = parts.join(' | ');
+        }
+        
         function updateEmergencyStatus(active) {
             const emergencyStatus = document.getElementById('emergencyStatus');
             if (active) {
@@ -463,41 +609,121 @@ const char mainPage[] PROGMEM = R"rawliteral(
             }
         }
         
+        // Log view: a fixed-capacity ring holds the entries and only the rows
+        // in view exist in the DOM; appends are drawn once per animation frame
+        const LOG_CAPACITY = 2000;
+        const LOG_ROW_HEIGHT = 28;          // Matches .log-entry height
+        
+        class LogRing {
+            constructor(capacity) {
+                this.capacity = capacity;
+                this.times = new Float64Array(capacity);
+                this.messages = new Array(capacity);
+                this.classes = new Array(capacity);
+                this.clear();
+            }
+            clear() {
+                this.start = 0;
+                this.length = 0;
+                this.dropped = 0;           // Oldest entries overwritten (for scroll anchoring)
+            }
+            push(time, message, cls) {
+                const i = (this.start + this.length) % this.capacity;
+                this.times[i] = time;
+                this.messages[i] = message;
+                this.classes[i] = cls;
+                if (this.length < this.capacity) this.length++;
+                else {
+                    this.start = (this.start + 1) % this.capacity;
+                    this.dropped++;
+                }
+            }
+            // Entry n counted from the oldest one held
+            at(n) {
+                const i = (this.start + n) % this.capacity;
+                return { time: this.times[i], message: this.messages[i], cls: this.classes[i] };
+            }
+        }
+        
+        // Rows to draw for a viewport: [first, first + count)
+        function visibleRange(scrollTop, viewHeight, length) {
+            const first = Math.max(0, Math.min(length - 1, Math.floor(scrollTop / LOG_ROW_HEIGHT)));
+            const count = Math.min(length - first, Math.ceil(viewHeight / LOG_ROW_HEIGHT) + 1);
+            return { first: first, count: Math.max(0, count) };
+        }
+        
+        const logRing = new LogRing(LOG_CAPACITY);
+        let logFramePending = false;
+        let logFollow = true;               // Stick to the newest entry
+        let logDroppedSeen = 0;
+        
+        function logClass(message, source) {
+            if (message.toLowerCase().includes('emergency')) return 'log-emergency';
+            if (source === 'serial') return 'log-serial';
+            if (source === 'web') return 'log-web';
+            return 'log-system';
+        }
+        
         function addLog(message, source = 'system') {
-            const now = new Date();
-            const timeStr = now.toLocaleTimeString();
-            const timestamp = `[${timeStr}]`;
-            
-            const logContainer = document.getElementById('logContainer');
-            const logEntry = document.createElement('div');
-            logEntry.className = 'log-entry';
+            logRing.push(Date.now(), String(message), logClass(message, source));
+            scheduleLogRender();
+        }
+        
+        function scheduleLogRender() {
+            if (logFramePending) return;
+            logFramePending = true;
+            requestAnimationFrame(renderLog);
+        }
+        
+        function renderLog() {
+            logFramePending = false;
+            const container = document.getElementById('logContainer');
+            const spacer = document.getElementById('logSpacer');
+            const rows = document.getElementById('logRows');
             
-            let sourceClass = 'log-system';
-            if (source === 'serial') sourceClass = 'log-serial';
-            if (source === 'web') sourceClass = 'log-web';
-            if (message.toLowerCase().includes('emergency')) sourceClass = 'log-emergency';
+            spacer.style.height = (logRing.length * LOG_ROW_HEIGHT) + 'px';
+            if (logFollow) {
+                container.scrollTop = container.scrollHeight;
+            } else if (logRing.dropped !== logDroppedSeen) {
+                // Keep the rows being read in place while old ones fall off
+                container.scrollTop -= (logRing.dropped - logDroppedSeen) * LOG_ROW_HEIGHT;
+            }
+            logDroppedSeen = logRing.dropped;
             
-            logEntry.innerHTML = `<span class="log-timestamp">${timestamp}</span> <span class="${sourceClass}">${message}</span>`;
-            logContainer.appendChild(logEntry);
-            logContainer.scrollTop = logContainer.scrollHeight;
+            const range = visibleRange(container.scrollTop, container.clientHeight, logRing.length);
+            rows.style.transform = `translateY(${range.first * LOG_ROW_HEIGHT}px)`;
             
-            // Store in array for clearing
-            logEntries.push({
-                timestamp: timeStr,
-                message: message,
-                source: source
-            });
+            // Reuse row nodes; text goes in via textContent, never as markup
+            while (rows.childNodes.length < range.count) {
+                const row = document.createElement('div');
+                row.className = 'log-entry';
+                const time = document.createElement('span');
+                time.className = 'log-timestamp';
+                row.appendChild(time);
+                row.appendChild(document.createElement('span'));
+                rows.appendChild(row);
+            }
+            while (rows.childNodes.length > range.count) rows.removeChild(rows.lastChild);
             
-            // Limit log entries to 100
-            if (logEntries.length > 100) {
-                logEntries.shift();
-                logContainer.removeChild(logContainer.firstChild);
+            for (let k = 0; k < range.count; k++) {
+                const entry = logRing.at(range.first + k);
+                const row = rows.childNodes[k];
+                row.firstChild.textContent = `[${new Date(entry.time).toLocaleTimeString()}]`;
+                row.lastChild.className = entry.cls;
+                row.lastChild.textContent = entry.message;
             }
         }
         
+        function onLogScroll() {
+            const container = document.getElementById('logContainer');
+            logFollow = container.scrollTop + container.clientHeight >= container.scrollHeight - LOG_ROW_HEIGHT;
+            scheduleLogRender();
+        }
+        
         function clearLogs() {
-            document.getElementById('logContainer').innerHTML = '';
-            logEntries = [];
+            logRing.clear();
+            logDroppedSeen = 0;
+            logFollow = true;
             addLog('Logs cleared by user', 'system');
         }
         
@@ -532,17 +758,124 @@ const char mainPage[] PROGMEM = R"rawliteral(
             sendCommand(command);
         }
         
-        function requestSystemStatus() {
+        // Motion lease: only the holder may send commands, renewed by heartbeat.
+        // Requested only when the operator asks for control; a request while
+        // another dashboard holds it is retried until answered.
+        const LEASE_RETRY_MS = 3000;
+        const LEASE_MAX_ATTEMPTS = 10;
+        
+        function toggleControl() {
+            if (!isConnected || !ws || ws.readyState !== WebSocket.OPEN) return;
+            if (haveControl) {
+                ws.send('LEASE:RELEASE');
+            } else if (leaseRetry) {
+                cancelLeaseRequest();
+                addLog('Control request cancelled', 'system');
+            } else {
+                leaseAttempts = 0;
+                requestLease();
+            }
+            updateLeaseButton();
+        }
+        
+        function requestLease() {
+            leaseRetry = null;
+            if (isConnected && ws && ws.readyState === WebSocket.OPEN) {
+                leaseAttempts++;
+                ws.send('LEASE:ACQUIRE');
+            }
+        }
+        
+        function cancelLeaseRequest() {
+            if (leaseRetry) clearTimeout(leaseRetry);
+            leaseRetry = null;
+        }
+        
+        function stopLeaseHeartbeat() {
+            if (leaseTimer) clearInterval(leaseTimer);
+            leaseTimer = null;
+        }
+        
+        function updateLeaseButton() {
+            document.getElementById('leaseButton').textContent =
+                haveControl ? 'Release control' : leaseRetry ? 'Cancel request' : 'Take control';
+        }
+        
+        // Non-blocking: the page keeps running (and renewing) while it is shown
+        function showHandoverPrompt(client) {
+            const prompt = document.getElementById('handoverPrompt');
+            if (client === null) {
+                prompt.style.display = 'none';
+                return;
+            }
+            document.getElementById('handoverText').textContent =
+                `Client #${client} requests control of the AGV.`;
+            prompt.style.display = 'block';
+        }
+        
+        function answerHandover(handOver) {
+            showHandoverPrompt(null);
+            if (ws && ws.readyState === WebSocket.OPEN) {
+                ws.send(handOver ? 'LEASE:RELEASE' : 'LEASE:DECLINE');
+            }
+        }
+        
+        function handleLeaseMessage(message) {
+            const parts = message.split(':');
+            if (parts[0] === 'GRANTED') {
+                myClient = parseInt(parts[1]);
+                const period = Math.max(500, parseInt(parts[2]) / 3);
+                cancelLeaseRequest();
+                stopLeaseHeartbeat();
+                haveControl = true;
+                leaseTimer = setInterval(() => {
+                    if (ws && ws.readyState === WebSocket.OPEN) ws.send('LEASE:RENEW');
+                }, period);
+                addLog('🎮 Control lease acquired', 'system');
+            } else if (parts[0] === 'WAIT') {
+                if (leaseAttempts === 1) {
+                    addLog(`👀 Client #${parts[1]} has control - handover requested`, 'system');
+                }
+                if (leaseAttempts < LEASE_MAX_ATTEMPTS) {
+                    leaseRetry = setTimeout(() => { requestLease(); updateLeaseButton(); }, LEASE_RETRY_MS);
+                } else {
+                    addLog('Control request not answered', 'system');
+                }
+            } else if (parts[0] === 'DECLINED') {
+                cancelLeaseRequest();
+                addLog('Control request declined by the current operator', 'system');
+            } else if (parts[0] === 'HANDOVER_REQUEST') {
+                if (haveControl) showHandoverPrompt(parts[1]);
+            } else if (parts[0] === 'LOST') {
+                stopLeaseHeartbeat();
+                haveControl = false;
+                showHandoverPrompt(null);
+                addLog('⚠️ Control lease lost - dashboard is read-only', 'system');
+            } else if (parts[0] === 'RELEASED') {
+                stopLeaseHeartbeat();
+                haveControl = false;
+                showHandoverPrompt(null);
+                addLog('Control released - dashboard is read-only', 'system');
+            } else if (parts[0] === 'DISABLED') {
+                cancelLeaseRequest();
+                document.getElementById('leaseButton').style.display = 'none';
+                addLog('Control lease is not enforced on this AGV', 'system');
+            }
+            updateLeaseButton();
+        }
+        
+        // Full snapshot on subscribe, then the AGV pushes only changed fields
+        function subscribeStatus() {
             if (isConnected && ws && ws.readyState === WebSocket.OPEN) {
-                ws.send('STATUS_REQUEST');
+                ws.send('SUBSCRIBE:status');
             }
         }
         
         // Initialize
         window.onload = function() {
+            document.getElementById('logContainer').addEventListener('scroll', onLogScroll, { passive: true });
             checkAuth();
             connectWebSocket();
-            setInterval(requestSystemStatus, 5000); // Request status every 5 seconds
             
             // Add initial log
             addLog('Intialized AGV Control Dashboard', 'system');
@@ -0,0 +1,162 @@
+#include "AGVCoreNetwork_Time.h"
+
+using namespace AGVCoreNetworkLib;
+
+// Clock synchronization
+
+void ClockSync::reset() {
+  next = 0;
+  count = 0;
+  minRtt = 0;
+  baseLocal = 0;
+  baseOffset = 0;
+  drift = 0;
+}
+
+void ClockSync::addSample(int64_t localSendUs, int64_t remoteUs, int64_t localReceiveUs) {
+  if (localReceiveUs < localSendUs) return;
+
+  Sample& s = window[next];
+  s.rtt = (uint32_t)(localReceiveUs - localSendUs);
+  s.local = localSendUs + s.rtt / 2;
+  s.offset = remoteUs - s.local;
+
+  next = (next + 1) % WINDOW;
+  if (count < WINDOW) count++;
+  fit();
+}
+
+void ClockSync::fit() {
+  minRtt = UINT32_MAX;
+  uint8_t best = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (window[i].rtt < minRtt) {
+      minRtt = window[i].rtt;
+      best = i;
+    }
+  }
+
+  // The slower half of the window carries mostly queueing noise
+  uint32_t sorted[WINDOW];
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t j = i;
+    for (; j > 0 && sorted[j - 1] > window[i].rtt; j--) sorted[j] = sorted[j - 1];
+    sorted[j] = window[i].rtt;
+  }
+  uint32_t limit = sorted[(count - 1) / 2];
+  double meanLocal = 0, meanOffset = 0;
+  int64_t first = window[best].local, last = first;
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (window[i].rtt > limit) continue;
+    if (window[i].local < first) first = window[i].local;
+    if (window[i].local > last) last = window[i].local;
+    meanLocal += (double)(window[i].local - window[best].local);
+    meanOffset += (double)(window[i].offset - window[best].offset);
+    n++;
+  }
+  meanLocal /= n;
+  meanOffset /= n;
+
+  double sxx = 0, sxy = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (window[i].rtt > limit) continue;
+    double dx = (double)(window[i].local - window[best].local) - meanLocal;
+    double dy = (double)(window[i].offset - window[best].offset) - meanOffset;
+    sxx += dx * dx;
+    sxy += dx * dy;
+  }
+
+  // Offset noise is about a millisecond, so drift is only meaningful once the
+  // samples span tens of seconds; until then assume none
+  drift = (n >= MIN_SAMPLES && last - first >= DRIFT_SPAN_US) ? sxy / sxx : 0;
+
+  // The line runs through the mean of the filtered samples
+  baseLocal = window[best].local + (int64_t)meanLocal;
+  baseOffset = window[best].offset + (int64_t)meanOffset;
+}
+
+int64_t ClockSync::toRemote(int64_t localUs) const {
+  return localUs + baseOffset + (int64_t)(drift * (double)(localUs - baseLocal));
+}
+
+int64_t ClockSync::toLocal(int64_t remoteUs) const {
+  // remote = local + baseOffset + drift * (local - baseLocal)
+  int64_t shifted = remoteUs - baseOffset - baseLocal;
+  return baseLocal + (int64_t)((double)shifted / (1.0 + drift));
+}
+
+// Timer wheel
+
+void TimerWheel::init() {
+  for (uint8_t i = 0; i < SLOTS; i++) slots[i] = -1;
+  for (uint8_t i = 0; i < CAPACITY; i++) entries[i].next = (i + 1 < CAPACITY) ? i + 1 : -1;
+  freeList = 0;
+  used = 0;
+  initialized = true;
+}
+
+void TimerWheel::clear() {
+  init();
+}
+
+bool TimerWheel::schedule(int64_t dueUs, uint8_t client, const char* command, uint32_t tag) {
+  if (!initialized) init();
+  if (freeList < 0) return false;
+
+  int8_t index = freeList;
+  Entry& e = entries[index];
+  freeList = e.next;
+
+  e.dueUs = dueUs;
+  e.tag = tag;
+  e.client = client;
+  strncpy(e.command, command, COMMAND_SIZE - 1);
+  e.command[COMMAND_SIZE - 1] = '\0';
+
+  // Ticks already passed are picked up by the next advance()
+  int64_t tick = dueUs / TICK_US;
+  if (lastTick >= 0 && tick < lastTick) tick = lastTick;
+  uint8_t slot = (uint8_t)(tick % SLOTS);
+  e.next = slots[slot];
+  slots[slot] = index;
+  used++;
+  return true;
+}
+
+void TimerWheel::releaseSlot(uint8_t slot, int64_t nowUs, const Handler& handler) {
+  int8_t* link = &slots[slot];
+  while (*link >= 0) {
+    int8_t index = *link;
+    Entry& e = entries[index];
+
+    if (e.dueUs > nowUs) {
+      link = &e.next;  // A later turn of the wheel
+      continue;
+    }
+
+    *link = e.next;
+    e.next = freeList;
+    freeList = index;
+    used--;
+
+    handler(e.client, e.command, e.tag, nowUs - e.dueUs);
+  }
+}
+
+void TimerWheel::advance(int64_t nowUs, const Handler& handler) {
+  if (!initialized) init();
+
+  int64_t tick = nowUs / TICK_US;
+  if (lastTick < 0) lastTick = tick;
+
+  if (used > 0) {
+    // The last tick is visited again for entries due later within it;
+    // after a long stall every slot is visited once
+    int64_t from = (tick - lastTick >= SLOTS) ? tick - SLOTS + 1 : lastTick;
+    for (int64_t t = from; t <= tick && used > 0; t++) {
+      releaseSlot((uint8_t)(t % SLOTS), nowUs, handler);
+    }
+  }
+  lastTick = tick;
+}
@@ -0,0 +1,96 @@
+#ifndef AGVCORENETWORK_TIME_H
+#define AGVCORENETWORK_TIME_H
+
+#include <Arduino.h>
+#include <functional>
+
+namespace AGVCoreNetworkLib {
+
+// Estimates a remote clock relative to the local one from request/response
+// exchanges: the local side sends its time t1, the remote answers with its
+// own time t2, and the reply arrives at t4. The offset is fitted over the
+// faster half of the samples (by round trip); a least-squares line through
+// them gives the drift once they span enough time.
+class ClockSync {
+public:
+  static const uint8_t WINDOW = 16;
+  static const uint8_t MIN_SAMPLES = 3;
+  static const int64_t DRIFT_SPAN_US = 30000000;
+
+  void reset();
+  void addSample(int64_t localSendUs, int64_t remoteUs, int64_t localReceiveUs);
+
+  bool synced() const { return count >= MIN_SAMPLES; }
+  uint8_t samples() const { return count; }
+
+  // Clock conversion using the fitted offset and drift
+  int64_t toLocal(int64_t remoteUs) const;
+  int64_t toRemote(int64_t localUs) const;
+
+  int64_t offsetUs(int64_t localUs) const { return toRemote(localUs) - localUs; }
+  uint32_t rttUs() const { return minRtt; }
+  int32_t driftPpb() const { return (int32_t)(drift * 1e9); }
+
+private:
+  struct Sample {
+    int64_t local;       // Midpoint of the exchange
+    int64_t offset;      // remote - local at that point
+    uint32_t rtt;
+  };
+
+  Sample window[WINDOW];
+  uint8_t next = 0;
+  uint8_t count = 0;
+  uint32_t minRtt = 0;
+
+  int64_t baseLocal = 0;
+  int64_t baseOffset = 0;
+  double drift = 0;
+
+  void fit();
+};
+
+// Hashed timer wheel for commands with an execute-at time. Insertion is
+// O(1); each tick only looks at the entries hashed to its slot.
+class TimerWheel {
+public:
+  static const uint8_t SLOTS = 64;
+  static const uint32_t TICK_US = 1000;
+  static const uint8_t CAPACITY = 16;
+  static const size_t COMMAND_SIZE = 65;
+
+  // client, command, how late the release is (us)
+  typedef std::function<void(uint8_t client, const char* command, uint32_t tag, int64_t lateUs)> Handler;
+
+  // 'tag' is returned on release (e.g. the emergency epoch at scheduling)
+  bool schedule(int64_t dueUs, uint8_t client, const char* command, uint32_t tag);
+
+  // Releases every entry due by nowUs
+  void advance(int64_t nowUs, const Handler& handler);
+
+  void clear();
+  uint8_t pending() const { return used; }
+
+private:
+  struct Entry {
+    int64_t dueUs;
+    uint32_t tag;
+    int8_t next;
+    uint8_t client;
+    char command[COMMAND_SIZE];
+  };
+
+  Entry entries[CAPACITY];
+  int8_t slots[SLOTS];
+  int8_t freeList = -1;
+  uint8_t used = 0;
+  int64_t lastTick = -1;
+  bool initialized = false;
+
+  void init();
+  void releaseSlot(uint8_t slot, int64_t nowUs, const Handler& handler);
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
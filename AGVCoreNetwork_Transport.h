@@ -0,0 +1,42 @@
+#ifndef AGVCORENETWORK_TRANSPORT_H
+#define AGVCORENETWORK_TRANSPORT_H
+
+#include <Arduino.h>
+#include <functional>
+
+namespace AGVCoreNetworkLib {
+
+// Plant-side messaging backend. AGVCoreNetwork publishes status and emergency
+// traffic through every registered transport and feeds inbound commands back
+// through the same command path as the web interface.
+//
+// begin(), loop() and stop() run on the network task (Core 0). publish() may
+// be called from either core and must only queue work for loop().
+class Transport {
+public:
+  enum Channel : uint8_t {
+    CHANNEL_STATUS = 0,     // High-rate telemetry, may be batched
+    CHANNEL_EMERGENCY       // Emergency transitions, delivered reliably
+  };
+
+  // Inbound command (NUL-terminated, length excludes the terminator)
+  typedef std::function<void(const char* command, size_t length)> CommandHandler;
+
+  virtual ~Transport() {}
+
+  virtual const char* name() const = 0;
+  virtual bool begin(const char* deviceName) = 0;
+  virtual void loop() = 0;
+  virtual void stop() = 0;
+  virtual bool connected() = 0;
+  virtual bool publish(Channel channel, const char* payload, size_t length) = 0;
+
+  void onCommand(CommandHandler handler) { commandHandler = handler; }
+
+protected:
+  CommandHandler commandHandler;
+};
+
+} // namespace AGVCoreNetworkLib
+
+#endif
@@ -0,0 +1,164 @@
+// Async tasks: many long-running commands at once through the scheduler.
+// Each command waits on a timer, then on a motion-complete event signalled
+// from the other core, then works in slices, one per loop pass. Checks that
+// a poll() pass stays short however long the commands run, that every live
+// task is resumed on every pass (no starvation), and that queued commands
+// get a slot as soon as one frees.
+//
+// Build: AGVCoreNetwork_Async.cpp
+
+#include "AGVCoreNetwork_Async.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static const int COMMANDS = 200;
+static const int SLICES = 40;          // Work slices per command, one per pass
+static const int SLICE_ROUNDS = 2000;  // About 10 us of work per slice
+
+// Virtual clock, one millisecond per loop pass
+static std::atomic<uint32_t> now{0};
+unsigned long millis() { return now.load(); }
+
+static uint32_t passes = 0;
+static volatile uint32_t sink = 0;
+
+static int64_t nowUs() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+class Command : public AsyncTask {
+public:
+  uint32_t motionBit = 0;
+  std::atomic<bool> moving{false};     // Waiting for the other core
+  int command = -1;
+  uint32_t waitMs = 0;
+  uint32_t startedPass = 0;
+  uint32_t resumes = 0;
+  uint32_t missed = 0;                 // Live passes without a resume
+  int completed = 0;
+
+  bool run(AsyncScheduler& scheduler) override {
+    resumes++;
+    AGV_ASYNC_BEGIN();
+    AGV_AWAIT_DELAY(waitMs);
+    moving = true;
+    AGV_AWAIT_EVENT(scheduler, motionBit);
+    for (slice = 0; slice < SLICES; slice++) {
+      for (int i = 0; i < SLICE_ROUNDS; i++) sink = sink * 31 + i;
+      mark = passes;
+      AGV_AWAIT_UNTIL(passes != mark);
+    }
+    AGV_ASYNC_END();
+  }
+
+  void finished() override {
+    // Started between passes, so it was resumed on each pass up to this one
+    uint32_t live = passes - startedPass + 1;
+    missed += live - resumes;
+    completed++;
+  }
+
+private:
+  int slice = 0;
+  uint32_t mark = 0;
+};
+
+int main() {
+  AsyncScheduler scheduler;
+  Command slots[AsyncScheduler::MAX_TASKS];
+  for (int k = 0; k < AsyncScheduler::MAX_TASKS; k++) slots[k].motionBit = AsyncScheduler::EVENT_USER << k;
+
+  // Full scheduler refuses more, and a task cannot be queued twice
+  for (Command& c : slots) {
+    c.startedPass = 1;
+    assert(scheduler.start(&c));
+  }
+  Command extra;
+  assert(!scheduler.start(&extra));
+  assert(!scheduler.start(&slots[0]));
+  std::atomic<bool> stop{false};
+
+  // The other core: completes a motion a little while after it began
+  std::thread motion([&]() {
+    while (!stop) {
+      for (Command& c : slots) {
+        if (c.moving.exchange(false)) scheduler.signal(c.motionBit);
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+  });
+
+  // Drain the first round, then run the commands through the free slots
+  int next = 0;
+  int done = 0;
+  uint32_t slotWaitMax = 0;            // Passes from a slot freeing to its reuse
+  uint32_t freedAt[AsyncScheduler::MAX_TASKS] = {};
+  bool busy[AsyncScheduler::MAX_TASKS];
+  std::fill(busy, busy + AsyncScheduler::MAX_TASKS, true);
+  std::vector<int64_t> passUs;
+  uint32_t longestCommand = 0;
+
+  while (done < COMMANDS) {
+    for (int k = 0; k < AsyncScheduler::MAX_TASKS; k++) {
+      if (busy[k] && !scheduler.isRunning(&slots[k])) {
+        busy[k] = false;
+        freedAt[k] = passes;
+        if (slots[k].command >= 0) {
+          done++;
+          longestCommand = std::max(longestCommand, passes - slots[k].startedPass);
+        }
+      }
+      if (!busy[k] && next < COMMANDS) {
+        Command& c = slots[k];
+        c.command = next++;
+        c.waitMs = (c.command * 7) % 50;
+        c.startedPass = passes + 1;
+        c.resumes = 0;
+        assert(scheduler.start(&c));
+        busy[k] = true;
+        slotWaitMax = std::max(slotWaitMax, passes - freedAt[k]);
+      }
+    }
+
+    now += 1;
+    passes++;
+    int64_t t0 = nowUs();
+    scheduler.poll();
+    passUs.push_back(nowUs() - t0);
+    assert(passes < 100000);
+  }
+  stop = true;
+  motion.join();
+
+  uint32_t missed = 0;
+  int completed = 0;
+  for (Command& c : slots) {
+    missed += c.missed;
+    completed += c.completed;
+  }
+  std::sort(passUs.begin(), passUs.end());
+  int64_t p99 = passUs[passUs.size() * 99 / 100];
+  int64_t worst = passUs.back();
+
+  printf("%d commands through %u slots in %u passes, longest %u passes; poll p99 %lld us, max %lld us\n",
+         COMMANDS, (unsigned)AsyncScheduler::MAX_TASKS, passes, longestCommand, (long long)p99, (long long)worst);
+  printf("slot reused within %u pass(es) of freeing; %u live passes without a resume\n", slotWaitMax, missed);
+
+  // The first round's tasks finish too, but carry no command
+  assert(completed == COMMANDS + AsyncScheduler::MAX_TASKS);
+  assert(missed == 0);
+  assert(slotWaitMax <= 1);
+  // One slice per task per pass: a pass costs a few slices, not a command
+  assert(longestCommand > SLICES);
+  assert(p99 < 2000);
+  return 0;
+}
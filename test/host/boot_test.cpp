@@ -0,0 +1,100 @@
+// Boot timeline: phases are stamped once and may arrive in any order, the
+// JSON fits any buffer, and time to ready for the normal, fast and
+// address-reusing boots under a cost model of the station start.
+//
+// Cost model (ms): NVS 15, scan 1600, association 250, DHCP 900, servers 40,
+// mDNS 180. The old connect task checked the link on a 500 ms tick.
+//
+// Build: AGVCoreNetwork_Boot.cpp
+
+#include "AGVCoreNetwork_Boot.h"
+
+#include <cassert>
+#include <cstdio>
+
+using namespace AGVCoreNetworkLib;
+
+enum Mode { BASELINE, FAST, FAST_REUSE };
+
+static uint32_t boot(Mode mode, BootTimeline& timeline, uint32_t now) {
+  timeline.start(now);
+  now += 15;
+  timeline.mark(BootTimeline::PHASE_STORAGE, now);
+  timeline.mark(BootTimeline::PHASE_RADIO, now);
+  uint32_t link = now + (mode == BASELINE ? 1600 : 0) + 250 + (mode == FAST_REUSE ? 0 : 900);
+
+  if (mode == BASELINE) {
+    // Link polled every 500 ms, then mDNS before the servers
+    uint32_t tick = now;
+    while ((int32_t)(tick - link) < 0) tick += 500;
+    now = tick;
+    timeline.mark(BootTimeline::PHASE_CONNECTED, now);
+    now += 180;
+    timeline.mark(BootTimeline::PHASE_MDNS, now);
+    now += 40;
+    timeline.mark(BootTimeline::PHASE_SERVERS, now);
+    timeline.mark(BootTimeline::PHASE_READY, now);
+  } else {
+    // Servers listen while associating; the link is seen on the next loop
+    now += 40;
+    timeline.mark(BootTimeline::PHASE_SERVERS, now);
+    now = (int32_t)(link - now) > 0 ? link + 1 : now + 1;
+    timeline.mark(BootTimeline::PHASE_CONNECTED, now);
+    timeline.mark(BootTimeline::PHASE_READY, now);
+    now += 180;
+    timeline.mark(BootTimeline::PHASE_MDNS, now);
+  }
+  return timeline.elapsed(BootTimeline::PHASE_READY);
+}
+
+int main() {
+  // Stamped once, relative to start(), across the tick wrap
+  BootTimeline timeline;
+  timeline.start(0xFFFFFF00u);
+  timeline.mark(BootTimeline::PHASE_SERVERS, 0x40);
+  timeline.mark(BootTimeline::PHASE_SERVERS, 0x400);
+  timeline.mark(BootTimeline::PHASE_COUNT, 0x400);
+  assert(timeline.reached(BootTimeline::PHASE_SERVERS) && !timeline.reached(BootTimeline::PHASE_STORAGE));
+  assert(timeline.elapsed(BootTimeline::PHASE_SERVERS) == 0x140);
+  char json[160];
+  size_t length = timeline.toJson(json, sizeof(json));
+  assert(length == strlen(json) && strcmp(json, "{\"servers\":320}") == 0);
+  timeline.start(1000);
+  length = timeline.toJson(json, sizeof(json));
+  assert(length == 2 && strcmp(json, "{}") == 0);
+
+  // Time to ready, each mode within its budget
+  const char* names[] = {"baseline", "fast", "fast+reuse"};
+  const uint32_t budgets[] = {4000, 1500, 400};
+  uint32_t ready[3];
+  for (int mode = 0; mode < 3; mode++) {
+    ready[mode] = boot((Mode)mode, timeline, 0xFFFFF000u);
+    bool complete = true;
+    for (uint8_t phase = 0; phase < BootTimeline::PHASE_COUNT; phase++) {
+      complete &= timeline.reached((BootTimeline::Phase)phase);
+    }
+    length = timeline.toJson(json, sizeof(json));
+    assert(complete && length == strlen(json) && ready[mode] <= budgets[mode]);
+    printf("%-10s ready %4u ms (budget %u) %s\n", names[mode], (unsigned)ready[mode], (unsigned)budgets[mode], json);
+  }
+  assert(ready[FAST_REUSE] < ready[FAST] && ready[FAST] < ready[BASELINE]);
+
+  // A short buffer holds a truncated, terminated prefix
+  for (size_t size = 1; size < 80; size++) {
+    char small[80];
+    memset(small, 'x', sizeof(small));
+    length = timeline.toJson(small, size);
+    assert(length < size && small[length] == '\0' && strncmp(small, json, length) == 0);
+  }
+
+  // Boot cache: only a cached channel is valid, and every field compares
+  BootCache a, b;
+  assert(!a.valid() && a == b);
+  a.channel = 6;
+  a.ip = 0x3201A8C0;
+  assert(a.valid() && !(a == b));
+  b = a;
+  b.bssid[5] = 1;
+  assert(!(a == b));
+  return 0;
+}
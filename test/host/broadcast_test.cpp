@@ -0,0 +1,186 @@
+// Broadcast cost against the number of WebSocket clients, for the path
+// before frames were built once (a String per message, then broadcastTXT
+// copying the payload behind a fresh header for every client) and for
+// sendFramed() and broadcastLog() today (one build behind reserved header
+// space, the header written in place for each client).
+//
+// The WebSocket side is a model of the links2004 WebSockets 2.x sendFrame()
+// as built for the ESP32 (WEBSOCKETS_USE_BIG_MEM): without headerToPayload a
+// payload under 1400 bytes is copied into a malloc'd buffer so header and
+// payload go out in one TCP write. Each client's write copies into its own
+// send buffer, as lwIP does with TCP_WRITE_FLAG_COPY.
+//
+// Build: AGVCoreNetwork_History.cpp
+
+#include "AGVCoreNetwork_History.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace AGVCoreNetworkLib;
+
+static const size_t HEADER_MAX = 14;              // WEBSOCKETS_MAX_HEADER_SIZE
+static const size_t FRAME_PAYLOAD_MAX = 256;      // AGVCoreNetwork::FRAME_PAYLOAD_MAX
+static const int MAX_CLIENTS = 16;
+static const int BROADCASTS = 20000;
+
+// Heap allocations, counted for both the Strings and the model's buffers
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static void* countedMalloc(size_t size) {
+  allocations++;
+  return malloc(size);
+}
+
+// One client's TCP send buffer
+struct Socket {
+  uint8_t buffer[8192];
+  size_t used = 0;
+
+  void write(const uint8_t* data, size_t length) {
+    if (used + length > sizeof(buffer)) used = 0;
+    memcpy(buffer + used, data, length);
+    used += length;
+  }
+};
+
+static Socket sockets[MAX_CLIENTS];
+
+// WebSockets::sendFrame() for a server text frame (unmasked, FIN)
+static void sendFrame(Socket& socket, uint8_t* payload, size_t length, bool headerToPayload) {
+  uint8_t* payloadPtr = payload;
+  uint8_t* internBuffer = nullptr;
+  if (!headerToPayload && length > 0 && length < 1400) {
+    internBuffer = (uint8_t*)countedMalloc(length + HEADER_MAX);
+    memcpy(internBuffer + HEADER_MAX, payload, length);
+    payloadPtr = internBuffer + HEADER_MAX;
+    headerToPayload = true;
+  }
+
+  uint8_t headerSize = length < 126 ? 2 : 4;
+  uint8_t header[4];
+  header[0] = 0x81;
+  if (length < 126) {
+    header[1] = (uint8_t)length;
+  } else {
+    header[1] = 126;
+    header[2] = (uint8_t)(length >> 8);
+    header[3] = (uint8_t)length;
+  }
+
+  if (headerToPayload) {
+    uint8_t* headerPtr = payloadPtr - headerSize;
+    memcpy(headerPtr, header, headerSize);
+    socket.write(headerPtr, length + headerSize);
+  } else {
+    socket.write(header, headerSize);
+    socket.write(payloadPtr, length);
+  }
+  free(internBuffer);
+}
+
+// Before: "WS: " + String(cmd), then broadcastTXT(msg.c_str())
+static void broadcastBefore(int clients, const char* prefix, const char* message) {
+  std::string text = std::string(prefix) + std::string(message);
+  for (int i = 0; i < clients; i++) sendFrame(sockets[i], (uint8_t*)&text[0], text.size(), false);
+}
+
+// sendFramed(ALL_CLIENTS, prefix, message, length)
+static void broadcastFramed(int clients, const char* prefix, const char* message, size_t length) {
+  size_t prefixLength = strlen(prefix);
+  size_t total = prefixLength + length;
+  uint8_t frame[HEADER_MAX + FRAME_PAYLOAD_MAX + 1];
+  uint8_t* heapFrame = nullptr;
+  uint8_t* payload = frame + HEADER_MAX;
+  if (total > FRAME_PAYLOAD_MAX) {
+    heapFrame = (uint8_t*)countedMalloc(HEADER_MAX + total + 1);
+    payload = heapFrame + HEADER_MAX;
+  }
+  memcpy(payload, prefix, prefixLength);
+  memcpy(payload + prefixLength, message, length);
+  payload[total] = '\0';
+  for (int i = 0; i < clients; i++) sendFrame(sockets[i], payload, total, true);
+  free(heapFrame);
+}
+
+// broadcastLog() for plain clients: sendFramed's build, the history append
+// under the stream lock, then the same in-place sends
+static EventHistory history;
+
+static void broadcastLogged(int clients, const char* prefix, const char* message, size_t length) {
+  size_t prefixLength = strlen(prefix);
+  size_t total = prefixLength + length;
+  uint8_t frame[HEADER_MAX + FRAME_PAYLOAD_MAX + 1];
+  uint8_t* payload = frame + HEADER_MAX;
+  memcpy(payload, prefix, prefixLength);
+  memcpy(payload + prefixLength, message, length);
+  payload[total] = '\0';
+  history.append(payload, total);
+  for (int i = 0; i < clients; i++) sendFrame(sockets[i], payload, total, true);
+}
+
+struct Cost {
+  double ns;
+  double allocations;
+};
+
+template <typename Broadcast>
+static Cost measure(Broadcast broadcast) {
+  // Best of three, for a loaded host
+  double best = 1e30;
+  size_t allocated = 0;
+  for (int round = 0; round < 3; round++) {
+    size_t before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int n = 0; n < BROADCASTS; n++) broadcast();
+    auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / BROADCASTS);
+    allocated = allocations - before;
+  }
+  return {best, (double)allocated / BROADCASTS};
+}
+
+int main() {
+  history.reset(1);
+  const char* command = "MOVE forward 1200 speed 40";
+  const char* status = "{\"emergency\":0,\"connected\":1,\"mode\":\"station\",\"rssi\":-61,\"ip\":\"192.168.1.50\","
+                       "\"uptime\":86400,\"clients\":4,\"pollClients\":2,\"serialPending\":0,\"lease\":1,"
+                       "\"lastCommand\":\"MOVE forward 1200\",\"reason\":\"\"}";
+
+  struct Message {
+    const char* name;
+    const char* prefix;
+    const char* text;
+  } messages[] = {{"echo", "WS: ", command}, {"status", "", status}};
+
+  printf("%-7s %7s %12s %12s %12s %14s\n", "message", "clients", "before ns", "framed ns", "log ns", "allocs b/f/l");
+  for (const Message& m : messages) {
+    size_t length = strlen(m.text);
+    for (int clients : {1, 2, 4, 8, 16}) {
+      Cost before = measure([&]() { broadcastBefore(clients, m.prefix, m.text); });
+      Cost framed = measure([&]() { broadcastFramed(clients, m.prefix, m.text, length); });
+      Cost logged = measure([&]() { broadcastLogged(clients, m.prefix, m.text, length); });
+      printf("%-7s %7d %12.0f %12.0f %12.0f %6.0f/%.0f/%.0f\n", m.name, clients, before.ns, framed.ns, logged.ns,
+             before.allocations, framed.allocations, logged.allocations);
+
+      // One buffer per client (plus the String) before, none now
+      assert(before.allocations >= clients);
+      assert(framed.allocations == 0 && logged.allocations == 0);
+      if (clients == 16) assert(framed.ns < before.ns);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+// Log stream compression: a realistic log decodes back exactly with the
+// dashboard's algorithm, adversarial messages never produce a frame longer
+// than the text (or MAX_OUTPUT), and the ratio and cost on the log.
+//
+// Build: AGVCoreNetwork_Compress.cpp
+
+#include "AGVCoreNetwork_Compress.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+// Same steps as decompressFrame() in the dashboard. Text messages leave the
+// window alone, as they do on the page.
+struct Decoder {
+  std::vector<uint8_t> history;
+
+  Decoder() : history(StreamCompressor::DICTIONARY, StreamCompressor::DICTIONARY + strlen(StreamCompressor::DICTIONARY)) {}
+
+  bool decode(const uint8_t* frame, size_t length, std::string& message) {
+    if (length == 0 || frame[0] != StreamCompressor::MAGIC) return false;
+    std::vector<uint8_t> out = history;
+    size_t start = out.size();
+    for (size_t i = 1; i < length;) {
+      uint8_t token = frame[i++];
+      if (token < 0x80) {
+        out.insert(out.end(), frame + i, frame + i + token + 1);
+        i += token + 1;
+      } else {
+        size_t n = (token & 0x7F) + 3;
+        size_t distance = frame[i] | (frame[i + 1] << 8);
+        i += 2;
+        if (distance == 0 || distance > out.size()) return false;
+        for (size_t k = 0; k < n; k++) out.push_back(out[out.size() - distance]);
+      }
+    }
+    message.assign(out.begin() + start, out.end());
+    if (out.size() > StreamCompressor::WINDOW) out.erase(out.begin(), out.end() - StreamCompressor::WINDOW);
+    history = out;
+    return true;
+  }
+};
+
+static std::vector<std::string> logStream(size_t count) {
+  std::mt19937 rng(7);
+  const char* commands[] = {"START", "STOP", "PAUSE", "RESUME", "PATH:1,1,3,2:ONCE", "MOVE:12,40", "PATH:3,4,5,6:LOOP"};
+  std::vector<std::string> stream;
+  char line[200];
+  for (size_t i = 0; i < count; i++) {
+    const char* command = commands[rng() % 7];
+    switch (rng() % 6) {
+      case 0: snprintf(line, sizeof(line), "WS: %s", command); break;
+      case 1: snprintf(line, sizeof(line), "Executing: %s", command); break;
+      case 2: snprintf(line, sizeof(line), "SERIAL: %s", command); break;
+      case 3: snprintf(line, sizeof(line), "{\"delta\":{\"rssi\":%d}}", -50 - (int)(rng() % 30)); break;
+      case 4:
+        snprintf(line, sizeof(line), "{\"delta\":{\"clients\":%u,\"lastCommand\":\"%s\"}}", (unsigned)(rng() % 4), command);
+        break;
+      default:
+        snprintf(line, sizeof(line), "Position x=%u y=%u heading=%u battery=%u%%", (unsigned)(rng() % 5000),
+                 (unsigned)(rng() % 5000), (unsigned)(rng() % 360), (unsigned)(60 + rng() % 40));
+        break;
+    }
+    stream.push_back(line);
+  }
+  return stream;
+}
+
+int main() {
+  // Guard bytes after the MAX_OUTPUT buffer catch any write past it
+  struct {
+    uint8_t frame[StreamCompressor::MAX_OUTPUT];
+    uint8_t guard[64];
+  } out;
+  memset(out.guard, 0xA5, sizeof(out.guard));
+
+  // Realistic log: exact round trip, ratio and cost
+  std::vector<std::string> stream = logStream(5000);
+  StreamCompressor compressor;
+  Decoder decoder;
+  bool enabled = compressor.enable(0);
+  assert(enabled);
+  size_t plain = 0, sent = 0;
+  double ns = 0;
+  for (const std::string& line : stream) {
+    auto start = std::chrono::steady_clock::now();
+    size_t n = compressor.compress(0, (const uint8_t*)line.data(), line.size(), out.frame);
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::string decoded = line;
+    if (n) {
+      assert(n < line.size());
+      bool ok = decoder.decode(out.frame, n, decoded);
+      assert(ok);
+    }
+    assert(decoded == line);
+    plain += line.size() + 2;
+    sent += (n ? n : line.size()) + 2;
+  }
+  printf("log: %zu messages, %zu -> %zu bytes with 2-byte headers (ratio %.2f), %.0f ns/message\n",
+         stream.size(), plain, sent, (double)plain / sent, ns / stream.size());
+
+  // broadcastLog compresses each message once per opted-in client with
+  // streamLock held: the lock hold time it adds, best of three
+  for (uint8_t clients : {1, 2, 4, 8}) {
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+      StreamCompressor shared;
+      for (uint8_t i = 0; i < clients; i++) shared.enable(i);
+      auto start = std::chrono::steady_clock::now();
+      for (const std::string& line : stream) {
+        for (uint8_t i = 0; i < clients; i++) {
+          shared.compress(i, (const uint8_t*)line.data(), line.size(), out.frame);
+        }
+      }
+      double total = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      best = std::min(best, total / stream.size());
+    }
+    printf("under streamLock: %u client(s), %6.0f ns/message, %5.0f ns/message/client\n", clients, best,
+           best / clients);
+  }
+
+  // Adversarial: 200-256 bytes over small alphabets, which alternate short
+  // literals and matches. Enough of them per window that it slides, often
+  // right after a message that went out as text.
+  std::mt19937 rng(1);
+  size_t worst = 0, fallbacks = 0, frames = 0;
+  for (int trial = 0; trial < 10000; trial++) {
+    StreamCompressor adversary;
+    Decoder mirror;
+    adversary.enable(0);
+    int alphabet = 2 + rng() % 6;
+    for (int m = 0; m < 8; m++) {
+      uint8_t message[StreamCompressor::MAX_MESSAGE];
+      size_t length = 200 + rng() % 57;
+      for (size_t i = 0; i < length; i++) message[i] = (uint8_t)('a' + rng() % alphabet);
+      size_t n = adversary.compress(0, message, length, out.frame);
+      if (!n) {
+        fallbacks++;
+        continue;
+      }
+      frames++;
+      if (n > worst) worst = n;
+      assert(n < length && n <= StreamCompressor::MAX_OUTPUT);
+      std::string decoded;
+      bool ok = mirror.decode(out.frame, n, decoded);
+      assert(ok && decoded == std::string((const char*)message, length));
+    }
+  }
+  for (uint8_t b : out.guard) assert(b == 0xA5);
+  printf("adversarial: %zu frames, %zu sent as text, largest frame %zu (MAX_OUTPUT %zu)\n", frames, fallbacks,
+         worst, (size_t)StreamCompressor::MAX_OUTPUT);
+
+  // Too long, too short and disabled clients are sent as text
+  std::string longLine(StreamCompressor::MAX_MESSAGE + 1, 'x');
+  size_t tooLong = compressor.compress(0, (const uint8_t*)longLine.data(), longLine.size(), out.frame);
+  size_t tooShort = compressor.compress(0, (const uint8_t*)"STOP", 4, out.frame);
+  size_t disabled = compressor.compress(1, (const uint8_t*)"Executing: STOP", 15, out.frame);
+  assert(tooLong == 0 && tooShort == 0 && disabled == 0);
+  return 0;
+}
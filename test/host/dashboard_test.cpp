@@ -0,0 +1,242 @@
+// Eight dashboards on one vehicle: WebSocket traffic they receive with the
+// old status polling and with the control namespace's pushed deltas.
+//
+// The whole library runs on the host with an operator and 8 dashboards
+// connected over real sockets, and the clock runs SPEEDUP times faster so
+// half a minute of floor time takes two seconds. In both runs the operator
+// sends a command every 2 s and the application posts a status line every
+// second.
+//   before  each dashboard polls every 5 s. The poll takes the command
+//           path as STATUS_REQUEST did before the control namespace: it
+//           reaches the application, is ACKed and echoed to every client.
+//           (STATUS_POLL stands in, since STATUS_REQUEST is now a control
+//           message.)
+//   after   each dashboard sends SUBSCRIBE:status once and gets deltas
+//
+// Build: AGVCoreNetwork*.cpp test/host/shim/platform.cpp test/host/shim/net.cpp test/host/shim/web.cpp test/host/shim/websockets.cpp -lcrypto -DWEBSOCKETS_SERVER_CLIENT_MAX=9
+
+#include "AGVCoreNetwork.h"
+#include "Preferences.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace AGVCoreNetworkLib;
+
+static const int DASHBOARDS = 8;
+static const int SPEEDUP = 15;
+static const uint16_t HTTP_PORT = 18280;
+static const uint16_t WS_PORT = 18281;
+static const int64_t RUN_MS = 30000;
+static const int64_t POLL_MS = 5000;
+static const int64_t COMMAND_MS = 2000;
+static const int64_t STATUS_MS = 1000;
+
+// Library time runs SPEEDUP times faster than the host clock
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+int64_t esp_timer_get_time() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now() - processStart).count() * SPEEDUP;
+}
+
+static std::atomic<int> commands{0};
+
+// Frames one client received, by kind
+struct Counts {
+  int frames = 0;
+  size_t bytes = 0;
+  int chatter = 0;         // Poll ACKs and echoes
+  int status = 0;          // Snapshots and deltas
+};
+
+class Client {
+public:
+  bool connect() {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(WS_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+
+    std::string request = "GET / HTTP/1.1\r\nHost: agv\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (::send(fd, request.data(), request.size(), 0) != (ssize_t)request.size()) return false;
+    std::string response;
+    char c;
+    while (response.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1) response += c;
+    return response.compare(0, 12, "HTTP/1.1 101") == 0;
+  }
+
+  void send(const char* text) {
+    size_t length = strlen(text);
+    uint8_t frame[6 + 125] = {0x81, (uint8_t)(0x80 | length), 1, 2, 3, 4};
+    for (size_t i = 0; i < length; i++) frame[6 + i] = text[i] ^ frame[2 + i % 4];
+    ::send(fd, frame, 6 + length, MSG_NOSIGNAL);
+  }
+
+  // Reads and counts whatever frames have arrived
+  void drain() {
+    char chunk[4096];
+    ssize_t n;
+    while ((n = recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) rx.append(chunk, n);
+    while (rx.size() >= 2) {
+      size_t length = rx[1] & 0x7F;
+      size_t at = 2;
+      if (length == 126) {
+        if (rx.size() < 4) return;
+        length = ((uint8_t)rx[2] << 8) | (uint8_t)rx[3];
+        at = 4;
+      }
+      if (rx.size() < at + length) return;
+      std::string text = rx.substr(at, length);
+      rx.erase(0, at + length);
+
+      counts.frames++;
+      counts.bytes += at + length;
+      if (text == "ACK: STATUS_POLL" || text == "WS: STATUS_POLL") counts.chatter++;
+      if (text[0] == '{') counts.status++;
+    }
+  }
+
+  void close() { ::close(fd); }
+
+  Counts counts;
+
+private:
+  int fd = -1;
+  std::string rx;
+};
+
+struct Totals {
+  Counts dashboards;
+  int polls = 0;
+  int commandsSent = 0;
+  int delivered = 0;
+};
+
+static void waitForClients(uint8_t count) {
+  AGVCoreNetwork::StatusSnapshot status;
+  for (int i = 0; i < 3000; i++) {
+    agvNetwork.getStatusSnapshot(status);
+    if (status.wsClients == count) return;
+    delay(1);
+  }
+  assert(!"client count never settled");
+}
+
+static Totals run(bool subscribe) {
+  Client clients[1 + DASHBOARDS];
+  for (Client& c : clients) assert(c.connect());
+  waitForClients(1 + DASHBOARDS);
+  if (subscribe) {
+    for (int d = 1; d <= DASHBOARDS; d++) clients[d].send("SUBSCRIBE:status");
+  }
+  delay(20);
+  for (Client& c : clients) {
+    c.drain();
+    c.counts = Counts();
+  }
+
+  Totals totals;
+  int commandsAtStart = commands;
+  int64_t start = esp_timer_get_time() / 1000;
+  int64_t nextCommand = start, nextStatus = start;
+  int64_t nextPoll[1 + DASHBOARDS];
+  for (int d = 1; d <= DASHBOARDS; d++) nextPoll[d] = start + d * POLL_MS / DASHBOARDS;
+
+  for (int64_t now = start; now - start < RUN_MS; now = esp_timer_get_time() / 1000) {
+    if (now >= nextCommand) {
+      char command[32];
+      snprintf(command, sizeof(command), "MOVE forward %d", totals.commandsSent++);
+      clients[0].send(command);
+      nextCommand += COMMAND_MS;
+    }
+    if (now >= nextStatus) {
+      agvNetwork.sendStatus(totals.commandsSent % 2 ? "AGV Moving" : "AGV Ready - Idle");
+      nextStatus += STATUS_MS;
+    }
+    for (int d = 1; !subscribe && d <= DASHBOARDS; d++) {
+      if (now >= nextPoll[d]) {
+        clients[d].send("STATUS_POLL");
+        totals.polls++;
+        nextPoll[d] += POLL_MS;
+      }
+    }
+    for (Client& c : clients) c.drain();
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+
+  // Let the last replies arrive
+  delay(300);
+  for (Client& c : clients) c.drain();
+  totals.delivered = commands - commandsAtStart;
+  for (int d = 1; d <= DASHBOARDS; d++) {
+    totals.dashboards.frames += clients[d].counts.frames;
+    totals.dashboards.bytes += clients[d].counts.bytes;
+    totals.dashboards.chatter += clients[d].counts.chatter;
+    totals.dashboards.status += clients[d].counts.status;
+    if (subscribe) assert(clients[d].counts.status > 0);
+  }
+  for (Client& c : clients) c.close();
+  waitForClients(0);
+  return totals;
+}
+
+static void report(const char* name, const Totals& t) {
+  double seconds = RUN_MS / 1000.0;
+  printf("%-6s %2d dashboards: %5.1f frames/s, %6.0f B/s in total; %4d poll frames, %3d status frames; "
+         "%d polls, %d of %d application commands were polls\n",
+         name, DASHBOARDS, t.dashboards.frames / seconds, t.dashboards.bytes / seconds, t.dashboards.chatter,
+         t.dashboards.status, t.polls, t.delivered - t.commandsSent, t.delivered);
+}
+
+int main() {
+  Preferences prefs;
+  prefs.begin("agvnet", false);
+  prefs.putString("ssid", "host");
+  prefs.putString("password", "host");
+  prefs.end();
+  hostStationLink(true);
+  hostRunTasks(true);
+
+  agvNetwork.setServerPorts(HTTP_PORT, WS_PORT);
+  agvNetwork.setPollServerPort(0);
+  agvNetwork.setRateLimit(0, 0);          // Every client shares 127.0.0.1
+  agvNetwork.begin("dashboards", "admin", "admin123");
+  agvNetwork.setCommandCallback([](const char*) { commands++; });
+  AGVCoreNetwork::StatusSnapshot status;
+  for (int i = 0; i < 2000 && !status.connected; i++) {
+    delay(1);
+    agvNetwork.getStatusSnapshot(status);
+  }
+  assert(status.connected);
+
+  Totals before = run(false);
+  Totals after = run(true);
+  report("before", before);
+  report("after", after);
+  printf("dashboard traffic %.0f%% lower, poll frames %d -> %d\n",
+         100.0 * (1.0 - (double)after.dashboards.frames / before.dashboards.frames), before.dashboards.chatter,
+         after.dashboards.chatter);
+
+  // Each poll went to the application and came back as an ACK to its
+  // sender plus an echo to every dashboard
+  assert(before.delivered == before.commandsSent + before.polls);
+  assert(before.dashboards.chatter == before.polls * (1 + DASHBOARDS));
+  assert(after.delivered == after.commandsSent);
+  assert(after.dashboards.chatter == 0);
+  assert(after.dashboards.frames < before.dashboards.frames);
+
+  fflush(stdout);
+  _exit(0);
+}
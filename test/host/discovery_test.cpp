@@ -0,0 +1,180 @@
+// Fleet discovery: 120 responders on a loopback multicast group answer one
+// query and every answer is merged into the cache, entries carry the TXT
+// records, cached lookups cost, and vehicles that go quiet expire after the
+// TTL. Answers are "name|ip|port|key=value;..." datagrams standing in for
+// the mDNS PTR/SRV/TXT records.
+//
+// Build: AGVCoreNetwork_Discovery.cpp
+
+#include "AGVCoreNetwork_Discovery.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static const char* GROUP = "239.255.77.1";
+static const uint16_t PORT = 15353;
+static const int RESPONDERS = 120;
+
+// Responders join the group on loopback; the gateway sends from any port
+static int openSocket(bool responder) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+  sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(responder ? PORT : 0);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (sockaddr*)&local, sizeof(local)) != 0) return -1;
+
+  if (responder) {
+    ip_mreq membership = {};
+    inet_pton(AF_INET, GROUP, &membership.imr_multiaddr);
+    membership.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) return -1;
+  }
+  in_addr loopback = {};
+  loopback.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+  unsigned char loop = 1;
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+  return fd;
+}
+
+// Parses one answer and merges it; false if it did not parse or fit
+static bool ingestAnswer(FleetDiscovery& discovery, const char* answer) {
+  std::string text(answer);
+  size_t a = text.find('|'), b = text.find('|', a + 1), c = text.find('|', b + 1);
+  if (c == std::string::npos) return false;
+
+  std::vector<std::string> keys, values;
+  for (size_t start = c + 1; start <= text.size();) {
+    size_t end = text.find(';', start);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(start, end - start);
+    size_t eq = item.find('=');
+    keys.push_back(item.substr(0, eq));
+    values.push_back(eq == std::string::npos ? "" : item.substr(eq + 1));
+    start = end + 1;
+  }
+  std::vector<FleetDiscovery::TxtItem> txt;
+  for (size_t i = 0; i < keys.size(); i++) txt.push_back({keys[i].c_str(), values[i].c_str()});
+
+  return discovery.ingest(text.substr(0, a).c_str(), (uint32_t)std::stoul(text.substr(a + 1, b - a - 1)),
+                          (uint16_t)std::stoul(text.substr(b + 1, c - b - 1)), txt.data(), txt.size(), millis());
+}
+
+// One query: the first `answering` responders reply, the gateway merges
+// until the group has been quiet for 100 ms. Returns the answers merged.
+static int query(FleetDiscovery& discovery, int gateway, const std::vector<int>& responders, int answering,
+                 uint32_t& elapsedMs) {
+  sockaddr_in group = {};
+  group.sin_family = AF_INET;
+  group.sin_port = htons(PORT);
+  inet_pton(AF_INET, GROUP, &group.sin_addr);
+  uint32_t start = millis();
+  sendto(gateway, "Q", 1, 0, (sockaddr*)&group, sizeof(group));
+
+  for (int i = 0; i < answering; i++) {
+    pollfd readable = {responders[i], POLLIN, 0};
+    if (poll(&readable, 1, 200) <= 0) continue;
+    sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    char request[8];
+    recvfrom(responders[i], request, sizeof(request), 0, (sockaddr*)&from, &fromLength);
+
+    char answer[256];
+    int n = snprintf(answer, sizeof(answer),
+                     "agv%03d|%u|81|proto=1;http=80;fw=1.4.%d;state=%s;caps=path,time,lz,resume,lease,ota;"
+                     "clients=%d;cpu=%d",
+                     i, 0x0A000000u + i, i, i % 7 == 0 ? "estop" : i % 2 ? "moving" : "idle", i % 4, i % 10 * 10);
+    sendto(responders[i], answer, n, 0, (sockaddr*)&from, fromLength);
+  }
+
+  int merged = 0;
+  uint32_t lastAnswer = millis();
+  for (;;) {
+    pollfd readable = {gateway, POLLIN, 0};
+    if (poll(&readable, 1, 100) <= 0) break;
+    char answer[256];
+    ssize_t n = recv(gateway, answer, sizeof(answer) - 1, 0);
+    if (n <= 0) break;
+    answer[n] = '\0';
+    merged += ingestAnswer(discovery, answer);
+    lastAnswer = millis();
+  }
+  elapsedMs = lastAnswer - start;
+  return merged;
+}
+
+int main() {
+  std::vector<int> responders;
+  for (int i = 0; i < RESPONDERS; i++) responders.push_back(openSocket(true));
+  int gateway = openSocket(false);
+  for (int fd : responders) {
+    if (fd < 0 || gateway < 0) {
+      printf("loopback multicast unavailable, skipped\n");
+      return 0;
+    }
+  }
+
+  static FleetDiscovery discovery;
+  bool allocated = discovery.begin();
+  assert(allocated);
+  discovery.setTtl(500);
+
+  uint32_t elapsed = 0;
+  int merged = query(discovery, gateway, responders, RESPONDERS, elapsed);
+  size_t cached = discovery.size(millis());
+  assert(merged == RESPONDERS && cached == (size_t)RESPONDERS);
+  printf("query: %d answers merged in %u ms\n", merged, (unsigned)elapsed);
+
+  // Names match case-insensitively; TXT records land in the entry
+  FleetDiscovery::Vehicle vehicle;
+  bool found = discovery.find("AGV007", vehicle, millis());
+  assert(found && vehicle.ip == 0x0A000007u && vehicle.wsPort == 81 && vehicle.httpPort == 80);
+  assert(vehicle.protocol == AGV_PROTOCOL_VERSION && vehicle.capabilities == 0x3F);
+  assert(vehicle.state == FleetDiscovery::STATE_ESTOP && strcmp(vehicle.firmware, "1.4.7") == 0);
+  assert(vehicle.clients == 3 && vehicle.cpuPercent == 70);
+
+  const int lookups = 100000;
+  int hits = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < lookups; k++) {
+    char name[8];
+    snprintf(name, sizeof(name), "agv%03d", k % RESPONDERS);
+    hits += discovery.find(name, vehicle, millis());
+  }
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / lookups;
+  assert(hits == lookups);
+  printf("cached lookup: %.2f us\n", us);
+
+  std::vector<FleetDiscovery::Vehicle> all(200);
+  size_t copied = discovery.copy(all.data(), all.size(), millis());
+  assert(copied == (size_t)RESPONDERS);
+
+  // 40 vehicles go quiet and expire; the rest answer again and stay
+  usleep(300000);
+  merged = query(discovery, gateway, responders, 80, elapsed);
+  usleep(300000);
+  cached = discovery.size(millis());
+  found = discovery.find("agv100", vehicle, millis());
+  assert(merged == 80 && cached == 80 && !found);
+  printf("after 40 went quiet: %zu cached\n", cached);
+
+  for (int fd : responders) close(fd);
+  close(gateway);
+  return 0;
+}
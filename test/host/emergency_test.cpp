@@ -0,0 +1,121 @@
+// EmergencyState under contention: two "cores" trigger, clear and run the
+// command-path check while a third thread takes snapshots, and every
+// observation must satisfy the state machine's invariants.
+//
+// Build: AGVCoreNetwork_Emergency.cpp
+
+#include "AGVCoreNetwork_Emergency.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace AGVCoreNetworkLib;
+
+// Every reading is a new millisecond, so a stale trigger time is visible
+static std::atomic<uint32_t> fakeClock{1000};
+unsigned long millis() { return ++fakeClock; }
+
+static EmergencyState state;
+static std::atomic<bool> running{true};
+static std::atomic<uint32_t> failures{0};
+static std::atomic<uint32_t> entered{0};
+static std::atomic<uint32_t> cleared{0};
+static std::atomic<uint32_t> rejected{0};
+
+static void fail(const char* what, const EmergencyState::Snapshot& s) {
+  if (failures++ < 5) {
+    printf("FAIL: %s (active %d reasons 0x%02x source %d epoch %u at %u)\n", what, s.active,
+           s.reasons, s.source, (unsigned)s.epoch, (unsigned)s.triggeredAtMs);
+  }
+}
+
+// Invariants of one observer's sequence of snapshots
+struct Observer {
+  uint32_t lastEpoch = 0;
+  uint32_t lastActiveEpoch = 0;
+  uint32_t lastTriggeredAt = 0;
+
+  void check(const EmergencyState::Snapshot& s) {
+    if ((s.epoch & 1) != s.active) fail("epoch parity does not match the state", s);
+    if (s.active && (s.reasons == 0 || s.source == EmergencyState::SOURCE_NONE)) {
+      fail("active without a reason or source", s);
+    }
+    if (!s.active && (s.reasons != 0 || s.source != EmergencyState::SOURCE_NONE)) {
+      fail("normal with a latched reason or source", s);
+    }
+    if (s.epoch < lastEpoch) fail("epoch went backwards", s);
+    lastEpoch = s.epoch;
+
+    // A newer emergency carries a newer time
+    if (s.active && s.epoch != lastActiveEpoch) {
+      if (lastActiveEpoch && (int32_t)(s.triggeredAtMs - lastTriggeredAt) <= 0) {
+        fail("new emergency shows an old trigger time", s);
+      }
+      lastActiveEpoch = s.epoch;
+      lastTriggeredAt = s.triggeredAtMs;
+    }
+  }
+};
+
+static void core(unsigned seed, EmergencyState::Source source) {
+  std::mt19937 rng(seed);
+  Observer observer;
+  while (running) {
+    switch (rng() % 8) {
+      case 0:
+      case 1: {
+        EmergencyState::Reason reason = (EmergencyState::Reason)(1u << (rng() % 4));
+        if (state.trigger(reason, source)) entered++;
+        break;
+      }
+      case 2:
+        if (state.clear()) cleared++;
+        break;
+      default:
+        // Command path, then what a status reader would see
+        if (state.isActive()) rejected++;
+        observer.check(state.snapshot());
+        break;
+    }
+  }
+}
+
+static void monitor() {
+  Observer observer;
+  while (running) observer.check(state.snapshot());
+}
+
+int main() {
+  std::thread core0(core, 1, EmergencyState::SOURCE_WEBSOCKET);
+  std::thread core1(core, 2, EmergencyState::SOURCE_APPLICATION);
+  std::thread watcher(monitor);
+
+  // Stay well inside the 20-bit epoch
+  while (entered + cleared < 400000 && failures == 0) std::this_thread::yield();
+  running = false;
+  core0.join();
+  core1.join();
+  watcher.join();
+
+  // Every transition is accounted for exactly once
+  EmergencyState::Snapshot s = state.snapshot();
+  if (s.epoch != entered + cleared) fail("epoch does not count the transitions", s);
+  if (entered - cleared != (uint32_t)s.active) fail("entries and clears do not pair up", s);
+
+  // Latching: a second reason does not transition and keeps the first source
+  while (state.clear()) {}
+  assert(state.trigger(EmergencyState::REASON_ABORT, EmergencyState::SOURCE_SERIAL));
+  assert(!state.trigger(EmergencyState::REASON_TRANSPORT, EmergencyState::SOURCE_TRANSPORT));
+  assert(!state.trigger(EmergencyState::REASON_TRANSPORT, EmergencyState::SOURCE_TRANSPORT));
+  s = state.snapshot();
+  assert(s.reasons == (EmergencyState::REASON_ABORT | EmergencyState::REASON_TRANSPORT));
+  assert(s.source == EmergencyState::SOURCE_SERIAL);
+  assert(state.clear() && !state.clear());
+
+  printf("%u entries, %u clears, %u commands rejected, %u failures\n", (unsigned)entered,
+         (unsigned)cleared, (unsigned)rejected, (unsigned)failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// Command filter: a corpus of valid and invalid commands in both the space
+// and the colon form gets the expected verdicts, rules that do not compile
+// are refused, rate intervals and the whitelist mode, and the cost per
+// command.
+//
+// Build: AGVCoreNetwork_Filter.cpp
+
+#include "AGVCoreNetwork_Filter.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+
+using namespace AGVCoreNetworkLib;
+
+typedef CommandFilter Filter;
+
+struct Case {
+  const char* cmd;
+  bool moving;
+  Filter::Verdict expected;
+};
+
+static const Case CORPUS[] = {
+  // Accepted
+  {"move forward", false, Filter::CMD_OK},
+  {"MOVE Backward 250", false, Filter::CMD_OK},
+  {"  move   left  ", false, Filter::CMD_OK},
+  {"move forward\r\n", false, Filter::CMD_OK},
+  {"MOVE:forward:250", false, Filter::CMD_OK},
+  {"turn_left 90", false, Filter::CMD_OK},
+  {"turn_right 360", false, Filter::CMD_OK},
+  {"turnaround", false, Filter::CMD_OK},
+  {"START", false, Filter::CMD_OK},
+  {"PATH:1,1,3,2:ONCE", false, Filter::CMD_OK},
+  {"path:3,4,5,6:loop", false, Filter::CMD_OK},
+  {"path 1,1,3,2 once", false, Filter::CMD_OK},
+  {"custom_app_verb 1 2 3 4 5 6 7", false, Filter::CMD_OK},
+  {"custom:a:b:c:d:e:f", false, Filter::CMD_OK},
+  {"calibrate", false, Filter::CMD_OK},
+  {"horn beep", false, Filter::CMD_OK},
+  {"TIME", false, Filter::CMD_OK},
+  {"note 12:30", false, Filter::CMD_OK},
+
+  // Structure
+  {"", false, Filter::CMD_EMPTY},
+  {"   \t ", false, Filter::CMD_EMPTY},
+  {nullptr, false, Filter::CMD_EMPTY},
+  {"move forward 1 0123456789012345678901234567890123456789012345678901234567", false, Filter::CMD_TOO_LONG},
+  {"move\x01 forward", false, Filter::CMD_BAD_CHARACTER},
+  {"move forw\xc3\xa4rd", false, Filter::CMD_BAD_CHARACTER},
+
+  // Control words, in any case and form
+  {"STATUS_REQUEST", false, Filter::CMD_RESERVED},
+  {"status_request", false, Filter::CMD_RESERVED},
+  {"PING", false, Filter::CMD_RESERVED},
+  {"Ping", false, Filter::CMD_RESERVED},
+  {"SUBSCRIBE:status", false, Filter::CMD_RESERVED},
+  {"unsubscribe:log", false, Filter::CMD_RESERVED},
+  {"LEASE:ACQUIRE", false, Filter::CMD_RESERVED},
+  {"lease:release", false, Filter::CMD_RESERVED},
+  {"AT:123:move forward", false, Filter::CMD_RESERVED},
+  {"at:123:move forward", false, Filter::CMD_RESERVED},
+  {"Time:Sync:12345", false, Filter::CMD_RESERVED},
+  {"COMPRESS:ON", false, Filter::CMD_RESERVED},
+  {"resume:42", false, Filter::CMD_RESERVED},
+
+  // Arguments
+  {"move", false, Filter::CMD_BAD_ARGUMENTS},
+  {"MOVE:", false, Filter::CMD_BAD_ARGUMENTS},
+  {"move up", false, Filter::CMD_BAD_ARGUMENTS},
+  {"MOVE:up:10", false, Filter::CMD_BAD_ARGUMENTS},
+  {"move forward 0", false, Filter::CMD_BAD_ARGUMENTS},
+  {"move forward 5001", false, Filter::CMD_BAD_ARGUMENTS},
+  {"move forward 10 extra", false, Filter::CMD_BAD_ARGUMENTS},
+  {"turn_left", false, Filter::CMD_BAD_ARGUMENTS},
+  {"turn_left 90deg", false, Filter::CMD_BAD_ARGUMENTS},
+  {"turn_left -90", false, Filter::CMD_BAD_ARGUMENTS},
+  {"turn_left 99999999999", false, Filter::CMD_BAD_ARGUMENTS},
+  {"turnaround now", false, Filter::CMD_BAD_ARGUMENTS},
+  {"START 1 2 3 4 5 6", false, Filter::CMD_BAD_ARGUMENTS},
+  {"PATH:1,1,3,2", false, Filter::CMD_BAD_ARGUMENTS},
+  {"PATH:1,1,3,2:TWICE", false, Filter::CMD_BAD_ARGUMENTS},
+  {"PATH:", false, Filter::CMD_BAD_ARGUMENTS},
+
+  // Motion state and rate
+  {"calibrate", true, Filter::CMD_NOT_WHILE_MOVING},
+  {"horn", false, Filter::CMD_RATE_LIMITED},
+};
+
+int main() {
+  Filter filter;
+  bool added = filter.addRule("move", "word:forward|backward|left|right int:1:5000?") &&
+               filter.addRule("turn_left", "int:1:360") && filter.addRule("turn_right", "int:1:360") &&
+               filter.addRule("turnaround") && filter.addRule("START") && filter.addRule("PAUSE") &&
+               filter.addRule("path", "text word:once|loop") &&
+               filter.addRule("calibrate", "", 0, Filter::RULE_NOT_WHILE_MOVING) &&
+               filter.addRule("horn", "text?", 500);
+  assert(added);
+
+  // Rules that do not compile
+  bool refused = !filter.addRule("bad", "int:5:1") && !filter.addRule("bad", "word:a||b") &&
+                 !filter.addRule("bad", "float") && !filter.addRule("bad", "text text text text text") &&
+                 !filter.addRule("") && !filter.addRule("a_verb_longer_than_twenty");
+  assert(refused);
+
+  int failures = 0;
+  for (const Case& c : CORPUS) {
+    Filter::Verdict verdict = filter.check(c.cmd, c.cmd ? strlen(c.cmd) : 0, 1000, c.moving);
+    if (verdict != c.expected) {
+      printf("'%s': %s, expected %s\n", c.cmd ? c.cmd : "(null)", Filter::reason(verdict), Filter::reason(c.expected));
+      failures++;
+    }
+  }
+  if (failures) return 1;
+  size_t corpus = sizeof(CORPUS) / sizeof(CORPUS[0]);
+  printf("corpus: %zu commands, all verdicts as expected\n", corpus);
+
+  // The interval runs from the last accepted command; syntax checks keep no state
+  Filter::Verdict later = filter.check("horn", 4, 1500, false);
+  Filter::Verdict again = filter.check("HORN:toot", 9, 1600, false);
+  Filter::Verdict syntax = filter.checkSyntax("horn", 4);
+  assert(later == Filter::CMD_OK && again == Filter::CMD_RATE_LIMITED && syntax == Filter::CMD_OK);
+  assert(filter.count(Filter::CMD_RESERVED) == 13 && filter.count(Filter::CMD_RATE_LIMITED) == 2);
+
+  // Whitelist mode
+  Filter strict;
+  strict.addRule("START");
+  strict.setAllowUnknownVerbs(false);
+  Filter::Verdict unknown = strict.check("jump", 4, 0, false);
+  Filter::Verdict known = strict.check("start", 5, 0, false);
+  Filter::Verdict colon = strict.check("Start:", 6, 0, false);
+  assert(unknown == Filter::CMD_UNKNOWN_VERB && known == Filter::CMD_OK && colon == Filter::CMD_OK);
+
+  // Cost on a typical mix
+  const char* mix[] = {"move forward 250", "turn_left 90", "PATH:1,1,3,2:ONCE", "custom_app_verb 1 2",
+                       "move sideways", "STATUS_REQUEST", "turnaround"};
+  size_t lengths[7];
+  for (int i = 0; i < 7; i++) lengths[i] = strlen(mix[i]);
+  const int reps = 2000000;
+  uint32_t accepted = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < reps; i++) accepted += filter.check(mix[i % 7], lengths[i % 7], i * 1000u, false) == Filter::CMD_OK;
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reps;
+  assert(accepted > 0);
+  printf("%.0f ns per command, %zu bytes of filter state\n", ns, sizeof(Filter));
+  return 0;
+}
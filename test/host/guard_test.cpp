@@ -0,0 +1,119 @@
+// Request guard: burst and sustained rate, one report per refused burst,
+// login lockouts that double up to the cap, eviction that keeps lockouts,
+// the soak scenario's load against the default and its own limit, and an
+// operator's latency while another address floods the server.
+//
+// Build: AGVCoreNetwork_Guard.cpp
+
+#include "AGVCoreNetwork_Guard.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static const uint32_t IP_A = 0x0A01A8C0;   // 192.168.1.10
+static const uint32_t IP_B = 0x0B01A8C0;
+
+// Fraction refused for Poisson arrivals at `rate` per second from one address
+static double refusedFraction(RequestGuard& guard, double rate, uint32_t seconds) {
+  std::mt19937 rng(5);
+  std::exponential_distribution<double> gap(rate);
+  size_t sent = 0, refused = 0;
+  for (double t = 1000; t < 1000 + seconds * 1000.0; t += gap(rng) * 1000) {
+    sent++;
+    if (guard.admit(IP_A, (uint32_t)t) != RequestGuard::ADMIT) refused++;
+  }
+  return (double)refused / sent;
+}
+
+// p99 latency of an operator at 5 requests/s while IP_A sends 500/s to a
+// single-threaded server (admitted 4 ms, refused 0.3 ms)
+static double operatorP99(bool guarded) {
+  RequestGuard guard;
+  if (!guarded) guard.setRateLimit(0, 0);
+  struct Arrival {
+    double t;
+    uint32_t ip;
+  };
+  std::vector<Arrival> arrivals;
+  for (double t = 0; t < 10000; t += 2) arrivals.push_back({t, IP_A});
+  for (double t = 0.7; t < 10000; t += 200) arrivals.push_back({t, IP_B});
+  std::sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) { return a.t < b.t; });
+
+  double busy = 0;
+  std::vector<double> latency;
+  for (const Arrival& a : arrivals) {
+    double start = std::max(busy, a.t);
+    busy = start + (guard.admit(a.ip, (uint32_t)start) == RequestGuard::ADMIT ? 4.0 : 0.3);
+    if (a.ip == IP_B) latency.push_back(busy - a.t);
+  }
+  std::sort(latency.begin(), latency.end());
+  return latency[latency.size() * 99 / 100];
+}
+
+int main() {
+  // Burst of 40, then 20/s; the first refusal of a burst is reported once
+  RequestGuard guard;
+  int admitted = 0;
+  for (int i = 0; i < 40; i++) admitted += guard.admit(IP_A, 1000) == RequestGuard::ADMIT;
+  RequestGuard::Verdict first = guard.admit(IP_A, 1000);
+  RequestGuard::Verdict again = guard.admit(IP_A, 1001);
+  assert(admitted == 40 && first == RequestGuard::LIMITED_FIRST && again == RequestGuard::LIMITED);
+  RequestGuard::Verdict refilled = guard.admit(IP_A, 1050);
+  RequestGuard::Verdict other = guard.admit(IP_B, 1050);
+  assert(refilled == RequestGuard::ADMIT && other == RequestGuard::ADMIT);
+  RequestGuard::Verdict next = guard.admit(IP_A, 1051);
+  assert(next == RequestGuard::LIMITED_FIRST);
+
+  // Rate 0 disables the limit
+  RequestGuard open;
+  open.setRateLimit(0, 0);
+  admitted = 0;
+  for (int i = 0; i < 10000; i++) admitted += open.admit(IP_A, 1000) == RequestGuard::ADMIT;
+  assert(admitted == 10000);
+
+  // Three free failures, then 1 s doubling up to LOCKOUT_MAX_MS
+  RequestGuard logins;
+  uint32_t now = 5000;
+  for (uint8_t i = 0; i < RequestGuard::FREE_LOGIN_FAILURES; i++) logins.loginFailed(IP_A, now);
+  assert(logins.loginLockedFor(IP_A, now) == 0);
+  uint32_t expected = RequestGuard::LOCKOUT_BASE_MS;
+  for (int i = 0; i < 12; i++) {
+    logins.loginFailed(IP_A, now);
+    uint32_t locked = logins.loginLockedFor(IP_A, now);
+    assert(locked == std::min(expected, RequestGuard::LOCKOUT_MAX_MS));
+    expected *= 2;
+    now += locked;
+  }
+  uint32_t expired = logins.loginLockedFor(IP_A, now);
+  logins.loginFailed(IP_A, now);
+  logins.loginSucceeded(IP_A);
+  uint32_t cleared = logins.loginLockedFor(IP_A, now);
+  assert(expired == 0 && cleared == 0 && logins.loginLockedFor(IP_B, now) == 0);
+
+  // A locked-out address survives a scan of many others
+  RequestGuard table;
+  for (uint8_t i = 0; i <= RequestGuard::FREE_LOGIN_FAILURES; i++) table.loginFailed(IP_A, 100);
+  for (uint32_t ip = 1; ip <= 1000; ip++) table.admit(ip, 100 + ip / 2);
+  uint32_t kept = table.loginLockedFor(IP_A, 600);
+  assert(kept > 0);
+
+  // The soak scenario's 40/s from one address against the default and the
+  // limit it sets
+  RequestGuard byDefault, configured;
+  configured.setRateLimit(100, 200);
+  double refusedDefault = refusedFraction(byDefault, 40, 600);
+  double refusedConfigured = refusedFraction(configured, 40, 600);
+  assert(refusedDefault > 0.4 && refusedConfigured == 0);
+  printf("soak load 40/s: %.0f%% refused at 20/s burst 40, %.0f%% at 100/s burst 200\n", refusedDefault * 100,
+         refusedConfigured * 100);
+
+  double unguarded = operatorP99(false), guarded = operatorP99(true);
+  assert(guarded < 10 && guarded < unguarded);
+  printf("p99 operator latency under a 500/s flood: unguarded %.1f ms, guarded %.1f ms\n", unguarded, guarded);
+  return 0;
+}
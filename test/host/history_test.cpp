@@ -0,0 +1,104 @@
+// Event history: resume returns exactly the missed events, id 0 is never
+// handed out when the ids wrap, stale cursors are gaps, and the cost of
+// building a catch-up batch.
+//
+// Build: AGVCoreNetwork_History.cpp
+
+#include "AGVCoreNetwork_History.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+typedef std::vector<std::pair<uint32_t, std::string>> Events;
+
+static Events resume(const EventHistory& history, uint32_t afterId, EventHistory::Resume& result) {
+  Events events;
+  result = history.resume(afterId, [&](uint32_t id, const char* text, size_t length) {
+    events.push_back({id, std::string(text, length)});
+  });
+  return events;
+}
+
+int main() {
+  std::mt19937 rng(3);
+  static EventHistory history;
+
+  // Near the top of the id space the ids wrap within the run
+  for (uint32_t base : {1u, 0xFFFFFF00u, 12345u}) {
+    history.reset(base);
+    Events sent;
+    bool wrapped = false;
+    for (int i = 0; i < 100000; i++) {
+      std::string text(1 + rng() % 300, (char)('a' + rng() % 26));
+      uint32_t id = history.append(text.data(), text.size());
+      assert(id != 0 && history.lastId() == id);
+      if (!sent.empty()) {
+        uint32_t expected = sent.back().first + 1 ? sent.back().first + 1 : 1;
+        assert(id == expected);
+        wrapped |= id < sent.back().first;
+      }
+      if (text.size() > EventHistory::MAX_EVENT) text.resize(EventHistory::MAX_EVENT);
+      sent.push_back({id, text});
+
+      // Checked every 97 events, and after every event around the wrap
+      bool nearWrap = id < AGVNET_HISTORY_EVENTS || id > 0u - AGVNET_HISTORY_EVENTS;
+      if (i % 97 != 0 && !(wrapped && nearWrap)) continue;
+
+      // A new client gets the newest events, in order
+      EventHistory::Resume result;
+      Events held = resume(history, 0, result);
+      assert(result == EventHistory::RESUME_OK);
+      size_t guaranteed = AGVNET_HISTORY_BYTES / EventHistory::MAX_EVENT - 1;
+      assert(held.size() >= std::min(sent.size(), guaranteed));
+      assert(Events(sent.end() - held.size(), sent.end()) == held);
+
+      // A cursor anywhere in the held range gets what follows it
+      size_t k = rng() % held.size();
+      Events missed = resume(history, held[k].first, result);
+      assert(result == EventHistory::RESUME_OK);
+      assert(Events(held.begin() + k + 1, held.end()) == missed);
+
+      // Cursors from before the ring or from the future are gaps
+      resume(history, held.front().first - 3, result);
+      assert(held.front().first - 3 == 0 || result == EventHistory::RESUME_GAP);
+      resume(history, history.lastId() + 3, result);
+      assert(result == EventHistory::RESUME_GAP);
+    }
+    assert(wrapped == (base == 0xFFFFFF00u));
+    printf("base %08x: %zu events, %u held at the end%s\n", (unsigned)base, sent.size(), (unsigned)history.size(),
+           wrapped ? ", ids wrapped past 0" : "");
+  }
+
+  // Catch-up cost: the batch handleResume() builds for a new client
+  static EventHistory log;
+  log.reset(777);
+  const char* lines[] = {"WS: move forward", "Executing: turn_left 90", "SERIAL: START",
+                         "SYSTEM_EMERGENCY: Obstacle detected", "Position x=1234 y=2345 heading=90"};
+  for (int i = 0; i < 10000; i++) log.append(lines[i % 5], strlen(lines[i % 5]));
+  static char batch[65536];
+  size_t length = 0;
+  uint32_t count = 0;
+  const int reps = 2000;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; r++) {
+    length = 32;
+    count = 0;
+    log.resume(0, [&](uint32_t id, const char* text, size_t n) {
+      length += snprintf(batch + length, 14, "\n#%lu ", (unsigned long)id);
+      for (size_t i = 0; i < n; i++) batch[length++] = text[i] == '\n' ? ' ' : text[i];
+      count++;
+    });
+  }
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / reps;
+  assert(length <= 32 + log.pendingBytes(0) + (size_t)log.size() * 13 + 1);
+  printf("catch-up batch of %u events (%zu bytes) built in %.1f us\n", (unsigned)count, length, us);
+  return 0;
+}
@@ -0,0 +1,233 @@
+// Keep-alive poll server under load over loopback TCP: four clients poll
+// /status at increasing offered rates, reconnecting per request, on one
+// kept-alive connection, and pipelining four requests at a time. Prints the
+// sustained rate, p99 latency and the 503/429 counts from getStats() per
+// step, then shows the pool refusing a fifth to eighth connection.
+//
+// The server is polled every millisecond as on the network task, with the
+// request guard as admission check (800 requests/s, burst 100).
+//
+// Build: AGVCoreNetwork_Http.cpp AGVCoreNetwork_Guard.cpp test/host/shim/net.cpp
+
+#include "AGVCoreNetwork_Http.h"
+#include "AGVCoreNetwork_Guard.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+typedef std::chrono::steady_clock Clock;
+
+enum Mode { CLOSE, KEEP_ALIVE, PIPELINED };
+static const char* MODE_NAMES[] = {"close", "keep-alive", "pipelined"};
+
+static const int CLIENTS = KeepAliveServer::MAX_CONNECTIONS;
+static const int DEPTH = 4;  // Requests in flight per pipelined client
+static const double STEP_SECONDS = 0.2;
+
+static uint16_t port;
+
+struct Tally {
+  int ok = 0;
+  int refused = 0;           // 503 or 429
+  int failed = 0;            // Connection lost before the answer
+  std::vector<double> latencyUs;
+};
+
+// Blocking client connection, or -1 when it could not connect
+static int openConnection() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in server = {};
+  server.sin_family = AF_INET;
+  server.sin_port = htons(port);
+  server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  timeval timeout = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  if (connect(fd, (sockaddr*)&server, sizeof(server)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Reads one response; returns the status code (0 on a lost connection) and
+// whether the server keeps the connection open
+static int readResponse(int fd, std::string& pending, bool& keepAlive) {
+  char chunk[2048];
+  for (;;) {
+    size_t headerEnd = pending.find("\r\n\r\n");
+    if (headerEnd != std::string::npos) {
+      size_t at = pending.find("Content-Length: ");
+      size_t bodyLength = at < headerEnd ? strtoul(pending.c_str() + at + 16, nullptr, 10) : 0;
+      if (pending.size() >= headerEnd + 4 + bodyLength) {
+        int code = atoi(pending.c_str() + 9);
+        keepAlive = pending.find("Connection: keep-alive") < headerEnd;
+        pending.erase(0, headerEnd + 4 + bodyLength);
+        return code;
+      }
+    }
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) return 0;
+    pending.append(chunk, n);
+  }
+}
+
+static void runClient(Mode mode, double rate, Clock::time_point start, Clock::time_point end, Tally& tally) {
+  const char* request = mode == CLOSE ? "GET /status HTTP/1.1\r\nHost: agv\r\nConnection: close\r\n\r\n"
+                                      : "GET /status HTTP/1.1\r\nHost: agv\r\n\r\n";
+  int batch = mode == PIPELINED ? DEPTH : 1;
+  std::string burst;
+  for (int i = 0; i < batch; i++) burst += request;
+  auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(batch / rate));
+
+  int fd = -1;
+  std::string pending;
+  for (Clock::time_point next = start + interval; next < end; next += interval) {
+    std::this_thread::sleep_until(next);
+    if (fd < 0) fd = openConnection();
+    if (fd < 0) {
+      tally.failed += batch;
+      continue;
+    }
+
+    Clock::time_point sent = Clock::now();
+    send(fd, burst.data(), burst.size(), MSG_NOSIGNAL);
+    bool keepAlive = true;
+    for (int i = 0; i < batch; i++) {
+      int code = keepAlive ? readResponse(fd, pending, keepAlive) : 0;
+      if (code == 200) {
+        tally.ok++;
+        tally.latencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+      } else if (code == 503 || code == 429) {
+        tally.refused++;
+      } else {
+        tally.failed++;
+      }
+    }
+    if (!keepAlive) {
+      close(fd);
+      fd = -1;
+      pending.clear();
+    }
+  }
+  if (fd >= 0) close(fd);
+}
+
+struct Step {
+  double sustained;
+  double p99Us;
+  uint32_t poolFull;
+  uint32_t limited;
+  int failed;
+};
+
+static Step runStep(KeepAliveServer& server, Mode mode, double rate, int clients) {
+  KeepAliveServer::Stats before = server.getStats();
+  std::vector<Tally> tallies(clients);
+  std::vector<std::thread> threads;
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(STEP_SECONDS));
+  for (int i = 0; i < clients; i++) {
+    threads.emplace_back(runClient, mode, rate / clients, start, end, std::ref(tallies[i]));
+  }
+  for (std::thread& t : threads) t.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  Step step = {};
+  std::vector<double> latencies;
+  int ok = 0;
+  for (const Tally& t : tallies) {
+    ok += t.ok;
+    step.failed += t.failed;
+    latencies.insert(latencies.end(), t.latencyUs.begin(), t.latencyUs.end());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  step.sustained = ok / seconds;
+  step.p99Us = latencies.empty() ? 0 : latencies[latencies.size() * 99 / 100];
+  step.poolFull = server.getStats().rejected - before.rejected;
+  step.limited = server.getStats().limited - before.limited;
+  return step;
+}
+
+int main() {
+  // Free port for the server
+  int probe = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(local);
+  bind(probe, (sockaddr*)&local, sizeof(local));
+  getsockname(probe, (sockaddr*)&local, &length);
+  port = ntohs(local.sin_port);
+  close(probe);
+
+  static const char STATUS[] =
+    "{\"wifi\":true,\"ip\":\"10.0.0.17\",\"rssi\":-61,\"clients\":2,\"emergency\":false,\"reason\":\"\","
+    "\"uptime\":81234,\"heap\":182344,\"cpu\":23,\"lease\":0,\"mode\":\"station\",\"fw\":\"1.4.2\"}";
+  KeepAliveServer server(port);
+  RequestGuard guard;
+  guard.setRateLimit(800, 100);
+  server.on("/status", "application/json", [](const char*& body) {
+    body = STATUS;
+    return sizeof(STATUS) - 1;
+  });
+  server.onAdmit([&guard](uint32_t ip) { return guard.admit(ip, millis()) == RequestGuard::ADMIT; });
+  server.begin();
+
+  std::atomic<bool> running(true);
+  std::thread network([&] {
+    while (running) {
+      server.poll();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  const double rates[] = {200, 400, 700, 2000};
+  Step steps[3][4];
+  printf("%-10s %8s %10s %9s %5s %5s\n", "mode", "offered", "sustained", "p99", "503", "429");
+  for (int mode = CLOSE; mode <= PIPELINED; mode++) {
+    for (int r = 0; r < 4; r++) {
+      // Let the guard's bucket refill between steps
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      Step& s = steps[mode][r] = runStep(server, (Mode)mode, rates[r], CLIENTS);
+      printf("%-10s %6.0f/s %8.0f/s %7.2fms %5u %5u\n", MODE_NAMES[mode], rates[r], s.sustained, s.p99Us / 1000,
+             (unsigned)s.poolFull, (unsigned)s.limited);
+    }
+  }
+
+  // Eight kept-alive clients: the four beyond the pool are answered 503
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  Step crowded = runStep(server, KEEP_ALIVE, 200, 2 * CLIENTS);
+  printf("%-10s %6.0f/s %8.0f/s %7.2fms %5u %5u  (%d clients)\n", "crowded", 200.0, crowded.sustained,
+         crowded.p99Us / 1000, (unsigned)crowded.poolFull, (unsigned)crowded.limited, 2 * CLIENTS);
+
+  running = false;
+  network.join();
+  const KeepAliveServer::Stats& stats = server.getStats();
+  printf("server: %u accepted, %u requests, %u pool full, %u limited, %u timeouts, %u errors\n",
+         (unsigned)stats.accepted, (unsigned)stats.requests, (unsigned)stats.rejected, (unsigned)stats.limited,
+         (unsigned)stats.timeouts, (unsigned)stats.errors);
+
+  // Under the guard's rate every mode keeps up without refusals; above it
+  // the guard answers 429; beyond the pool, 503
+  for (int mode = CLOSE; mode <= PIPELINED; mode++) {
+    const Step& low = steps[mode][0];
+    assert(low.sustained > rates[0] * 0.8 && low.poolFull == 0 && low.limited == 0 && low.failed == 0);
+    assert(steps[mode][3].limited > 0);
+  }
+  assert(crowded.poolFull > 0 && stats.errors == 0);
+  return 0;
+}
@@ -0,0 +1,43 @@
+// Many AGVCoreNetwork instances in one process: each keeps its own state,
+// and the memory one instance costs.
+//
+// Build: AGVCoreNetwork*.cpp test/host/shim/platform.cpp test/host/shim/net.cpp test/host/shim/web.cpp test/host/shim/websockets.cpp -lcrypto
+
+#include "AGVCoreNetwork.h"
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static const int INSTANCES = 100;
+
+int main() {
+  std::vector<std::unique_ptr<AGVCoreNetwork>> vehicles;
+  for (int i = 0; i < INSTANCES; i++) {
+    vehicles.emplace_back(new AGVCoreNetwork());
+    vehicles.back()->setServerPorts(8000 + 2 * i, 8001 + 2 * i);
+    vehicles.back()->setControlLeaseDuration(i % 2 ? 5000 : 0);
+  }
+
+  // An emergency on one vehicle stays on that vehicle
+  vehicles[7]->broadcastEmergency("bumper");
+  for (int i = 0; i < INSTANCES; i++) {
+    AGVCoreNetwork::StatusSnapshot status;
+    vehicles[i]->getStatusSnapshot(status);
+    assert(vehicles[i]->isEmergencyActive() == (i == 7));
+    assert(status.emergency == (i == 7));
+    assert(strcmp(status.emergencyReason, i == 7 ? "bumper" : "") == 0);
+  }
+  vehicles[7]->clearEmergencyState();
+  assert(!vehicles[7]->isEmergencyActive());
+
+  printf("sizeof(AGVCoreNetwork) %zu bytes, %d instances %zu KiB\n", sizeof(AGVCoreNetwork), INSTANCES,
+         INSTANCES * sizeof(AGVCoreNetwork) / 1024);
+  printf("largest parts: flight recorder %zu, timer wheel %zu, clock sync x%d %zu, OTA updater %zu\n",
+         sizeof(FlightRecorder), sizeof(TimerWheel), WEBSOCKETS_SERVER_CLIENT_MAX,
+         sizeof(ClockSync) * WEBSOCKETS_SERVER_CLIENT_MAX, sizeof(OtaUpdater));
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Motion lease: grant, handover, decline, expiry across the tick wrap, and
+// competing clients that only command while they hold the lease.
+//
+// Build: AGVCoreNetwork_Lease.cpp
+
+#include "AGVCoreNetwork_Lease.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static const int CLIENTS = 5;
+static const int ROUNDS = 20000;
+
+int main() {
+  ControlLease lease;
+
+  // Off by default: everyone commands, nobody can acquire
+  assert(!lease.enabled());
+  assert(lease.holds(3, 1000));
+  assert(lease.acquire(3, 1000) == ControlLease::LEASE_DENIED);
+
+  lease.setDuration(5000);
+  assert(lease.acquire(1, 1000) == ControlLease::LEASE_GRANTED);
+  assert(lease.acquire(2, 1100) == ControlLease::LEASE_REQUESTED);
+  assert(lease.requester() == 2);
+  assert(lease.holds(1, 1200) && !lease.holds(2, 1200));
+
+  // Declined: holder keeps it, the request is gone
+  assert(lease.decline(2, 1200) == ControlLease::NONE);
+  assert(lease.decline(1, 1200) == 2);
+  assert(lease.requester() == ControlLease::NONE && lease.holds(1, 1200));
+
+  // Handover on release, then expiry without renewal
+  assert(lease.acquire(2, 1300) == ControlLease::LEASE_REQUESTED);
+  assert(lease.release(1, 1300) == 2 && lease.holds(2, 1300));
+  assert(lease.renew(2, 5000) && lease.holds(2, 9900));
+  assert(!lease.holds(2, 10100) && !lease.renew(2, 10100));
+  assert(lease.acquire(3, 10200) == ControlLease::LEASE_GRANTED);
+  lease.drop(3);
+  assert(lease.holder(10300) == ControlLease::NONE);
+
+  // Expiry across the 24-bit tick wrap
+  uint32_t base = (0xFFFFFFu - 10) * 100;
+  assert(lease.acquire(1, base) == ControlLease::LEASE_GRANTED);
+  assert(lease.holds(1, base + 4000) && !lease.holds(1, base + 5100));
+  lease.drop(1);
+
+  // Competing clients: each keeps requesting, commands only while it holds
+  // the lease and hands it over when done. At most one may be inside.
+  std::atomic<int> inside{0};
+  std::atomic<int> overlaps{0};
+  std::atomic<int> handovers{0};
+  std::atomic<int> grants[CLIENTS] = {};
+  const uint32_t now = 50000;          // Frozen clock: only handovers move the lease
+  std::vector<std::thread> clients;
+  for (int c = 0; c < CLIENTS; c++) {
+    clients.emplace_back([&, c] {
+      for (int round = 0; round < ROUNDS; round++) {
+        if (!lease.holds(c, now)) {
+          lease.acquire(c, now);
+          std::this_thread::yield();
+          continue;
+        }
+        if (inside.fetch_add(1) != 0) overlaps++;
+        grants[c]++;
+        inside.fetch_sub(1);
+        if (lease.release(c, now) != ControlLease::NONE) handovers++;
+      }
+      lease.drop(c);
+    });
+  }
+  for (std::thread& t : clients) t.join();
+
+  int total = 0;
+  for (int c = 0; c < CLIENTS; c++) total += grants[c];
+  printf("%d clients: %d commanded turns, %d handovers, %d overlaps\n", CLIENTS, total,
+         handovers.load(), overlaps.load());
+  for (int c = 0; c < CLIENTS; c++) assert(grants[c] > 0);
+  return overlaps == 0 ? 0 : 1;
+}
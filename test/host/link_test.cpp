@@ -0,0 +1,89 @@
+// Link policy: the moving profile follows motion and command activity, a
+// pause inside the hold-off does not flap the radio, a fixed profile pins
+// it, and round-trip statistics per profile.
+//
+// The radio is a stand-in that holds each downlink frame until the next
+// wake-up of the applied profile (0, 102.4 or 307.2 ms).
+//
+// Build: AGVCoreNetwork_Link.cpp
+
+#include "AGVCoreNetwork_Link.h"
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+
+using namespace AGVCoreNetworkLib;
+
+struct Radio {
+  LinkProfile profile = LINK_PROFILE_COUNT;
+  int applies = 0;
+  std::mt19937 rng{1};
+
+  void apply(LinkProfile p) {
+    profile = p;
+    applies++;
+  }
+
+  uint32_t roundTripUs() {
+    std::uniform_real_distribution<double> u(0, 1);
+    double wake = profile == LINK_LOW_LATENCY ? 0 : profile == LINK_BALANCED ? 102400 : 307200;
+    return (uint32_t)(2500 + u(rng) * 1500 + u(rng) * wake);
+  }
+};
+
+int main() {
+  // Parked 0-60 s, path 60-120 s with commands every 2 s, paused 5 s,
+  // moving again 125-180 s, then parked
+  LinkPolicy policy;
+  Radio radio;
+  policy.setAuto(LINK_LOW_LATENCY, LINK_POWER_SAVE, 10000);
+  for (uint32_t t = 0; t < 300000; t += 10) {
+    policy.setMoving((t >= 60000 && t < 120000) || (t >= 125000 && t < 180000));
+    if (t >= 60000 && t < 180000 && t % 2000 == 0) policy.activity(t);
+
+    LinkProfile wanted = policy.evaluate(t);
+    if (wanted != policy.current()) {
+      radio.apply(wanted);
+      policy.applied(wanted, t);
+    }
+    if (t % 1000 == 0) policy.recordLatency(radio.roundTripUs());
+
+    if (t == 59990) assert(policy.current() == LINK_POWER_SAVE);
+    if (t == 122000) assert(policy.current() == LINK_LOW_LATENCY);
+    if (t == 185000) assert(policy.current() == LINK_LOW_LATENCY);
+    if (t == 195000) assert(policy.current() == LINK_POWER_SAVE);
+  }
+  assert(radio.applies == 3);
+
+  LinkPolicy::Stats stats[LINK_PROFILE_COUNT];
+  uint32_t resident = 0;
+  for (uint8_t i = 0; i < LINK_PROFILE_COUNT; i++) {
+    policy.getStats((LinkProfile)i, stats[i], 300000);
+    resident += stats[i].residentMs;
+    printf("%-11s %3u samples, median %5.1f ms, p95 %5.1f ms, max %5.1f ms, %u switches, %3u s\n",
+           LinkPolicy::name((LinkProfile)i), (unsigned)stats[i].samples, stats[i].medianUs / 1e3,
+           stats[i].p95Us / 1e3, stats[i].maxUs / 1e3, (unsigned)stats[i].switches,
+           (unsigned)(stats[i].residentMs / 1000));
+  }
+  assert(resident == 300000);
+  assert(stats[LINK_LOW_LATENCY].switches == 1 && stats[LINK_POWER_SAVE].switches == 2);
+  assert(stats[LINK_BALANCED].samples == 0);
+  assert(stats[LINK_LOW_LATENCY].p95Us < 5000 && stats[LINK_POWER_SAVE].p95Us > 100000);
+  assert(stats[LINK_LOW_LATENCY].minUs <= stats[LINK_LOW_LATENCY].medianUs &&
+         stats[LINK_LOW_LATENCY].medianUs <= stats[LINK_LOW_LATENCY].p95Us &&
+         stats[LINK_LOW_LATENCY].p95Us <= stats[LINK_LOW_LATENCY].maxUs);
+
+  // A fixed profile ignores motion and activity
+  policy.setFixed(LINK_BALANCED);
+  policy.setMoving(true);
+  policy.activity(300000);
+  assert(!policy.isAuto() && policy.evaluate(300000) == LINK_BALANCED);
+
+  // Untouched, the link idles in the ESP32 default and commands wake it up
+  LinkPolicy defaults;
+  assert(defaults.evaluate(0) == LINK_BALANCED);
+  defaults.activity(1000);
+  assert(defaults.evaluate(1000) == LINK_LOW_LATENCY && defaults.evaluate(11001) == LINK_BALANCED);
+  return 0;
+}
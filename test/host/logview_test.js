@@ -0,0 +1,107 @@
+// Dashboard log view: the ring keeps the newest LOG_CAPACITY entries, only
+// the visible rows exist in the DOM, messages are text (never markup), a
+// scrolled-up view stays anchored, and the cost per message and per frame.
+//
+// The log code is taken from the dashboard page in AGVCoreNetwork_Resources.h
+// and run against a minimal DOM.
+'use strict';
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const page = fs.readFileSync(path.join(__dirname, '../../AGVCoreNetwork_Resources.h'), 'utf8');
+const begin = page.indexOf('        // Log view: a fixed-capacity ring');
+const end = page.indexOf('        function sendCommand(command) {');
+assert.ok(begin > 0 && end > begin, 'log view code not found in the dashboard page');
+
+let created = 0;
+class Node {
+    constructor(tag) {
+        this.tag = tag;
+        this.childNodes = [];
+        this.style = {};
+        this.className = '';
+        this.textContent = '';
+    }
+    appendChild(node) { this.childNodes.push(node); created++; return node; }
+    removeChild(node) { this.childNodes.splice(this.childNodes.indexOf(node), 1); }
+    get firstChild() { return this.childNodes[0]; }
+    get lastChild() { return this.childNodes[this.childNodes.length - 1]; }
+}
+
+const spacer = new Node('div');
+const rows = new Node('div');
+const container = new Node('div');
+container.clientHeight = 300;
+let scrollTop = 0;
+Object.defineProperty(container, 'scrollHeight', { get: () => parseInt(spacer.style.height) || 0 });
+Object.defineProperty(container, 'scrollTop', {
+    get: () => scrollTop,
+    set: (v) => { scrollTop = Math.max(0, Math.min(v, container.scrollHeight - container.clientHeight)); }
+});
+
+let frames = [];
+const context = {
+    document: {
+        getElementById: (id) => ({ logContainer: container, logSpacer: spacer, logRows: rows })[id],
+        createElement: (tag) => new Node(tag)
+    },
+    requestAnimationFrame: (f) => frames.push(f),
+    Date: Date
+};
+vm.createContext(context);
+vm.runInContext(page.slice(begin, end) +
+    '\nthis.view = { addLog, onLogScroll, clearLogs, logRing, LOG_CAPACITY, LOG_ROW_HEIGHT };', context);
+const { addLog, onLogScroll, clearLogs, logRing, LOG_CAPACITY, LOG_ROW_HEIGHT } = context.view;
+
+function flush() {
+    const pending = frames;
+    frames = [];
+    pending.forEach((f) => f());
+}
+
+// A burst is drawn once, and only the newest entries are kept
+for (let i = 0; i < 5000; i++) addLog('<b>msg ' + i + '</b>', i % 3 ? 'web' : 'serial');
+assert.strictEqual(frames.length, 1, 'one frame per burst');
+flush();
+assert.strictEqual(logRing.length, LOG_CAPACITY);
+assert.strictEqual(logRing.at(0).message, '<b>msg 3000</b>');
+assert.ok(rows.childNodes.length <= Math.ceil(container.clientHeight / LOG_ROW_HEIGHT) + 1, 'only visible rows');
+assert.strictEqual(rows.lastChild.lastChild.textContent, '<b>msg 4999</b>', 'text, not markup');
+
+// Scrolled up, new entries do not move the rows being read
+container.scrollTop = LOG_ROW_HEIGHT * 100;
+onLogScroll();
+flush();
+const reading = rows.firstChild.lastChild.textContent;
+for (let i = 0; i < 50; i++) addLog('late ' + i);
+flush();
+assert.strictEqual(rows.firstChild.lastChild.textContent, reading, 'view anchored');
+
+clearLogs();
+flush();
+assert.strictEqual(logRing.length, 1);
+
+// Cost: 50 messages per frame, then a frame per message
+container.scrollTop = 1e9;
+onLogScroll();
+flush();
+const N = 200000;
+let start = process.hrtime.bigint();
+for (let i = 0; i < N; i++) {
+    addLog('Executing: move forward ' + i, 'web');
+    if (i % 50 === 49) flush();
+}
+flush();
+const perMessage = Number(process.hrtime.bigint() - start) / N;
+const R = 20000;
+start = process.hrtime.bigint();
+for (let i = 0; i < R; i++) {
+    addLog('x');
+    flush();
+}
+const perFrame = Number(process.hrtime.bigint() - start) / R;
+console.log(`addLog ${perMessage.toFixed(0)} ns/message at 50 per frame; append and render ` +
+    `${rows.childNodes.length} of ${logRing.length} rows ${(perFrame / 1000).toFixed(1)} us/frame; ` +
+    `${created} DOM nodes created in total`);
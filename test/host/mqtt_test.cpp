@@ -0,0 +1,272 @@
+// MQTT transport against a loopback fake broker: CONNACK with and without
+// session present, status batching, QoS 1 emergency messages resent with
+// DUP until PUBACK and in queue order across a reconnect, commands delivered
+// through the filter, and the keep-alive timeout. The transport runs on a
+// test clock; the broker is a plain socket served between loop() calls.
+//
+// Build: AGVCoreNetwork_Mqtt.cpp AGVCoreNetwork_Filter.cpp test/host/shim/platform.cpp test/host/shim/net.cpp
+
+#include "AGVCoreNetwork_Mqtt.h"
+#include "AGVCoreNetwork_Filter.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+static uint32_t now = 100000;
+unsigned long millis() { return now; }
+
+struct Packet {
+  uint8_t header = 0;
+  std::string body;
+
+  uint8_t type() const { return header & 0xF0; }
+  bool dup() const { return header & 0x08; }
+  uint8_t qos() const { return (header >> 1) & 0x03; }
+  bool retain() const { return header & 0x01; }
+  std::string topic() const { return body.substr(2, ((uint8_t)body[0] << 8) | (uint8_t)body[1]); }
+  uint16_t packetId() const {
+    size_t at = 2 + topic().size();
+    return ((uint8_t)body[at] << 8) | (uint8_t)body[at + 1];
+  }
+  std::string payload() const { return body.substr(2 + topic().size() + (qos() ? 2 : 0)); }
+};
+
+struct Broker {
+  int listenFd = -1;
+  int fd = -1;
+  uint16_t port = 0;
+
+  bool listen() {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(local);
+    if (bind(listenFd, (sockaddr*)&local, sizeof(local)) != 0 || ::listen(listenFd, 4) != 0) return false;
+    getsockname(listenFd, (sockaddr*)&local, &length);
+    port = ntohs(local.sin_port);
+    return true;
+  }
+
+  bool accept() {
+    pollfd readable = {listenFd, POLLIN, 0};
+    if (poll(&readable, 1, 1000) != 1) return false;
+    fd = ::accept(listenFd, nullptr, nullptr);
+    return fd >= 0;
+  }
+
+  void drop() {
+    close(fd);
+    fd = -1;
+  }
+
+  bool readByte(uint8_t& c, int timeoutMs) {
+    pollfd readable = {fd, POLLIN, 0};
+    return poll(&readable, 1, timeoutMs) == 1 && recv(fd, &c, 1, 0) == 1;
+  }
+
+  // Next packet from the vehicle, or false if none arrives in time
+  bool read(Packet& packet, int timeoutMs = 200) {
+    uint8_t c;
+    if (!readByte(packet.header, timeoutMs)) return false;
+    size_t length = 0, multiplier = 1;
+    do {
+      if (!readByte(c, 1000)) return false;
+      length += (c & 0x7F) * multiplier;
+      multiplier *= 128;
+    } while (c & 0x80);
+    packet.body.resize(length);
+    for (size_t i = 0; i < length; i++) {
+      if (!readByte(c, 1000)) return false;
+      packet.body[i] = c;
+    }
+    return true;
+  }
+
+  bool closed() {
+    uint8_t c;
+    pollfd readable = {fd, POLLIN, 0};
+    return poll(&readable, 1, 1000) == 1 && recv(fd, &c, 1, 0) == 0;
+  }
+
+  void send(uint8_t header, const std::string& body) {
+    std::string packet(1, (char)header);
+    size_t length = body.size();
+    do {
+      uint8_t b = length % 128;
+      length /= 128;
+      packet += (char)(b | (length ? 0x80 : 0));
+    } while (length);
+    packet += body;
+    ::send(fd, packet.data(), packet.size(), 0);
+  }
+
+  void connack(bool sessionPresent) { send(0x20, std::string{(char)sessionPresent, 0}); }
+  void puback(uint16_t id) { send(0x40, std::string{(char)(id >> 8), (char)(id & 0xFF)}); }
+
+  void publish(const std::string& topic, const std::string& payload, int qos, uint16_t id) {
+    std::string body{(char)(topic.size() >> 8), (char)(topic.size() & 0xFF)};
+    body += topic;
+    if (qos) body += std::string{(char)(id >> 8), (char)(id & 0xFF)};
+    send(0x30 | (qos << 1), body + payload);
+  }
+};
+
+// Runs the transport until the broker has read one packet
+static bool exchange(MqttTransport& mqtt, Broker& broker, Packet& packet) {
+  for (int i = 0; i < 20; i++) {
+    mqtt.loop();
+    if (broker.read(packet, 10)) return true;
+  }
+  return false;
+}
+
+// Every emergency payload the broker receives up to the first other packet
+static std::vector<Packet> emergencies(MqttTransport& mqtt, Broker& broker) {
+  std::vector<Packet> sent;
+  Packet packet;
+  mqtt.loop();
+  while (broker.read(packet, 50) && packet.topic() == "plant/agv7/emergency") sent.push_back(packet);
+  return sent;
+}
+
+int main() {
+  hostStationLink(true);
+  Broker broker;
+  bool listening = broker.listen();
+  assert(listening);
+
+  CommandFilter filter;
+  filter.addRule("move", "word:forward|backward|left|right int:1:5000?");
+  std::vector<std::string> accepted, refused;
+
+  MqttTransport mqtt("127.0.0.1", broker.port);
+  mqtt.setTopicPrefix("plant");
+  mqtt.onCommand([&](const char* command, size_t length) {
+    bool ok = filter.check(command, length, now, false) == CommandFilter::CMD_OK;
+    (ok ? accepted : refused).push_back(command);
+  });
+  mqtt.begin("agv7");
+
+  // New session: persistent, with a retained last will, then the command
+  // subscription and the retained online flag
+  Packet packet;
+  mqtt.loop();
+  bool accepted1 = broker.accept() && broker.read(packet);
+  assert(accepted1 && packet.type() == 0x10);
+  uint8_t flags = packet.body[7];
+  assert(!(flags & 0x02) && (flags & 0x04) && (flags & 0x20));
+  broker.connack(false);
+  bool subscribed = exchange(mqtt, broker, packet);
+  assert(subscribed && packet.type() == 0x80 && packet.body.substr(4, 12) == "plant/agv7/c");
+  bool online = broker.read(packet);
+  assert(online && packet.topic() == "plant/agv7/online" && packet.retain() && packet.payload() == "1");
+  assert(mqtt.connected() && mqtt.getStats().connects == 1 && mqtt.getStats().sessionResumes == 0);
+
+  // Telemetry lines within one interval go out as one QoS 0 message
+  mqtt.publish(Transport::CHANNEL_STATUS, "a=1", 3);
+  mqtt.publish(Transport::CHANNEL_STATUS, "b=2", 3);
+  mqtt.publish(Transport::CHANNEL_STATUS, "c=3", 3);
+  mqtt.loop();
+  bool early = broker.read(packet, 50);
+  now += 200;
+  bool batched = exchange(mqtt, broker, packet);
+  assert(!early && batched && packet.topic() == "plant/agv7/status" && packet.qos() == 0);
+  assert(packet.payload() == "a=1\nb=2\nc=3" && mqtt.getStats().batches == 1);
+
+  // QoS 1: resent with DUP after the ack timeout, never after the PUBACK
+  mqtt.publish(Transport::CHANNEL_EMERGENCY, "estop", 5);
+  std::vector<Packet> first = emergencies(mqtt, broker);
+  now += 5001;
+  std::vector<Packet> second = emergencies(mqtt, broker);
+  assert(first.size() == 1 && !first[0].dup() && first[0].qos() == 1 && first[0].retain());
+  assert(second.size() == 1 && second[0].dup() && second[0].packetId() == first[0].packetId());
+  broker.puback(first[0].packetId());
+  mqtt.loop();
+  now += 5001;
+  std::vector<Packet> third = emergencies(mqtt, broker);
+  assert(third.empty() && mqtt.getStats().retransmits == 1);
+  printf("qos1: sent, resent with DUP, acknowledged\n");
+
+  // Queue order across a reconnect: "clear" takes the slot "estop" freed but
+  // is newer than "fault" and "bumper", so it goes out last and stays retained
+  mqtt.publish(Transport::CHANNEL_EMERGENCY, "estop", 5);
+  mqtt.publish(Transport::CHANNEL_EMERGENCY, "fault", 5);
+  mqtt.publish(Transport::CHANNEL_EMERGENCY, "bumper", 6);
+  std::vector<Packet> queued = emergencies(mqtt, broker);
+  assert(queued.size() == 3);
+  broker.puback(queued[0].packetId());
+  mqtt.loop();
+  mqtt.publish(Transport::CHANNEL_EMERGENCY, "clear", 5);
+  queued = emergencies(mqtt, broker);
+  assert(queued.size() == 1 && queued[0].payload() == "clear");
+
+  broker.drop();
+  mqtt.loop();
+  now += 1000;
+  mqtt.loop();
+  bool reconnected = broker.accept() && broker.read(packet);
+  assert(reconnected && packet.type() == 0x10 && !mqtt.connected());
+  broker.connack(true);
+  online = exchange(mqtt, broker, packet);
+  assert(online && packet.topic() == "plant/agv7/online");  // No SUBSCRIBE on a resumed session
+  std::vector<Packet> resent = emergencies(mqtt, broker);
+  std::string order;
+  for (const Packet& p : resent) order += p.payload() + (p.dup() ? "* " : " ");
+  assert(order == "fault* bumper* clear* ");
+  assert(mqtt.getStats().sessionResumes == 1);
+
+  // An ack timeout on the oldest entry resends the newer ones behind it
+  broker.puback(resent[2].packetId());
+  mqtt.loop();
+  now += 5001;
+  resent = emergencies(mqtt, broker);
+  order.clear();
+  for (const Packet& p : resent) order += p.payload() + " ";
+  assert(order == "fault bumper ");
+  for (const Packet& p : resent) broker.puback(p.packetId());
+  mqtt.loop();
+  printf("qos1 across reconnect: %s\n", order.c_str());
+
+  // Commands reach the handler at either QoS; QoS 1 is acknowledged and
+  // other topics are not delivered
+  broker.publish("plant/agv7/cmd", "move forward 250", 0, 0);
+  broker.publish("plant/agv7/cmd", "move up", 1, 0x1234);
+  broker.publish("plant/agv8/cmd", "move left", 0, 0);
+  bool acked = exchange(mqtt, broker, packet);
+  assert(acked && packet.type() == 0x40 && packet.body == std::string("\x12\x34", 2));
+  assert(accepted.size() == 1 && accepted[0] == "move forward 250");
+  assert(refused.size() == 1 && refused[0] == "move up");
+  assert(mqtt.getStats().received == 3);
+
+  // Keep-alive: ping after half the interval idle, drop when no PINGRESP
+  // arrives within the interval
+  now += 15001;
+  bool pinged = exchange(mqtt, broker, packet);
+  assert(pinged && packet.type() == 0xC0);
+  broker.send(0xD0, "");
+  mqtt.loop();
+  now += 15001;
+  pinged = exchange(mqtt, broker, packet);
+  assert(pinged && packet.type() == 0xC0);
+  now += 30001;
+  mqtt.loop();
+  bool closed = broker.closed();
+  assert(closed && !mqtt.connected());
+
+  const MqttTransport::Stats& stats = mqtt.getStats();
+  printf("%u connects (%u resumed), %u published in %u batches, %u retransmits, %u received\n",
+         (unsigned)stats.connects, (unsigned)stats.sessionResumes, (unsigned)stats.published,
+         (unsigned)stats.batches, (unsigned)stats.retransmits, (unsigned)stats.received);
+  mqtt.stop();
+  return 0;
+}
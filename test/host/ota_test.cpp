@@ -0,0 +1,174 @@
+// OTA updater against a file-backed partition stand-in: full and delta
+// images produce the same bytes, a wrong hash or truncated upload is never
+// committed, and the throughput of both paths.
+//
+// Build: AGVCoreNetwork_Ota.cpp -lcrypto
+
+#include "AGVCoreNetwork_Ota.h"
+
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+// The ESP-IDF side is not exercised on the host
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t*) { return nullptr; }
+const esp_partition_t* esp_ota_get_running_partition() { return nullptr; }
+esp_err_t esp_ota_begin(const esp_partition_t*, size_t, esp_ota_handle_t*) { return -1; }
+esp_err_t esp_ota_write(esp_ota_handle_t, const void*, size_t) { return -1; }
+esp_err_t esp_ota_end(esp_ota_handle_t) { return -1; }
+esp_err_t esp_ota_abort(esp_ota_handle_t) { return -1; }
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t*) { return -1; }
+esp_err_t esp_ota_get_state_partition(const esp_partition_t*, esp_ota_img_states_t*) { return -1; }
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() { return -1; }
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot() { return -1; }
+esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) { return -1; }
+
+// Inactive slot in a temporary file, running image in memory
+class FileFlashWriter : public FlashWriter {
+public:
+  explicit FileFlashWriter(const std::vector<uint8_t>& running) : running(running) {}
+  ~FileFlashWriter() override { abort(); }
+
+  bool begin() override {
+    slot = tmpfile();
+    return slot != nullptr;
+  }
+  bool write(const uint8_t* data, size_t length) override { return fwrite(data, 1, length, slot) == length; }
+  size_t sourceSize() override { return running.size(); }
+  bool readSource(uint32_t offset, uint8_t* out, size_t length) override {
+    if (offset + length > running.size()) return false;
+    memcpy(out, running.data() + offset, length);
+    return true;
+  }
+  bool commit() override {
+    committed = true;
+    return true;
+  }
+  void abort() override {
+    if (slot) fclose(slot);
+    slot = nullptr;
+  }
+
+  std::vector<uint8_t> contents() {
+    std::vector<uint8_t> image;
+    if (!slot) return image;
+    rewind(slot);
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), slot)) > 0) image.insert(image.end(), buffer, buffer + n);
+    return image;
+  }
+
+  bool committed = false;
+
+private:
+  const std::vector<uint8_t>& running;
+  FILE* slot = nullptr;
+};
+
+// Builds a new image from the running one and the delta that describes it
+struct DeltaBuilder {
+  const std::vector<uint8_t>& source;
+  std::vector<uint8_t> target;
+  std::vector<uint8_t> delta = {'A', 'G', 'V', 'D', 1, 0, 0, 0, 0};
+  uint32_t copyEnd = 0;
+
+  explicit DeltaBuilder(const std::vector<uint8_t>& source) : source(source) {}
+
+  void varint(uint32_t value) {
+    while (value >= 0x80) {
+      delta.push_back((uint8_t)(value | 0x80));
+      value >>= 7;
+    }
+    delta.push_back((uint8_t)value);
+  }
+  void copy(uint32_t offset, uint32_t length) {
+    int32_t relative = (int32_t)(offset - copyEnd);
+    varint(length << 1);
+    varint(((uint32_t)relative << 1) ^ (uint32_t)(relative >> 31));
+    target.insert(target.end(), source.begin() + offset, source.begin() + offset + length);
+    copyEnd = offset + length;
+  }
+  void insert(const std::vector<uint8_t>& bytes) {
+    varint((uint32_t)(bytes.size() << 1) | 1);
+    delta.insert(delta.end(), bytes.begin(), bytes.end());
+    target.insert(target.end(), bytes.begin(), bytes.end());
+  }
+  void finish() {
+    for (int i = 0; i < 4; i++) delta[5 + i] = (uint8_t)(target.size() >> (8 * i));
+  }
+};
+
+static OtaUpdater::Error upload(FileFlashWriter& writer, OtaUpdater::Format format,
+                                const std::vector<uint8_t>& image, size_t length, const uint8_t* hash) {
+  OtaUpdater updater;
+  if (!updater.begin(&writer, format, hash)) return updater.getError();
+  // One TCP segment per chunk, as the web server hands the upload over
+  for (size_t o = 0; o < length; o += 1436) updater.write(&image[o], std::min<size_t>(1436, length - o));
+  return updater.end();
+}
+
+int main() {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> running(1 << 20);
+  for (uint8_t& b : running) b = (uint8_t)rng();
+
+  // New image: 64 patched regions, a 1 KB insertion and a backwards copy
+  DeltaBuilder builder(running);
+  uint32_t offset = 0;
+  for (int k = 0; k < 64; k++) {
+    uint32_t length = 8000 + rng() % 8000;
+    builder.copy(offset, length);
+    offset += length;
+    std::vector<uint8_t> patch(k == 32 ? 1024 : 40);
+    for (uint8_t& b : patch) b = (uint8_t)rng();
+    builder.insert(patch);
+    if (k == 32) builder.copy(1000, 4096);
+    else offset += 40;
+  }
+  builder.copy(offset, (uint32_t)running.size() - offset);
+  builder.finish();
+  const std::vector<uint8_t>& target = builder.target;
+  const std::vector<uint8_t>& delta = builder.delta;
+
+  uint8_t hash[SHA256_DIGEST_LENGTH];
+  SHA256(target.data(), target.size(), hash);
+
+  for (OtaUpdater::Format format : {OtaUpdater::FORMAT_FULL, OtaUpdater::FORMAT_DELTA}) {
+    const std::vector<uint8_t>& image = format == OtaUpdater::FORMAT_DELTA ? delta : target;
+    FileFlashWriter writer(running);
+    auto start = std::chrono::steady_clock::now();
+    OtaUpdater::Error error = upload(writer, format, image, image.size(), hash);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(error == OtaUpdater::OTA_OK && writer.committed);
+    assert(writer.contents() == target);
+    printf("%s: %zu bytes uploaded for a %zu-byte image, %.1f ms (%.0f MB/s written)\n",
+           format == OtaUpdater::FORMAT_DELTA ? "delta" : "full", image.size(), target.size(), ms,
+           target.size() / ms / 1000);
+  }
+
+  // Wrong hash
+  uint8_t wrong[SHA256_DIGEST_LENGTH] = {};
+  FileFlashWriter mismatched(running);
+  OtaUpdater::Error error = upload(mismatched, OtaUpdater::FORMAT_DELTA, delta, delta.size(), wrong);
+  assert(error == OtaUpdater::OTA_HASH_MISMATCH && !mismatched.committed);
+
+  // Truncated upload
+  FileFlashWriter truncated(running);
+  error = upload(truncated, OtaUpdater::FORMAT_DELTA, delta, delta.size() / 2, hash);
+  assert(error != OtaUpdater::OTA_OK && !truncated.committed);
+
+  // A copy beyond the running image is a bad delta
+  std::vector<uint8_t> outside = {'A', 'G', 'V', 'D', 1, 16, 0, 0, 0, 16 << 1, 0x80, 0x80, 0x80, 0x01};
+  FileFlashWriter invalid(running);
+  error = upload(invalid, OtaUpdater::FORMAT_DELTA, outside, outside.size(), hash);
+  assert(error == OtaUpdater::OTA_BAD_DELTA && !invalid.committed);
+  return 0;
+}
@@ -0,0 +1,159 @@
+// Binary path format: a route survives encoding and decoding at every frame
+// split, malformed data is refused, and the benchmark against the ASCII
+// PATH: form that the format replaces.
+//
+// Build: AGVCoreNetwork_Path.cpp
+
+#include "AGVCoreNetwork_Path.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+struct Cell {
+  int32_t x, y;
+  bool operator==(const Cell& o) const { return x == o.x && y == o.y; }
+};
+
+// Expands decoded waypoints back into the cells they cover
+struct Expander {
+  std::vector<Cell> cells;
+  std::vector<PathDecoder::Waypoint> waypoints;
+
+  void operator()(const PathDecoder::Waypoint& w) {
+    waypoints.push_back(w);
+    if (w.flags & PathDecoder::WAYPOINT_START) {
+      cells.push_back({w.x, w.y});
+      return;
+    }
+    if (w.flags & PathDecoder::WAYPOINT_END) return;
+    Cell from = cells.back();
+    int32_t dx = w.x - from.x, dy = w.y - from.y;
+    bool unit = dx == 0 || dy == 0 || abs(dx) == abs(dy);
+    if (!unit) {
+      cells.push_back({w.x, w.y});      // Jump
+      return;
+    }
+    int32_t sx = (dx > 0) - (dx < 0), sy = (dy > 0) - (dy < 0);
+    for (int32_t i = 1; i <= (int32_t)w.steps; i++) cells.push_back({from.x + sx * i, from.y + sy * i});
+  }
+};
+
+static std::vector<Cell> decode(const uint8_t* data, size_t length, size_t chunk, PathDecoder::State& state,
+                                std::vector<PathDecoder::Waypoint>* waypoints = nullptr) {
+  Expander expander;
+  PathDecoder decoder;
+  decoder.setHandler([&](const PathDecoder::Waypoint& w) { expander(w); });
+  for (size_t o = 0; o < length; o += chunk) decoder.feed(data + o, length - o < chunk ? length - o : chunk);
+  state = decoder.getState();
+  if (waypoints) *waypoints = expander.waypoints;
+  return expander.cells;
+}
+
+int main() {
+  // Manhattan route with every cell listed, as the dashboard sends it
+  std::vector<Cell> route;
+  srand(1);
+  Cell c = {3, 5};
+  route.push_back(c);
+  while (route.size() < 5000) {
+    int d = rand() % 4, n = 1 + rand() % 12;
+    for (int k = 0; k < n && route.size() < 5000; k++) {
+      if (d == 0) c.x++; else if (d == 1) c.y++; else if (d == 2) c.x--; else c.y--;
+      route.push_back(c);
+    }
+  }
+
+  static uint8_t buffer[65536];
+  PathEncoder encoder(buffer, sizeof(buffer));
+  bool encoded = encoder.begin(route[0].x, route[0].y);
+  for (size_t i = 1; i < route.size(); i++) encoded = encoder.add(route[i].x, route[i].y) && encoded;
+  size_t length = encoder.finish();
+  assert(encoded && length > 0);
+
+  // Every split, including one byte per frame, gives the same route
+  for (size_t chunk : {1, 2, 3, 7, 64, 1000, 65536}) {
+    PathDecoder::State state;
+    std::vector<Cell> cells = decode(buffer, length, chunk, state);
+    assert(state == PathDecoder::STATE_DONE);
+    assert(cells == route);
+  }
+
+  // Diagonals, jumps, negative cells and the loop flag
+  Cell shape[] = {{0, 0}, {4, 4}, {4, -3}, {-20, 100}, {-21, 99}, {-21, 99}, {-30, 99}};
+  uint8_t shapeBuffer[64];
+  PathEncoder small(shapeBuffer, sizeof(shapeBuffer));
+  small.begin(0, 0, true);
+  for (const Cell& s : shape) small.add(s.x, s.y);
+  size_t smallLength = small.finish();
+  PathDecoder::State state;
+  std::vector<PathDecoder::Waypoint> waypoints;
+  std::vector<Cell> cells = decode(shapeBuffer, smallLength, 3, state, &waypoints);
+  assert(state == PathDecoder::STATE_DONE);
+  assert(waypoints.size() == 7);        // Start, 5 corners/jumps, end
+  assert(waypoints.back().flags == (PathDecoder::WAYPOINT_END | PathDecoder::WAYPOINT_LOOP));
+  assert(waypoints[3].x == -20 && waypoints[3].y == 100);
+  assert(cells.back() == (Cell{-30, 99}));
+
+  // Malformed data
+  const uint8_t badMagic[] = {0x00, 0x10, 0x00, 0x00};
+  const uint8_t badVersion[] = {0xA7, 0x20, 0x00, 0x00};
+  const uint8_t zeroRun[] = {0xA7, 0x10, 0x00, 0x00, 0x00};
+  const uint8_t longVarint[] = {0xA7, 0x10, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+  decode(badMagic, sizeof(badMagic), 64, state);
+  assert(state == PathDecoder::STATE_ERROR);
+  decode(badVersion, sizeof(badVersion), 64, state);
+  assert(state == PathDecoder::STATE_ERROR);
+  decode(zeroRun, sizeof(zeroRun), 64, state);
+  assert(state == PathDecoder::STATE_ERROR);
+  decode(longVarint, sizeof(longVarint), 64, state);
+  assert(state == PathDecoder::STATE_ERROR);
+
+  // Encoder overflow is reported, not truncated silently
+  uint8_t tiny[8];
+  PathEncoder full(tiny, sizeof(tiny));
+  full.begin(0, 0);
+  for (int i = 1; i < 10; i++) full.add(i * 100, i % 2);
+  assert(full.finish() == 0);
+
+  // Benchmark: size and decode time against the ASCII form
+  std::string ascii = "PATH:";
+  for (size_t i = 0; i < route.size(); i++) {
+    if (i) ascii += ",";
+    ascii += std::to_string(route[i].x) + "," + std::to_string(route[i].y);
+  }
+  ascii += ":ONCE";
+
+  const int reps = 2000;
+  PathDecoder decoder;
+  uint32_t steps = 0;
+  decoder.setHandler([&](const PathDecoder::Waypoint& w) { steps += w.steps; });
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; r++) {
+    decoder.reset();
+    for (size_t o = 0; o < length; o += 64) decoder.feed(buffer + o, length - o < 64 ? length - o : 64);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  volatile long sink = 0;
+  for (int r = 0; r < reps; r++) {
+    const char* p = ascii.c_str() + 5;
+    while (*p && *p != ':') {
+      sink += strtol(p, (char**)&p, 10);
+      if (*p == ',') p++;
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  assert(steps == reps * (route.size() - 1));
+
+  printf("%zu cells: ASCII %zu bytes, binary %zu bytes (%.1fx smaller)\n", route.size(), ascii.size(),
+         length, (double)ascii.size() / length);
+  printf("decode in 64-byte frames %.1f us/route, ASCII strtol alone %.1f us/route\n",
+         std::chrono::duration<double, std::micro>(t1 - t0).count() / reps,
+         std::chrono::duration<double, std::micro>(t2 - t1).count() / reps);
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Flight recorder: whole commands and path frames survive a dump and replay.
+//
+// Build: AGVCoreNetwork_Recorder.cpp
+
+#include "AGVCoreNetwork_Recorder.h"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+int main() {
+  static FlightRecorder recorder;
+
+  // Commands up to the 64-byte limit are kept whole
+  std::string command = "PATH:1,1,3,2,5,5,7,7,9,9,11,11,13,13,15,15,17,17,19,19,21:ONCE";
+  assert(command.size() > 32 && command.size() <= 64);
+  recorder.record(FlightRecorder::REC_WS_COMMAND, 2, command.data(), command.size());
+
+  // A binary path frame longer than a record is split, not truncated
+  std::vector<uint8_t> frame(300);
+  for (size_t i = 0; i < frame.size(); i++) frame[i] = (uint8_t)(i * 7);
+  recorder.recordStream(FlightRecorder::REC_PATH_FRAME, 1, frame.data(), frame.size());
+
+  // Longer commands are flagged
+  std::string longCommand(100, 'x');
+  recorder.record(FlightRecorder::REC_WS_COMMAND, 2, longCommand.data(), longCommand.size());
+
+  // Dump as /debug/recorder does, then replay as fast as possible
+  std::vector<uint8_t> dump(sizeof(FlightRecorder::DumpHeader));
+  uint32_t seq = recorder.oldestSeq();
+  FlightRecorder::DumpHeader header = {{'A', 'G', 'V', 'R'}, FlightRecorder::DUMP_VERSION,
+                                       sizeof(FlightRecorder::Record),
+                                       recorder.nextSeq() - seq, seq};
+  memcpy(dump.data(), &header, sizeof(header));
+  FlightRecorder::Record records[8];
+  size_t n = recorder.copyRecords(seq, records, 8);
+  dump.insert(dump.end(), (uint8_t*)records, (uint8_t*)(records + n));
+
+  FlightReplayer replayer;
+  assert(replayer.start(dump.data(), dump.size(), 0));
+  FlightRecorder::Record rec;
+  std::string replayedCommand;
+  std::vector<uint8_t> replayedFrame;
+  size_t truncated = 0;
+  while (replayer.nextDue(0, rec)) {
+    if (rec.flags & FlightRecorder::FLAG_TRUNCATED) {
+      truncated++;
+    } else if (rec.type == FlightRecorder::REC_WS_COMMAND) {
+      replayedCommand.assign(rec.payload, rec.length);
+    } else if (rec.type == FlightRecorder::REC_PATH_FRAME) {
+      replayedFrame.insert(replayedFrame.end(), rec.payload, rec.payload + rec.length);
+    }
+  }
+
+  assert(n == 7);                 // 1 command, 5 path records, 1 long command
+  assert(replayedCommand == command);
+  assert(replayedFrame == frame);
+  assert(truncated == 1);
+  printf("%zu records, %zu-byte frame replayed whole\n", n, replayedFrame.size());
+  return 0;
+}
@@ -0,0 +1,238 @@
+// Replay driver: feeds a recorded session through a live AGVCoreNetwork on
+// the host and reports when each command reached the application, against
+// when it was scheduled.
+//
+// Run:  replay                    a synthetic session at 100%, 400% and as
+//                                 fast as possible, checked against the
+//                                 commands it must deliver
+//       replay <dump> [speed%]    a GET /debug/recorder dump (default 100%)
+//
+// The library runs as on the device: station link up on 127.0.0.1, servers
+// on ports 18180/18181, the network task as a thread replaying from its loop.
+//
+// Build: AGVCoreNetwork*.cpp test/host/shim/platform.cpp test/host/shim/net.cpp test/host/shim/web.cpp test/host/shim/websockets.cpp -lcrypto
+
+#include "AGVCoreNetwork.h"
+#include "Preferences.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace AGVCoreNetworkLib;
+
+typedef FlightRecorder::Record Record;
+
+struct Delivery {
+  std::string command;
+  int64_t atUs;
+};
+
+static std::mutex deliveredLock;
+static std::vector<Delivery> delivered;
+
+static void onCommand(const char* command) {
+  std::lock_guard<std::mutex> guard(deliveredLock);
+  delivered.push_back({command, esp_timer_get_time()});
+}
+
+static bool isInbound(uint8_t type) {
+  return type == FlightRecorder::REC_WS_COMMAND || type == FlightRecorder::REC_SERIAL_COMMAND ||
+         type == FlightRecorder::REC_HTTP_COMMAND || type == FlightRecorder::REC_TRANSPORT_COMMAND;
+}
+
+static void add(std::vector<Record>& session, uint32_t atMs, FlightRecorder::RecordType type, uint8_t source,
+                const char* text) {
+  Record r = {};
+  r.timestampUs = 5000000 + (uint64_t)atMs * 1000;     // Recorded five seconds after boot
+  r.seq = (uint32_t)session.size();
+  r.type = type;
+  r.source = source;
+  r.length = (uint8_t)strlen(text);
+  memcpy(r.payload, text, r.length);
+  session.push_back(r);
+}
+
+// About half a second of an operator session: a dashboard connecting,
+// commands over WebSocket, serial and HTTP, a STOP that blocks the next
+// command until it is cleared, status broadcasts in between
+static std::vector<Record> syntheticSession(std::vector<std::string>& expected) {
+  std::vector<Record> session;
+  add(session, 0, FlightRecorder::REC_CLIENT_CONNECT, 1, "");
+  add(session, 2, FlightRecorder::REC_WS_CONTROL, 1, "SUBSCRIBE:status");
+  for (int i = 0; i < 20; i++) {
+    char command[32];
+    snprintf(command, sizeof(command), "MOVE forward %d", 100 + i);
+    add(session, 10 + i * 20, FlightRecorder::REC_WS_COMMAND, 1, command);
+    expected.push_back(command);
+    if (i % 5 == 0) add(session, 12 + i * 20, FlightRecorder::REC_STATUS, 0, "AGV Moving");
+    if (i % 4 == 1) {
+      snprintf(command, sizeof(command), "SPEED %d", i);
+      add(session, 15 + i * 20, FlightRecorder::REC_SERIAL_COMMAND, 0, command);
+      expected.push_back(command);
+    }
+    if (i == 9) {
+      add(session, 16 + i * 20, FlightRecorder::REC_HTTP_COMMAND, 0, "STOP");
+      expected.push_back("STOP");
+      add(session, 16 + i * 20, FlightRecorder::REC_EMERGENCY_SET, 3, "Operator STOP via http");
+      add(session, 18 + i * 20, FlightRecorder::REC_WS_COMMAND, 1, "TURN 90");     // Blocked
+      add(session, 19 + i * 20, FlightRecorder::REC_SERIAL_COMMAND, 0, "CLEAR_EMERGENCY");
+      add(session, 19 + i * 20, FlightRecorder::REC_EMERGENCY_CLEAR, 0, "");
+    }
+  }
+  add(session, 430, FlightRecorder::REC_TRANSPORT_COMMAND, 0, "DOCK");
+  expected.push_back("DOCK");
+  add(session, 440, FlightRecorder::REC_CLIENT_DISCONNECT, 1, "");
+  return session;
+}
+
+static std::vector<uint8_t> makeDump(const std::vector<Record>& session) {
+  FlightRecorder::DumpHeader header = {{'A', 'G', 'V', 'R'}, FlightRecorder::DUMP_VERSION,
+                                       sizeof(Record), (uint32_t)session.size(), 0};
+  std::vector<uint8_t> dump((const uint8_t*)&header, (const uint8_t*)(&header + 1));
+  dump.insert(dump.end(), (const uint8_t*)session.data(), (const uint8_t*)(session.data() + session.size()));
+  return dump;
+}
+
+struct Result {
+  size_t commands;
+  size_t matched;
+  double spanMs;       // Recorded, scaled to the replay speed
+  double tookMs;
+  int64_t lagMinUs;
+  int64_t lagP50Us;
+  int64_t lagP99Us;
+  int64_t lagMaxUs;
+};
+
+// Replays a dump to the end and matches each delivery to the next inbound
+// record with the same text (blocked and control messages deliver nothing)
+static Result replay(const std::vector<uint8_t>& dump, uint16_t speed, bool verbose) {
+  {
+    std::lock_guard<std::mutex> guard(deliveredLock);
+    delivered.clear();
+  }
+  int64_t startUs = esp_timer_get_time();
+  if (!agvNetwork.startReplay(dump.data(), dump.size(), speed)) {
+    fprintf(stderr, "replay: not a recorder dump (version %u)\n", FlightRecorder::DUMP_VERSION);
+    _exit(1);
+  }
+  while (agvNetwork.isReplaying()) delay(1);
+  int64_t endUs = esp_timer_get_time();
+
+  FlightRecorder::DumpHeader header;
+  memcpy(&header, dump.data(), sizeof(header));
+  std::vector<Record> records(header.count);
+  if (header.count) memcpy(records.data(), dump.data() + sizeof(header), header.count * sizeof(Record));
+
+  Result result = {};
+  std::lock_guard<std::mutex> guard(deliveredLock);
+  result.commands = delivered.size();
+  result.tookMs = (endUs - startUs) / 1000.0;
+  uint64_t firstUs = records.empty() ? 0 : records[0].timestampUs;
+  if (!records.empty()) result.spanMs = (records.back().timestampUs - firstUs) / 1000.0 * 100 / std::max<int>(speed, 1);
+  if (speed == 0) result.spanMs = 0;
+
+  std::vector<int64_t> lags;
+  size_t next = 0;
+  for (const Delivery& d : delivered) {
+    size_t r = next;
+    while (r < records.size() && !(isInbound(records[r].type) &&
+                                   d.command == std::string(records[r].payload, records[r].length))) {
+      r++;
+    }
+    if (r == records.size()) {
+      if (verbose) printf("%10.3f ms  %s (unmatched)\n", (d.atUs - startUs) / 1000.0, d.command.c_str());
+      continue;
+    }
+    int64_t scheduledUs = speed ? (int64_t)((records[r].timestampUs - firstUs) * 100 / speed) : 0;
+    int64_t lagUs = d.atUs - startUs - scheduledUs;
+    lags.push_back(lagUs);
+    if (verbose) printf("%10.3f ms  %-40s lag %7.3f ms\n", (d.atUs - startUs) / 1000.0, d.command.c_str(), lagUs / 1000.0);
+    next = r + 1;
+  }
+  result.matched = lags.size();
+  std::sort(lags.begin(), lags.end());
+  if (!lags.empty()) {
+    result.lagMinUs = lags.front();
+    result.lagP50Us = lags[lags.size() / 2];
+    result.lagP99Us = lags[std::min(lags.size() - 1, lags.size() * 99 / 100)];
+    result.lagMaxUs = lags.back();
+  }
+  return result;
+}
+
+static void report(const char* name, uint16_t speed, const Result& r) {
+  printf("%s at %u%%: %zu commands (%zu matched), %.1f ms for %.1f ms scheduled; lag p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+         name, speed, r.commands, r.matched, r.tookMs, r.spanMs, r.lagP50Us / 1000.0, r.lagP99Us / 1000.0,
+         r.lagMaxUs / 1000.0);
+}
+
+int main(int argc, char** argv) {
+  Preferences prefs;
+  prefs.begin("agvnet", false);
+  prefs.putString("ssid", "host");
+  prefs.putString("password", "host");
+  prefs.end();
+  hostStationLink(true);
+  hostRunTasks(true);
+
+  agvNetwork.setServerPorts(18180, 18181);
+  agvNetwork.setPollServerPort(0);
+  agvNetwork.begin("replay", "admin", "admin123");
+  agvNetwork.setCommandCallback(onCommand);
+
+  // Replayed WebSocket records need the station services up
+  AGVCoreNetwork::StatusSnapshot status;
+  for (int i = 0; i < 2000; i++) {
+    agvNetwork.getStatusSnapshot(status);
+    if (status.connected) break;
+    delay(1);
+  }
+  assert(status.connected);
+
+  if (argc > 1) {
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+      fprintf(stderr, "replay: cannot read %s\n", argv[1]);
+      _exit(1);
+    }
+    std::vector<uint8_t> dump((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    uint16_t speed = argc > 2 ? atoi(argv[2]) : 100;
+    Result r = replay(dump, speed, true);
+    report(argv[1], speed, r);
+    fflush(stdout);
+    _exit(0);
+  }
+
+  std::vector<std::string> expected;
+  std::vector<uint8_t> dump = makeDump(syntheticSession(expected));
+  for (uint16_t speed : {100, 400, 0}) {
+    Result r = replay(dump, speed, false);
+    report("session", speed, r);
+
+    // Every command that should reach the application did, in order
+    std::vector<std::string> got;
+    for (const Delivery& d : delivered) got.push_back(d.command);
+    assert(got == expected);
+    assert(r.matched == expected.size());
+    assert(!agvNetwork.isEmergencyActive());
+
+    // Paced replays never run early and keep to the schedule within a few
+    // loop passes
+    if (speed) {
+      assert(r.lagMinUs >= 0);
+      assert(r.lagP99Us < 20000);
+    }
+  }
+
+  fflush(stdout);
+  _exit(0);
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+# Host tests for AGVCoreNetwork.
+#
+# Syntax-checks every library translation unit against the shim headers,
+# then builds and runs each program in this directory. A program names the
+# library sources (and any extra libraries) it links with on a
+# "// Build:" line, paths relative to the repository root. The .js tests
+# cover dashboard code and run under node (skipped when it is missing).
+#
+# Run from anywhere:  test/host/run.sh [program...]
+# Programs run with no arguments must finish within a few seconds and exit
+# non-zero on failure; the build products go to test/host/build/.
+
+set -u
+HOST=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HOST/../.." && pwd)
+OUT="$HOST/build"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=gnu++17 -O2 -Wall -Wextra -Wno-unused-parameter}
+mkdir -p "$OUT"
+cd "$ROOT"
+
+failed=0
+
+if [ $# -eq 0 ]; then
+  for f in *.cpp; do
+    $CXX $CXXFLAGS -fsyntax-only -I"$HOST/shim" -I. "$f" || failed=1
+  done
+  [ $failed -eq 0 ] && echo "syntax: ok"
+  set -- $(cd "$HOST" && ls *.cpp *.js | sed 's/\.\(cpp\|js\)$//')
+fi
+
+for name in "$@"; do
+  if [ -f "$HOST/$name.js" ]; then
+    if ! command -v node >/dev/null; then
+      echo "$name: skipped (no node)"
+    elif node "$HOST/$name.js"; then
+      echo "$name: ok"
+    else
+      echo "$name: FAILED"
+      failed=1
+    fi
+    continue
+  fi
+
+  src="$HOST/$name.cpp"
+  build=$(sed -n 's#^// Build: *##p' "$src")
+  if ! $CXX $CXXFLAGS -pthread -I"$HOST/shim" -I. -o "$OUT/$name" "$src" "$HOST/shim/host.cpp" $build; then
+    echo "$name: BUILD FAILED"
+    failed=1
+    continue
+  fi
+  if "$OUT/$name"; then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED"
+    failed=1
+  fi
+done
+
+exit $failed
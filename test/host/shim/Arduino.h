@@ -0,0 +1,84 @@
+#pragma once
+// Host shim for the Arduino-ESP32 core, just enough to build the library's
+// components (and syntax-check the core) with a desktop compiler. Only the
+// time, Serial and heap functions are defined (host.cpp); the rest are
+// declarations for the syntax check.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <functional>
+#include <type_traits>
+#include <string>
+#define PROGMEM
+#define PGM_P const char*
+#define F(x) x
+#define HEX 16
+#define DEC 10
+typedef bool boolean;
+class String {
+public:
+  std::string s;
+  String(const char* c = "") : s(c ? c : "") {}
+  String(const std::string& x) : s(x) {}
+  String(int v, int base = 10) { char b[32]; snprintf(b, sizeof b, base == 16 ? "%x" : "%d", v); s = b; }
+  String(unsigned v, int base = 10) { char b[32]; snprintf(b, sizeof b, base == 16 ? "%x" : "%u", v); s = b; }
+  String(long v, int base = 10) { char b[32]; snprintf(b, sizeof b, "%ld", v); s = b; }
+  String(unsigned long v, int base = 10) { char b[32]; snprintf(b, sizeof b, "%lu", v); s = b; }
+  String(bool v) : s(v ? "1" : "0") {}
+  const char* c_str() const { return s.c_str(); }
+  size_t length() const { return s.size(); }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  int indexOf(const char* x, int from = 0) const { auto p = s.find(x, from); return p == std::string::npos ? -1 : (int)p; }
+  String substring(int a, int b = -1) const { return String(s.substr(a, b < 0 ? std::string::npos : b - a)); }
+  bool startsWith(const char* x) const { return s.rfind(x, 0) == 0; }
+  void trim() {}
+  bool equalsIgnoreCase(const char* x) const { return strcasecmp(s.c_str(), x) == 0; }
+  void replace(const char*, const char*) {}
+  char operator[](size_t i) const { return s[i]; }
+  int toInt() const { return atoi(s.c_str()); }
+};
+class Print {
+public:
+  virtual size_t write(uint8_t) { return 1; }
+  virtual size_t write(const uint8_t*, size_t n) { return n; }
+  size_t print(const char*) { return 0; }
+  size_t print(const String&) { return 0; }
+  size_t println(const char* = "") { return 0; }
+  size_t println(const String&) { return 0; }
+  size_t printf(const char*, ...) { return 0; }
+};
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  size_t readBytes(uint8_t*, size_t) { return 0; }
+  size_t readBytes(char*, size_t) { return 0; }
+  void setTimeout(unsigned long) {}
+};
+class HardwareSerial : public Stream { public: void begin(unsigned long) {} };
+extern HardwareSerial Serial;
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void yield();
+long random(long, long);
+long random(long);
+uint32_t esp_random();
+class EspClass { public: void restart(); uint32_t getFreeHeap(); uint32_t getMinFreeHeap(); };
+extern EspClass ESP;
+#include "IPAddress.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+template<class A,class B> typename std::common_type<A,B>::type min(A a, B b) { return a<b?a:b; }
+template<class A,class B> typename std::common_type<A,B>::type max(A a, B b) { return a>b?a:b; }
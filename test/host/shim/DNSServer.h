@@ -0,0 +1,3 @@
+#pragma once
+#include "WiFi.h"
+class DNSServer { public: bool start(uint16_t, const String&, const IPAddress&); void processNextRequest(); void stop(); };
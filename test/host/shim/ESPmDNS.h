@@ -0,0 +1,15 @@
+#pragma once
+#include "Arduino.h"
+class MDNSResponder {
+public:
+  bool begin(const char*);
+  void end();
+  bool addService(const char*, const char*, uint16_t);
+  bool addServiceTxt(const char*, const char*, const char*, const char*);
+  int queryService(const char*, const char*);
+  String hostname(int);
+  IPAddress IP(int);
+  uint16_t port(int);
+  String txt(int, const char*);
+};
+extern MDNSResponder MDNS;
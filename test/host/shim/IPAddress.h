@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+class String;
+class IPAddress {
+public:
+  uint8_t b[4] = {0,0,0,0};
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t c, uint8_t d, uint8_t e) { b[0]=a; b[1]=c; b[2]=d; b[3]=e; }
+  IPAddress(uint32_t v) { memcpy(b, &v, 4); }
+  operator uint32_t() const { uint32_t v; memcpy(&v, b, 4); return v; }
+  uint8_t operator[](int i) const { return b[i]; }
+  uint8_t& operator[](int i) { return b[i]; }
+  String toString() const;
+  bool fromString(const char*) { return true; }
+};
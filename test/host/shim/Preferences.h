@@ -0,0 +1,19 @@
+#pragma once
+#include "Arduino.h"
+class Preferences {
+public:
+  bool begin(const char*, bool = false);
+  void end();
+  String getString(const char*, const String& = String());
+  size_t putString(const char*, const String&);
+  size_t getBytes(const char*, void*, size_t);
+  size_t putBytes(const char*, const void*, size_t);
+  size_t getBytesLength(const char*);
+  uint8_t getUChar(const char*, uint8_t = 0);
+  size_t putUChar(const char*, uint8_t);
+  uint32_t getUInt(const char*, uint32_t = 0);
+  size_t putUInt(const char*, uint32_t);
+  bool getBool(const char*, bool = false);
+  size_t putBool(const char*, bool);
+  bool remove(const char*);
+};
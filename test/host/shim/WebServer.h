@@ -0,0 +1,76 @@
+#pragma once
+#include "WiFi.h"
+#include <string>
+#include <vector>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_DELETE };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+enum HTTPRawStatus { RAW_START, RAW_WRITE, RAW_END, RAW_ABORTED };
+#define HTTP_UPLOAD_BUFLEN 1436
+#define HTTP_RAW_BUFLEN 1436
+struct HTTPUpload { HTTPUploadStatus status; String filename; String name; String type; size_t totalSize; size_t currentSize; uint8_t buf[HTTP_UPLOAD_BUFLEN]; };
+struct HTTPRaw { HTTPRawStatus status; size_t totalSize; size_t currentSize; uint8_t buf[HTTP_RAW_BUFLEN]; };
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+// HTTP/1.1 server on host sockets (web.cpp), one request per connection like
+// the ESP32 WebServer: query and form arguments, the body as arg("plain") or
+// through the raw handler, response headers and content. Multipart uploads
+// are not parsed.
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+  WebServer(int port) : listener(port) {}
+  void begin() { listener.begin(); }
+  void handleClient();
+  void enableDelay(bool) {}
+  void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn) { on(uri, method, fn, nullptr); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) { routes.push_back({uri.s, method, fn, ufn}); }
+  void onNotFound(THandlerFunction fn) { notFound = fn; }
+  String uri() { return String(path); }
+  HTTPMethod method() { return requestMethod; }
+  WiFiClient client() { return current; }
+  HTTPUpload& upload() { return uploadState; }
+  HTTPRaw& raw() { return rawState; }
+  String arg(const String& name);
+  String arg(int i) { return i < args() ? String(arguments[i].second) : String(); }
+  String argName(int i) { return i < args() ? String(arguments[i].first) : String(); }
+  int args() { return (int)arguments.size(); }
+  bool hasArg(const String& name);
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {}
+  String header(const String& name);
+  bool hasHeader(const String& name) { return header(name).length() > 0; }
+  void send(int code, const char* type, const String& content) { send(code, type, content.c_str(), content.length()); }
+  void send(int code, const String& type, const String& content) { send(code, type.c_str(), content.c_str(), content.length()); }
+  void send(int code, const char* type = nullptr) { send(code, type, "", 0); }
+  void send_P(int code, PGM_P type, PGM_P content) { send(code, type, content, strlen(content)); }
+  void send_P(int code, PGM_P type, PGM_P content, size_t length) { send(code, type, content, length); }
+  void setContentLength(size_t length) { contentLength = length; lengthSet = true; }
+  void sendHeader(const String& name, const String& value, bool = false) { extraHeaders += name.s + ": " + value.s + "\r\n"; }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t length);
+  void sendContent_P(PGM_P content, size_t length) { sendContent(content, length); }
+  void stop() { listener.end(); }
+private:
+  struct Route {
+    std::string uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+    THandlerFunction ufn;
+  };
+  WiFiServer listener;
+  std::vector<Route> routes;
+  THandlerFunction notFound;
+  WiFiClient current;
+  std::string request;
+  uint32_t acceptedAt = 0;
+  HTTPMethod requestMethod = HTTP_GET;
+  std::string path;
+  std::string head;
+  std::vector<std::pair<std::string, std::string>> arguments;
+  std::string extraHeaders;
+  size_t contentLength = 0;
+  bool lengthSet = false;
+  HTTPUpload uploadState = {};
+  HTTPRaw rawState = {};
+  void send(int code, const char* type, const char* content, size_t length);
+  void dispatch(size_t headerLength, size_t bodyLength);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "WiFi.h"
+#include <mutex>
+#include <string>
+#ifndef WEBSOCKETS_SERVER_CLIENT_MAX
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#endif
+#define WEBSOCKETS_MAX_HEADER_SIZE 14
+typedef enum { WStype_ERROR, WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT, WStype_BIN, WStype_FRAGMENT_TEXT_START, WStype_FRAGMENT_BIN_START, WStype_FRAGMENT, WStype_FRAGMENT_FIN, WStype_PING, WStype_PONG } WStype_t;
+// RFC 6455 server on host sockets (websockets.cpp): handshake, masked client
+// frames, fragments, ping/pong and close, with the links2004 event order.
+// Sends may come from any thread.
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t, WStype_t, uint8_t*, size_t)> WebSocketServerEvent;
+  WebSocketsServer(uint16_t port, const String& = "", const String& = "arduino") : listener(port) {}
+  void begin() { listener.begin(); }
+  void loop();
+  void onEvent(WebSocketServerEvent handler) { event = handler; }
+  bool sendTXT(uint8_t num, uint8_t* p, size_t n = 0, bool = false) { return sendFrame(num, 0x1, p, n ? n : strlen((char*)p)); }
+  bool sendTXT(uint8_t num, const uint8_t* p, size_t n = 0) { return sendFrame(num, 0x1, p, n ? n : strlen((const char*)p)); }
+  bool sendTXT(uint8_t num, char* p, size_t n = 0, bool = false) { return sendTXT(num, (const uint8_t*)p, n); }
+  bool sendTXT(uint8_t num, const char* p, size_t n = 0) { return sendTXT(num, (const uint8_t*)p, n); }
+  bool sendTXT(uint8_t num, String& s) { return sendTXT(num, s.c_str(), s.length()); }
+  bool broadcastTXT(uint8_t* p, size_t n = 0, bool = false) { return broadcast(0x1, p, n ? n : strlen((char*)p)); }
+  bool broadcastTXT(const uint8_t* p, size_t n = 0) { return broadcast(0x1, p, n ? n : strlen((const char*)p)); }
+  bool broadcastTXT(char* p, size_t n = 0, bool = false) { return broadcastTXT((const uint8_t*)p, n); }
+  bool broadcastTXT(const char* p, size_t n = 0) { return broadcastTXT((const uint8_t*)p, n); }
+  bool broadcastTXT(String& s) { return broadcastTXT(s.c_str(), s.length()); }
+  bool sendBIN(uint8_t num, uint8_t* p, size_t n, bool = false) { return sendFrame(num, 0x2, p, n); }
+  bool sendBIN(uint8_t num, const uint8_t* p, size_t n) { return sendFrame(num, 0x2, p, n); }
+  bool broadcastBIN(uint8_t* p, size_t n, bool = false) { return broadcast(0x2, p, n); }
+  bool broadcastBIN(const uint8_t* p, size_t n) { return broadcast(0x2, p, n); }
+  uint8_t connectedClients(bool = false);
+  bool clientIsConnected(uint8_t num) { return num < WEBSOCKETS_SERVER_CLIENT_MAX && clients[num].open; }
+  void disconnect(uint8_t num);
+  void disconnect() { for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) disconnect(i); }
+  IPAddress remoteIP(uint8_t num) { return num < WEBSOCKETS_SERVER_CLIENT_MAX ? clients[num].tcp.remoteIP() : IPAddress(); }
+  void enableHeartbeat(uint32_t, uint32_t, uint8_t) {}
+  bool sendPing(uint8_t num, uint8_t* p = nullptr, size_t n = 0) { return sendFrame(num, 0x9, p, n); }
+private:
+  struct Client {
+    WiFiClient tcp;
+    bool open = false;            // Handshake done
+    bool fragmented = false;      // Inside a fragmented message
+    std::string rx;
+  };
+  WiFiServer listener;
+  WebSocketServerEvent event;
+  Client clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+  std::recursive_mutex lock;      // Client state and writes
+  bool sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length);
+  bool broadcast(uint8_t opcode, const uint8_t* payload, size_t length);
+  bool handshake(uint8_t num);
+  bool readFrame(uint8_t num);
+  void drop(uint8_t num);
+};
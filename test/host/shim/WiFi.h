@@ -0,0 +1,83 @@
+#pragma once
+#include "Arduino.h"
+#include <memory>
+typedef enum { WL_IDLE_STATUS, WL_CONNECTED, WL_CONNECT_FAILED, WL_DISCONNECTED } wl_status_t;
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN, WIFI_AUTH_WPA2_PSK } wifi_auth_mode_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+// TCP client and server on host sockets (net.cpp). Copies of a client share
+// one socket, which closes with the last copy or stop(), as on the ESP32.
+struct HostSocket;
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+  uint8_t connected();
+  operator bool() { return connected(); }
+  void stop();
+  int connect(const char* host, uint16_t port) { return connect(host, port, 3000); }
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  int connect(IPAddress ip, uint16_t port);
+  IPAddress remoteIP();
+  uint16_t remotePort();
+  void setNoDelay(bool);
+  int fd() const;
+  int read() override;
+  int read(uint8_t*, size_t);
+  int available() override;
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t*, size_t) override;
+  using Print::write;
+private:
+  std::shared_ptr<HostSocket> socket;
+};
+class WiFiServer {
+public:
+  WiFiServer(uint16_t port) : port(port) {}
+  ~WiFiServer() { end(); }
+  void begin();
+  void setNoDelay(bool on) { noDelay = on; }
+  WiFiClient available() { return accept(); }
+  WiFiClient accept();
+  bool hasClient();
+  void end();
+private:
+  uint16_t port;
+  int listenFd = -1;
+  int pendingFd = -1;
+  bool noDelay = false;
+};
+class WiFiClass {
+public:
+  wl_status_t status();
+  bool mode(wifi_mode_t);
+  bool softAP(const char*, const char*);
+  IPAddress softAPIP();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t = 0);
+  wl_status_t begin(const char*, const char* = nullptr, int32_t = 0, const uint8_t* = nullptr, bool = true);
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress());
+  int16_t scanNetworks(bool async = false);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t);
+  int32_t RSSI(uint8_t);
+  int32_t RSSI();
+  wifi_auth_mode_t encryptionType(uint8_t);
+  uint8_t* BSSID();
+  int32_t channel();
+  bool setSleep(bool);
+  bool setSleep(wifi_ps_type_t);
+  bool setHostname(const char*);
+  bool setAutoReconnect(bool);
+  bool disconnect(bool = false);
+  uint8_t softAPgetStationNum();
+};
+extern WiFiClass WiFi;
+
+// Host only: brings the station link up or down (platform.cpp)
+void hostStationLink(bool up);
@@ -0,0 +1,7 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+typedef int esp_err_t;
+#define ESP_OK 0
+typedef struct { uint32_t address; uint32_t size; } esp_partition_t;
+esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t);
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+typedef int BaseType_t; typedef unsigned UBaseType_t; typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdTRUE 1
+#define pdFALSE 0
+#define configMAX_PRIORITIES 25
+#define pdMS_TO_TICKS(x) (x)
+#define portMAX_DELAY 0xffffffff
+#define tskNO_AFFINITY 0x7fffffff
+typedef struct { int x; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL(m)
@@ -0,0 +1,12 @@
+#pragma once
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskPriorityGet(TaskHandle_t);
+BaseType_t xPortGetCoreID();
+void vTaskDelay(TickType_t);
+void vTaskDelete(TaskHandle_t);
+// Host only: start created tasks as threads instead of refusing them (platform.cpp)
+void hostRunTasks(bool run);
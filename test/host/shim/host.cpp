@@ -0,0 +1,21 @@
+// Host definitions for the shim: a monotonic clock since process start and
+// a Serial that discards output. The clock functions are weak so a test can
+// substitute its own time.
+#include "Arduino.h"
+#include "esp_timer.h"
+#include <chrono>
+#include <thread>
+
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+__attribute__((weak)) int64_t esp_timer_get_time() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now() - processStart).count();
+}
+
+__attribute__((weak)) unsigned long millis() { return (unsigned long)(esp_timer_get_time() / 1000); }
+__attribute__((weak)) unsigned long micros() { return (unsigned long)esp_timer_get_time(); }
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void yield() { std::this_thread::yield(); }
+
+HardwareSerial Serial;
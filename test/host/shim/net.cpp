@@ -0,0 +1,168 @@
+// Host definitions for WiFiClient and WiFiServer on POSIX sockets, for tests
+// that talk to the library over loopback TCP. Reads never block; writes block
+// until the kernel takes the bytes, like the ESP32 client.
+#include "WiFi.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+struct HostSocket {
+  int fd;
+  explicit HostSocket(int fd) : fd(fd) {}
+  ~HostSocket() {
+    if (fd >= 0) close(fd);
+  }
+};
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<HostSocket>(fd)) {}
+
+int WiFiClient::fd() const { return socket ? socket->fd : -1; }
+
+// Open until the peer has closed and everything it sent has been read
+uint8_t WiFiClient::connected() {
+  if (fd() < 0) return 0;
+  char c;
+  ssize_t n = recv(fd(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) return 1;
+  stop();
+  return 0;
+}
+
+void WiFiClient::stop() {
+  if (socket && socket->fd >= 0) {
+    close(socket->fd);
+    socket->fd = -1;
+  }
+  socket.reset();
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &found) != 0 || !found) return 0;
+
+  int s = ::socket(AF_INET, SOCK_STREAM, 0);
+  fcntl(s, F_SETFL, O_NONBLOCK);
+  int result = ::connect(s, found->ai_addr, found->ai_addrlen);
+  freeaddrinfo(found);
+  if (result != 0 && errno == EINPROGRESS) {
+    pollfd writable = {s, POLLOUT, 0};
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (poll(&writable, 1, timeoutMs) == 1 && getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && !error) {
+      result = 0;
+    }
+  }
+  if (result != 0) {
+    close(s);
+    return 0;
+  }
+  fcntl(s, F_SETFL, 0);
+  socket = std::make_shared<HostSocket>(s);
+  return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  char host[16];
+  snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return connect(host, port, 3000);
+}
+
+IPAddress WiFiClient::remoteIP() {
+  sockaddr_in peer = {};
+  socklen_t length = sizeof(peer);
+  if (fd() < 0 || getpeername(fd(), (sockaddr*)&peer, &length) != 0) return IPAddress();
+  return IPAddress((uint32_t)peer.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() {
+  sockaddr_in peer = {};
+  socklen_t length = sizeof(peer);
+  if (fd() < 0 || getpeername(fd(), (sockaddr*)&peer, &length) != 0) return 0;
+  return ntohs(peer.sin_port);
+}
+
+void WiFiClient::setNoDelay(bool on) {
+  int flag = on;
+  if (fd() >= 0) setsockopt(fd(), IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+int WiFiClient::available() {
+  int pending = 0;
+  if (fd() < 0 || ioctl(fd(), FIONREAD, &pending) != 0) return 0;
+  return pending;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* out, size_t length) {
+  if (fd() < 0) return -1;
+  ssize_t n = recv(fd(), out, length, MSG_DONTWAIT);
+  return n > 0 ? (int)n : -1;
+}
+
+size_t WiFiClient::write(uint8_t c) { return write(&c, 1); }
+
+size_t WiFiClient::write(const uint8_t* data, size_t length) {
+  size_t written = 0;
+  while (fd() >= 0 && written < length) {
+    ssize_t n = send(fd(), data + written, length - written, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    written += n;
+  }
+  return written;
+}
+
+void WiFiServer::begin() {
+  end();
+  listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(port);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(listenFd, (sockaddr*)&local, sizeof(local)) != 0 || listen(listenFd, 64) != 0) {
+    fprintf(stderr, "WiFiServer: port %u unavailable\n", port);
+    close(listenFd);
+    listenFd = -1;
+    return;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+}
+
+bool WiFiServer::hasClient() {
+  if (pendingFd < 0 && listenFd >= 0) pendingFd = ::accept(listenFd, nullptr, nullptr);
+  return pendingFd >= 0;
+}
+
+WiFiClient WiFiServer::accept() {
+  if (!hasClient()) return WiFiClient();
+  WiFiClient client(pendingFd);
+  pendingFd = -1;
+  client.setNoDelay(noDelay);
+  return client;
+}
+
+void WiFiServer::end() {
+  if (pendingFd >= 0) close(pendingFd);
+  if (listenFd >= 0) close(listenFd);
+  pendingFd = listenFd = -1;
+}
@@ -0,0 +1,194 @@
+// Host definitions for the rest of the platform, for tests that link the
+// whole library: a station link that is down until the test calls
+// hostStationLink() (the address is then 127.0.0.1; scans find nothing),
+// NVS in memory, no OTA partitions or mDNS, and FreeRTOS mutexes on
+// std::timed_mutex. TCP is on host sockets in net.cpp. Tasks are not
+// started unless hostRunTasks() asks for threads; taskemu.cpp emulates the
+// task layout in more detail.
+#include "Arduino.h"
+#include "ESPmDNS.h"
+#include "Preferences.h"
+#include "WiFi.h"
+#include "esp_ota_ops.h"
+#include "mdns.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+EspClass ESP;
+
+// Arduino core
+static std::mt19937 generator(1);
+long random(long low, long high) { return high > low ? low + (long)(generator() % (unsigned long)(high - low)) : low; }
+long random(long high) { return random(0, high); }
+uint32_t esp_random() { return generator(); }
+void EspClass::restart() {}
+uint32_t EspClass::getFreeHeap() { return 200000; }
+uint32_t EspClass::getMinFreeHeap() { return 200000; }
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+  return String(text);
+}
+
+// FreeRTOS
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::timed_mutex(); }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks) {
+  if (!m) return pdFALSE;
+  return static_cast<std::timed_mutex*>(m)->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) {
+  if (!m) return pdFALSE;
+  static_cast<std::timed_mutex*>(m)->unlock();
+  return pdTRUE;
+}
+static std::atomic<bool> runTasks(false);
+void hostRunTasks(bool run) { runTasks = run; }
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char*, uint32_t, void* parameter, UBaseType_t,
+                                   TaskHandle_t* handle, BaseType_t) {
+  if (!runTasks) return pdFALSE;
+  std::thread* task = new std::thread(function, parameter);  // Runs until the process exits
+  if (handle) *handle = task;
+  return pdPASS;
+}
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+UBaseType_t uxTaskPriorityGet(TaskHandle_t) { return 1; }
+BaseType_t xPortGetCoreID() { return 1; }
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+void vTaskDelete(TaskHandle_t) {}
+
+// WiFi
+static std::atomic<bool> stationUp(false);
+void hostStationLink(bool up) { stationUp = up; }
+wl_status_t WiFiClass::status() { return stationUp ? WL_CONNECTED : WL_DISCONNECTED; }
+bool WiFiClass::mode(wifi_mode_t) { return true; }
+bool WiFiClass::softAP(const char*, const char*) { return true; }
+IPAddress WiFiClass::softAPIP() { return IPAddress(192, 168, 4, 1); }
+IPAddress WiFiClass::localIP() { return stationUp ? IPAddress(127, 0, 0, 1) : IPAddress(); }
+IPAddress WiFiClass::gatewayIP() { return IPAddress(); }
+IPAddress WiFiClass::subnetMask() { return IPAddress(); }
+IPAddress WiFiClass::dnsIP(uint8_t) { return IPAddress(); }
+wl_status_t WiFiClass::begin(const char*, const char*, int32_t, const uint8_t*, bool) { return status(); }
+bool WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress, IPAddress) { return true; }
+int16_t WiFiClass::scanNetworks(bool) { return 0; }
+int16_t WiFiClass::scanComplete() { return 0; }
+void WiFiClass::scanDelete() {}
+String WiFiClass::SSID(uint8_t) { return String(); }
+int32_t WiFiClass::RSSI(uint8_t) { return 0; }
+int32_t WiFiClass::RSSI() { return 0; }
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t) { return WIFI_AUTH_OPEN; }
+uint8_t* WiFiClass::BSSID() { return nullptr; }
+int32_t WiFiClass::channel() { return 0; }
+bool WiFiClass::setSleep(bool) { return true; }
+bool WiFiClass::setSleep(wifi_ps_type_t) { return true; }
+bool WiFiClass::setHostname(const char*) { return true; }
+bool WiFiClass::setAutoReconnect(bool) { return true; }
+bool WiFiClass::disconnect(bool) { return true; }
+uint8_t WiFiClass::softAPgetStationNum() { return 0; }
+
+// NVS: one map per namespace, shared by every Preferences object
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+static std::mutex nvsMutex;
+static thread_local std::string openNamespace;
+
+bool Preferences::begin(const char* ns, bool) {
+  openNamespace = ns;
+  return true;
+}
+void Preferences::end() {}
+static size_t nvsPut(const char* key, const void* data, size_t length) {
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  nvs[openNamespace][key].assign(bytes, bytes + length);
+  return length;
+}
+static bool nvsGet(const char* key, std::vector<uint8_t>& value) {
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  auto& entries = nvs[openNamespace];
+  auto found = entries.find(key);
+  if (found == entries.end()) return false;
+  value = found->second;
+  return true;
+}
+String Preferences::getString(const char* key, const String& fallback) {
+  std::vector<uint8_t> value;
+  if (!nvsGet(key, value)) return fallback;
+  return String(std::string(value.begin(), value.end()));
+}
+size_t Preferences::putString(const char* key, const String& value) { return nvsPut(key, value.c_str(), value.length()); }
+size_t Preferences::getBytes(const char* key, void* out, size_t length) {
+  std::vector<uint8_t> value;
+  if (!nvsGet(key, value) || value.size() > length) return 0;
+  memcpy(out, value.data(), value.size());
+  return value.size();
+}
+size_t Preferences::putBytes(const char* key, const void* data, size_t length) { return nvsPut(key, data, length); }
+size_t Preferences::getBytesLength(const char* key) {
+  std::vector<uint8_t> value;
+  return nvsGet(key, value) ? value.size() : 0;
+}
+uint8_t Preferences::getUChar(const char* key, uint8_t fallback) {
+  uint8_t value = fallback;
+  getBytes(key, &value, sizeof(value));
+  return value;
+}
+size_t Preferences::putUChar(const char* key, uint8_t value) { return nvsPut(key, &value, sizeof(value)); }
+uint32_t Preferences::getUInt(const char* key, uint32_t fallback) {
+  uint32_t value = fallback;
+  getBytes(key, &value, sizeof(value));
+  return value;
+}
+size_t Preferences::putUInt(const char* key, uint32_t value) { return nvsPut(key, &value, sizeof(value)); }
+bool Preferences::getBool(const char* key, bool fallback) {
+  bool value = fallback;
+  getBytes(key, &value, sizeof(value));
+  return value;
+}
+size_t Preferences::putBool(const char* key, bool value) { return nvsPut(key, &value, sizeof(value)); }
+bool Preferences::remove(const char* key) {
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  return nvs[openNamespace].erase(key) > 0;
+}
+
+// mDNS
+bool MDNSResponder::begin(const char*) { return false; }
+void MDNSResponder::end() {}
+bool MDNSResponder::addService(const char*, const char*, uint16_t) { return false; }
+bool MDNSResponder::addServiceTxt(const char*, const char*, const char*, const char*) { return false; }
+int MDNSResponder::queryService(const char*, const char*) { return 0; }
+String MDNSResponder::hostname(int) { return String(); }
+IPAddress MDNSResponder::IP(int) { return IPAddress(); }
+uint16_t MDNSResponder::port(int) { return 0; }
+String MDNSResponder::txt(int, const char*) { return String(); }
+mdns_search_once_t* mdns_query_async_new(const char*, const char*, const char*, uint16_t, uint32_t, size_t, void*) {
+  return nullptr;
+}
+bool mdns_query_async_get_results(mdns_search_once_t*, uint32_t, mdns_result_t**) { return false; }
+void mdns_query_async_delete(mdns_search_once_t*) {}
+void mdns_query_results_free(mdns_result_t*) {}
+
+// OTA: no partitions
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t*) { return nullptr; }
+const esp_partition_t* esp_ota_get_running_partition() { return nullptr; }
+esp_err_t esp_ota_begin(const esp_partition_t*, size_t, esp_ota_handle_t*) { return -1; }
+esp_err_t esp_ota_write(esp_ota_handle_t, const void*, size_t) { return -1; }
+esp_err_t esp_ota_end(esp_ota_handle_t) { return -1; }
+esp_err_t esp_ota_abort(esp_ota_handle_t) { return -1; }
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t*) { return -1; }
+esp_err_t esp_ota_get_state_partition(const esp_partition_t*, esp_ota_img_states_t*) { return -1; }
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() { return -1; }
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot() { return -1; }
+const esp_app_desc_t* esp_ota_get_app_description() {
+  static esp_app_desc_t description = {0xABCD5432, 0, {0, 0}, "host", "AGVCoreNetwork"};
+  return &description;
+}
+esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) { return -1; }
@@ -0,0 +1,182 @@
+// Host definition of WebServer. handleClient() never blocks: it takes one
+// connection at a time, buffers the request across calls until the headers
+// and Content-Length body are in, runs the route and closes the connection.
+#include "WebServer.h"
+
+#include <strings.h>
+
+static const uint32_t REQUEST_TIMEOUT_MS = 2000;
+
+static const char* reasonPhrase(int code) {
+  switch (code) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 302: return "Found";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static std::string urlDecode(const std::string& in) {
+  std::string out;
+  for (size_t i = 0; i < in.size(); i++) {
+    if (in[i] == '+') {
+      out += ' ';
+    } else if (in[i] == '%' && i + 2 < in.size()) {
+      out += (char)strtol(in.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else {
+      out += in[i];
+    }
+  }
+  return out;
+}
+
+static void parseArguments(const std::string& text, std::vector<std::pair<std::string, std::string>>& out) {
+  for (size_t start = 0; start < text.size();) {
+    size_t end = text.find('&', start);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(start, end - start);
+    size_t eq = item.find('=');
+    if (!item.empty()) {
+      out.push_back({urlDecode(item.substr(0, eq)), eq == std::string::npos ? "" : urlDecode(item.substr(eq + 1))});
+    }
+    start = end + 1;
+  }
+}
+
+void WebServer::handleClient() {
+  if (current.fd() < 0) {
+    if (!listener.hasClient()) return;
+    current = listener.accept();
+    request.clear();
+    acceptedAt = millis();
+  }
+
+  uint8_t chunk[2048];
+  int n;
+  while ((n = current.read(chunk, sizeof(chunk))) > 0) request.append((const char*)chunk, n);
+
+  size_t headerEnd = request.find("\r\n\r\n");
+  size_t bodyLength = 0;
+  if (headerEnd != std::string::npos) {
+    head = request.substr(0, headerEnd + 2);
+    bodyLength = strtoul(header("Content-Length").c_str(), nullptr, 10);
+  }
+  if (headerEnd == std::string::npos || request.size() < headerEnd + 4 + bodyLength) {
+    if (!current.connected() || millis() - acceptedAt > REQUEST_TIMEOUT_MS) current.stop();
+    return;
+  }
+
+  dispatch(headerEnd + 4, bodyLength);
+  current.stop();
+}
+
+void WebServer::dispatch(size_t headerLength, size_t bodyLength) {
+  size_t sp1 = head.find(' ');
+  size_t sp2 = head.find(' ', sp1 + 1);
+  std::string verb = head.substr(0, sp1);
+  std::string target = sp1 == std::string::npos ? "/" : head.substr(sp1 + 1, sp2 - sp1 - 1);
+  requestMethod = verb == "POST" ? HTTP_POST : verb == "PUT" ? HTTP_PUT : verb == "DELETE" ? HTTP_DELETE : HTTP_GET;
+
+  size_t query = target.find('?');
+  path = target.substr(0, query);
+  arguments.clear();
+  if (query != std::string::npos) parseArguments(target.substr(query + 1), arguments);
+
+  extraHeaders.clear();
+  lengthSet = false;
+
+  const Route* route = nullptr;
+  for (const Route& r : routes) {
+    if (r.uri == path && (r.method == HTTP_ANY || r.method == requestMethod)) {
+      route = &r;
+      break;
+    }
+  }
+
+  // As on the ESP32: any non-multipart body goes to a raw handler when the
+  // route has one, otherwise it is arg("plain") plus any form arguments
+  std::string body = request.substr(headerLength, bodyLength);
+  std::string type = header("Content-Type").s;
+  bool plain = !body.empty() && type.compare(0, 19, "multipart/form-data") != 0;
+  if (plain && route && route->ufn) {
+    rawState.status = RAW_START;
+    rawState.totalSize = 0;
+    rawState.currentSize = 0;
+    route->ufn();
+    for (size_t at = 0; at < body.size(); at += HTTP_RAW_BUFLEN) {
+      rawState.status = RAW_WRITE;
+      rawState.currentSize = std::min((size_t)HTTP_RAW_BUFLEN, body.size() - at);
+      memcpy(rawState.buf, body.data() + at, rawState.currentSize);
+      rawState.totalSize += rawState.currentSize;
+      route->ufn();
+    }
+    rawState.status = RAW_END;
+    route->ufn();
+  } else if (plain) {
+    if (type.compare(0, 33, "application/x-www-form-urlencoded") == 0) parseArguments(body, arguments);
+    arguments.push_back({"plain", body});
+  }
+
+  if (route) {
+    route->fn();
+  } else if (notFound) {
+    notFound();
+  } else {
+    send(404, "text/plain", "Not found");
+  }
+}
+
+String WebServer::arg(const String& name) {
+  for (const auto& a : arguments) {
+    if (a.first == name.s) return String(a.second);
+  }
+  return String();
+}
+
+bool WebServer::hasArg(const String& name) {
+  for (const auto& a : arguments) {
+    if (a.first == name.s) return true;
+  }
+  return false;
+}
+
+String WebServer::header(const String& name) {
+  size_t nameLength = name.length();
+  for (size_t line = head.find("\r\n"); line != std::string::npos && line + 2 < head.size();
+       line = head.find("\r\n", line + 2)) {
+    const char* at = head.c_str() + line + 2;
+    if (strncasecmp(at, name.c_str(), nameLength) != 0 || at[nameLength] != ':') continue;
+    size_t start = head.find_first_not_of(' ', line + 3 + nameLength);
+    return String(head.substr(start, head.find("\r\n", start) - start));
+  }
+  return String();
+}
+
+void WebServer::send(int code, const char* type, const char* content, size_t length) {
+  char status[64];
+  snprintf(status, sizeof(status), "HTTP/1.1 %d %s\r\n", code, reasonPhrase(code));
+  std::string response = status;
+  response += std::string("Content-Type: ") + (type ? type : "text/html") + "\r\n";
+  if (!lengthSet || contentLength != CONTENT_LENGTH_UNKNOWN) {
+    response += "Content-Length: " + std::to_string(lengthSet ? contentLength : length) + "\r\n";
+  }
+  response += extraHeaders + "Connection: close\r\n\r\n";
+  response.append(content, length);
+  current.write((const uint8_t*)response.data(), response.size());
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+  current.write((const uint8_t*)content, length);
+}
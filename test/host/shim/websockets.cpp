@@ -0,0 +1,216 @@
+// Host definition of WebSocketsServer: RFC 6455 over host sockets, enough
+// for browsers and load generators to talk to the library. Events fire from
+// loop() in the links2004 order (CONNECTED with the URL, TEXT or BIN for a
+// whole message, FRAGMENT_*_START/FRAGMENT/FRAGMENT_FIN for a fragmented
+// one, DISCONNECTED once per open connection); pings are answered here.
+#include "WebSocketsServer.h"
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <strings.h>
+
+static const size_t MAX_FRAME = 64 * 1024;
+static const char BUSY_RESPONSE[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+// Sec-WebSocket-Accept for a client key
+static std::string acceptKey(const std::string& key) {
+  std::string input = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1((const unsigned char*)input.data(), input.size(), digest);
+  unsigned char encoded[32];
+  int n = EVP_EncodeBlock(encoded, digest, sizeof(digest));
+  return std::string((const char*)encoded, n);
+}
+
+static std::string headerValue(const std::string& head, const char* name) {
+  size_t nameLength = strlen(name);
+  for (size_t line = head.find("\r\n"); line != std::string::npos; line = head.find("\r\n", line + 2)) {
+    if (strncasecmp(head.c_str() + line + 2, name, nameLength) != 0 || head[line + 2 + nameLength] != ':') continue;
+    size_t start = head.find_first_not_of(' ', line + 3 + nameLength);
+    size_t end = head.find("\r\n", start);
+    return start == std::string::npos ? "" : head.substr(start, end - start);
+  }
+  return "";
+}
+
+void WebSocketsServer::loop() {
+  while (listener.hasClient()) {
+    WiFiClient tcp = listener.accept();
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    uint8_t num = 0;
+    while (num < WEBSOCKETS_SERVER_CLIENT_MAX && clients[num].tcp.fd() >= 0) num++;
+    if (num == WEBSOCKETS_SERVER_CLIENT_MAX) {
+      tcp.write((const uint8_t*)BUSY_RESPONSE, sizeof(BUSY_RESPONSE) - 1);
+      tcp.stop();
+      continue;
+    }
+    clients[num] = Client();
+    clients[num].tcp = tcp;
+  }
+
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    Client& c = clients[num];
+    bool closed;
+    {
+      // Events fire outside the lock, since their handlers send
+      std::lock_guard<std::recursive_mutex> guard(lock);
+      if (c.tcp.fd() < 0) continue;
+      uint8_t chunk[4096];
+      int n;
+      while ((n = c.tcp.read(chunk, sizeof(chunk))) > 0) c.rx.append((const char*)chunk, n);
+      closed = !c.tcp.connected();
+    }
+
+    if (!c.open && c.rx.find("\r\n\r\n") != std::string::npos && !handshake(num)) {
+      drop(num);
+      continue;
+    }
+    while (c.open && readFrame(num)) {
+    }
+    if (closed) drop(num);
+  }
+}
+
+bool WebSocketsServer::handshake(uint8_t num) {
+  Client& c = clients[num];
+  size_t end = c.rx.find("\r\n\r\n");
+  std::string head = c.rx.substr(0, end);
+  c.rx.erase(0, end + 4);
+
+  std::string key = headerValue(head, "Sec-WebSocket-Key");
+  if (head.compare(0, 4, "GET ") != 0 || key.empty()) return false;
+  std::string url = head.substr(4, head.find(' ', 4) - 4);
+
+  std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n\r\n";
+  {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    if (c.tcp.write((const uint8_t*)response.data(), response.size()) != response.size()) return false;
+    c.open = true;
+  }
+  if (event) event(num, WStype_CONNECTED, (uint8_t*)&url[0], url.size());
+  return true;
+}
+
+// Dispatches one complete frame from the receive buffer; false when none
+bool WebSocketsServer::readFrame(uint8_t num) {
+  Client& c = clients[num];
+  const uint8_t* p = (const uint8_t*)c.rx.data();
+  size_t have = c.rx.size();
+  if (have < 2) return false;
+
+  bool fin = p[0] & 0x80;
+  uint8_t opcode = p[0] & 0x0F;
+  bool masked = p[1] & 0x80;
+  uint64_t length = p[1] & 0x7F;
+  size_t at = 2;
+  if (length == 126) {
+    if (have < 4) return false;
+    length = ((uint64_t)p[2] << 8) | p[3];
+    at = 4;
+  } else if (length == 127) {
+    if (have < 10) return false;
+    length = 0;
+    for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+    at = 10;
+  }
+  if (!masked || length > MAX_FRAME) {
+    disconnect(num);
+    return false;
+  }
+  if (have < at + 4 + length) return false;
+
+  // Unmasked copy with a terminator, as the library expects for text
+  std::string payload(length + 1, '\0');
+  const uint8_t* mask = p + at;
+  for (size_t i = 0; i < length; i++) payload[i] = p[at + 4 + i] ^ mask[i % 4];
+  c.rx.erase(0, at + 4 + length);
+  uint8_t* data = (uint8_t*)&payload[0];
+
+  WStype_t type;
+  switch (opcode) {
+    case 0x0:
+      if (!c.fragmented) {
+        disconnect(num);
+        return false;
+      }
+      c.fragmented = !fin;
+      type = fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT;
+      break;
+    case 0x1:
+    case 0x2:
+      c.fragmented = !fin;
+      type = fin ? (opcode == 0x1 ? WStype_TEXT : WStype_BIN)
+                 : (opcode == 0x1 ? WStype_FRAGMENT_TEXT_START : WStype_FRAGMENT_BIN_START);
+      break;
+    case 0x8:
+      disconnect(num);
+      return false;
+    case 0x9:
+      sendFrame(num, 0xA, data, length);
+      type = WStype_PING;
+      break;
+    case 0xA:
+      type = WStype_PONG;
+      break;
+    default:
+      disconnect(num);
+      return false;
+  }
+  if (event) event(num, type, data, length);
+  return true;
+}
+
+bool WebSocketsServer::sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  std::string frame(1, (char)(0x80 | opcode));
+  if (length < 126) {
+    frame += (char)length;
+  } else if (length < 65536) {
+    frame += (char)126;
+    frame += (char)(length >> 8);
+    frame += (char)(length & 0xFF);
+  } else {
+    frame += (char)127;
+    for (int i = 7; i >= 0; i--) frame += (char)((uint64_t)length >> (8 * i));
+  }
+  if (length) frame.append((const char*)payload, length);
+
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  Client& c = clients[num];
+  return c.open && c.tcp.write((const uint8_t*)frame.data(), frame.size()) == frame.size();
+}
+
+bool WebSocketsServer::broadcast(uint8_t opcode, const uint8_t* payload, size_t length) {
+  bool all = true;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    if (clientIsConnected(num)) all &= sendFrame(num, opcode, payload, length);
+  }
+  return all;
+}
+
+uint8_t WebSocketsServer::connectedClients(bool) {
+  uint8_t count = 0;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) count += clientIsConnected(num);
+  return count;
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  sendFrame(num, 0x8, nullptr, 0);
+  drop(num);
+}
+
+void WebSocketsServer::drop(uint8_t num) {
+  bool wasOpen;
+  {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    Client& c = clients[num];
+    wasOpen = c.open;
+    c.tcp.stop();
+    c.open = false;
+    c.fragmented = false;
+    c.rx.clear();
+  }
+  if (wasOpen && event) event(num, WStype_DISCONNECTED, nullptr, 0);
+}
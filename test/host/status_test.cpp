@@ -0,0 +1,321 @@
+// Status serving cost before and after the cached snapshot: /status and
+// STATUS_REQUEST built per request (Strings as the original route did, or
+// one snprintf) against getStatusJson()'s version check, and full snapshots
+// pushed to every subscriber on each 100 ms tick against pushStatusDeltas().
+//
+// The serializers follow getStatusJson() and pushStatusDeltas() in
+// AGVCoreNetwork.cpp (same fields, format and suppression rules) over the
+// library's StatusSnapshot; allocations are counted through operator new.
+//
+// Build:
+
+#include "AGVCoreNetwork.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace AGVCoreNetworkLib;
+
+typedef AGVCoreNetwork::StatusSnapshot StatusSnapshot;
+
+static const int SUBSCRIBERS = 5;
+static const int REQUESTS = 100000;
+static const int TICKS = 600;                 // One minute of 100 ms pushes
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static size_t sentBytes = 0;
+static volatile char sink;
+
+static void send(const char* text, size_t length) {
+  sink = text[length ? length - 1 : 0];
+  sentBytes += length;
+}
+
+static void jsonEscape(char* out, size_t size, const char* in) {
+  size_t o = 0;
+  for (; *in && o + 2 < size; in++) {
+    char c = *in;
+    if (c == '"' || c == '\\') {
+      out[o++] = '\\';
+      out[o++] = c;
+    } else if ((uint8_t)c >= 0x20) {
+      out[o++] = c;
+    }
+  }
+  out[o] = '\0';
+}
+
+static void appendf(char* out, size_t size, size_t& len, const char* fmt, ...) {
+  if (len >= size) return;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(out + len, size - len, fmt, args);
+  va_end(args);
+  if (n > 0) len = ((size_t)n < size - len) ? len + n : size - 1;
+}
+
+static String ipString(uint32_t ip) {
+  return String((unsigned)(ip & 0xFF)) + "." + String((unsigned)((ip >> 8) & 0xFF)) + "." +
+         String((unsigned)((ip >> 16) & 0xFF)) + "." + String((unsigned)(ip >> 24));
+}
+
+// Before: the original route's String concatenation, widened to every field
+static String statusString(const StatusSnapshot& s) {
+  return "{\"emergency\":" + String(s.emergency ? 1 : 0) + ",\"connected\":" + String(s.connected ? 1 : 0) +
+         ",\"mode\":\"" + String(s.apMode ? "ap" : "station") + "\",\"rssi\":" + String((int)s.rssi) +
+         ",\"ip\":\"" + ipString(s.ip) + "\",\"uptime\":" + String((unsigned)s.uptimeSec) +
+         ",\"clients\":" + String((unsigned)s.wsClients) + ",\"pollClients\":" + String((unsigned)s.pollClients) +
+         ",\"serialPending\":" + String((unsigned)s.serialPending) + ",\"lease\":" + String((int)s.leaseHolder) +
+         ",\"lastCommand\":\"" + String(s.lastCommand) + "\",\"reason\":\"" + String(s.emergencyReason) + "\"}";
+}
+
+// The serialization getStatusJson() caches
+static size_t statusJson(const StatusSnapshot& snap, char* out, size_t size) {
+  char command[sizeof(snap.lastCommand) * 2];
+  char reason[sizeof(snap.emergencyReason) * 2];
+  jsonEscape(command, sizeof(command), snap.lastCommand);
+  jsonEscape(reason, sizeof(reason), snap.emergencyReason);
+  int len = snprintf(out, size,
+    "{\"emergency\":%d,\"connected\":%d,\"mode\":\"%s\",\"rssi\":%d,"
+    "\"ip\":\"%u.%u.%u.%u\",\"uptime\":%u,\"clients\":%u,\"pollClients\":%u,"
+    "\"serialPending\":%u,\"lease\":%d,\"lastCommand\":\"%s\",\"reason\":\"%s\"}",
+    snap.emergency ? 1 : 0, snap.connected ? 1 : 0, snap.apMode ? "ap" : "station", snap.rssi,
+    (unsigned)(snap.ip & 0xFF), (unsigned)((snap.ip >> 8) & 0xFF),
+    (unsigned)((snap.ip >> 16) & 0xFF), (unsigned)(snap.ip >> 24),
+    (unsigned)snap.uptimeSec, snap.wsClients, snap.pollClients, snap.serialPending,
+    snap.leaseHolder, command, reason);
+  return (len > 0 && (size_t)len < size) ? (size_t)len : 0;
+}
+
+// The library's snapshot state: fields updated in place bump the version
+struct Status {
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  StatusSnapshot snapshot;
+  uint32_t version = 1;
+  uint32_t jsonVersion = 0;
+  size_t jsonLength = 0;
+  char json[384];
+  uint32_t pushVersion = 0;
+  StatusSnapshot pushed;
+
+  template <typename T> void update(T& field, T value) {
+    portENTER_CRITICAL(&lock);
+    if (field != value) {
+      field = value;
+      version++;
+    }
+    portEXIT_CRITICAL(&lock);
+  }
+
+  void updateText(char* field, size_t size, const char* value) {
+    portENTER_CRITICAL(&lock);
+    if (strncmp(field, value, size - 1) != 0) {
+      strncpy(field, value, size - 1);
+      field[size - 1] = '\0';
+      version++;
+    }
+    portEXIT_CRITICAL(&lock);
+  }
+
+  // getStatusJson()
+  const char* cachedJson(size_t& length) {
+    StatusSnapshot snap;
+    portENTER_CRITICAL(&lock);
+    uint32_t v = version;
+    if (v != jsonVersion) snap = snapshot;
+    portEXIT_CRITICAL(&lock);
+    if (v != jsonVersion) {
+      jsonLength = statusJson(snap, json, sizeof(json));
+      jsonVersion = v;
+    }
+    length = jsonLength;
+    return json;
+  }
+
+  StatusSnapshot copy() {
+    portENTER_CRITICAL(&lock);
+    StatusSnapshot snap = snapshot;
+    portEXIT_CRITICAL(&lock);
+    return snap;
+  }
+
+  // pushStatusDeltas()
+  void pushDeltas() {
+    StatusSnapshot snap;
+    portENTER_CRITICAL(&lock);
+    uint32_t v = version;
+    if (v != pushVersion) snap = snapshot;
+    portEXIT_CRITICAL(&lock);
+    if (v == pushVersion) return;
+    pushVersion = v;
+
+    const StatusSnapshot& prev = pushed;
+    if (abs(snap.rssi - prev.rssi) < 3) snap.rssi = prev.rssi;
+
+    char delta[384];
+    char text[sizeof(snap.lastCommand) * 2];
+    size_t len = 0;
+    appendf(delta, sizeof(delta), len, "{\"delta\":{");
+    size_t start = len;
+    if (snap.emergency != prev.emergency) appendf(delta, sizeof(delta), len, "\"emergency\":%d,", snap.emergency ? 1 : 0);
+    if (snap.connected != prev.connected) appendf(delta, sizeof(delta), len, "\"connected\":%d,", snap.connected ? 1 : 0);
+    if (snap.apMode != prev.apMode) appendf(delta, sizeof(delta), len, "\"mode\":\"%s\",", snap.apMode ? "ap" : "station");
+    if (snap.rssi != prev.rssi) appendf(delta, sizeof(delta), len, "\"rssi\":%d,", snap.rssi);
+    if (snap.ip != prev.ip) {
+      appendf(delta, sizeof(delta), len, "\"ip\":\"%u.%u.%u.%u\",",
+              (unsigned)(snap.ip & 0xFF), (unsigned)((snap.ip >> 8) & 0xFF),
+              (unsigned)((snap.ip >> 16) & 0xFF), (unsigned)(snap.ip >> 24));
+    }
+    if (snap.wsClients != prev.wsClients) appendf(delta, sizeof(delta), len, "\"clients\":%u,", snap.wsClients);
+    if (snap.pollClients != prev.pollClients) appendf(delta, sizeof(delta), len, "\"pollClients\":%u,", snap.pollClients);
+    if (snap.serialPending != prev.serialPending) appendf(delta, sizeof(delta), len, "\"serialPending\":%u,", snap.serialPending);
+    if (snap.leaseHolder != prev.leaseHolder) appendf(delta, sizeof(delta), len, "\"lease\":%d,", snap.leaseHolder);
+    if (strcmp(snap.lastCommand, prev.lastCommand) != 0) {
+      jsonEscape(text, sizeof(text), snap.lastCommand);
+      appendf(delta, sizeof(delta), len, "\"lastCommand\":\"%s\",", text);
+    }
+    if (strcmp(snap.emergencyReason, prev.emergencyReason) != 0) {
+      jsonEscape(text, sizeof(text), snap.emergencyReason);
+      appendf(delta, sizeof(delta), len, "\"reason\":\"%s\",", text);
+    }
+    pushed = snap;
+    if (len == start) return;
+    if (delta[len - 1] == ',') len--;
+    appendf(delta, sizeof(delta), len, "}}");
+    for (int i = 0; i < SUBSCRIBERS; i++) send(delta, len);
+  }
+};
+
+// A minute on the floor: uptime and RSSI jitter every second, a command
+// every 400 ms, a client joining and leaving, one emergency
+static void advance(Status& status, int tick) {
+  StatusSnapshot& s = status.snapshot;
+  if (tick % 10 == 0) {
+    status.update(s.uptimeSec, (uint32_t)(tick / 10));
+    status.update(s.rssi, (int8_t)(-60 + (tick / 10) % 3 - (tick % 200 == 0 ? 6 : 0)));
+  }
+  if (tick % 4 == 0) {
+    char command[32];
+    snprintf(command, sizeof(command), "MOVE forward %d", 100 + tick);
+    status.updateText(s.lastCommand, sizeof(s.lastCommand), command);
+  }
+  if (tick == 150) status.update(s.wsClients, (uint8_t)4);
+  if (tick == 450) status.update(s.wsClients, (uint8_t)3);
+  if (tick == 300) {
+    status.update(s.emergency, true);
+    status.updateText(s.emergencyReason, sizeof(s.emergencyReason), "Operator STOP via websocket");
+  }
+  if (tick == 320) {
+    status.update(s.emergency, false);
+    status.updateText(s.emergencyReason, sizeof(s.emergencyReason), "");
+  }
+}
+
+struct Cost {
+  double ns;
+  double allocations;
+};
+
+template <typename Fn>
+static Cost measure(int count, Fn fn) {
+  double best = 1e30;
+  size_t allocated = 0;
+  for (int round = 0; round < 3; round++) {
+    size_t before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int n = 0; n < count; n++) fn(n);
+    auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / count);
+    allocated = allocations - before;
+  }
+  return {best, (double)allocated / count};
+}
+
+int main() {
+  Status status;
+  StatusSnapshot& s = status.snapshot;
+  s.connected = true;
+  s.rssi = -61;
+  s.ip = 0x3201A8C0;                            // 192.168.1.50
+  s.uptimeSec = 86400;
+  s.wsClients = 3;
+  s.pollClients = 2;
+  s.leaseHolder = 1;
+  strcpy(s.lastCommand, "MOVE forward 1200");
+
+  // The three forms agree
+  char buffer[384];
+  size_t cachedLength;
+  const char* cached = status.cachedJson(cachedLength);
+  String built = statusString(s);
+  assert(statusJson(s, buffer, sizeof(buffer)) == cachedLength);
+  assert(built.length() == cachedLength && memcmp(built.c_str(), cached, cachedLength) == 0);
+
+  // /status and STATUS_REQUEST at a high poll rate; a field changes about
+  // every 50 requests (a 20 Hz poller against once-a-second refreshes is
+  // rarer still)
+  Cost strings = measure(REQUESTS, [&](int n) {
+    if (n % 50 == 0) status.update(s.uptimeSec, s.uptimeSec + 1);
+    String json = statusString(status.copy());
+    send(json.c_str(), json.length());
+  });
+  Cost rebuilt = measure(REQUESTS, [&](int n) {
+    if (n % 50 == 0) status.update(s.uptimeSec, s.uptimeSec + 1);
+    StatusSnapshot snap = status.copy();
+    send(buffer, statusJson(snap, buffer, sizeof(buffer)));
+  });
+  Cost cachedCost = measure(REQUESTS, [&](int n) {
+    if (n % 50 == 0) status.update(s.uptimeSec, s.uptimeSec + 1);
+    size_t len;
+    const char* json = status.cachedJson(len);
+    send(json, len);
+  });
+  printf("status request: Strings %.0f ns (%.0f allocs), rebuilt %.0f ns, cached %.0f ns (%.2f allocs); "
+         "%.0fk / %.0fk / %.0fk requests/s\n",
+         strings.ns, strings.allocations, rebuilt.ns, cachedCost.ns, cachedCost.allocations,
+         1e6 / strings.ns, 1e6 / rebuilt.ns, 1e6 / cachedCost.ns);
+
+  // Pushes to SUBSCRIBERS clients every 100 ms for a minute
+  Status before;
+  before.snapshot = s;
+  sentBytes = 0;
+  Cost full = measure(TICKS, [&](int tick) {
+    advance(before, tick);
+    StatusSnapshot snap = before.copy();
+    size_t len = statusJson(snap, buffer, sizeof(buffer));
+    for (int i = 0; i < SUBSCRIBERS; i++) send(buffer, len);
+  });
+  size_t fullBytes = sentBytes / 3;
+
+  Status after;
+  after.snapshot = s;
+  after.pushed = s;
+  sentBytes = 0;
+  Cost deltas = measure(TICKS, [&](int tick) {
+    advance(after, tick);
+    after.pushDeltas();
+  });
+  size_t deltaBytes = sentBytes / 3;
+  printf("status push: full snapshots %.0f ns/tick, %zu B/s per client; deltas %.0f ns/tick, %zu B/s per client\n",
+         full.ns, fullBytes / SUBSCRIBERS / 60, deltas.ns, deltaBytes / SUBSCRIBERS / 60);
+
+  assert(cachedCost.allocations == 0 && rebuilt.allocations == 0);
+  assert(strings.allocations > 10);
+  assert(cachedCost.ns < rebuilt.ns && rebuilt.ns < strings.ns);
+  assert(deltaBytes * 4 < fullBytes);
+  return 0;
+}
@@ -0,0 +1,330 @@
+// taskemu - host emulation of the AGVCoreNetwork task layout
+//
+// Runs the network task and the Arduino loop task as pthreads pinned to host
+// CPUs, with the core, priority and stack size of a TaskConfig, so a
+// placement can be tried off-device before it is flashed. The network task
+// runs the library's TaskProfiler over a cost model of its subsystems and
+// prints the same sample /debug/tasks reports; the loop task measures how
+// late its 1 ms tick runs. Stacks are painted and scanned like FreeRTOS
+// does, and overrunning the configured size is reported as a failure.
+//
+// Priorities map to SCHED_FIFO (needs root or CAP_SYS_NICE; otherwise they
+// are reported as not applied). Host stack frames are smaller than Xtensa
+// ones, so stack figures are a lower bound.
+//
+// Build: AGVCoreNetwork_Profiler.cpp
+// Run:   taskemu [--core N] [--priority N] [--stack BYTES]
+//                [--loop-core N] [--loop-priority N] [--seconds S]
+//                [--cost http=50,ws=150,...] [--stack-use http=2048,...]
+//
+// Exit status is 1 when a task overruns its stack or the profiler sample
+// is inconsistent.
+
+#include "AGVCoreNetwork.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+using namespace AGVCoreNetworkLib;
+
+static const char* const SUBSYSTEM_NAMES[SUBSYS_COUNT] = {
+  "http", "ws", "dns", "serial", "transport", "async"
+};
+
+// Cost model per loop iteration of the network task
+static uint32_t costUs[SUBSYS_COUNT] = {60, 150, 0, 5, 20, 10};
+static uint32_t stackUse[SUBSYS_COUNT] = {2048, 1536, 512, 256, 1024, 256};
+
+// ---------------------------------------------------------------------------
+// FreeRTOS task API on pthreads (the subset in shim/freertos)
+
+static const uint8_t STACK_PAINT = 0xA5;
+static const size_t THREAD_RESERVE = 64 * 1024;   // Thread descriptor and TLS
+
+struct EmuTask {
+  const char* name;
+  TaskFunction_t function;
+  void* parameter;
+  uint32_t stackSize;
+  uint8_t* stack;             // Lowest address of the mapping
+  size_t mapped;
+  uint8_t* entryFrame;        // Stack pointer at task entry
+  pthread_t thread;
+  bool priorityApplied;
+};
+
+static thread_local EmuTask* currentTask = nullptr;
+static EmuTask* tasks[4];
+static std::atomic<uint8_t> taskCount{0};
+
+// Bytes of the configured stack never touched since the task started
+static uint32_t stackHighWater(const EmuTask* t) {
+  const uint8_t* low = t->stack + getpagesize();   // Above the guard page
+  const uint8_t* p = low;
+  while (p < t->entryFrame && *p == STACK_PAINT) p++;
+  size_t used = t->entryFrame - p;
+  return used >= t->stackSize ? 0 : (uint32_t)(t->stackSize - used);
+}
+
+static void* taskEntry(void* arg) {
+  EmuTask* t = (EmuTask*)arg;
+  uint8_t marker;
+  t->entryFrame = &marker;
+  currentTask = t;
+  t->function(t->parameter);
+  return nullptr;
+}
+
+static void onStackFault(int) {
+  static const char msg[] = "FAIL: stack overflow (guard page hit)\n";
+  if (write(2, msg, sizeof(msg) - 1) < 0) {}
+  _exit(1);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  EmuTask* t = new EmuTask();
+  t->name = name;
+  t->function = function;
+  t->parameter = parameter;
+  t->stackSize = stackSize;
+
+  // Guard page, then the configured stack and room for the thread descriptor
+  size_t page = getpagesize();
+  t->mapped = page + ((stackSize + THREAD_RESERVE + page - 1) / page) * page;
+  t->stack = (uint8_t*)mmap(nullptr, t->mapped, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (t->stack == MAP_FAILED) return pdFALSE;
+  memset(t->stack, STACK_PAINT, t->mapped);
+  mprotect(t->stack, page, PROT_NONE);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, t->stack, t->mapped);
+
+  if (core != tskNO_AFFINITY) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+  }
+
+  // FreeRTOS priorities 0..24 become SCHED_FIFO 1..25
+  sched_param sp = {};
+  sp.sched_priority = 1 + (int)priority;
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  pthread_attr_setschedparam(&attr, &sp);
+  t->priorityApplied = pthread_create(&t->thread, &attr, taskEntry, t) == 0;
+  if (!t->priorityApplied) {
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    if (pthread_create(&t->thread, &attr, taskEntry, t) != 0) return pdFALSE;
+  }
+  pthread_attr_destroy(&attr);
+
+  tasks[taskCount++] = t;
+  if (handle) *handle = t;
+  return pdPASS;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle) {
+  return stackHighWater(handle ? (EmuTask*)handle : currentTask);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return currentTask; }
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::timed_mutex(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks) {
+  return ((std::timed_mutex*)m)->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) {
+  ((std::timed_mutex*)m)->unlock();
+  return pdTRUE;
+}
+
+// ---------------------------------------------------------------------------
+// Emulated tasks
+
+static SemaphoreHandle_t mutex;
+static TaskProfile snapshot;
+static uint32_t windows = 0;
+static std::atomic<bool> running{true};
+
+static void spinUs(uint32_t us) {
+  uint32_t start = micros();
+  while (micros() - start < us) {}
+}
+
+// A subsystem handler: a stack frame of the modelled size, then busy time
+static void __attribute__((noinline)) runSubsystem(Subsystem s) {
+  volatile uint8_t* frame = (volatile uint8_t*)alloca(stackUse[s]);
+  for (uint32_t i = 0; i < stackUse[s]; i += 64) frame[i] = (uint8_t)i;
+  spinUs(costUs[s]);
+}
+
+// Same shape as AGVCoreNetwork::core0Task
+static void networkTask(void*) {
+  TaskProfiler profiler;
+  profiler.start(micros());
+
+  while (running) {
+    uint32_t loopStart = micros();
+    uint32_t t = loopStart;
+    for (uint8_t s = 0; s < SUBSYS_COUNT; s++) {
+      if (costUs[s] == 0 && stackUse[s] == 0) continue;
+      runSubsystem((Subsystem)s);
+      t = profiler.section((Subsystem)s, t, micros());
+    }
+
+    TaskProfile completed;
+    if (profiler.loopEnd(loopStart, t, completed)) {
+      completed.stackHighWater = uxTaskGetStackHighWaterMark(NULL);
+      if (xSemaphoreTake(mutex, pdMS_TO_TICKS(5)) == pdPASS) {
+        snapshot = completed;
+        windows++;
+        xSemaphoreGive(mutex);
+      }
+    }
+
+    delay(1);
+  }
+}
+
+// The application's loop(): 200 us of work on a 1 ms tick
+static std::atomic<uint32_t> loopTicks{0};
+static std::atomic<uint32_t> loopMaxLateUs{0};
+
+static void loopTask(void*) {
+  uint32_t due = micros() + 1000;
+  while (running) {
+    int32_t wait = (int32_t)(due - micros());
+    if (wait > 0) usleep(wait);
+    uint32_t late = micros() - due;
+    if (late > loopMaxLateUs) loopMaxLateUs = late;
+    loopTicks++;
+    spinUs(200);
+    due += 1000;
+    if ((int32_t)(micros() - due) > 0) due = micros();   // Skip missed ticks
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+static bool parseList(const char* arg, uint32_t* values) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s", arg);
+  for (char* item = strtok(buf, ","); item; item = strtok(nullptr, ",")) {
+    char* eq = strchr(item, '=');
+    if (!eq) return false;
+    *eq = '\0';
+    uint8_t s = 0;
+    while (s < SUBSYS_COUNT && strcmp(item, SUBSYSTEM_NAMES[s]) != 0) s++;
+    if (s == SUBSYS_COUNT) return false;
+    values[s] = (uint32_t)atoi(eq + 1);
+  }
+  return true;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: taskemu [--core N] [--priority N] [--stack BYTES] [--loop-core N]\n"
+                  "               [--loop-priority N] [--seconds S] [--cost name=us,...]\n"
+                  "               [--stack-use name=bytes,...]\n");
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  AGVCoreNetwork::TaskConfig config;       // The library defaults
+  BaseType_t loopCore = 1;
+  UBaseType_t loopPriority = 1;            // Arduino loopTask
+  double seconds = 2;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!v) usage();
+    if (!strcmp(a, "--core")) config.core = atoi(v);
+    else if (!strcmp(a, "--priority")) config.priority = atoi(v);
+    else if (!strcmp(a, "--stack")) config.stackSize = atoi(v);
+    else if (!strcmp(a, "--loop-core")) loopCore = atoi(v);
+    else if (!strcmp(a, "--loop-priority")) loopPriority = atoi(v);
+    else if (!strcmp(a, "--seconds")) seconds = atof(v);
+    else if (!strcmp(a, "--cost")) { if (!parseList(v, costUs)) usage(); }
+    else if (!strcmp(a, "--stack-use")) { if (!parseList(v, stackUse)) usage(); }
+    else usage();
+    i++;
+  }
+
+  // Cores beyond the host's CPUs share them (a single-CPU host runs both
+  // tasks on one core, which is worth knowing about too)
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  BaseType_t netCpu = config.core % cpus;
+  BaseType_t loopCpu = loopCore % cpus;
+  if (netCpu != config.core || loopCpu != loopCore) {
+    fprintf(stderr, "note: host has %ld CPU(s); cores %d/%d run on CPUs %d/%d\n", cpus,
+            (int)config.core, (int)loopCore, (int)netCpu, (int)loopCpu);
+  }
+
+  // Stack overruns land on the guard page
+  static uint8_t altStack[64 * 1024];
+  stack_t ss = {};
+  ss.ss_sp = altStack;
+  ss.ss_size = sizeof(altStack);
+  sigaltstack(&ss, nullptr);
+  struct sigaction sa = {};
+  sa.sa_handler = onStackFault;
+  sa.sa_flags = SA_ONSTACK;
+  sigaction(SIGSEGV, &sa, nullptr);
+
+  mutex = xSemaphoreCreateMutex();
+  TaskHandle_t net, loop;
+  if (xTaskCreatePinnedToCore(networkTask, "AGVNetCore0", config.stackSize, nullptr,
+                              config.priority, &net, netCpu) != pdPASS ||
+      xTaskCreatePinnedToCore(loopTask, "loopTask", 8192, nullptr,
+                              loopPriority, &loop, loopCpu) != pdPASS) {
+    fprintf(stderr, "task creation failed\n");
+    return 1;
+  }
+
+  delay((unsigned long)(seconds * 1000));
+  running = false;
+  for (uint8_t i = 0; i < taskCount; i++) pthread_join(tasks[i]->thread, nullptr);
+
+  TaskProfile p = snapshot;
+  EmuTask* n = (EmuTask*)net;
+  printf("{\"task\":\"AGVNetCore0\",\"core\":%d,\"priority\":%u,\"priorityApplied\":%s,\"stackSize\":%u,"
+         "\"stackHighWater\":%u,\"cpuPercent\":%u,\"windowUs\":%u,\"loops\":%u,\"maxLoopUs\":%u,\"subsystemUs\":{",
+         (int)config.core, (unsigned)config.priority, n->priorityApplied ? "true" : "false",
+         (unsigned)config.stackSize, (unsigned)stackHighWater(n), (unsigned)p.cpuPercent,
+         (unsigned)p.windowUs, (unsigned)p.loops, (unsigned)p.maxLoopUs);
+  for (uint8_t s = 0; s < SUBSYS_COUNT; s++) {
+    printf("%s\"%s\":%u", s ? "," : "", SUBSYSTEM_NAMES[s], (unsigned)p.subsystemUs[s]);
+  }
+  printf("}}\n{\"task\":\"loopTask\",\"core\":%d,\"priority\":%u,\"ticks\":%u,\"maxLateUs\":%u}\n",
+         (int)loopCore, (unsigned)loopPriority, (unsigned)loopTicks, (unsigned)loopMaxLateUs);
+
+  // The sample must add up
+  uint32_t subsystems = 0;
+  for (uint8_t s = 0; s < SUBSYS_COUNT; s++) subsystems += p.subsystemUs[s];
+  bool ok = windows > 0 && p.loops > 0 && subsystems <= p.busyUs && p.busyUs <= p.windowUs &&
+            p.maxLoopUs <= p.busyUs;
+  if (!ok) printf("FAIL: inconsistent profile sample (%u windows)\n", (unsigned)windows);
+  if (stackHighWater(n) == 0) {
+    printf("FAIL: network task used its whole %u-byte stack\n", (unsigned)config.stackSize);
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
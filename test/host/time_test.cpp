@@ -0,0 +1,75 @@
+// Clock sync against a simulated skewed remote clock with queueing delay,
+// and timer wheel release lateness for a loop slower than the tick.
+//
+// Build: AGVCoreNetwork_Time.cpp
+
+#include "AGVCoreNetwork_Time.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace AGVCoreNetworkLib;
+
+int main() {
+  for (double ppm : {0.0, 50.0, -120.0}) {
+    // 0.5 ms each way plus exponential queueing (mean 3 ms), sometimes
+    // four times worse on the way back
+    std::mt19937 rng(7);
+    std::exponential_distribution<double> queueing(1.0 / 3000);
+    const double skew = ppm * 1e-6;
+    const int64_t epoch = 1700000000000000LL;
+    auto remoteAt = [&](double local) { return (int64_t)llround(local * (1 + skew)) + epoch; };
+
+    ClockSync sync;
+    double t = 1e6, maxError = 0, sumError = 0;
+    int evaluated = 0;
+    for (int i = 0; i < 200; i++) {
+      double up = 500 + queueing(rng);
+      double down = 500 + queueing(rng) * (rng() % 3 == 0 ? 4 : 1);
+      sync.addSample((int64_t)t, remoteAt(t + up), (int64_t)(t + up + down));
+      // Fast exchanges until synced, then the steady 5 s period
+      t += sync.samples() < 8 ? 250000 : 5000000;
+
+      // A command for a remote instant 2 s ahead
+      if (i >= 24) {
+        double local = t + 2e6;
+        double error = fabs((double)sync.toLocal(remoteAt(local)) - local);
+        maxError = std::max(maxError, error);
+        sumError += error;
+        evaluated++;
+      }
+    }
+    double driftError = fabs(sync.driftPpb() - ppm * 1000) / 1000;
+    printf("skew %+5.0f ppm: rtt %u us, drift error %.1f ppm, mean error %.0f us, max error %.0f us\n", ppm,
+           (unsigned)sync.rttUs(), driftError, sumError / evaluated, maxError);
+    assert(sync.synced());
+    assert(driftError < 20);
+    assert(sumError / evaluated < 2000 && maxError < 10000);
+  }
+
+  // 16 commands over half a second, one spare request over capacity
+  TimerWheel wheel;
+  int64_t now = 1000000;
+  for (int i = 0; i < TimerWheel::CAPACITY; i++) {
+    bool scheduled = wheel.schedule(now + (i * 37 % 500) * 1000 + 123, 0, "X", i);
+    assert(scheduled);
+  }
+  bool overflow = wheel.schedule(now + 1, 0, "overflow", 0);
+  assert(!overflow);
+
+  int released = 0;
+  int64_t worst = 0;
+  for (; now < 2000000; now += 700) {
+    wheel.advance(now, [&](uint8_t, const char*, uint32_t, int64_t lateUs) {
+      released++;
+      worst = std::max(worst, lateUs);
+    });
+  }
+  printf("wheel: %d released, worst lateness %lld us with a 700 us loop\n", released, (long long)worst);
+  assert(released == TimerWheel::CAPACITY && wheel.pending() == 0);
+  assert(worst >= 0 && worst < 700);
+  return 0;
+}
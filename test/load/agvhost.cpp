@@ -0,0 +1,53 @@
+// agvhost - the whole AGVCoreNetwork library on the host, as a load target
+//
+// Builds the library against the host shim (test/host/shim): the station
+// link is up on 127.0.0.1, the web, WebSocket and poll servers listen on
+// host ports, and the network task runs as a thread. The main thread plays
+// the Arduino loop task and sends a status line every second. Commands are
+// acknowledged by the library and otherwise ignored.
+//
+// Build and run against agvload with run_host.sh.
+// Run:  agvhost [http_port ws_port poll_port] [seconds]
+//
+// Sketch settings match host.scenario: login admin/admin123, rate limit
+// 100/s with a burst of 200, motion lease of 5 s.
+
+#include "AGVCoreNetwork.h"
+#include "Preferences.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+  uint16_t httpPort = argc > 3 ? atoi(argv[1]) : 18080;
+  uint16_t wsPort = argc > 3 ? atoi(argv[2]) : 18081;
+  uint16_t pollPort = argc > 3 ? atoi(argv[3]) : 18082;
+  int seconds = argc == 2 ? atoi(argv[1]) : argc > 4 ? atoi(argv[4]) : 0;
+
+  // Saved credentials take the station path; the host link is already up
+  Preferences prefs;
+  prefs.begin("agvnet", false);
+  prefs.putString("ssid", "host");
+  prefs.putString("password", "host");
+  prefs.end();
+  hostStationLink(true);
+  hostRunTasks(true);
+
+  agvNetwork.setServerPorts(httpPort, wsPort);
+  agvNetwork.setPollServerPort(pollPort);
+  agvNetwork.setRateLimit(100, 200);
+  agvNetwork.setControlLeaseDuration(5000);
+  agvNetwork.begin("agvhost", "admin", "admin123");
+  agvNetwork.setCommandCallback([](const char*) {});
+
+  fprintf(stderr, "agvhost: http :%u, ws :%u, poll :%u\n", httpPort, wsPort, pollPort);
+  for (int elapsed = 0; seconds == 0 || elapsed < seconds; elapsed++) {
+    agvNetwork.sendStatus("AGV Ready - Idle");
+    delay(1000);
+  }
+
+  // The network task never returns; leave without running destructors under it
+  _exit(0);
+}
@@ -0,0 +1,776 @@
+// agvload - load and soak tester for AGVCoreNetwork endpoints
+//
+// Opens WebSocket connections (port 81) and HTTP sessions (/login, /command,
+// /status, ...) against a vehicle, drives them with the message mixes and
+// rates of a scenario file, and reports latency histograms, ACK correlation,
+// drops and HTTP status codes.
+//
+// Build (Linux/macOS):  g++ -O2 -std=c++17 -pthread agvload.cpp -o agvload
+// Run:                  ./agvload soak.scenario [host]
+//
+// Exit status is 1 when drops and errors exceed the scenario's max_error_pct.
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Latency histogram: 16 linear sub-buckets per power of two (about 6% error)
+
+class Histogram {
+public:
+  static const int SUB = 16;
+  static const int BUCKETS = 40 * SUB;
+
+  void record(int64_t us) {
+    if (us < 0) us = 0;
+    counts[index(us)]++;
+    total++;
+    if (us > maxUs) maxUs = us;
+  }
+
+  void merge(const Histogram& other) {
+    for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+    total += other.total;
+    maxUs = std::max(maxUs, other.maxUs);
+  }
+
+  int64_t percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)std::ceil(p / 100.0 * total);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+      if (seen >= rank) return std::min(upper(i), maxUs);
+    }
+    return maxUs;
+  }
+
+  uint64_t count() const { return total; }
+  int64_t max() const { return maxUs; }
+
+private:
+  uint64_t counts[BUCKETS] = {};
+  uint64_t total = 0;
+  int64_t maxUs = 0;
+
+  static int index(int64_t v) {
+    if (v < SUB) return (int)v;
+    int log = 63 - __builtin_clzll((uint64_t)v);
+    int shift = log - 4;
+    int i = (shift + 1) * SUB + (int)((v >> shift) - SUB);
+    return std::min(i, BUCKETS - 1);
+  }
+
+  static int64_t upper(int i) {
+    if (i < SUB) return i;
+    int shift = i / SUB - 1;
+    return ((int64_t)(i % SUB + SUB + 1) << shift) - 1;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Per-stream results, merged from all worker threads
+
+struct StreamStats {
+  Histogram latency;
+  uint64_t sent = 0;
+  uint64_t replies = 0;
+  uint64_t nacks = 0;
+  uint64_t drops = 0;       // No reply within the timeout
+  uint64_t errors = 0;      // Connection or protocol failures
+  std::map<std::string, uint64_t> codes;
+};
+
+class Results {
+public:
+  StreamStats& lock(const std::string& name) {
+    mutex.lock();
+    return streams[name];
+  }
+  void unlock() { mutex.unlock(); }
+
+  void print(const char* title, double seconds) {
+    std::lock_guard<std::mutex> guard(mutex);
+    printf("\n== %s (%.0f s) ==\n", title, seconds);
+    printf("%-28s %9s %9s %7s %7s %7s %8s %8s %8s %8s %8s\n", "stream", "sent", "replies", "nack",
+           "drop", "error", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+    for (auto& entry : streams) {
+      const StreamStats& s = entry.second;
+      printf("%-28s %9llu %9llu %7llu %7llu %7llu %8.2f %8.2f %8.2f %8.2f %8.2f\n", entry.first.c_str(),
+             (unsigned long long)s.sent, (unsigned long long)s.replies, (unsigned long long)s.nacks,
+             (unsigned long long)s.drops, (unsigned long long)s.errors,
+             s.latency.percentile(50) / 1000.0, s.latency.percentile(90) / 1000.0,
+             s.latency.percentile(99) / 1000.0, s.latency.percentile(99.9) / 1000.0,
+             s.latency.max() / 1000.0);
+      if (!s.codes.empty()) {
+        printf("%-28s", "");
+        for (auto& code : s.codes) printf(" %s:%llu", code.first.c_str(), (unsigned long long)code.second);
+        printf("\n");
+      }
+    }
+    fflush(stdout);
+  }
+
+  void totals(uint64_t& sent, uint64_t& failed) {
+    std::lock_guard<std::mutex> guard(mutex);
+    sent = failed = 0;
+    for (auto& entry : streams) {
+      sent += entry.second.sent;
+      failed += entry.second.drops + entry.second.errors;
+    }
+  }
+
+private:
+  std::mutex mutex;
+  std::map<std::string, StreamStats> streams;
+};
+
+// ---------------------------------------------------------------------------
+// Scenario
+//
+//   host agv.local
+//   http_port 80
+//   ws_port 81
+//   duration 600          seconds
+//   report 30             interim report interval (0 = final only)
+//   timeout 2000          ms without a reply before a message counts as dropped
+//   max_error_pct 1
+//   login admin admin123
+//   rate_limit 100 200    the vehicle's setRateLimit(); all load comes from one
+//                         address, so a scenario above it is refused
+//
+//   ws <connections> <messages/s per connection> [lease] [subscribe]
+//   send <weight> <text>  message mix of the preceding ws group
+//
+//   http <GET|POST> <path> <requests/s total> <sessions> [keepalive] [body...]
+//                         path ":8080/status" targets another port (poll server)
+
+struct Message {
+  int weight;
+  std::string text;
+};
+
+struct WsGroup {
+  int connections = 1;
+  double rate = 1;
+  bool lease = false;
+  bool subscribe = false;
+  std::vector<Message> mix;
+};
+
+struct HttpGroup {
+  std::string method = "GET";
+  std::string path = "/status";
+  double rate = 1;
+  int sessions = 1;
+  bool keepAlive = false;
+  std::string body;
+};
+
+struct Scenario {
+  std::string host = "agvcontrol.local";
+  int httpPort = 80;
+  int wsPort = 81;
+  int duration = 60;
+  int report = 0;
+  int timeoutMs = 2000;
+  double maxErrorPct = 1.0;
+  int rateLimit = 20;        // RequestGuard defaults
+  int rateBurst = 40;
+  std::string user, password;
+  std::vector<WsGroup> ws;
+  std::vector<HttpGroup> http;
+};
+
+static bool loadScenario(const char* path, Scenario& sc) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "Cannot open scenario '%s'\n", path);
+    return false;
+  }
+
+  std::string line;
+  int number = 0;
+  while (std::getline(in, line)) {
+    number++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+
+    std::istringstream words(line);
+    std::string key;
+    if (!(words >> key)) continue;
+
+    bool ok = true;
+    if (key == "host") ok = (bool)(words >> sc.host);
+    else if (key == "http_port") ok = (bool)(words >> sc.httpPort);
+    else if (key == "ws_port") ok = (bool)(words >> sc.wsPort);
+    else if (key == "duration") ok = (bool)(words >> sc.duration);
+    else if (key == "report") ok = (bool)(words >> sc.report);
+    else if (key == "timeout") ok = (bool)(words >> sc.timeoutMs);
+    else if (key == "max_error_pct") ok = (bool)(words >> sc.maxErrorPct);
+    else if (key == "login") ok = (bool)(words >> sc.user >> sc.password);
+    else if (key == "rate_limit") ok = (bool)(words >> sc.rateLimit >> sc.rateBurst);
+    else if (key == "ws") {
+      WsGroup group;
+      ok = (bool)(words >> group.connections >> group.rate);
+      std::string flag;
+      while (words >> flag) {
+        if (flag == "lease") group.lease = true;
+        else if (flag == "subscribe") group.subscribe = true;
+        else ok = false;
+      }
+      sc.ws.push_back(group);
+    } else if (key == "send") {
+      Message msg;
+      ok = !sc.ws.empty() && (bool)(words >> msg.weight);
+      std::getline(words >> std::ws, msg.text);
+      ok = ok && !msg.text.empty() && msg.weight > 0;
+      if (ok) sc.ws.back().mix.push_back(msg);
+    } else if (key == "http") {
+      HttpGroup group;
+      ok = (bool)(words >> group.method >> group.path >> group.rate >> group.sessions);
+      std::string rest;
+      std::getline(words >> std::ws, rest);
+      if (rest.compare(0, 9, "keepalive") == 0) {
+        group.keepAlive = true;
+        size_t body = rest.find_first_not_of(' ', 9);
+        rest = body == std::string::npos ? "" : rest.substr(body);
+      }
+      group.body = rest;
+      sc.http.push_back(group);
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, number, line.c_str());
+      return false;
+    }
+  }
+
+  for (auto& group : sc.ws) {
+    if (group.mix.empty()) group.mix.push_back({1, "PING"});
+  }
+
+  // Every request and message from this host shares one token bucket
+  double rate = 0;
+  for (auto& group : sc.ws) rate += group.connections * group.rate;
+  for (auto& group : sc.http) rate += group.rate;
+  if (sc.rateLimit > 0 && rate > sc.rateLimit) {
+    fprintf(stderr, "%s: %.1f requests/s exceeds rate_limit %d; the vehicle would answer 429/NACK\n", path, rate,
+            sc.rateLimit);
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Sockets
+
+static int connectTcp(const std::string& host, int port) {
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0 || !res) return -1;
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+
+  if (fd >= 0) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+static bool sendAll(int fd, const void* data, size_t length) {
+  const char* p = (const char*)data;
+  while (length > 0) {
+    ssize_t n = send(fd, p, length, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    p += n;
+    length -= n;
+  }
+  return true;
+}
+
+// Waits up to timeoutMs for data; returns bytes read, 0 on timeout, -1 on close/error
+static ssize_t readSome(int fd, std::string& buffer, int timeoutMs) {
+  pollfd pfd = {fd, POLLIN, 0};
+  int ready = poll(&pfd, 1, timeoutMs);
+  if (ready < 0) return -1;
+  if (ready == 0) return 0;
+
+  char chunk[4096];
+  ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+  if (n <= 0) return -1;
+  buffer.append(chunk, n);
+  return n;
+}
+
+// ---------------------------------------------------------------------------
+// HTTP
+
+struct HttpResponse {
+  int status = 0;
+  std::string body;
+  bool keepAlive = false;
+};
+
+static bool httpRequest(int& fd, const Scenario& sc, const std::string& method, const std::string& path,
+                        const std::string& body, const std::string& token, bool keepAlive, int port,
+                        HttpResponse& out) {
+  if (fd < 0) fd = connectTcp(sc.host, port);
+  if (fd < 0) return false;
+
+  std::string req = method + " " + path + " HTTP/1.1\r\nHost: " + sc.host + "\r\n";
+  if (!token.empty()) req += "Authorization: Bearer " + token + "\r\n";
+  if (!body.empty() || method == "POST") {
+    req += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+  }
+  req += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  req += body;
+  if (!sendAll(fd, req.data(), req.size())) return false;
+
+  std::string buffer;
+  size_t headerEnd;
+  int64_t deadline = nowUs() + (int64_t)sc.timeoutMs * 1000;
+  while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+    if (nowUs() > deadline || readSome(fd, buffer, 100) < 0) return false;
+  }
+
+  std::string head = buffer.substr(0, headerEnd);
+  for (auto& c : head) c = (char)tolower((unsigned char)c);
+  if (sscanf(buffer.c_str(), "HTTP/%*d.%*d %d", &out.status) != 1) return false;
+
+  long contentLength = -1;
+  size_t pos = head.find("content-length:");
+  if (pos != std::string::npos) contentLength = atol(head.c_str() + pos + 15);
+  out.keepAlive = keepAlive && head.find("connection: close") == std::string::npos && contentLength >= 0;
+
+  size_t bodyStart = headerEnd + 4;
+  while (true) {
+    size_t have = buffer.size() - bodyStart;
+    if (contentLength >= 0 && have >= (size_t)contentLength) break;
+    ssize_t n = readSome(fd, buffer, 100);
+    if (n < 0) {
+      if (contentLength < 0) break;  // Body delimited by close
+      return false;
+    }
+    if (nowUs() > deadline) return false;
+  }
+  out.body = buffer.substr(bodyStart, contentLength >= 0 ? (size_t)contentLength : std::string::npos);
+
+  if (!out.keepAlive) {
+    close(fd);
+    fd = -1;
+  }
+  return true;
+}
+
+static std::string login(const Scenario& sc) {
+  int fd = -1;
+  HttpResponse res;
+  std::string body = "{\"username\":\"" + sc.user + "\",\"password\":\"" + sc.password + "\"}";
+  if (!httpRequest(fd, sc, "POST", "/login", body, "", false, sc.httpPort, res) || res.status != 200) {
+    return "";
+  }
+  size_t pos = res.body.find("\"token\":\"");
+  if (pos == std::string::npos) return "";
+  pos += 9;
+  return res.body.substr(pos, res.body.find('"', pos) - pos);
+}
+
+// ---------------------------------------------------------------------------
+// WebSocket client (RFC 6455, text frames, masked as clients must)
+
+class WsClient {
+public:
+  ~WsClient() { if (fd >= 0) close(fd); }
+
+  bool open(const Scenario& sc) {
+    fd = connectTcp(sc.host, sc.wsPort);
+    if (fd < 0) return false;
+
+    static const char* b64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string key;
+    for (int i = 0; i < 22; i++) key += b64[rng() % 64];
+    key += "==";
+
+    std::string req = "GET / HTTP/1.1\r\nHost: " + sc.host + ":" + std::to_string(sc.wsPort) +
+                      "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + key +
+                      "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (!sendAll(fd, req.data(), req.size())) return false;
+
+    int64_t deadline = nowUs() + (int64_t)sc.timeoutMs * 1000;
+    size_t end;
+    while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+      if (nowUs() > deadline || readSome(fd, in, 100) < 0) return false;
+    }
+    bool upgraded = in.compare(0, 12, "HTTP/1.1 101") == 0;
+    in.erase(0, end + 4);
+    return upgraded;
+  }
+
+  bool sendText(const std::string& text) {
+    std::string frame;
+    frame += (char)0x81;
+    size_t n = text.size();
+    if (n < 126) {
+      frame += (char)(0x80 | n);
+    } else {
+      frame += (char)(0x80 | 126);
+      frame += (char)(n >> 8);
+      frame += (char)(n & 0xFF);
+    }
+    uint8_t mask[4];
+    for (auto& m : mask) m = (uint8_t)rng();
+    frame.append((const char*)mask, 4);
+    for (size_t i = 0; i < n; i++) frame += (char)(text[i] ^ mask[i & 3]);
+    return sendAll(fd, frame.data(), frame.size());
+  }
+
+  // Next text message; 0 = timeout, 1 = message, -1 = closed
+  int receive(std::string& message, int timeoutMs) {
+    int64_t deadline = nowUs() + (int64_t)timeoutMs * 1000;
+    while (true) {
+      int r = parseFrame(message);
+      if (r != 0) return r;
+      int64_t left = (deadline - nowUs()) / 1000;
+      if (left <= 0) return 0;
+      ssize_t n = readSome(fd, in, (int)left);
+      if (n < 0) return -1;
+    }
+  }
+
+private:
+  int fd = -1;
+  std::string in;
+  std::mt19937 rng{std::random_device{}()};
+
+  int parseFrame(std::string& message) {
+    while (in.size() >= 2) {
+      uint8_t op = in[0] & 0x0F;
+      uint64_t len = in[1] & 0x7F;
+      size_t header = 2;
+      if (len == 126) {
+        if (in.size() < 4) return 0;
+        len = ((uint8_t)in[2] << 8) | (uint8_t)in[3];
+        header = 4;
+      } else if (len == 127) {
+        if (in.size() < 10) return 0;
+        len = 0;
+        for (int i = 0; i < 8; i++) len = (len << 8) | (uint8_t)in[2 + i];
+        header = 10;
+      }
+      if (in.size() < header + len) return 0;
+
+      std::string payload = in.substr(header, len);
+      in.erase(0, header + len);
+
+      if (op == 0x8) return -1;                            // Close
+      if (op == 0x9) {                                     // Ping -> pong
+        std::string pong;
+        pong += (char)0x8A;
+        pong += (char)0x80;
+        pong.append(4, '\0');
+        sendAll(fd, pong.data(), pong.size());
+        continue;
+      }
+      if (op == 0x1 || op == 0x2) {
+        message = payload;
+        return 1;
+      }
+    }
+    return 0;
+  }
+};
+
+// Reply a message is waiting for
+static bool matches(const std::string& sent, const std::string& reply, bool& nack) {
+  nack = false;
+  if (sent == "PING") return reply == "PONG";
+  if (sent == "STATUS_REQUEST" || sent.compare(0, 9, "SUBSCRIBE") == 0) {
+    return reply.compare(0, 12, "{\"emergency\"") == 0;
+  }
+  if (sent.compare(0, 6, "LEASE:") == 0) {
+    return reply.compare(0, 6, "LEASE:") == 0;
+  }
+  if (reply.compare(0, 6, "NACK: ") == 0) {
+    nack = true;
+    return true;
+  }
+  if (sent.compare(0, 3, "AT:") == 0) return reply.compare(0, 8, "ACK: AT ") == 0;
+  return reply.compare(0, 5, "ACK: ") == 0 && reply.compare(5, std::string::npos, sent) == 0;
+}
+
+static std::string streamName(const std::string& text) {
+  // Commands with arguments are grouped by verb ("ws PATH", "ws AT")
+  return ("ws " + text.substr(0, text.find(':'))).substr(0, 28);
+}
+
+struct Pending {
+  std::string text;
+  int64_t sentUs;
+};
+
+static void wsWorker(const Scenario& sc, const WsGroup& group, Results& results, int64_t endUs,
+                     std::atomic<bool>& stop, unsigned seed) {
+  std::mt19937 rng(seed);
+  int totalWeight = 0;
+  for (auto& m : group.mix) totalWeight += m.weight;
+  std::exponential_distribution<double> gap(group.rate > 0 ? group.rate : 1);
+
+  while (!stop && nowUs() < endUs) {
+    WsClient ws;
+    if (!ws.open(sc)) {
+      StreamStats& s = results.lock("ws connect");
+      s.errors++;
+      s.codes["connect-failed"]++;
+      results.unlock();
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      continue;
+    }
+    {
+      StreamStats& s = results.lock("ws connect");
+      s.sent++;
+      s.replies++;
+      results.unlock();
+    }
+
+    // Opening messages are tracked like the mix so their replies are not
+    // mistaken for answers to it
+    std::deque<Pending> pending;
+    std::vector<std::string> opening;
+    if (group.lease) opening.push_back("LEASE:ACQUIRE");
+    if (group.subscribe) opening.push_back("SUBSCRIBE:status");
+    for (auto& text : opening) {
+      ws.sendText(text);
+      pending.push_back({text, nowUs()});
+      StreamStats& s = results.lock(streamName(text));
+      s.sent++;
+      results.unlock();
+    }
+
+    int64_t nextSend = nowUs();
+    int64_t nextRenew = nowUs() + 1500000;
+    bool closed = false;
+
+    while (!stop && !closed && nowUs() < endUs) {
+      int64_t now = nowUs();
+
+      if (group.lease && now >= nextRenew) {
+        ws.sendText("LEASE:RENEW");
+        nextRenew = now + 1500000;
+      }
+
+      if (group.rate > 0 && now >= nextSend) {
+        int pick = (int)(rng() % totalWeight);
+        const Message* msg = &group.mix[0];
+        for (auto& m : group.mix) {
+          if (pick < m.weight) { msg = &m; break; }
+          pick -= m.weight;
+        }
+        if (!ws.sendText(msg->text)) {
+          closed = true;
+          break;
+        }
+        pending.push_back({msg->text, now});
+        StreamStats& s = results.lock(streamName(msg->text));
+        s.sent++;
+        results.unlock();
+        nextSend = now + (int64_t)(gap(rng) * 1e6);
+      }
+
+      // Expire messages that never got their reply
+      int64_t cutoff = now - (int64_t)sc.timeoutMs * 1000;
+      while (!pending.empty() && pending.front().sentUs < cutoff) {
+        StreamStats& s = results.lock(streamName(pending.front().text));
+        s.drops++;
+        results.unlock();
+        pending.pop_front();
+      }
+
+      int waitMs = (int)std::max<int64_t>(0, std::min<int64_t>(nextSend - nowUs(), 50000) / 1000);
+      std::string reply;
+      int r = ws.receive(reply, waitMs);
+      if (r < 0) {
+        closed = true;
+        break;
+      }
+      if (r == 0) continue;
+
+      int64_t at = nowUs();
+      for (auto it = pending.begin(); it != pending.end(); ++it) {
+        bool nack;
+        if (!matches(it->text, reply, nack)) continue;
+        StreamStats& s = results.lock(streamName(it->text));
+        s.replies++;
+        if (nack) {
+          s.nacks++;
+          s.codes[reply.substr(6, 24)]++;
+        }
+        s.latency.record(at - it->sentUs);
+        results.unlock();
+        pending.erase(it);
+        break;
+      }
+    }
+
+    if (closed) {
+      StreamStats& s = results.lock("ws connect");
+      s.errors++;
+      s.codes["closed"]++;
+      results.unlock();
+      for (auto& p : pending) {
+        StreamStats& ps = results.lock(streamName(p.text));
+        ps.drops++;
+        results.unlock();
+      }
+    }
+  }
+}
+
+static void httpWorker(const Scenario& sc, const HttpGroup& group, const std::string& token,
+                       Results& results, int64_t endUs, std::atomic<bool>& stop, unsigned seed) {
+  std::mt19937 rng(seed);
+  double perSession = group.rate / std::max(1, group.sessions);
+  std::exponential_distribution<double> gap(perSession > 0 ? perSession : 1);
+  std::string name = "http " + group.method + " " + group.path;
+  int port = sc.httpPort;
+
+  // "path" may carry its own port, e.g. :8080/status for the keep-alive server
+  std::string path = group.path;
+  if (!path.empty() && path[0] == ':') {
+    size_t slash = path.find('/');
+    port = atoi(path.substr(1, slash - 1).c_str());
+    path = slash == std::string::npos ? "/" : path.substr(slash);
+  }
+
+  int fd = -1;
+  while (!stop && nowUs() < endUs) {
+    int64_t start = nowUs();
+    HttpResponse res;
+    bool ok = httpRequest(fd, sc, group.method, path, group.body, token, group.keepAlive, port, res);
+    int64_t done = nowUs();
+
+    StreamStats& s = results.lock(name);
+    s.sent++;
+    if (ok) {
+      s.replies++;
+      s.latency.record(done - start);
+      s.codes[std::to_string(res.status)]++;
+      if (res.status >= 400) s.nacks++;
+    } else {
+      s.errors++;
+      s.codes["io-error"]++;
+    }
+    results.unlock();
+
+    if (!ok && fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+
+    int64_t wait = start + (int64_t)(gap(rng) * 1e6) - nowUs();
+    if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+  }
+  if (fd >= 0) close(fd);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <scenario> [host]\n", argv[0]);
+    return 2;
+  }
+
+  Scenario sc;
+  if (!loadScenario(argv[1], sc)) return 2;
+  if (argc > 2) sc.host = argv[2];
+
+  printf("agvload: %s, %d s, %zu ws group(s), %zu http group(s), rate limit %d/s burst %d\n", sc.host.c_str(),
+         sc.duration, sc.ws.size(), sc.http.size(), sc.rateLimit, sc.rateBurst);
+
+  std::string token;
+  if (!sc.user.empty()) {
+    token = login(sc);
+    printf("login: %s\n", token.empty() ? "FAILED" : "ok");
+  }
+
+  Results results;
+  std::atomic<bool> stop{false};
+  int64_t startUs = nowUs();
+  int64_t endUs = startUs + (int64_t)sc.duration * 1000000;
+  std::vector<std::thread> threads;
+  unsigned seed = 1;
+
+  for (auto& group : sc.ws) {
+    for (int i = 0; i < group.connections; i++) {
+      threads.emplace_back(wsWorker, std::cref(sc), std::cref(group), std::ref(results), endUs,
+                           std::ref(stop), seed++);
+    }
+  }
+  for (auto& group : sc.http) {
+    for (int i = 0; i < group.sessions; i++) {
+      threads.emplace_back(httpWorker, std::cref(sc), std::cref(group), std::cref(token),
+                           std::ref(results), endUs, std::ref(stop), seed++);
+    }
+  }
+
+  int64_t nextReport = startUs + (int64_t)sc.report * 1000000;
+  while (nowUs() < endUs) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if (sc.report > 0 && nowUs() >= nextReport && nowUs() < endUs) {
+      results.print("interim", (nowUs() - startUs) / 1e6);
+      nextReport += (int64_t)sc.report * 1000000;
+    }
+  }
+
+  stop = true;
+  for (auto& t : threads) t.join();
+
+  results.print("final", (nowUs() - startUs) / 1e6);
+
+  uint64_t sent, failed;
+  results.totals(sent, failed);
+  double pct = sent ? 100.0 * failed / sent : 0;
+  printf("\ndrops+errors: %llu of %llu (%.2f%%, limit %.2f%%)\n", (unsigned long long)failed,
+         (unsigned long long)sent, pct, sc.maxErrorPct);
+  return pct > sc.maxErrorPct ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Runs agvload against the whole library built for the host.
+#
+# Builds agvhost (the library, the test/host shim and a small sketch) and
+# agvload, starts agvhost on ports 18080-18082, runs a scenario against it
+# and stops it again. Needs OpenSSL for the WebSocket handshake.
+#
+# Run from anywhere:  test/load/run_host.sh [scenario]   (default host.scenario)
+# Exits with agvload's status; the build products go to test/load/build/.
+
+set -u
+LOAD=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$LOAD/../.." && pwd)
+SHIM="$ROOT/test/host/shim"
+OUT="$LOAD/build"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=gnu++17 -O2 -Wall -Wextra -Wno-unused-parameter}
+SCENARIO=${1:-$LOAD/host.scenario}
+mkdir -p "$OUT"
+cd "$ROOT"
+
+$CXX $CXXFLAGS -pthread -I"$SHIM" -I. -o "$OUT/agvhost" "$LOAD/agvhost.cpp" AGVCoreNetwork*.cpp \
+  "$SHIM/host.cpp" "$SHIM/platform.cpp" "$SHIM/net.cpp" "$SHIM/web.cpp" "$SHIM/websockets.cpp" -lcrypto || exit 1
+$CXX -O2 -std=c++17 -pthread -o "$OUT/agvload" "$LOAD/agvload.cpp" || exit 1
+
+"$OUT/agvhost" > "$OUT/agvhost.log" 2>&1 &
+host=$!
+trap 'kill $host 2>/dev/null' EXIT
+
+# Wait for the web server to come up
+tries=0
+until (exec 3<>/dev/tcp/127.0.0.1/18080) 2>/dev/null; do
+  tries=$((tries + 1))
+  if [ $tries -gt 50 ] || ! kill -0 $host 2>/dev/null; then
+    echo "agvhost did not start; see $OUT/agvhost.log"
+    exit 1
+  fi
+  sleep 0.1
+done
+
+"$OUT/agvload" "$SCENARIO"
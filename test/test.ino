@@ -26,6 +26,14 @@ void onCommandReceived(const char* command, uint8_t source, uint8_t priority) {
   agvNetwork.sendStatus(status.c_str());
 }
 
+// Optional: waypoints of binary path streams, delivered as they are decoded
+void onWaypoint(const AGVCoreNetworkLib::PathDecoder::Waypoint& waypoint) {
+  Serial.printf("Waypoint %u: (%ld, %ld) after %lu cells%s\n", waypoint.index,
+                (long)waypoint.x, (long)waypoint.y, (unsigned long)waypoint.steps,
+                (waypoint.flags & AGVCoreNetworkLib::PathDecoder::WAYPOINT_END) ? " - path complete" : "");
+  // Queue the waypoint for the motion controller here
+}
+
 void setup() {
   Serial.begin(115200);
   delay(1000);
@@ -35,6 +43,7 @@ void setup() {
   
   // 3. Register command callback (connects communication to your AGV logic)
   agvNetwork.setCommandCallback(onCommandReceived);
+  agvNetwork.setWaypointCallback(onWaypoint);
   
   Serial.println("\n✅ AGV system ready!");
   Serial.println("🌐 Web interface: http://factory_agv_01.local");